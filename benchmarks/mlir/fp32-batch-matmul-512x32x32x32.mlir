@@ -0,0 +1,14 @@
+// RUN: tpp-run %s -n 10 \
+// RUN:  -e entry -entry-point-result=void
+
+// BENCH_TOTAL_FLOPS: 33554432
+
+// Many tiny per-head products, as in attention with a small head size.
+func.func @entry(%arg0: tensor<512x32x32xf32>, %arg1: tensor<512x32x32xf32>,
+                 %out: tensor<512x32x32xf32>) -> tensor<512x32x32xf32> {
+  %cst_0 = arith.constant 0.0 : f32
+  %0 = linalg.fill ins(%cst_0 : f32) outs(%out : tensor<512x32x32xf32>) -> tensor<512x32x32xf32>
+  %1 = linalg.batch_matmul ins(%arg0, %arg1 : tensor<512x32x32xf32>, tensor<512x32x32xf32>)
+                           outs(%0 : tensor<512x32x32xf32>) -> tensor<512x32x32xf32>
+  return %1 : tensor<512x32x32xf32>
+}
@@ -0,0 +1,13 @@
+// RUN: tpp-opt %s -pack-conv2DNchwFchw="block-factors=32,32" -rewrite-conv-to-matmul-or-brgemm="enable-brgemm=true" | \
+// RUN: tpp-run -n 10 \
+// RUN:  -e entry -entry-point-result=void
+
+// BENCH_TOTAL_FLOPS: 924844032
+
+// 3x3 with dilation 2 (DeepLab-style atrous conv).
+func.func @entry(%img: tensor<1x256x32x32xf32>, %filter: tensor<256x256x3x3xf32>, %out: tensor<1x256x28x28xf32>) -> tensor<1x256x28x28xf32> {
+  %0 = linalg.conv_2d_nchw_fchw {dilations = dense<2> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+    ins(%img, %filter : tensor<1x256x32x32xf32>, tensor<256x256x3x3xf32>)
+    outs(%out : tensor<1x256x28x28xf32>) -> tensor<1x256x28x28xf32>
+  return %0 : tensor<1x256x28x28xf32>
+}
@@ -0,0 +1,13 @@
+// RUN: tpp-opt %s -pack-conv2DNchwFchw="block-factors=32,32" -rewrite-conv-to-matmul-or-brgemm="enable-brgemm=true" | \
+// RUN: tpp-run -n 10 \
+// RUN:  -e entry -entry-point-result=void
+
+// BENCH_TOTAL_FLOPS: 231211008
+
+// ResNet-50 conv3_1 3x3, stride 2.
+func.func @entry(%img: tensor<1x128x57x57xf32>, %filter: tensor<128x128x3x3xf32>, %out: tensor<1x128x28x28xf32>) -> tensor<1x128x28x28xf32> {
+  %0 = linalg.conv_2d_nchw_fchw {dilations = dense<1> : tensor<2xi64>, strides = dense<2> : tensor<2xi64>}
+    ins(%img, %filter : tensor<1x128x57x57xf32>, tensor<128x128x3x3xf32>)
+    outs(%out : tensor<1x128x28x28xf32>) -> tensor<1x128x28x28xf32>
+  return %0 : tensor<1x128x28x28xf32>
+}
@@ -0,0 +1,26 @@
+// RUN: tpp-run %s -n 10 \
+// RUN:  -e entry -entry-point-result=void
+
+// BENCH_TOTAL_FLOPS: 536870912
+
+// Matmul followed by a scaled exponential, exp(x * scale), in a single
+// generic that does not map to XSMM.
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @entry(%arg0: tensor<256x1024xf32>, %arg1: tensor<1024x1024xf32>,
+                 %out: tensor<256x1024xf32>) -> tensor<256x1024xf32> {
+  %cst_0 = arith.constant 0.0 : f32
+  %0 = linalg.fill ins(%cst_0 : f32) outs(%out : tensor<256x1024xf32>) -> tensor<256x1024xf32>
+  %1 = linalg.matmul ins(%arg0, %arg1 : tensor<256x1024xf32>, tensor<1024x1024xf32>)
+                     outs(%0 : tensor<256x1024xf32>) -> tensor<256x1024xf32>
+  %2 = linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%1 : tensor<256x1024xf32>) {
+    ^bb0(%x: f32):
+      %scale = arith.constant 0.125 : f32
+      %s = arith.mulf %x, %scale : f32
+      %y = math.exp %s : f32
+      linalg.yield %y : f32
+  } -> tensor<256x1024xf32>
+  return %2 : tensor<256x1024xf32>
+}
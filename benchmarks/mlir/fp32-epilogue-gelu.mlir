@@ -0,0 +1,36 @@
+// RUN: tpp-run %s -n 10 \
+// RUN:  -e entry -entry-point-result=void
+
+// BENCH_TOTAL_FLOPS: 536870912
+
+// Matmul followed by a tanh-approximated GELU, which does not map to XSMM:
+// 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @entry(%arg0: tensor<256x1024xf32>, %arg1: tensor<1024x1024xf32>,
+                 %out: tensor<256x1024xf32>) -> tensor<256x1024xf32> {
+  %cst_0 = arith.constant 0.0 : f32
+  %0 = linalg.fill ins(%cst_0 : f32) outs(%out : tensor<256x1024xf32>) -> tensor<256x1024xf32>
+  %1 = linalg.matmul ins(%arg0, %arg1 : tensor<256x1024xf32>, tensor<1024x1024xf32>)
+                     outs(%0 : tensor<256x1024xf32>) -> tensor<256x1024xf32>
+  %2 = linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%1 : tensor<256x1024xf32>) {
+    ^bb0(%x: f32):
+      %half = arith.constant 0.5 : f32
+      %one = arith.constant 1.0 : f32
+      %c = arith.constant 0.044715 : f32
+      %s = arith.constant 0.797884583 : f32
+      %x2 = arith.mulf %x, %x : f32
+      %x3 = arith.mulf %x2, %x : f32
+      %t0 = arith.mulf %c, %x3 : f32
+      %t1 = arith.addf %x, %t0 : f32
+      %t2 = arith.mulf %s, %t1 : f32
+      %t3 = math.tanh %t2 : f32
+      %t4 = arith.addf %one, %t3 : f32
+      %t5 = arith.mulf %half, %x : f32
+      %y = arith.mulf %t5, %t4 : f32
+      linalg.yield %y : f32
+  } -> tensor<256x1024xf32>
+  return %2 : tensor<256x1024xf32>
+}
@@ -0,0 +1,56 @@
+// RUN: tpp-run %s -n 10 \
+// RUN:  -e entry -entry-point-result=void
+
+// BENCH_TOTAL_FLOPS: 2359296
+
+// Layer normalization over rows of 768 elements: mean, variance and the
+// normalization with scale and shift. Maps to a single fused XSMM kernel.
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+func.func @entry(%x: tensor<256x768xf32>, %gamma: tensor<768xf32>,
+                 %beta: tensor<768xf32>) -> tensor<256x768xf32> {
+  %zero = arith.constant 0.0 : f32
+  %invN = arith.constant 0.0013020833333333333 : f32
+  %eps = arith.constant 1.0e-05 : f32
+  %empty = tensor.empty() : tensor<256xf32>
+  %init = linalg.fill ins(%zero : f32) outs(%empty : tensor<256xf32>) -> tensor<256xf32>
+  %mean = linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : tensor<256x768xf32>) outs(%init : tensor<256xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %invN : f32
+      %1 = arith.addf %0, %acc : f32
+      linalg.yield %1 : f32
+  } -> tensor<256xf32>
+  %var = linalg.generic {
+    indexing_maps = [#map, #row, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x, %mean : tensor<256x768xf32>, tensor<256xf32>) outs(%init : tensor<256xf32>) {
+    ^bb0(%in: f32, %m: f32, %acc: f32):
+      %0 = arith.subf %in, %m : f32
+      %1 = arith.mulf %0, %0 : f32
+      %2 = arith.mulf %1, %invN : f32
+      %3 = arith.addf %2, %acc : f32
+      linalg.yield %3 : f32
+  } -> tensor<256xf32>
+  %out = tensor.empty() : tensor<256x768xf32>
+  %res = linalg.generic {
+    indexing_maps = [#map, #row, #row, #col, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %mean, %var, %gamma, %beta
+      : tensor<256x768xf32>, tensor<256xf32>, tensor<256xf32>, tensor<768xf32>, tensor<768xf32>)
+    outs(%out : tensor<256x768xf32>) {
+    ^bb0(%in: f32, %m: f32, %v: f32, %g: f32, %b: f32, %o: f32):
+      %0 = arith.subf %in, %m : f32
+      %1 = arith.addf %v, %eps : f32
+      %2 = math.rsqrt %1 : f32
+      %3 = arith.mulf %0, %2 : f32
+      %4 = arith.mulf %3, %g : f32
+      %5 = arith.addf %4, %b : f32
+      linalg.yield %5 : f32
+  } -> tensor<256x768xf32>
+  return %res : tensor<256x768xf32>
+}
@@ -0,0 +1,22 @@
+// RUN: tpp-run %s -n 10 \
+// RUN:  -e entry -entry-point-result=void
+
+// BENCH_TOTAL_FLOPS: 536870912
+
+// Attention for 4 batches of 8 heads, sequence length 256 and head size 64:
+// softmax(Q x K^T) x V, fused into a single tiled kernel.
+func.func @entry(%Q: tensor<32x256x64xf32>, %K: tensor<32x256x64xf32>,
+                 %V: tensor<32x256x64xf32>, %out: tensor<32x256x64xf32>) -> tensor<32x256x64xf32> {
+  %cst_0 = arith.constant 0.0 : f32
+  %0 = tensor.empty() : tensor<32x256x256xf32>
+  %1 = linalg.fill ins(%cst_0 : f32) outs(%0 : tensor<32x256x256xf32>) -> tensor<32x256x256xf32>
+  %2 = linalg.batch_matmul_transpose_b ins(%Q, %K : tensor<32x256x64xf32>, tensor<32x256x64xf32>)
+                                       outs(%1 : tensor<32x256x256xf32>) -> tensor<32x256x256xf32>
+  %3 = tensor.empty() : tensor<32x256x256xf32>
+  %4 = linalg.softmax dimension(2)
+    ins(%2 : tensor<32x256x256xf32>) outs(%3 : tensor<32x256x256xf32>) -> tensor<32x256x256xf32>
+  %5 = linalg.fill ins(%cst_0 : f32) outs(%out : tensor<32x256x64xf32>) -> tensor<32x256x64xf32>
+  %6 = linalg.batch_matmul ins(%4, %V : tensor<32x256x256xf32>, tensor<32x256x64xf32>)
+                           outs(%5 : tensor<32x256x64xf32>) -> tensor<32x256x64xf32>
+  return %6 : tensor<32x256x64xf32>
+}
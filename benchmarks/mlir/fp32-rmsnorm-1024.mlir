@@ -0,0 +1,43 @@
+// RUN: tpp-run %s -n 10 \
+// RUN:  -e entry -entry-point-result=void
+
+// BENCH_TOTAL_FLOPS: 1835008
+
+// RMS normalization over rows of 1024 elements: mean square and the
+// normalization with scale. Maps to a single fused XSMM kernel.
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+func.func @entry(%x: tensor<256x1024xf32>,
+                 %gamma: tensor<1024xf32>) -> tensor<256x1024xf32> {
+  %zero = arith.constant 0.0 : f32
+  %invN = arith.constant 0.0009765625 : f32
+  %eps = arith.constant 1.0e-05 : f32
+  %empty = tensor.empty() : tensor<256xf32>
+  %init = linalg.fill ins(%zero : f32) outs(%empty : tensor<256xf32>) -> tensor<256xf32>
+  %ms = linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : tensor<256x1024xf32>) outs(%init : tensor<256xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %in : f32
+      %1 = arith.mulf %0, %invN : f32
+      %2 = arith.addf %1, %acc : f32
+      linalg.yield %2 : f32
+  } -> tensor<256xf32>
+  %out = tensor.empty() : tensor<256x1024xf32>
+  %res = linalg.generic {
+    indexing_maps = [#map, #row, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %ms, %gamma : tensor<256x1024xf32>, tensor<256xf32>, tensor<1024xf32>)
+    outs(%out : tensor<256x1024xf32>) {
+    ^bb0(%in: f32, %s: f32, %g: f32, %o: f32):
+      %0 = arith.addf %s, %eps : f32
+      %1 = math.rsqrt %0 : f32
+      %2 = arith.mulf %in, %1 : f32
+      %3 = arith.mulf %2, %g : f32
+      linalg.yield %3 : f32
+  } -> tensor<256x1024xf32>
+  return %res : tensor<256x1024xf32>
+}
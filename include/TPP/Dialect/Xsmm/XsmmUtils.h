@@ -82,6 +82,10 @@ FailureOr<BinaryFlags> getBinaryFlags(Type operandType, Type outputType,
 
 FailureOr<int64_t> getLeadingDim(Type type, size_t pos = 0);
 
+// Return true if libxsmm can apply `kind` as the unary epilogue of a fused
+// brgemm.
+bool isFusableUnaryKind(UnaryKind kind);
+
 FailureOr<FusedMatch> getFusedBrgemmSequenceFromProducer(Operation *op);
 
 ArrayAttr getUnaryDispatchFlags(UnaryOp op);
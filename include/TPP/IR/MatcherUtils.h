@@ -9,6 +9,8 @@
 #ifndef TPP_IR_MATCHERUTILS_H
 #define TPP_IR_MATCHERUTILS_H
 
+#include <optional>
+
 namespace mlir {
 class Value;
 namespace linalg {
@@ -32,6 +34,11 @@ bool isTwoDSubOp(linalg::LinalgOp linalgOp,
 bool isTwoDMulOp(linalg::LinalgOp linalgOp,
                  SmallVectorImpl<Value> *capturedOperands = nullptr);
 
+// Returns true if the linalg operation is a 2d eltwsie floating point
+// division.
+bool isTwoDDivOp(linalg::LinalgOp linalgOp,
+                 SmallVectorImpl<Value> *capturedOperands = nullptr);
+
 // Returns true if the linalg.generic is a 2d eltwise floating point fill
 // operation with zeros.
 bool isTwoDZeroOp(linalg::LinalgOp linalgOp,
@@ -42,6 +49,79 @@ bool isTwoDZeroOp(linalg::LinalgOp linalgOp,
 bool isTwoDReluOp(linalg::LinalgOp linalgOp,
                   SmallVectorImpl<Value> *capturedOperands = nullptr);
 
+// Returns true if the linalg.generic is a 2d eltwise floating point
+// exponential.
+bool isTwoDExpOp(linalg::LinalgOp linalgOp,
+                 SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic is a 2d eltwise floating point tanh.
+bool isTwoDTanhOp(linalg::LinalgOp linalgOp,
+                  SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic is a 2d eltwise floating point sigmoid,
+// 1 / (1 + exp(-x)).
+bool isTwoDSigmoidOp(linalg::LinalgOp linalgOp,
+                     SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic is a 2d eltwise floating point gelu,
+// 0.5 * x * (1 + erf(x / sqrt(2))).
+bool isTwoDGeluOp(linalg::LinalgOp linalgOp,
+                  SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic is a 2d eltwise floating point silu,
+// x * sigmoid(x) or x / (1 + exp(-x)).
+bool isTwoDSiluOp(linalg::LinalgOp linalgOp,
+                  SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic is a 2d eltwise floating point
+// subtraction followed by an exponential, i.e. the numerator of a softmax.
+bool isTwoDSubExpOp(linalg::LinalgOp linalgOp,
+                    SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic is a floating point sum of a 2d input
+// along one of its dimensions. Use `getTwoDReductionDim` to know which one.
+bool isTwoDReduceAddOp(linalg::LinalgOp linalgOp,
+                       SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic is a floating point max of a 2d input
+// along one of its dimensions. Use `getTwoDReductionDim` to know which one.
+bool isTwoDReduceMaxOp(linalg::LinalgOp linalgOp,
+                       SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Return the input dimension reduced by a 2d reduction. The output must either
+// drop the reduced dimension or keep it with size one.
+std::optional<unsigned> getTwoDReductionDim(linalg::LinalgOp linalgOp);
+
+// Returns true if the linalg.generic computes the mean of each row of a 2d
+// input, sum(x / n) along the columns. Captures the input and the output.
+bool isTwoDRowMeanOp(linalg::LinalgOp linalgOp,
+                     SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic computes the mean of the squares of each
+// row of a 2d input, sum(x * x / n). Captures the input and the output.
+bool isTwoDRowMeanSquareOp(linalg::LinalgOp linalgOp,
+                           SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic computes the variance of each row of a 2d
+// input given its mean, sum((x - mean)^2 / n). Captures the input, the mean
+// and the output.
+bool isTwoDRowVarianceOp(linalg::LinalgOp linalgOp,
+                         SmallVectorImpl<Value> *capturedOperands = nullptr);
+
+// Returns true if the linalg.generic normalizes, scales and shifts the rows of
+// a 2d input, (x - mean) * rsqrt(var + eps) * gamma + beta. Captures the input,
+// the mean, the variance, gamma, beta and the output.
+bool isTwoDLayerNormOp(linalg::LinalgOp linalgOp,
+                       SmallVectorImpl<Value> *capturedOperands = nullptr,
+                       double *epsilon = nullptr);
+
+// Returns true if the linalg.generic normalizes and scales the rows of a 2d
+// input by their root mean square, x * rsqrt(mean(x * x) + eps) * gamma.
+// Captures the input, the mean square, gamma and the output.
+bool isTwoDRmsNormOp(linalg::LinalgOp linalgOp,
+                     SmallVectorImpl<Value> *capturedOperands = nullptr,
+                     double *epsilon = nullptr);
+
 // Returns true if the linalg.generic is a 2d floating point copy operation.
 bool isTwoDIdentityOp(linalg::LinalgOp linalgOp,
                       SmallVectorImpl<Value> *capturedOperands = nullptr);
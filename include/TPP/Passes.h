@@ -22,6 +22,10 @@ namespace arith {
 class ArithDialect;
 } // namespace arith
 
+namespace async {
+class AsyncDialect;
+} // namespace async
+
 namespace check {
 class CheckDialect;
 } // namespace check
@@ -56,6 +60,10 @@ namespace memref {
 class MemRefDialect;
 } // namespace memref
 
+namespace omp {
+class OpenMPDialect;
+} // namespace omp
+
 namespace perf {
 class PerfDialect;
 } // namespace perf
@@ -41,14 +41,15 @@ class FuncOp;
 struct MLIRBenchConfig {
   MLIRBenchConfig() = default;
   MLIRBenchConfig(int seed, TensorInitType initType, std::string backend,
-                  bool offloadToDevice)
+                  bool offloadToDevice, bool blockedAbi = false)
       : seed(seed), initType(initType), backend(backend),
-        offloadToDevice(offloadToDevice) {}
+        offloadToDevice(offloadToDevice), blockedAbi(blockedAbi) {}
 
   int seed = 0;
   TensorInitType initType = TensorInitType::Auto;
   std::string backend = "cpu";
   bool offloadToDevice = true;
+  bool blockedAbi = false;
 };
 
 /// MLIRBench - Creates wrapper for calling kernel methods.
@@ -94,6 +95,9 @@ class MLIRBench {
   /// Allocate arguments on target device
   bool offloadToDevice;
 
+  /// Pass kernel arguments and results in blocked layout
+  bool blockedAbi;
+
   /// Gets module's main block
   Block &getModuleBlock();
 
@@ -123,6 +127,8 @@ public:
 
   /// Create and initialize the kernel input arguments
   /// The values are cached locally in a kernel argument list, in order
+  /// With the blocked ABI, the arguments are packed once, right after their
+  /// creation, and the kernel is called with pre-packed inputs
   LogicalResult createKernelArgs();
 
   /// Create main wrapper function, sets insertion point
@@ -17,6 +17,10 @@ namespace mlir {
 class RewriterBase;
 class Value;
 
+namespace func {
+class FuncOp;
+} // namespace func
+
 namespace linalg {
 class GenericOp;
 class LinalgOp;
@@ -41,6 +45,22 @@ FailureOr<SmallVector<Value>> rewriteToBRGemmOp(RewriterBase &rewriter,
 FailureOr<linalg::MatmulOp> rewriteConvToMatmul(RewriterBase &rewriter,
                                                 linalg::LinalgOp linalgOp);
 
+// Rewrite a blocked convolution to BRGEMMs reducing over the blocked input
+// channels, with materialized loops over the output rows and the filter:
+// [N][K'][P][Q][k] += [N][C'][H][W][c] * [K'][C'][R][S][c][k]
+// Strides and dilations are supported, the strides on W become the leading
+// dimension of the image slice.
+FailureOr<linalg::BatchReduceMatmulOp>
+rewriteBlockedConvToBRGemm(RewriterBase &rewriter, linalg::LinalgOp linalgOp);
+
+// Rewrite a blocked convolution to BRGEMMs reducing over the blocked input
+// channels and the filter window, with materialized loops over the output
+// rows only. The blocks of the image are not evenly strided, the returned
+// generic maps to a BRGEMM with a list of block offsets.
+FailureOr<linalg::GenericOp>
+rewriteBlockedConvToOffsetBRGemm(RewriterBase &rewriter,
+                                 linalg::LinalgOp linalgOp);
+
 // Attempt to block a Conv2DNchwFchwOp.
 FailureOr<linalg::GenericOp>
 packConv2DNchwFchwOp(RewriterBase &rewriter, linalg::Conv2DNchwFchwOp linalgOp,
@@ -67,6 +87,13 @@ collapseIterators(RewriterBase &rewriter, linalg::GenericOp genericOp,
 } // namespace linalgx
 
 namespace tpp {
+// Clone `func`, whose dynamic dimensions all have the same runtime size, into
+// a version where they are specialized to `bucket`. The version is named
+// `<func>_b<bucket>` and reused if it already exists.
+FailureOr<func::FuncOp> createShapeBucketVersion(RewriterBase &rewriter,
+                                                 func::FuncOp func,
+                                                 int64_t bucket);
+
 void populateLinalgToXsmmPatterns(RewritePatternSet &patterns);
 void populateSimplifyPacking(RewritePatternSet &patterns);
 void populateSinkPackPatterns(RewritePatternSet &patterns);
@@ -87,12 +87,33 @@ bool validateFullTilesOnDims(TilingInterface tileOp,
                              ArrayRef<size_t> dims = {},
                              int64_t minTileFactor = 2);
 
+// Return true if `linalgOp` is a linalg.batch_matmul whose per-batch m, n and
+// k are static and at most `maxSize`. A `maxSize` of 0 matches nothing.
+bool isSmallBatchMatmul(linalg::LinalgOp linalgOp, int64_t maxSize);
+
 // Rewrite scf.for to scf.forall. Assumes the loop to be parallel and
 // marked with `kLoopId`.
 constexpr const static llvm::StringLiteral kLoopParallel = "parallel";
 constexpr const static llvm::StringLiteral kLoopRoot = "root";
 void populateScfForToForAllRewritePattern(RewritePatternSet &patterns);
 
+// Function attribute requesting the blocked layout ABI: kernel arguments and
+// results are passed in the blocked layout chosen by the compiler. The layout
+// of each converted argument/result is recorded with `kBlockedLayout`, as a
+// dictionary for a single pack or as an array of dictionaries for a chain of
+// packs (e.g., blocking followed by VNNI).
+constexpr const static llvm::StringLiteral kBlockedAbi = "tpp.blocked_abi";
+constexpr const static llvm::StringLiteral kBlockedLayout =
+    "tpp.blocked_layout";
+// Argument attribute marking an input (e.g., weights) as prepacked offline.
+// The argument is passed in the blocked layout even if the function does not
+// use the blocked layout ABI.
+constexpr const static llvm::StringLiteral kPrepacked = "tpp.prepacked";
+// Function attribute requesting static versions of a kernel with a dynamic
+// dimension, one for each shape bucket. Either a unit attribute, to use the
+// default buckets, or an array of the bucket sizes.
+constexpr const static llvm::StringLiteral kShapeBuckets = "tpp.shape_buckets";
+
 // Given a value `val` expand its shape based on `reassociationMap`.
 Value expand(OpBuilder &builder, Location loc, Value val, Type newType,
              ArrayRef<ReassociationIndices> reassociationMap);
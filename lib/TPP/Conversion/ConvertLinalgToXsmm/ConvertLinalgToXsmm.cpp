@@ -19,6 +19,7 @@
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Utils/Utils.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Utils/IndexingUtils.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -62,6 +63,8 @@ struct BrgemmInfo {
   int64_t strideB;
 
   bool isVnni = false;
+  // Position of m in the output, used to query m at runtime if dynamic.
+  unsigned mPosOnC = 0;
 };
 
 } // namespace
@@ -266,7 +269,7 @@ static Value makeOperandShapeRowBroadCastable(RewriterBase &rewriter,
                                 *reassoc);
 }
 
-// Convert linalg.generic to xsmm unary relu or identity op.
+// Convert linalg.generic to xsmm unary relu, identity, exp or activation op.
 struct ConvertGenericToUnary : public OpRewritePattern<linalg::GenericOp> {
   using OpRewritePattern<linalg::GenericOp>::OpRewritePattern;
 
@@ -284,6 +287,19 @@ struct ConvertGenericToUnary : public OpRewritePattern<linalg::GenericOp> {
                                                          &operands)) {
       kind = xsmm::UnaryKindAttr::get(rewriter.getContext(),
                                       xsmm::UnaryKind::IDENTITY);
+    } else if (structured_match::utils::isTwoDExpOp(genericOp, &operands)) {
+      kind = xsmm::UnaryKindAttr::get(rewriter.getContext(),
+                                      xsmm::UnaryKind::EXP);
+    } else if (structured_match::utils::isTwoDTanhOp(genericOp, &operands)) {
+      kind = xsmm::UnaryKindAttr::get(rewriter.getContext(),
+                                      xsmm::UnaryKind::TANH);
+    } else if (structured_match::utils::isTwoDSigmoidOp(genericOp,
+                                                        &operands)) {
+      kind = xsmm::UnaryKindAttr::get(rewriter.getContext(),
+                                      xsmm::UnaryKind::SIGMOID);
+    } else if (structured_match::utils::isTwoDGeluOp(genericOp, &operands)) {
+      kind = xsmm::UnaryKindAttr::get(rewriter.getContext(),
+                                      xsmm::UnaryKind::GELU);
     }
 
     if (!kind || operands.size() != 2)
@@ -400,6 +416,7 @@ static LogicalResult rewriteBinaryOp(RewriterBase &rewriter,
 // 1. Add
 // 2. Mul
 // 3. Sub
+// 4. Div
 struct ConvertGenericToBinary : public OpRewritePattern<linalg::GenericOp> {
   using OpRewritePattern<linalg::GenericOp>::OpRewritePattern;
 
@@ -416,6 +433,8 @@ struct ConvertGenericToBinary : public OpRewritePattern<linalg::GenericOp> {
       kind = xsmm::BinaryKind::MUL;
     else if (structured_match::utils::isTwoDSubOp(genericOp, &operands))
       kind = xsmm::BinaryKind::SUB;
+    else if (structured_match::utils::isTwoDDivOp(genericOp, &operands))
+      kind = xsmm::BinaryKind::DIV;
 
     if (kind == xsmm::BinaryKind::NONE || operands.size() != 3)
       return failure();
@@ -423,6 +442,181 @@ struct ConvertGenericToBinary : public OpRewritePattern<linalg::GenericOp> {
   }
 };
 
+// Convert a linalg.generic reducing a 2d buffer along one of its dimensions to
+// an xsmm unary reduce-add or reduce-max. linalg accumulates into the output,
+// so the reduction must do the same.
+struct ConvertGenericToReduce : public OpRewritePattern<linalg::GenericOp> {
+  using OpRewritePattern<linalg::GenericOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::GenericOp genericOp,
+                                PatternRewriter &rewriter) const override {
+    SmallVector<Value> operands;
+    if (!genericOp.hasPureBufferSemantics())
+      return failure();
+
+    xsmm::UnaryKind kind = xsmm::UnaryKind::NONE;
+    if (structured_match::utils::isTwoDReduceAddOp(genericOp, &operands))
+      kind = xsmm::UnaryKind::REDUCE_ADD;
+    else if (structured_match::utils::isTwoDReduceMaxOp(genericOp, &operands))
+      kind = xsmm::UnaryKind::REDUCE_MAX;
+
+    if (kind == xsmm::UnaryKind::NONE || operands.size() != 2)
+      return failure();
+    std::optional<unsigned> reductionDim =
+        structured_match::utils::getTwoDReductionDim(genericOp);
+    if (!reductionDim)
+      return failure();
+
+    Value input = operands[0];
+    Value output = operands[1];
+    auto stridesOnInput = mlir::utils::getStaticStrides(input);
+    if (failed(stridesOnInput) || stridesOnInput->back() != 1)
+      return failure();
+    // The reduced values are stored contiguously.
+    auto stridesOnOutput = mlir::utils::getStaticStrides(output);
+    if (failed(stridesOnOutput))
+      return failure();
+    ArrayRef<int64_t> shapeOutput =
+        cast<MemRefType>(output.getType()).getShape();
+    for (auto [size, stride] : llvm::zip(shapeOutput, *stridesOnOutput)) {
+      if (size != 1 && stride != 1)
+        return failure();
+    }
+
+    ArrayRef<int64_t> shapeInput = cast<MemRefType>(input.getType()).getShape();
+    xsmm::UnaryInfo unaryInfo;
+    unaryInfo.m = shapeInput[0];
+    unaryInfo.n = shapeInput[1];
+    unaryInfo.ldi = stridesOnInput->front();
+    unaryInfo.ldo = (*reductionDim == 1) ? unaryInfo.m : unaryInfo.n;
+
+    // XSMM is column-major: reducing the innermost dimension reduces rows.
+    auto reduceFlag = (*reductionDim == 1) ? xsmm::UnaryFlags::REDUCE_ROWS
+                                           : xsmm::UnaryFlags::REDUCE_COLS;
+    SmallVector<Attribute> flagsVec{
+        xsmm::UnaryFlagsAttr::get(rewriter.getContext(), reduceFlag),
+        xsmm::UnaryFlagsAttr::get(rewriter.getContext(),
+                                  xsmm::UnaryFlags::REDUCE_INIT_ACC)};
+    ArrayAttr flags = rewriter.getArrayAttr(flagsVec);
+    xsmm::utils::replaceOpWithUnary(
+        rewriter, genericOp, operands, unaryInfo, flags,
+        xsmm::UnaryKindAttr::get(rewriter.getContext(), kind));
+    return success();
+  }
+};
+
+// Create an xsmm unary dispatch plus invoke of `xsmmTy` from `input` to
+// `output`, without broadcast.
+static void createUnaryOp(RewriterBase &rewriter, Location loc,
+                          xsmm::UnaryKind xsmmTy, xsmm::UnaryInfo unaryInfo,
+                          Value input, Value output) {
+  IntegerType integer64 = IntegerType::get(rewriter.getContext(), 64);
+  DenseI64ArrayAttr dims = DenseI64ArrayAttr::get(
+      rewriter.getContext(), ArrayRef<int64_t>{unaryInfo.m, unaryInfo.n,
+                                               unaryInfo.ldi, unaryInfo.ldo});
+  auto flags = rewriter.getArrayAttr(xsmm::UnaryFlagsAttr::get(
+      rewriter.getContext(), xsmm::UnaryFlags::NONE));
+  auto kind = xsmm::UnaryKindAttr::get(rewriter.getContext(), xsmmTy);
+  auto dtype = xsmm::utils::getDataType(rewriter, output.getType());
+  Value dispatched = rewriter.create<xsmm::UnaryDispatchOp>(
+      loc, integer64, kind, dims, flags, dtype);
+  SmallVector<Value> invokeOperands{dispatched, input, output};
+  rewriter.create<xsmm::UnaryOp>(loc, dtype, kind, invokeOperands);
+}
+
+// Convert the numerator of a softmax, exp(x - max), to an xsmm binary sub
+// followed by an in-place xsmm unary exp. This keeps the max broadcast in the
+// sub instead of materializing it.
+struct ConvertGenericToSubExp : public OpRewritePattern<linalg::GenericOp> {
+  using OpRewritePattern<linalg::GenericOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::GenericOp genericOp,
+                                PatternRewriter &rewriter) const override {
+    SmallVector<Value> operands;
+    if (!genericOp.hasPureBufferSemantics() ||
+        !structured_match::utils::isTwoDSubExpOp(genericOp, &operands) ||
+        operands.size() != 3) {
+      return failure();
+    }
+
+    Value output = operands[2];
+    auto expInfo =
+        xsmm::utils::getUnaryInfo(output, output, xsmm::UnaryFlags::NONE);
+    if (failed(expInfo))
+      return failure();
+
+    Location loc = genericOp.getLoc();
+    Operation *nextOp = genericOp->getNextNode();
+    if (failed(rewriteBinaryOp(rewriter, genericOp, operands,
+                               xsmm::BinaryKind::SUB))) {
+      return failure();
+    }
+
+    rewriter.setInsertionPoint(nextOp);
+    createUnaryOp(rewriter, loc, xsmm::UnaryKind::EXP, *expInfo, output,
+                  output);
+    return success();
+  }
+};
+
+// Convert a silu, x * sigmoid(x), to an xsmm unary sigmoid into a scratch
+// buffer followed by an xsmm binary mul. libxsmm has no silu kernel, and the
+// silu is usually computed in-place so the sigmoid cannot overwrite x.
+struct ConvertGenericToSilu : public OpRewritePattern<linalg::GenericOp> {
+  using OpRewritePattern<linalg::GenericOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::GenericOp genericOp,
+                                PatternRewriter &rewriter) const override {
+    SmallVector<Value> operands;
+    if (!genericOp.hasPureBufferSemantics() ||
+        !structured_match::utils::isTwoDSiluOp(genericOp, &operands) ||
+        operands.size() != 2) {
+      return failure();
+    }
+    // The scratch buffer has the shape of the output, no broadcast.
+    if (genericOp.getNumDpsInputs() != 0 &&
+        !genericOp.getMatchingIndexingMap(genericOp.getDpsInputOperand(0))
+             .isIdentity()) {
+      return failure();
+    }
+
+    Value input = operands[0];
+    Value output = operands[1];
+    auto unaryInfo =
+        xsmm::utils::getUnaryInfo(input, output, xsmm::UnaryFlags::NONE);
+    if (failed(unaryInfo))
+      return failure();
+    xsmm::UnaryInfo sigmoidInfo = *unaryInfo;
+    sigmoidInfo.ldo = sigmoidInfo.n;
+    xsmm::BinaryInfo mulInfo;
+    mulInfo.m = unaryInfo->m;
+    mulInfo.n = unaryInfo->n;
+    mulInfo.ldiLhs = unaryInfo->ldi;
+    mulInfo.ldiRhs = sigmoidInfo.ldo;
+    mulInfo.ldo = unaryInfo->ldo;
+
+    Location loc = genericOp.getLoc();
+    Operation *nextOp = genericOp->getNextNode();
+    auto outputType = cast<MemRefType>(output.getType());
+    Value scratch = rewriter.create<memref::AllocOp>(
+        loc, MemRefType::get(outputType.getShape(),
+                             outputType.getElementType()));
+    createUnaryOp(rewriter, loc, xsmm::UnaryKind::SIGMOID, sigmoidInfo, input,
+                  scratch);
+
+    auto flags = rewriter.getArrayAttr(xsmm::BinaryFlagsAttr::get(
+        rewriter.getContext(), xsmm::BinaryFlags::NONE));
+    auto kind =
+        xsmm::BinaryKindAttr::get(rewriter.getContext(), xsmm::BinaryKind::MUL);
+    replaceOpWithBinary(rewriter, genericOp, {input, scratch, output}, mulInfo,
+                        flags, kind);
+
+    rewriter.setInsertionPoint(nextOp);
+    rewriter.create<memref::DeallocOp>(loc, scratch);
+    return success();
+  }
+};
+
 // Replace linalgOp with a matmul or a batch reduce matmul.
 static void replaceOpWithGemmLikeOp(RewriterBase &rewriter,
                                     linalg::LinalgOp linalgOp,
@@ -453,12 +647,21 @@ static void replaceOpWithGemmLikeOp(RewriterBase &rewriter,
   auto flags = rewriter.getArrayAttr(gemmFlags);
   SmallVector<Value> invokeOperands;
 
+  // A dynamic m is passed at runtime to the dispatch.
+  Value dynamicM;
+  if (ShapedType::isDynamic(m)) {
+    Value dim = rewriter.create<memref::DimOp>(loc, linalgOp.getDpsInits()[0],
+                                               brgemmInfo.mPosOnC);
+    dynamicM = rewriter.create<arith::IndexCastOp>(loc, integer64, dim);
+    m = 0;
+  }
+
   if (batch != 0) {
     DenseI64ArrayAttr dims = DenseI64ArrayAttr::get(
         rewriter.getContext(),
         ArrayRef<int64_t>{m, n, k, lda, ldb, ldc, strideA, strideB});
     Value dispatched = rewriter.create<xsmm::BrgemmDispatchOp>(
-        loc, integer64, dims, flags, dtype);
+        loc, integer64, dims, flags, dtype, dynamicM);
     Value batchDim = rewriter.create<arith::ConstantOp>(
         loc, integer64, rewriter.getIntegerAttr(integer64, batch));
     invokeOperands.push_back(dispatched);
@@ -471,7 +674,7 @@ static void replaceOpWithGemmLikeOp(RewriterBase &rewriter,
     DenseI64ArrayAttr dims = DenseI64ArrayAttr::get(
         rewriter.getContext(), ArrayRef<int64_t>{m, n, k, lda, ldb, ldc});
     Value dispatched = rewriter.create<xsmm::GemmDispatchOp>(
-        loc, integer64, dims, flags, dtype);
+        loc, integer64, dims, flags, dtype, dynamicM);
     invokeOperands.push_back(dispatched);
     invokeOperands.append(linalgOp->getOperands().begin(),
                           linalgOp->getOperands().end());
@@ -479,15 +682,14 @@ static void replaceOpWithGemmLikeOp(RewriterBase &rewriter,
   }
 }
 
-// Structural matcher.
+// Structural matcher. All the loops must be static but m, which is passed at
+// runtime to the dispatch.
 static FailureOr<linalg::ContractionDimensions>
 checkStructure(linalg::LinalgOp linalgOp) {
   // clang-format off
   using namespace structured_match;
   auto maybeBrgemmMatcher =
     StructuredOpMatcher::make<linalg::LinalgOp>()
-      .output(MatchAll(), HasStaticShape())
-      .input(MatchAll(), HasStaticShape())
       .output(MatchAll(), HasStaticStrides())
       .input(MatchAll(), HasStaticStrides())
       .operation(NumOfLoops(GreaterThanOrEqualTo(3)));
@@ -514,6 +716,13 @@ checkStructure(linalg::LinalgOp linalgOp) {
                << "[checkStructure] Not all loops are classified\n");
     return failure();
   }
+  for (auto [idx, loop] : llvm::enumerate(linalgOp.getStaticLoopRanges())) {
+    if (ShapedType::isDynamic(loop) && idx != contractionDims->m[0]) {
+      LLVM_DEBUG(llvm::dbgs() << "[checkStructure] Dynamic loop: " << idx
+                              << "\n");
+      return failure();
+    }
+  }
   return contractionDims;
 }
 
@@ -576,6 +785,7 @@ static FailureOr<BrgemmInfo> checkAccess(linalg::LinalgOp linalgOp, unsigned m,
 
   BrgemmInfo info{loops[m], loops[n], loops[k], batchVal, *lda,
                   *ldb,     *ldc,     strideA,  strideB};
+  info.mPosOnC = *getPosInCodomain(m, operandC, linalgOp);
   return info;
 }
 
@@ -630,6 +840,363 @@ struct ConvertGenericToBrgemm : public OpRewritePattern<linalg::GenericOp> {
   }
 };
 
+// Check if `linalgOp` is a batch of independent GEMMs: a static contraction
+// with 1 batch, 1 m, 1 n and 1 k dimensions. The batch dimension is parallel,
+// the GEMMs are not reduced together as in a BRGEMM. On success `batchPos`
+// holds the position of the batch loop.
+static FailureOr<BrgemmInfo> isMappableToBatchGemm(linalg::LinalgOp linalgOp,
+                                                   unsigned &batchPos) {
+  // clang-format off
+  using namespace structured_match;
+  auto batchGemmMatcher =
+    StructuredOpMatcher::make<linalg::LinalgOp>()
+      .output(MatchAll(), HasStaticStrides())
+      .input(MatchAll(), HasStaticStrides())
+      .operation(NumOfLoops(EqualsTo(4)));
+  // clang-format on
+  if (!batchGemmMatcher.match(linalgOp))
+    return failure();
+
+  auto contractionDims = linalgx::utils::isContraction(linalgOp);
+  if (failed(contractionDims) || contractionDims->batch.size() != 1 ||
+      contractionDims->m.size() != 1 || contractionDims->n.size() != 1 ||
+      contractionDims->k.size() != 1) {
+    LLVM_DEBUG(llvm::dbgs() << "[isMappableToBatchGemm] Wrong dimensions\n");
+    return failure();
+  }
+  if (linalgOp.hasDynamicShape()) {
+    LLVM_DEBUG(llvm::dbgs() << "[isMappableToBatchGemm] Dynamic shape\n");
+    return failure();
+  }
+
+  batchPos = contractionDims->batch[0];
+  for (OpOperand &operand : linalgOp->getOpOperands()) {
+    if (!getPosInCodomain(batchPos, &operand, linalgOp))
+      return failure();
+  }
+
+  // The batch dimension is sliced away, the GEMM sees the remaining 2d views
+  // with the same leading dimensions.
+  auto gemmInfo =
+      checkAccess(linalgOp, contractionDims->m[0], contractionDims->n[0],
+                  contractionDims->k[0], /*batchPos=*/std::nullopt);
+  if (failed(gemmInfo))
+    return failure();
+  gemmInfo->batch = linalgOp.getStaticLoopRanges()[batchPos];
+  return gemmInfo;
+}
+
+// Return the 2d view of `operand` at `offset` along the batch dimension.
+static Value getGemmOperandView(OpBuilder &builder, Location loc,
+                                linalg::LinalgOp linalgOp, OpOperand *operand,
+                                unsigned batchPos, OpFoldResult offset) {
+  Value source = operand->get();
+  auto sourceType = cast<MemRefType>(source.getType());
+  unsigned batchPosOnOperand = *getPosInCodomain(batchPos, operand, linalgOp);
+
+  int64_t rank = sourceType.getRank();
+  SmallVector<OpFoldResult> offsets(rank, builder.getIndexAttr(0));
+  SmallVector<OpFoldResult> sizes;
+  SmallVector<OpFoldResult> strides(rank, builder.getIndexAttr(1));
+  SmallVector<int64_t> viewShape;
+  for (auto [idx, size] : llvm::enumerate(sourceType.getShape())) {
+    if (idx == batchPosOnOperand) {
+      offsets[idx] = offset;
+      sizes.push_back(builder.getIndexAttr(1));
+      continue;
+    }
+    sizes.push_back(builder.getIndexAttr(size));
+    viewShape.push_back(size);
+  }
+  auto viewType =
+      cast<MemRefType>(memref::SubViewOp::inferRankReducedResultType(
+          viewShape, sourceType, offsets, sizes, strides));
+  return builder.create<memref::SubViewOp>(loc, viewType, source, offsets,
+                                           sizes, strides);
+}
+
+// Replace a batch of GEMMs with a single GEMM dispatch and an scf.parallel
+// over the batch invoking the kernel on the 2d views of the operands. A batch
+// of one is invoked directly.
+static void replaceOpWithGemmLoop(RewriterBase &rewriter,
+                                  linalg::LinalgOp linalgOp,
+                                  const BrgemmInfo &gemmInfo,
+                                  unsigned batchPos) {
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(linalgOp);
+  Location loc = linalgOp.getLoc();
+  IntegerType integer64 = rewriter.getI64Type();
+  auto dtype =
+      xsmm::utils::getDataType(rewriter, linalgOp.getDpsInits()[0].getType());
+  auto flags = rewriter.getArrayAttr(
+      xsmm::GemmFlagsAttr::get(rewriter.getContext(), xsmm::GemmFlags::NONE));
+  DenseI64ArrayAttr dims = DenseI64ArrayAttr::get(
+      rewriter.getContext(),
+      ArrayRef<int64_t>{gemmInfo.m, gemmInfo.n, gemmInfo.k, gemmInfo.lda,
+                        gemmInfo.ldb, gemmInfo.ldc});
+  Value dispatched = rewriter.create<xsmm::GemmDispatchOp>(
+      loc, integer64, dims, flags, dtype, /*dynamicM=*/Value());
+
+  auto buildGemm = [&](OpBuilder &builder, OpFoldResult offset) {
+    SmallVector<Value> invokeOperands{dispatched};
+    for (OpOperand &operand : linalgOp->getOpOperands()) {
+      invokeOperands.push_back(getGemmOperandView(builder, loc, linalgOp,
+                                                  &operand, batchPos, offset));
+    }
+    builder.create<xsmm::GemmOp>(loc, dtype, invokeOperands);
+  };
+
+  if (gemmInfo.batch == 1) {
+    buildGemm(rewriter, rewriter.getIndexAttr(0));
+  } else {
+    Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    Value batch = rewriter.create<arith::ConstantIndexOp>(loc, gemmInfo.batch);
+    rewriter.create<scf::ParallelOp>(
+        loc, ValueRange{zero}, ValueRange{batch}, ValueRange{one},
+        [&](OpBuilder &builder, Location, ValueRange ivs) {
+          buildGemm(builder, ivs[0]);
+        });
+  }
+  rewriter.eraseOp(linalgOp);
+}
+
+// Convert a batch matmul written as a generic to a parallel loop of GEMMs.
+struct ConvertGenericToGemmLoop : public OpRewritePattern<linalg::GenericOp> {
+  using OpRewritePattern<linalg::GenericOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::GenericOp genericOp,
+                                PatternRewriter &rewriter) const override {
+    unsigned batchPos = 0;
+    auto gemmInfo = isMappableToBatchGemm(genericOp, batchPos);
+    if (failed(gemmInfo))
+      return failure();
+    replaceOpWithGemmLoop(rewriter, genericOp, *gemmInfo, batchPos);
+    return success();
+  }
+};
+
+namespace {
+struct BrgemmOffsInfo {
+  int64_t m;
+  int64_t n;
+  int64_t k;
+
+  int64_t lda;
+  int64_t ldb;
+  int64_t ldc;
+
+  // Element offsets of the A and B blocks, one per batch.
+  SmallVector<int64_t> offsetsA;
+  SmallVector<int64_t> offsetsB;
+};
+} // namespace
+
+// Accumulate in `coeffs` and `offset` the linear terms of `expr` scaled by
+// `scale`. Fail if `expr` is not a linear combination of dimensions with
+// constant coefficients.
+static LogicalResult addLinearTerms(AffineExpr expr, int64_t scale,
+                                    SmallVectorImpl<int64_t> &coeffs,
+                                    int64_t &offset) {
+  if (auto dimExpr = dyn_cast<AffineDimExpr>(expr)) {
+    coeffs[dimExpr.getPosition()] += scale;
+    return success();
+  }
+  if (auto cstExpr = dyn_cast<AffineConstantExpr>(expr)) {
+    offset += cstExpr.getValue() * scale;
+    return success();
+  }
+  auto binaryExpr = dyn_cast<AffineBinaryOpExpr>(expr);
+  if (!binaryExpr)
+    return failure();
+  if (expr.getKind() == AffineExprKind::Add) {
+    return success(
+        succeeded(addLinearTerms(binaryExpr.getLHS(), scale, coeffs, offset)) &&
+        succeeded(addLinearTerms(binaryExpr.getRHS(), scale, coeffs, offset)));
+  }
+  if (expr.getKind() == AffineExprKind::Mul) {
+    if (auto cstExpr = dyn_cast<AffineConstantExpr>(binaryExpr.getRHS())) {
+      return addLinearTerms(binaryExpr.getLHS(), scale * cstExpr.getValue(),
+                            coeffs, offset);
+    }
+    if (auto cstExpr = dyn_cast<AffineConstantExpr>(binaryExpr.getLHS())) {
+      return addLinearTerms(binaryExpr.getRHS(), scale * cstExpr.getValue(),
+                            coeffs, offset);
+    }
+  }
+  return failure();
+}
+
+// Return the distance in elements between two consecutive iterations of each
+// loop on `operand`. The distance of the first element accessed from the
+// origin of the buffer is returned in `offset`.
+static FailureOr<SmallVector<int64_t>>
+getLinearAccess(linalg::LinalgOp linalgOp, OpOperand *operand,
+                int64_t &offset) {
+  auto strides = utils::getStaticStrides(operand->get());
+  if (failed(strides))
+    return failure();
+  AffineMap map = linalgOp.getMatchingIndexingMap(operand);
+  SmallVector<int64_t> coeffs(map.getNumDims(), 0);
+  offset = 0;
+  for (auto [expr, stride] : llvm::zip_equal(map.getResults(), *strides)) {
+    if (failed(addLinearTerms(expr, stride, coeffs, offset)))
+      return failure();
+  }
+  return coeffs;
+}
+
+// Check if `linalgOp` is a BRGEMM whose blocks are not evenly strided, e.g. a
+// convolution where the filter window is folded into the reduction. The GEMM
+// dimensions are:
+// -- n, the minor dimension of C with unit stride on B and C.
+// -- m, the other parallel dimension, not accessed by B.
+// -- k, the minor dimension of A with unit stride on A.
+// The remaining reduction dimensions are enumerated into the batch, the offset
+// of each block is computed statically, up to `kMaxBrgemmOffsBatches` blocks;
+// larger batches are left to the default lowering rather than materializing
+// the offset lists.
+static constexpr int64_t kMaxBrgemmOffsBatches = 1024;
+
+static FailureOr<BrgemmOffsInfo>
+isMappableToBrgemmOffs(linalg::LinalgOp linalgOp) {
+  // clang-format off
+  using namespace structured_match;
+  auto brgemmOffsMatcher =
+    StructuredOpMatcher::make<linalg::LinalgOp>()
+      .operation(HasBufferSemantics())
+      .operation(NumDpsInputs(EqualsTo(2)))
+      .operation(NumDpsInits(EqualsTo(1)))
+      .operation(NumOfLoops(GreaterThanOrEqualTo(4)))
+      .output(MatchAll(), HasStaticShape())
+      .input(MatchAll(), HasStaticShape())
+      .region(MatchOne(0), WithOpChain<KindMul, KindAdd>(
+                                     /*captures=*/nullptr));
+  // clang-format on
+  if (!brgemmOffsMatcher.match(linalgOp))
+    return failure();
+  // Only f32, bf16 would require the blocks of B to be VNNI packed.
+  for (Value operand : linalgOp->getOperands()) {
+    if (!getElementTypeOrSelf(operand.getType()).isF32())
+      return failure();
+  }
+  // Evenly strided blocks are handled as a plain BRGEMM.
+  if (succeeded(isMappableToBrgemm(linalgOp)))
+    return failure();
+
+  SmallVector<unsigned> parallelDims;
+  SmallVector<unsigned> reductionDims;
+  linalgOp.getParallelDims(parallelDims);
+  linalgOp.getReductionDims(reductionDims);
+  if (parallelDims.size() != 2)
+    return failure();
+
+  OpOperand *operandA = linalgOp.getDpsInputOperands()[0];
+  OpOperand *operandB = linalgOp.getDpsInputOperands()[1];
+  OpOperand *operandC = &linalgOp.getDpsInitsMutable()[0];
+  int64_t offsetA = 0;
+  int64_t offsetB = 0;
+  int64_t offsetC = 0;
+  auto coeffsA = getLinearAccess(linalgOp, operandA, offsetA);
+  auto coeffsB = getLinearAccess(linalgOp, operandB, offsetB);
+  auto coeffsC = getLinearAccess(linalgOp, operandC, offsetC);
+  if (failed(coeffsA) || failed(coeffsB) || failed(coeffsC) || offsetC != 0)
+    return failure();
+
+  auto minorDimExpr = [&](OpOperand *operand) -> std::optional<unsigned> {
+    AffineMap map = linalgOp.getMatchingIndexingMap(operand);
+    if (map.getNumResults() == 0)
+      return std::nullopt;
+    auto dimExpr = dyn_cast<AffineDimExpr>(map.getResults().back());
+    if (!dimExpr)
+      return std::nullopt;
+    return dimExpr.getPosition();
+  };
+  std::optional<unsigned> n = minorDimExpr(operandC);
+  std::optional<unsigned> k = minorDimExpr(operandA);
+  if (!n || !k || !linalg::isReductionIterator(
+                      linalgOp.getIteratorTypesArray()[*k]))
+    return failure();
+  unsigned m = parallelDims[0] == *n ? parallelDims[1] : parallelDims[0];
+  for (unsigned dim : reductionDims) {
+    if ((*coeffsC)[dim] != 0)
+      return failure();
+  }
+  if ((*coeffsC)[*n] != 1 || (*coeffsB)[*n] != 1 || (*coeffsA)[*n] != 0 ||
+      (*coeffsA)[*k] != 1 || (*coeffsB)[m] != 0) {
+    LLVM_DEBUG(llvm::dbgs() << "[isMappableToBrgemmOffs] Wrong access\n");
+    return failure();
+  }
+
+  SmallVector<int64_t> loops = linalgOp.getStaticLoopRanges();
+  BrgemmOffsInfo info{loops[m],        loops[n],        loops[*k],
+                      (*coeffsA)[m],   (*coeffsB)[*k],  (*coeffsC)[m],
+                      /*offsetsA=*/{}, /*offsetsB=*/{}};
+
+  SmallVector<unsigned> batchDims;
+  SmallVector<int64_t> batchSizes;
+  for (unsigned dim : reductionDims) {
+    if (dim == *k)
+      continue;
+    batchDims.push_back(dim);
+    batchSizes.push_back(loops[dim]);
+  }
+  SmallVector<int64_t> batchStrides = computeStrides(batchSizes);
+  int64_t numBatches = computeProduct(batchSizes);
+  if (numBatches > kMaxBrgemmOffsBatches) {
+    LLVM_DEBUG(llvm::dbgs()
+               << "[isMappableToBrgemmOffs] Too many batches: " << numBatches
+               << "\n");
+    return failure();
+  }
+  for (int64_t idx = 0; idx < numBatches; idx++) {
+    SmallVector<int64_t> ivs = delinearize(idx, batchStrides);
+    int64_t blockA = offsetA;
+    int64_t blockB = offsetB;
+    for (auto [dim, iv] : llvm::zip_equal(batchDims, ivs)) {
+      blockA += iv * (*coeffsA)[dim];
+      blockB += iv * (*coeffsB)[dim];
+    }
+    if (blockA < 0 || blockB < 0)
+      return failure();
+    info.offsetsA.push_back(blockA);
+    info.offsetsB.push_back(blockB);
+  }
+  return info;
+}
+
+// Convert a contraction whose blocks are at arbitrary static offsets to an
+// XSMM brgemm with offset lists.
+struct ConvertGenericToBrgemmOffs
+    : public OpRewritePattern<linalg::GenericOp> {
+  using OpRewritePattern<linalg::GenericOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::GenericOp genericOp,
+                                PatternRewriter &rewriter) const override {
+    auto info = isMappableToBrgemmOffs(genericOp);
+    if (failed(info))
+      return failure();
+
+    Location loc = genericOp.getLoc();
+    auto dtype =
+        xsmm::utils::getDataType(rewriter, genericOp.getDpsInits()[0].getType());
+    auto flags = rewriter.getArrayAttr(
+        xsmm::GemmFlagsAttr::get(rewriter.getContext(), xsmm::GemmFlags::NONE));
+    DenseI64ArrayAttr dims = rewriter.getDenseI64ArrayAttr(
+        {info->m, info->n, info->k, info->lda, info->ldb, info->ldc});
+    Value dispatched = rewriter.create<xsmm::BrgemmOffsDispatchOp>(
+        loc, rewriter.getI64Type(), dims, flags, dtype);
+    SmallVector<Value> invokeOperands{dispatched};
+    invokeOperands.append(genericOp->getOperands().begin(),
+                          genericOp->getOperands().end());
+    rewriter.replaceOpWithNewOp<xsmm::BrgemmOffsOp>(
+        genericOp, dtype, invokeOperands,
+        rewriter.getDenseI64ArrayAttr(info->offsetsA),
+        rewriter.getDenseI64ArrayAttr(info->offsetsB));
+    return success();
+  }
+};
+
 // Emit a transpose operation for `operand` by swapping `dim` with `newDim`.
 // Emit a transpose operation for `operand` by swapping the dimensions at index
 // `dim` with `newDim`.
@@ -788,6 +1355,224 @@ makeMinorDimensionsInnerMost(RewriterBase &rewriter, linalg::GenericOp linalgOp,
   return linalgOp;
 }
 
+// Return the buffer `value` is a view of.
+static Value getUnderlyingBuffer(Value value) {
+  while (auto view = value.getDefiningOp<ViewLikeOpInterface>())
+    value = view.getViewSource();
+  return value;
+}
+
+// Return true if `value` is a memref.alloc only accessed directly, i.e. all
+// its readers and writers are among its users.
+static bool isPlainAlloc(Value value) {
+  return value.getDefiningOp<memref::AllocOp>() &&
+         llvm::none_of(value.getUsers(), [](Operation *user) {
+           return isa<ViewLikeOpInterface>(user);
+         });
+}
+
+// Return the target of `op` if it copies a buffer into another.
+static Value getCopyTarget(Operation *op) {
+  if (auto copyOp = dyn_cast<linalg::CopyOp>(op))
+    return copyOp.getDpsInits()[0];
+  if (auto copyOp = dyn_cast<memref::CopyOp>(op))
+    return copyOp.getTarget();
+  return Value();
+}
+
+static Value getCopySource(Operation *op) {
+  if (auto copyOp = dyn_cast<linalg::CopyOp>(op))
+    return copyOp.getDpsInputs()[0];
+  return cast<memref::CopyOp>(op).getSource();
+}
+
+// Return true if the plain alloc `buffer` holds zeros right before `op`. The
+// zeros are either filled in or copied from another zero-filled buffer.
+static bool isZeroInitialized(Value buffer, Operation *op) {
+  if (!isPlainAlloc(buffer))
+    return false;
+  for (Operation *prev = op->getPrevNode(); prev; prev = prev->getPrevNode()) {
+    if (!llvm::is_contained(prev->getOperands(), buffer))
+      continue;
+    if (auto fillOp = dyn_cast<linalg::FillOp>(prev)) {
+      if (fillOp.getDpsInits()[0] != buffer)
+        continue;
+      return mlir::utils::isValConstZero(fillOp.getDpsInputs()[0]);
+    }
+    if (Value target = getCopyTarget(prev)) {
+      if (target != buffer)
+        continue;
+      return isZeroInitialized(getCopySource(prev), prev);
+    }
+    // Reading the buffer leaves it untouched.
+    auto linalgOp = dyn_cast<linalg::LinalgOp>(prev);
+    if (linalgOp && !llvm::is_contained(linalgOp.getDpsInits(), buffer))
+      continue;
+    return false;
+  }
+  return false;
+}
+
+namespace {
+// A row-wise normalization: the reductions computing the row statistics and
+// the operation normalizing, scaling and shifting the rows.
+struct NormInfo {
+  xsmm::NormKind kind;
+  double epsilon;
+  linalg::GenericOp root;
+  // The mean and the variance, or the mean square.
+  SmallVector<linalg::GenericOp, 2> stats;
+  // x, gamma, [beta], out.
+  SmallVector<Value, 4> operands;
+};
+} // namespace
+
+// Collect the normalization rooted at `root`, matching the reductions which
+// produce its statistics.
+static FailureOr<NormInfo> getNormInfo(linalg::GenericOp root) {
+  if (!root.hasPureBufferSemantics())
+    return failure();
+  NormInfo info;
+  info.root = root;
+  SmallVector<Value> captured;
+  SmallVector<Value, 2> statBuffers;
+  if (structured_match::utils::isTwoDLayerNormOp(root, &captured,
+                                                 &info.epsilon)) {
+    info.kind = xsmm::NormKind::LAYERNORM;
+    statBuffers = {captured[1], captured[2]};
+    info.operands = {captured[0], captured[3], captured[4], captured[5]};
+  } else if (structured_match::utils::isTwoDRmsNormOp(root, &captured,
+                                                      &info.epsilon)) {
+    info.kind = xsmm::NormKind::RMSNORM;
+    statBuffers = {captured[1]};
+    info.operands = {captured[0], captured[2], captured[3]};
+  } else {
+    return failure();
+  }
+  Value x = info.operands[0];
+
+  // Each statistic is produced by the closest preceding writer of its buffer.
+  for (auto [idx, buffer] : llvm::enumerate(statBuffers)) {
+    linalg::GenericOp statOp;
+    for (Operation *prev = root->getPrevNode(); prev && !statOp;
+         prev = prev->getPrevNode()) {
+      auto genericOp = dyn_cast<linalg::GenericOp>(prev);
+      if (genericOp && genericOp.getNumDpsInits() == 1 &&
+          genericOp.getDpsInits()[0] == buffer) {
+        statOp = genericOp;
+      }
+    }
+    if (!statOp)
+      return failure();
+    SmallVector<Value> statOperands;
+    bool matched = false;
+    if (info.kind == xsmm::NormKind::RMSNORM) {
+      matched = structured_match::utils::isTwoDRowMeanSquareOp(statOp,
+                                                               &statOperands);
+    } else if (idx == 0) {
+      matched = structured_match::utils::isTwoDRowMeanOp(statOp, &statOperands);
+    } else {
+      // The variance is centered on the mean matched above.
+      matched =
+          structured_match::utils::isTwoDRowVarianceOp(statOp, &statOperands) &&
+          statOperands[1] == statBuffers[0] &&
+          info.stats[0]->isBeforeInBlock(statOp);
+    }
+    if (!matched || statOperands.front() != x ||
+        !isZeroInitialized(buffer, statOp))
+      return failure();
+    info.stats.push_back(statOp);
+  }
+
+  auto isStat = [&](Operation *op) {
+    return llvm::any_of(info.stats, [&](linalg::GenericOp statOp) {
+      return statOp.getOperation() == op;
+    });
+  };
+
+  // The statistics are only used by the normalization, they are dropped with
+  // their zero initialization.
+  for (Value buffer : statBuffers) {
+    for (Operation *user : buffer.getUsers()) {
+      if (user == root.getOperation() || isStat(user) || isa<memref::DeallocOp>(user)) {
+        continue;
+      }
+      Value target = isa<linalg::FillOp>(user)
+                         ? cast<linalg::FillOp>(user).getDpsInits()[0]
+                         : getCopyTarget(user);
+      if (!target || !llvm::is_contained(statBuffers, target))
+        return failure();
+    }
+  }
+
+  // x must not change between the first reduction and the normalization.
+  Value xBuffer = getUnderlyingBuffer(x);
+  for (Operation *op = info.stats.front()->getNextNode();
+       op != root.getOperation(); op = op->getNextNode()) {
+    if (isStat(op))
+      continue;
+    if (auto linalgOp = dyn_cast<linalg::LinalgOp>(op)) {
+      if (llvm::any_of(linalgOp.getDpsInits(), [&](Value init) {
+            return getUnderlyingBuffer(init) == xBuffer;
+          })) {
+        return failure();
+      }
+      continue;
+    }
+    auto effects = dyn_cast<MemoryEffectOpInterface>(op);
+    if (!effects || effects.hasEffect<MemoryEffects::Write>())
+      return failure();
+  }
+
+  // The rows are contiguous, and so are gamma and beta.
+  for (Value operand : info.operands) {
+    auto strides = mlir::utils::getStaticStrides(operand);
+    if (failed(strides) || strides->back() != 1)
+      return failure();
+  }
+  return info;
+}
+
+// Replace the normalization with an xsmm norm dispatch plus invoke, which
+// reads each row once and writes it once. Drop the reductions and the
+// buffers holding the statistics.
+static void fuseNormalization(RewriterBase &rewriter, NormInfo &info) {
+  linalg::GenericOp root = info.root;
+  Location loc = root.getLoc();
+  Value x = info.operands.front();
+  Value output = info.operands.back();
+  ArrayRef<int64_t> shape = cast<MemRefType>(x.getType()).getShape();
+  int64_t ldi = mlir::utils::getStaticStrides(x)->front();
+  int64_t ldo = mlir::utils::getStaticStrides(output)->front();
+
+  rewriter.setInsertionPoint(root);
+  IntegerType integer64 = IntegerType::get(rewriter.getContext(), 64);
+  DenseI64ArrayAttr dims = DenseI64ArrayAttr::get(
+      rewriter.getContext(), ArrayRef<int64_t>{shape[0], shape[1], ldi, ldo});
+  auto kind = xsmm::NormKindAttr::get(rewriter.getContext(), info.kind);
+  auto dtype = xsmm::utils::getDataType(rewriter, output.getType());
+  Value dispatched = rewriter.create<xsmm::NormDispatchOp>(
+      loc, integer64, kind, dims,
+      rewriter.getF32FloatAttr(static_cast<float>(info.epsilon)), dtype);
+  SmallVector<Value> invokeOperands{dispatched};
+  invokeOperands.append(info.operands.begin(), info.operands.end());
+  rewriter.replaceOpWithNewOp<xsmm::NormOp>(root, dtype, kind, invokeOperands);
+
+  SmallVector<Value, 2> statBuffers;
+  for (linalg::GenericOp statOp : llvm::reverse(info.stats)) {
+    statBuffers.push_back(statOp.getDpsInits()[0]);
+    rewriter.eraseOp(statOp);
+  }
+  for (Value buffer : statBuffers) {
+    for (Operation *user : llvm::make_early_inc_range(buffer.getUsers()))
+      rewriter.eraseOp(user);
+  }
+  for (Value buffer : statBuffers) {
+    if (buffer.use_empty())
+      rewriter.eraseOp(buffer.getDefiningOp());
+  }
+}
+
 void ConvertLinalgToXsmm::runOnOperation() {
   MLIRContext *ctx = &getContext();
   RewritePatternSet patterns(ctx);
@@ -808,7 +1593,10 @@ void ConvertLinalgToXsmm::runOnOperation() {
 
     if (failed(checkAccess(genericOp, m, n, k, batch))) {
       // The generic is a Brgemm but the strides of the selected dims (m, n, k)
-      // are not unit strides. Inject transposes to bring them innermost.
+      // are not unit strides. Inject transposes to bring them innermost. The
+      // transposes are only materialized for static shapes.
+      if (genericOp.hasDynamicShape())
+        return WalkResult::skip();
       if (failed(makeMinorDimensionsInnerMost(rewriter, genericOp, m, n, k))) {
         return WalkResult::interrupt();
       }
@@ -819,6 +1607,17 @@ void ConvertLinalgToXsmm::runOnOperation() {
     LLVM_DEBUG(llvm::dbgs() << "pass failed!\n");
     return signalPassFailure();
   }
+
+  // Fuse layernorm and rmsnorm before their reductions get mapped on their
+  // own, which would make several passes over the rows.
+  SmallVector<NormInfo> norms;
+  getOperation()->walk([&](linalg::GenericOp genericOp) {
+    if (auto normInfo = getNormInfo(genericOp); succeeded(normInfo))
+      norms.push_back(*normInfo);
+  });
+  for (NormInfo &normInfo : norms)
+    fuseNormalization(rewriter, normInfo);
+
   tpp::populateLinalgToXsmmPatterns(patterns);
   if (failed(applyPatternsAndFoldGreedily(getOperation(), std::move(patterns))))
     return signalPassFailure();
@@ -1004,6 +1803,22 @@ struct ConvertBatchReduceMatmulToBatchReduceMatmul
   }
 };
 
+// Convert a linalg.batch_matmul to a parallel loop of XSMM gemm ops.
+struct ConvertBatchMatmulToGemmLoop
+    : public OpRewritePattern<linalg::BatchMatmulOp> {
+  using OpRewritePattern<linalg::BatchMatmulOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::BatchMatmulOp batchMatmulOp,
+                                PatternRewriter &rewriter) const override {
+    unsigned batchPos = 0;
+    auto gemmInfo = isMappableToBatchGemm(batchMatmulOp, batchPos);
+    if (failed(gemmInfo))
+      return failure();
+    replaceOpWithGemmLoop(rewriter, batchMatmulOp, *gemmInfo, batchPos);
+    return success();
+  }
+};
+
 // Convert a vnni pack to xsmm norm to vnni op. It assumes the pack to be
 // decomposed as an expand.shape + linalg.transpose.
 struct ConvertVnniPacking : public OpRewritePattern<linalg::TransposeOp> {
@@ -1065,6 +1880,8 @@ struct ConvertGenericToVnniMatmulLikeOp
     if (!genericOp.hasPureBufferSemantics()) {
       return rewriter.notifyMatchFailure(genericOp, "expects buffer semantics");
     }
+    if (genericOp.hasDynamicShape())
+      return rewriter.notifyMatchFailure(genericOp, "expects static shapes");
 
     auto [isBrgemmOp, hasBatch] = structured_match::utils::isBrgemmVnniOp(
         genericOp, /*operands=*/nullptr);
@@ -1144,8 +1961,10 @@ struct ConvertCopyOp : public OpRewritePattern<linalg::CopyOp> {
 void mlir::tpp::populateLinalgToXsmmPatterns(RewritePatternSet &patterns) {
   patterns.add<
       ConvertFillOpToUnaryZero, ConvertTransposeOpToUnaryTranspose,
-      ConvertGenericToUnary, ConvertGenericToBinary, ConvertGenericToBrgemm,
+      ConvertGenericToUnary, ConvertGenericToBinary, ConvertGenericToReduce,
+      ConvertGenericToSubExp, ConvertGenericToSilu, ConvertGenericToBrgemm,
+      ConvertGenericToGemmLoop, ConvertGenericToBrgemmOffs,
       ConvertBatchReduceMatmulToBatchReduceMatmul, ConvertMatmulToMatmul,
-      ConvertVnniPacking, ConvertGenericToVnniMatmulLikeOp, ConvertCopyOp>(
-      patterns.getContext());
+      ConvertBatchMatmulToGemmLoop, ConvertVnniPacking,
+      ConvertGenericToVnniMatmulLikeOp, ConvertCopyOp>(patterns.getContext());
 }
@@ -93,7 +93,7 @@ static SmallVector<Value> getNormalizedOperands(OpBuilder &b, Location loc,
 
 // Create a perf function prototype.
 static func::FuncOp createPerfFuncPrototype(Location loc, const std::string& funcName,
-                                            Operation *op,
+                                            Operation *op, ValueRange operands,
                                             PatternRewriter &rewriter) {
   // Insert before module terminator.
   ModuleOp module = op->getParentOfType<ModuleOp>();
@@ -103,7 +103,7 @@ static func::FuncOp createPerfFuncPrototype(Location loc, const std::string& fun
 
   FlatSymbolRefAttr fnName = SymbolRefAttr::get(op->getContext(), funcName);
   auto libFnType = rewriter.getFunctionType(
-      extractNormalizedTypes(rewriter, op->getOperands()),
+      extractNormalizedTypes(rewriter, operands),
       extractNormalizedTypes(rewriter, op->getResults()));
 
   auto funcOp =
@@ -118,7 +118,8 @@ static LogicalResult buildPerfSinkFunc(Location loc,
                                        const std::string &funcName,
                                        Operation *op,
                                        PatternRewriter &rewriter) {
-  auto funcOp = createPerfFuncPrototype(loc, std::move(funcName), op, rewriter);
+  auto funcOp = createPerfFuncPrototype(loc, std::move(funcName), op,
+                                        op->getOperands(), rewriter);
 
   // Add function attributes which ensure that the passed data and its producers
   // operations cannot be optimized away such that the time measured by a
@@ -143,17 +144,19 @@ static LogicalResult buildPerfSinkFunc(Location loc,
 // The function implementation has to be provided externally by the end user.
 static LogicalResult buildPerfRuntimeFunc(Location loc,
                                           const std::string &funcName,
-                                          Operation *op,
+                                          Operation *op, ValueRange operands,
                                           PatternRewriter &rewriter) {
-  (void)createPerfFuncPrototype(loc, std::move(funcName), op, rewriter);
+  (void)createPerfFuncPrototype(loc, std::move(funcName), op, operands,
+                                rewriter);
   return success();
 }
 
 // Insert calls to functions implementing corresponding perf op functionality.
 // If a function is unavailable in the current module, the function's builder
-// is called.
+// is called. The function takes `operands`, which default to the operands of
+// the op.
 static LogicalResult buildPerfFuncCall(Location loc, std::string funcName,
-                                       Operation *op,
+                                       Operation *op, ValueRange operands,
                                        PatternRewriter &rewriter) {
   if (op->getNumResults() > 1)
     return op->emitError(
@@ -170,7 +173,8 @@ static LogicalResult buildPerfFuncCall(Location loc, std::string funcName,
                      return buildPerfSinkFunc(loc, funcName, op, rewriter);
                    })
                    .Default([&](Operation *op) {
-                     return buildPerfRuntimeFunc(loc, funcName, op, rewriter);
+                     return buildPerfRuntimeFunc(loc, funcName, op, operands,
+                                                 rewriter);
                    });
     if (failed(res))
       return res;
@@ -180,12 +184,19 @@ static LogicalResult buildPerfFuncCall(Location loc, std::string funcName,
   auto funcCall = rewriter.create<func::CallOp>(
       loc, fnName.getValue(),
       extractNormalizedTypes(rewriter, op->getResults()),
-      getNormalizedOperands(rewriter, loc, op->getOperands()));
+      getNormalizedOperands(rewriter, loc, operands));
   op->replaceAllUsesWith(funcCall.getResults());
 
   return success();
 }
 
+static LogicalResult buildPerfFuncCall(Location loc, std::string funcName,
+                                       Operation *op,
+                                       PatternRewriter &rewriter) {
+  return buildPerfFuncCall(loc, std::move(funcName), op, op->getOperands(),
+                           rewriter);
+}
+
 struct ConvertStartTimerOp : public OpRewritePattern<perf::StartTimerOp> {
   using OpRewritePattern<perf::StartTimerOp>::OpRewritePattern;
 
@@ -232,8 +243,41 @@ struct ConvertSinkOp : public OpRewritePattern<perf::SinkOp> {
   }
 };
 
+struct ConvertTimelineBeginOp
+    : public OpRewritePattern<perf::TimelineBeginOp> {
+  using OpRewritePattern<perf::TimelineBeginOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(perf::TimelineBeginOp beginOp,
+                                PatternRewriter &rewriter) const override {
+    auto res = buildPerfFuncCall(beginOp.getLoc(),
+                                 beginOp.getLibraryCallName(), beginOp,
+                                 rewriter);
+    if (succeeded(res))
+      rewriter.eraseOp(beginOp);
+    return res;
+  }
+};
+
+struct ConvertTimelineEndOp : public OpRewritePattern<perf::TimelineEndOp> {
+  using OpRewritePattern<perf::TimelineEndOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(perf::TimelineEndOp endOp,
+                                PatternRewriter &rewriter) const override {
+    // The event kind is passed to the runtime along with the operands.
+    Value kind = rewriter.create<arith::ConstantOp>(endOp.getLoc(),
+                                                    endOp.getKindAttr());
+    auto res = buildPerfFuncCall(
+        endOp.getLoc(), endOp.getLibraryCallName(), endOp,
+        ValueRange{endOp.getBegin(), kind, endOp.getArg()}, rewriter);
+    if (succeeded(res))
+      rewriter.eraseOp(endOp);
+    return res;
+  }
+};
+
 void populatePerfToFuncPatterns(RewritePatternSet &patterns) {
-  patterns.add<ConvertStartTimerOp, ConvertStopTimerOp, ConvertSinkOp>(
+  patterns.add<ConvertStartTimerOp, ConvertStopTimerOp, ConvertSinkOp,
+               ConvertTimelineBeginOp, ConvertTimelineEndOp>(
       patterns.getContext());
 }
 
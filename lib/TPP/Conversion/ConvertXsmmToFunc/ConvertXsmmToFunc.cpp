@@ -15,6 +15,9 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 using namespace mlir;
@@ -35,7 +38,7 @@ namespace tpp {
 namespace {
 
 static SmallVector<Type> extractInvokeOperandTypes(OpBuilder &builder,
-                                                   OperandRange operands) {
+                                                   ValueRange operands) {
   SmallVector<Type> results;
   // One extra operand for datatype
   IntegerType integer64 = IntegerType::get(builder.getContext(), 64);
@@ -79,11 +82,11 @@ static SmallVector<Value> getOperands(OpBuilder &builder, Location loc,
 
 static void buildInvokeCall(OpBuilder &builder, Location loc,
                             const std::string &funcName, Operation *op,
-                            IntegerAttr dataTypeAttr) {
+                            ValueRange operands, IntegerAttr dataTypeAttr) {
   FlatSymbolRefAttr fnName = SymbolRefAttr::get(op->getContext(), funcName);
   ModuleOp module = op->getParentOfType<ModuleOp>();
-  auto libFnType = builder.getFunctionType(
-      extractInvokeOperandTypes(builder, op->getOperands()), {});
+  auto libFnType =
+      builder.getFunctionType(extractInvokeOperandTypes(builder, operands), {});
 
   if (!module.lookupSymbol(fnName)) {
     OpBuilder::InsertionGuard guard(builder);
@@ -97,7 +100,14 @@ static void buildInvokeCall(OpBuilder &builder, Location loc,
 
   builder.create<func::CallOp>(
       loc, fnName.getValue(), TypeRange(),
-      getOperands(builder, loc, op->getOperands(), dataTypeAttr));
+      getOperands(builder, loc, operands, dataTypeAttr));
+}
+
+static void buildInvokeCall(OpBuilder &builder, Location loc,
+                            const std::string &funcName, Operation *op,
+                            IntegerAttr dataTypeAttr) {
+  buildInvokeCall(builder, loc, funcName, op, op->getOperands(),
+                  dataTypeAttr);
 }
 
 struct ConvertGemmXsmmOp : public OpRewritePattern<GemmOp> {
@@ -126,6 +136,95 @@ struct ConvertBrgemmXsmmOp : public OpRewritePattern<BrgemmOp> {
   }
 };
 
+struct ConvertGemmBatchXsmmOp : public OpRewritePattern<GemmBatchOp> {
+  using OpRewritePattern<GemmBatchOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(GemmBatchOp batchOp,
+                                PatternRewriter &rewriter) const override {
+    std::string funcName = batchOp.isBrgemm() ? "xsmm_brgemm_batch_invoke"
+                                              : "xsmm_gemm_batch_invoke";
+    buildInvokeCall(rewriter, batchOp.getLoc(), funcName, batchOp,
+                    batchOp.getDataTypeAttr());
+    rewriter.eraseOp(batchOp);
+    return success();
+  }
+};
+
+// Return a constant global holding `offsets`. Globals are shared between the
+// invocations using the same offsets.
+static memref::GlobalOp getOrCreateOffsetsGlobal(RewriterBase &rewriter,
+                                                 Location loc, ModuleOp module,
+                                                 DenseIntElementsAttr offsets) {
+  constexpr StringLiteral prefix = "__xsmm_brgemm_offsets_";
+  int64_t numGlobals = 0;
+  for (auto global : module.getOps<memref::GlobalOp>()) {
+    if (!global.getSymName().starts_with(prefix))
+      continue;
+    if (global.getInitialValueAttr() == offsets)
+      return global;
+    numGlobals++;
+  }
+
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPointToStart(module.getBody());
+  auto type = MemRefType::get(offsets.getType().getShape(),
+                              offsets.getType().getElementType());
+  return rewriter.create<memref::GlobalOp>(
+      loc, (prefix + Twine(numGlobals)).str(),
+      /*sym_visibility=*/rewriter.getStringAttr("private"), type, offsets,
+      /*constant=*/true, /*alignment=*/IntegerAttr());
+}
+
+// The offsets are passed to the runtime as constant buffers. LIBXSMM expects
+// them in bytes.
+struct ConvertBrgemmOffsXsmmOp : public OpRewritePattern<BrgemmOffsOp> {
+  using OpRewritePattern<BrgemmOffsOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(BrgemmOffsOp brgemmOp,
+                                PatternRewriter &rewriter) const override {
+    Location loc = brgemmOp.getLoc();
+    ModuleOp module = brgemmOp->getParentOfType<ModuleOp>();
+    int64_t typeSize = brgemmOp.getDataType() == DataType::F32 ? 4 : 2;
+    IntegerType integer64 = rewriter.getI64Type();
+
+    SmallVector<Value> operands(brgemmOp.getInputs());
+    for (ArrayRef<int64_t> offsets :
+         {brgemmOp.getOffsetsA(), brgemmOp.getOffsetsB()}) {
+      SmallVector<int64_t> byteOffsets;
+      for (int64_t offset : offsets)
+        byteOffsets.push_back(offset * typeSize);
+      auto offsetsAttr = DenseIntElementsAttr::get(
+          RankedTensorType::get({static_cast<int64_t>(byteOffsets.size())},
+                                integer64),
+          byteOffsets);
+      memref::GlobalOp global =
+          getOrCreateOffsetsGlobal(rewriter, loc, module, offsetsAttr);
+      operands.push_back(rewriter.create<memref::GetGlobalOp>(
+          loc, global.getType(), global.getSymName()));
+    }
+    operands.push_back(rewriter.create<arith::ConstantOp>(
+        loc, integer64, rewriter.getI64IntegerAttr(brgemmOp.getBatch())));
+
+    buildInvokeCall(rewriter, loc, "xsmm_brgemm_offs_invoke", brgemmOp,
+                    operands, brgemmOp.getDataTypeAttr());
+    rewriter.eraseOp(brgemmOp);
+    return success();
+  }
+};
+
+struct ConvertBrgemmAddrXsmmOp : public OpRewritePattern<BrgemmAddrOp> {
+  using OpRewritePattern<BrgemmAddrOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(BrgemmAddrOp brgemmOp,
+                                PatternRewriter &rewriter) const override {
+    std::string funcName = "xsmm_brgemm_addr_invoke";
+    buildInvokeCall(rewriter, brgemmOp.getLoc(), funcName, brgemmOp,
+                    brgemmOp.getDataTypeAttr());
+    rewriter.eraseOp(brgemmOp);
+    return success();
+  }
+};
+
 struct ConvertUnaryXsmmOp : public OpRewritePattern<UnaryOp> {
   using OpRewritePattern<UnaryOp>::OpRewritePattern;
 
@@ -171,6 +270,22 @@ struct ConvertFusedBrgemmXsmmOp : public OpRewritePattern<FusedBrgemmOp> {
   }
 };
 
+struct ConvertNormXsmmOp : public OpRewritePattern<NormOp> {
+  using OpRewritePattern<NormOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(NormOp normOp,
+                                PatternRewriter &rewriter) const override {
+    // Layernorm and rmsnorm take a different number of operands.
+    std::string funcName = normOp.getCallee() == NormKind::LAYERNORM
+                               ? "xsmm_layernorm_invoke"
+                               : "xsmm_rmsnorm_invoke";
+    buildInvokeCall(rewriter, normOp.getLoc(), funcName, normOp,
+                    normOp.getDataTypeAttr());
+    rewriter.eraseOp(normOp);
+    return success();
+  }
+};
+
 struct ConvertIntelAMXTileConfigXsmmOp
     : public OpRewritePattern<IntelAMXTileConfigOp> {
   using OpRewritePattern<IntelAMXTileConfigOp>::OpRewritePattern;
@@ -241,6 +356,18 @@ void addKindOperand(RewriterBase &rewriter, FusedBrgemmDispatchOp dispatchOp,
   /* do nothing */
 }
 
+void addKindOperand(RewriterBase &rewriter, BrgemmOffsDispatchOp dispatchOp,
+                    SmallVectorImpl<Value> &dispatchOperands,
+                    SmallVectorImpl<Type> &dispatchOperandTypes) {
+  /* do nothing */
+}
+
+void addKindOperand(RewriterBase &rewriter, BrgemmAddrDispatchOp dispatchOp,
+                    SmallVectorImpl<Value> &dispatchOperands,
+                    SmallVectorImpl<Type> &dispatchOperandTypes) {
+  /* do nothing */
+}
+
 void addKindOperand(RewriterBase &rewriter,
                     IntelAMXTileConfigDispatchOp dispatchOp,
                     SmallVectorImpl<Value> &dispatchOperands,
@@ -248,6 +375,15 @@ void addKindOperand(RewriterBase &rewriter,
   /* do nothing */
 }
 
+// Return the runtime m dimension of the dispatch, if any.
+template <typename OpTy> static Value getDynamicM(OpTy dispatchOp) {
+  if constexpr (llvm::is_one_of<OpTy, GemmDispatchOp,
+                                BrgemmDispatchOp>::value) {
+    return dispatchOp.getDynamicM();
+  }
+  return Value();
+}
+
 static int64_t getOredFlags(ArrayAttr flags) {
   int64_t oredFlag = 0;
   for (auto flag : flags) {
@@ -320,10 +456,16 @@ static LogicalResult buildDispatchOp(RewriterBase &rewriter, OpTy dispatchOp,
       loc, integer64, cast<TypedAttr>(dispatchOp.getDataTypeAttr())));
   dispatchOperandTypes.push_back(integer64);
 
-  // Dispatch the inputs.
+  // Dispatch the inputs. A dynamic m replaces the first input, the runtime
+  // caches the kernels for each value of m.
   ArrayRef<int64_t> integers = dispatchOp.getInputsAttr().asArrayRef();
   size_t arrayAttrSize = integers.size();
   for (size_t idx = 0; idx < arrayAttrSize; idx++) {
+    if (Value dynamicM = getDynamicM(dispatchOp); dynamicM && idx == 0) {
+      dispatchOperands.push_back(dynamicM);
+      dispatchOperandTypes.push_back(integer64);
+      continue;
+    }
     IntegerAttr attr = IntegerAttr::get(rewriter.getI64Type(), integers[idx]);
     dispatchOperands.push_back(
         rewriter.create<arith::ConstantOp>(loc, integer64, attr));
@@ -371,6 +513,28 @@ struct ConvertBrgemmDispatchOp : public OpRewritePattern<BrgemmDispatchOp> {
   }
 };
 
+struct ConvertBrgemmOffsDispatchOp
+    : public OpRewritePattern<BrgemmOffsDispatchOp> {
+  using OpRewritePattern<BrgemmOffsDispatchOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(BrgemmOffsDispatchOp dispatchOp,
+                                PatternRewriter &rewriter) const override {
+    return buildDispatchOp<BrgemmOffsDispatchOp>(rewriter, dispatchOp,
+                                                 "xsmm_brgemm_offs_dispatch");
+  }
+};
+
+struct ConvertBrgemmAddrDispatchOp
+    : public OpRewritePattern<BrgemmAddrDispatchOp> {
+  using OpRewritePattern<BrgemmAddrDispatchOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(BrgemmAddrDispatchOp dispatchOp,
+                                PatternRewriter &rewriter) const override {
+    return buildDispatchOp<BrgemmAddrDispatchOp>(rewriter, dispatchOp,
+                                                 "xsmm_brgemm_addr_dispatch");
+  }
+};
+
 struct ConvertBinaryDispatchOp : public OpRewritePattern<BinaryDispatchOp> {
   using OpRewritePattern<BinaryDispatchOp>::OpRewritePattern;
 
@@ -391,6 +555,40 @@ struct ConvertUnaryDispatchOp : public OpRewritePattern<UnaryDispatchOp> {
   }
 };
 
+// The norm dispatch passes the kind, the data type, the inputs and epsilon,
+// there are no flags.
+struct ConvertNormDispatchOp : public OpRewritePattern<NormDispatchOp> {
+  using OpRewritePattern<NormDispatchOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(NormDispatchOp dispatchOp,
+                                PatternRewriter &rewriter) const override {
+    Location loc = dispatchOp.getLoc();
+    IntegerType integer64 = IntegerType::get(rewriter.getContext(), 64);
+    SmallVector<Value, 7> dispatchOperands;
+    dispatchOperands.push_back(rewriter.create<arith::ConstantOp>(
+        loc, integer64, cast<TypedAttr>(dispatchOp.getKindAttr())));
+    dispatchOperands.push_back(rewriter.create<arith::ConstantOp>(
+        loc, integer64, cast<TypedAttr>(dispatchOp.getDataTypeAttr())));
+    for (int64_t input : dispatchOp.getInputs()) {
+      dispatchOperands.push_back(rewriter.create<arith::ConstantOp>(
+          loc, integer64, IntegerAttr::get(integer64, input)));
+    }
+    SmallVector<Type, 7> dispatchOperandTypes(dispatchOperands.size(),
+                                              integer64);
+    dispatchOperands.push_back(
+        rewriter.create<arith::ConstantOp>(loc, dispatchOp.getEpsilonAttr()));
+    dispatchOperandTypes.push_back(rewriter.getF32Type());
+
+    FlatSymbolRefAttr fnName =
+        SymbolRefAttr::get(rewriter.getContext(), "xsmm_norm_dispatch");
+    func::CallOp call = buildDispatchCall(
+        rewriter, loc, dispatchOperands, dispatchOperandTypes,
+        dispatchOp->getParentOfType<ModuleOp>(), fnName);
+    rewriter.replaceOp(dispatchOp, call.getResult(0));
+    return success();
+  }
+};
+
 struct ConvertIntelAMXTileConfigDispatchOp
     : public OpRewritePattern<IntelAMXTileConfigDispatchOp> {
   using OpRewritePattern<IntelAMXTileConfigDispatchOp>::OpRewritePattern;
@@ -421,19 +619,214 @@ struct ConvertFusedBrgemmOp : public OpRewritePattern<FusedBrgemmDispatchOp> {
   }
 };
 
+// Direct call lowering.
+//
+// Instead of calling the runtime invoke wrappers, build the libxsmm kernel
+// parameters in place and call the kernel through its function pointer. The
+// parameter structs are sequences of argument structs (libxsmm_matrix_op_arg,
+// libxsmm_matrix_arg) of four pointers each:
+//   - gemm:   {op, a, b, c}
+//   - unary:  {op, in, out}
+//   - binary: {op, in0, in1, out}
+// XsmmRunnerUtils checks that this layout matches libxsmm.
+constexpr int32_t kPtrsPerArg = 4;
+constexpr int32_t kMaxParamArgs = 4;
+// Extra slot after the largest parameter struct holding the BRGEMM batch count.
+constexpr int32_t kBatchSlot = kPtrsPerArg * kMaxParamArgs;
+
+static Type getParamBufferType(MLIRContext *ctx) {
+  return LLVM::LLVMArrayType::get(LLVM::LLVMPointerType::get(ctx),
+                                  kBatchSlot + 1);
+}
+
+// Return a stack buffer large enough for any kernel parameters. A single
+// buffer is shared by all the invocations within the same allocation scope.
+// Parallel loop bodies get their own buffer, released at the end of each
+// iteration, as the iterations may run concurrently.
+static Value getParamBuffer(RewriterBase &rewriter, Operation *op,
+                            DenseMap<Block *, Value> &buffers) {
+  Operation *scope = op->getParentOp();
+  while (!scope->hasTrait<OpTrait::AutomaticAllocationScope>() &&
+         !isa<scf::ParallelOp, scf::ForallOp>(scope))
+    scope = scope->getParentOp();
+  Block *block = &scope->getRegion(0).front();
+  Value &buffer = buffers[block];
+  if (buffer)
+    return buffer;
+
+  OpBuilder::InsertionGuard guard(rewriter);
+  MLIRContext *ctx = rewriter.getContext();
+  Type ptrType = LLVM::LLVMPointerType::get(ctx);
+  Location loc = scope->getLoc();
+  rewriter.setInsertionPointToStart(block);
+  if (isa<scf::ParallelOp, scf::ForallOp>(scope)) {
+    Value stackPtr = rewriter.create<LLVM::StackSaveOp>(loc, ptrType);
+    rewriter.setInsertionPoint(block->getTerminator());
+    rewriter.create<LLVM::StackRestoreOp>(loc, stackPtr);
+    rewriter.setInsertionPointAfterValue(stackPtr);
+  }
+  Value one = rewriter.create<LLVM::ConstantOp>(
+      loc, rewriter.getI64Type(), rewriter.getI64IntegerAttr(1));
+  buffer = rewriter.create<LLVM::AllocaOp>(loc, ptrType,
+                                           getParamBufferType(ctx), one);
+  return buffer;
+}
+
+// Return the address of the first element of the memref `operand`.
+static Value getBasePtr(RewriterBase &rewriter, Location loc, Value operand) {
+  auto [ptr, offset] = utils::getPtrAndOffset(rewriter, operand, loc);
+  Value offsetI64 = rewriter.create<arith::IndexCastOp>(
+      loc, rewriter.getI64Type(), offset);
+  return rewriter.create<LLVM::GEPOp>(
+      loc, ptr.getType(), cast<MemRefType>(operand.getType()).getElementType(),
+      ptr, ValueRange{offsetI64});
+}
+
+// Return the address of the `slot`-th pointer in the parameter buffer.
+static Value getParamSlot(RewriterBase &rewriter, Location loc, Value buffer,
+                          int32_t slot) {
+  return rewriter.create<LLVM::GEPOp>(
+      loc, buffer.getType(), getParamBufferType(rewriter.getContext()), buffer,
+      ArrayRef<LLVM::GEPArg>{0, slot});
+}
+
+// Store `value` into the `member`-th pointer of the `arg`-th argument struct.
+static void storeParam(RewriterBase &rewriter, Location loc, Value buffer,
+                       int32_t arg, int32_t member, Value value) {
+  rewriter.create<LLVM::StoreOp>(
+      loc, value,
+      getParamSlot(rewriter, loc, buffer, arg * kPtrsPerArg + member));
+}
+
+// Lower the invocation `op` to a direct call of its kernel. Fail for
+// invocations the runtime wrappers need to handle.
+static LogicalResult buildDirectCall(RewriterBase &rewriter, Operation *op,
+                                     DenseMap<Block *, Value> &buffers) {
+  if (!isa<GemmOp, BrgemmOp, UnaryOp, BinaryOp>(op))
+    return failure();
+  if (auto unaryOp = dyn_cast<UnaryOp>(op); unaryOp && unaryOp.hasScalarInput())
+    return failure();
+  if (auto binaryOp = dyn_cast<BinaryOp>(op);
+      binaryOp && (binaryOp.hasScalarLhs() || binaryOp.hasScalarRhs()))
+    return failure();
+
+  // Memref operands, in order, after the dispatch.
+  SmallVector<Value> memrefs;
+  for (Value operand : op->getOperands().drop_front()) {
+    auto memrefType = dyn_cast<MemRefType>(operand.getType());
+    if (!memrefType)
+      continue;
+    if (!memrefType.getElementType().isF32() &&
+        !memrefType.getElementType().isBF16())
+      return failure();
+    memrefs.push_back(operand);
+  }
+
+  Location loc = op->getLoc();
+  MLIRContext *ctx = rewriter.getContext();
+  Type ptrType = LLVM::LLVMPointerType::get(ctx);
+  Value buffer = getParamBuffer(rewriter, op, buffers);
+
+  SmallVector<Value> basePtrs;
+  for (Value memref : memrefs)
+    basePtrs.push_back(getBasePtr(rewriter, loc, memref));
+
+  if (isa<GemmOp, BrgemmOp>(op)) {
+    // LIBXSMM col-major change A with B.
+    storeParam(rewriter, loc, buffer, /*arg=*/1, /*member=*/0, basePtrs[1]);
+    storeParam(rewriter, loc, buffer, /*arg=*/2, /*member=*/0, basePtrs[0]);
+    storeParam(rewriter, loc, buffer, /*arg=*/3, /*member=*/0, basePtrs[2]);
+  } else {
+    for (auto [idx, basePtr] : llvm::enumerate(basePtrs))
+      storeParam(rewriter, loc, buffer, /*arg=*/idx + 1, /*member=*/0,
+                 basePtr);
+  }
+
+  if (auto brgemmOp = dyn_cast<BrgemmOp>(op)) {
+    Value batchSlot = getParamSlot(rewriter, loc, buffer, kBatchSlot);
+    rewriter.create<LLVM::StoreOp>(loc, brgemmOp.getBatch(), batchSlot);
+    storeParam(rewriter, loc, buffer, /*arg=*/0, /*member=*/2, batchSlot);
+  }
+
+  Value kernel = rewriter.create<LLVM::IntToPtrOp>(loc, ptrType,
+                                                   op->getOperand(0));
+  auto kernelType =
+      LLVM::LLVMFunctionType::get(LLVM::LLVMVoidType::get(ctx), {ptrType});
+  rewriter.create<LLVM::CallOp>(loc, kernelType, ValueRange{kernel, buffer});
+  return success();
+}
+
 struct ConvertXsmmToFunc
     : public tpp::impl::ConvertXsmmToFuncBase<ConvertXsmmToFunc> {
+  using ConvertXsmmToFuncBase::ConvertXsmmToFuncBase;
+
   void runOnOperation() override {
+    // Direct calls bypass the runtime, which times the invocations.
+    if (trace)
+      enableTracing();
+    else if (directCall)
+      lowerToDirectCalls();
+
     RewritePatternSet patterns(&getContext());
     patterns.add<ConvertBinaryXsmmOp, ConvertUnaryXsmmOp, ConvertGemmXsmmOp,
-                 ConvertBrgemmXsmmOp, ConvertFusedBrgemmXsmmOp,
+                 ConvertBrgemmXsmmOp, ConvertGemmBatchXsmmOp,
+                 ConvertBrgemmOffsXsmmOp, ConvertBrgemmAddrXsmmOp,
+                 ConvertFusedBrgemmXsmmOp, ConvertNormXsmmOp,
                  ConvertIntelAMXTileConfigXsmmOp>(patterns.getContext());
     patterns.add<ConvertBinaryDispatchOp, ConvertUnaryDispatchOp,
                  ConvertGemmDispatchOp, ConvertBrgemmDispatchOp,
-                 ConvertFusedBrgemmOp, ConvertIntelAMXTileConfigDispatchOp>(
-        patterns.getContext());
+                 ConvertBrgemmOffsDispatchOp, ConvertBrgemmAddrDispatchOp,
+                 ConvertFusedBrgemmOp, ConvertNormDispatchOp,
+                 ConvertIntelAMXTileConfigDispatchOp>(patterns.getContext());
     (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
   }
+
+private:
+  // Turn the runtime tracing on at the entry of each function dispatching
+  // kernels, so that the kernels are known to the tracer when invoked.
+  void enableTracing() {
+    ModuleOp module = getOperation();
+    llvm::SetVector<Operation *> functions;
+    module->walk([&](Operation *op) {
+      if (isa<GemmDispatchOp, BrgemmDispatchOp, BrgemmOffsDispatchOp,
+              BrgemmAddrDispatchOp, FusedBrgemmDispatchOp, UnaryDispatchOp,
+              BinaryDispatchOp>(op))
+        functions.insert(op->getParentOfType<FunctionOpInterface>());
+    });
+    functions.remove(nullptr);
+    if (functions.empty())
+      return;
+
+    StringRef fnName = "xsmm_trace_enable";
+    OpBuilder builder(&getContext());
+    if (!module.lookupSymbol(fnName)) {
+      builder.setInsertionPointToEnd(module.getBody());
+      func::FuncOp funcOp = builder.create<func::FuncOp>(
+          module.getLoc(), fnName, builder.getFunctionType({}, {}));
+      funcOp.setPrivate();
+    }
+    for (Operation *function : functions) {
+      auto funcOp = cast<FunctionOpInterface>(function);
+      builder.setInsertionPointToStart(&funcOp.getFunctionBody().front());
+      builder.create<func::CallOp>(funcOp.getLoc(), fnName, TypeRange());
+    }
+  }
+
+  void lowerToDirectCalls() {
+    SmallVector<Operation *> invokes;
+    getOperation()->walk([&](Operation *op) {
+      if (isa<GemmOp, BrgemmOp, UnaryOp, BinaryOp>(op))
+        invokes.push_back(op);
+    });
+
+    IRRewriter rewriter(&getContext());
+    DenseMap<Block *, Value> paramBuffers;
+    for (Operation *op : invokes) {
+      rewriter.setInsertionPoint(op);
+      if (succeeded(buildDirectCall(rewriter, op, paramBuffers)))
+        rewriter.eraseOp(op);
+    }
+  }
 };
 
 } // namespace
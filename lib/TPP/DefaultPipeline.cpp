@@ -54,6 +54,43 @@ llvm::cl::list<unsigned>
                      llvm::cl::list_init<unsigned>(SmallVector<unsigned>{2, 8}),
                      llvm::cl::CommaSeparated);
 
+// Fuse activation packs into the tiled contraction loops.
+llvm::cl::opt<bool>
+    fusePacks("fuse-packs",
+              llvm::cl::desc("Pack input blocks right before their use"),
+              llvm::cl::init(false));
+
+// Dispatch each distinct XSMM kernel once for the whole module.
+llvm::cl::opt<bool> globalDispatch(
+    "global-dispatch",
+    llvm::cl::desc("Dispatch identical XSMM kernels once per module"),
+    llvm::cl::init(false));
+
+// Call XSMM kernels directly instead of through the runtime invoke wrappers.
+llvm::cl::opt<bool> xsmmDirectCall(
+    "xsmm-direct-call",
+    llvm::cl::desc("Call XSMM kernels directly through their pointers"),
+    llvm::cl::init(false));
+
+// Time the XSMM invocations per kernel and print a summary at exit.
+llvm::cl::opt<bool>
+    xsmmTrace("xsmm-trace",
+              llvm::cl::desc("Trace the XSMM kernel invocations"),
+              llvm::cl::init(false));
+
+// Record a timeline of the benchmark and parallel iterations and of the XSMM
+// invocations, written to a Chrome trace file at exit.
+llvm::cl::opt<bool>
+    timeline("timeline",
+             llvm::cl::desc("Record a Chrome trace timeline of the run"),
+             llvm::cl::init(false));
+
+// Invoke the XSMM gemms of a tile loop with a single runtime call.
+llvm::cl::opt<bool> xsmmBatchInvoke(
+    "xsmm-batch-invoke",
+    llvm::cl::desc("Batch the XSMM gemm invocations of tile loops"),
+    llvm::cl::init(false));
+
 namespace mlir {
 namespace tpp {
 #define GEN_PASS_DEF_DEFAULTPIPELINE
@@ -129,7 +166,13 @@ private:
     } else {
       // Apply the default preprocessing pass
       DefaultTppPassesOptions tppDefaultOptions{linalgToLoops,
-                                                parallelTaskGrid};
+                                                parallelTaskGrid, fusePacks};
+      tppDefaultOptions.vectorWidth = vectorWidth;
+      tppDefaultOptions.globalDispatch = globalDispatch;
+      tppDefaultOptions.xsmmDirectCall = xsmmDirectCall;
+      tppDefaultOptions.xsmmTrace = xsmmTrace;
+      tppDefaultOptions.batchInvoke = xsmmBatchInvoke;
+      tppDefaultOptions.timeline = timeline;
       pm.addPass(createDefaultTppPasses(tppDefaultOptions));
     }
 
@@ -140,8 +183,11 @@ private:
     pm.addPass(memref::createExpandStridedMetadataPass());
     pm.addPass(createConvertTensorToLinalgPass());
     pm.addNestedPass<func::FuncOp>(createConvertLinalgToLoopsPass());
-    if (defParallel)
+    if (defParallel) {
       pm.addPass(createConvertSCFToOpenMPPass());
+      // Reuse per-thread scratch buffers across parallel loop iterations.
+      pm.addNestedPass<func::FuncOp>(createThreadLocalScratch());
+    }
     pm.addPass(createConvertVectorToSCFPass());
     pm.addPass(arith::createArithExpandOpsPass());
     pm.addPass(createLowerAffinePass());
@@ -157,6 +203,8 @@ private:
     if (defParallel)
       pm.addPass(createConvertOpenMPToLLVMPass());
     pm.addPass(createConvertMathToLLVMPass());
+    // Math functions without an LLVM intrinsic, e.g. erf, become libm calls.
+    pm.addPass(createConvertMathToLibmPass());
 
     pm.addNestedPass<func::FuncOp>(createGpuAsyncRegionPass());
     pm.addPass(createGpuToLLVMConversionPass());
@@ -43,6 +43,8 @@ namespace tpp {
 #include "TPP/Passes.h.inc"
 #define GEN_PASS_DEF_TPPMAPPING
 #include "TPP/Passes.h.inc"
+#define GEN_PASS_DEF_TPPPACKING
+#include "TPP/Passes.h.inc"
 } // namespace tpp
 } // namespace mlir
 
@@ -128,6 +130,10 @@ struct LocalDialectsLowering
       UtilityPassBase<ModuleOp> {
 
   LocalDialectsLowering() {}
+  LocalDialectsLowering(const LocalDialectsLoweringOptions &options) {
+    xsmmDirectCall = options.xsmmDirectCall;
+    xsmmTrace = options.xsmmTrace;
+  }
   void runOnOperation() override {
     auto module = getOperation();
 
@@ -146,7 +152,8 @@ private:
 
     pm.addNestedPass<func::FuncOp>(createConvertCheckToLoops());
     pm.addNestedPass<func::FuncOp>(createConvertPerfToLoops());
-    pm.addPass(createConvertXsmmToFunc());
+    pm.addPass(createConvertXsmmToFunc(
+        ConvertXsmmToFuncOptions{xsmmDirectCall, xsmmTrace}));
     pm.addPass(createConvertPerfToFunc());
   }
 };
@@ -194,6 +201,8 @@ private:
 // TPP-compatible forms.
 struct TppMapping : public tpp::impl::TppMappingBase<TppMapping>,
                     UtilityPassBase<ModuleOp> {
+  using TppMappingBase::TppMappingBase;
+
   void getDependentDialects(DialectRegistry &registry) const override {
     // clang-format off
     registry
@@ -232,14 +241,20 @@ private:
     pm.addPass(createPackConv2DNhwcHwcf());
     pm.addPass(createPackConv2DNchwFchw());
     pm.addPass(createRewriteConvToMatmulOrBrgemm());
-    pm.addPass(createPackMatmul());
+    PackMatmulOptions packMatmulOptions;
+    packMatmulOptions.smallGemmSize = smallGemmSize;
+    pm.addPass(createPackMatmul(packMatmulOptions));
     pm.addPass(createPackVNNI());
 
+    // Keep the element-wise ops between packed ops in the blocked layout.
+    pm.addNestedPass<func::FuncOp>(createLayoutAssignment());
+
     // Postprocess packing.
     // Run only canonicalizer at this stage as full cleanup (mostly CSE) can
     // mess up tensor producer-consumer chains used for analysis in the
     // following passes.
     pm.addPass(createPropagatePackUnPack());
+    pm.addPass(createBlockedLayoutABI());
     pm.addPass(createConstantFoldPack());
     pm.addPass(createSimplifyAndCanonicalizePack());
 
@@ -248,12 +263,65 @@ private:
     pm.addNestedPass<func::FuncOp>(
         createLinalgConvertCompareSelectToMaximumfPass());
 
-    pm.addPass(createTileConsumerAndFuseProducers());
+    TileConsumerAndFuseProducersOptions tileAndFuseOptions;
+    tileAndFuseOptions.fusePacks = fusePacks;
+    pm.addPass(createTileConsumerAndFuseProducers(tileAndFuseOptions));
     pm.addPass(createSimplifyAndCanonicalizePack());
     pm.addPass(createCleanup());
   }
 };
 
+// Apply the linalg-level passes that pick the blocked layouts.
+struct TppPacking : public tpp::impl::TppPackingBase<TppPacking>,
+                    UtilityPassBase<ModuleOp> {
+  using TppPackingBase::TppPackingBase;
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    // clang-format off
+    registry
+        .insert<arith::ArithDialect,
+                func::FuncDialect,
+                linalg::LinalgDialect,
+                math::MathDialect,
+                memref::MemRefDialect,
+                scf::SCFDialect,
+                tensor::TensorDialect>();
+    // clang-format on
+    check::registerBufferizableOpInterfaceExternalModels(registry);
+    perf::registerBufferizableOpInterfaceExternalModels(registry);
+  }
+
+  void runOnOperation() override {
+    auto module = getOperation();
+
+    // Initialize the pipeline if needed.
+    // Otherwise, just run the cached one.
+    if (pm.empty())
+      constructPipeline();
+
+    if (failed(runPipeline(pm, module)))
+      return signalPassFailure();
+  }
+
+private:
+  void constructPipeline() override {
+    pm.clear();
+
+    // Specialize kernels with a dynamic dimension for the shape buckets.
+    pm.addPass(createShapeBucketing());
+    // Fuse attention heads before softmax gets decomposed.
+    pm.addNestedPass<func::FuncOp>(createFuseAttention());
+    pm.addNestedPass<func::FuncOp>(createConvertAddInplacePass());
+    // Convert linalg.batch_matmul to linalg.matmul. Small per-batch products
+    // are kept whole and later map to a parallel loop of GEMMs, blocking
+    // them would only add packing overhead.
+    pm.addPass(createRewriteBatchMatmulToMatmul(
+        RewriteBatchMatmulToMatmulOptions{smallGemmSize}));
+
+    pm.addPass(createTppMapping(TppMappingOptions{fusePacks, smallGemmSize}));
+  }
+};
+
 // Lower Linalg to into combination of standard and local dialects.
 struct LinalgLowering : public tpp::impl::LinalgLoweringBase<LinalgLowering>,
                         UtilityPassBase<func::FuncOp> {
@@ -326,12 +394,9 @@ private:
       pm.addNestedPass<func::FuncOp>(createConvertLinalgToLoopsPass());
       pm.addNestedPass<func::FuncOp>(createCleanup());
     } else {
-      pm.addNestedPass<func::FuncOp>(createConvertAddInplacePass());
-      // Convert linalg.batch_matmul to linalg.matmul.
-      pm.addPass(createRewriteBatchMatmulToMatmul());
-
       // Applies a set of passes at the linalg level to fuse and pack.
-      pm.addPass(createTppMapping());
+      pm.addPass(
+          createTppPacking(TppPackingOptions{fusePacks, smallGemmSize}));
 
       // Generalize tensor.pack and tensor.unpack.
       pm.addPass(createLowerPacksAndUnPacks());
@@ -359,6 +424,14 @@ private:
       // Lower all Tile operations.
       pm.addNestedPass<func::FuncOp>(createLinalgLowering());
       pm.addNestedPass<func::FuncOp>(createCleanup());
+
+      // Vectorize the element-wise and reduction ops that did not map to
+      // XSMM instead of leaving them to scalar loops.
+      if (vectorWidth > 0) {
+        pm.addNestedPass<func::FuncOp>(
+            createLinalgVectorization(LinalgVectorizationOptions{vectorWidth}));
+        pm.addNestedPass<func::FuncOp>(createCleanup());
+      }
     }
 
     // Convert forAll to parallel loops should run after bufferization
@@ -373,8 +446,21 @@ private:
     pm.addPass(mlir::microkernel::createMicrokernelInvariantCodeMotion());
     // pm.addPass(createPrintIRPass());
 
+    // Issue the gemms of each tile loop with a single runtime call.
+    if (batchInvoke)
+      pm.addNestedPass<func::FuncOp>(createXsmmBatchInvoke());
+
+    // Dispatch each distinct kernel once for the whole module.
+    if (globalDispatch)
+      pm.addPass(createXsmmGlobalDispatch());
+
+    // Record the benchmark and parallel iterations on the thread timelines.
+    if (timeline)
+      pm.addNestedPass<func::FuncOp>(createPerfTimeline());
+
     // Covert all local TPP-related dialects.
-    pm.addPass(createLocalDialectsLowering());
+    pm.addPass(createLocalDialectsLowering(
+        LocalDialectsLoweringOptions{xsmmDirectCall, xsmmTrace}));
 
     // Clean up after the default pipeline.
     pm.addNestedPass<func::FuncOp>(createPostprocessing());
@@ -28,6 +28,8 @@ constexpr std::string_view UNARY_FLAGS_NAME = "unary_flags";
 constexpr std::string_view BINARY_FLAGS_NAME = "binary_flags";
 constexpr std::string_view BINARY_KIND = "binary_kind";
 constexpr std::string_view UNARY_KIND = "unary_kind";
+constexpr std::string_view DYNAMIC_M = "dynamic_m";
+constexpr std::string_view EPSILON = "epsilon";
 } // namespace
 
 template <typename EnumClass>
@@ -90,8 +92,23 @@ static ParseResult parserFlagsImpl(OpAsmParser &parser, OperationState &result,
   return success();
 }
 
+// Parse the optional runtime m dimension: `dynamic_m = %m`.
+static ParseResult parseDynamicMImpl(OpAsmParser &parser,
+                                     OperationState &result) {
+  if (failed(parser.parseOptionalKeyword(DYNAMIC_M)))
+    return success();
+  OpAsmParser::UnresolvedOperand dynamicM;
+  if (parser.parseEqual() || parser.parseOperand(dynamicM) ||
+      parser.resolveOperand(dynamicM, parser.getBuilder().getIntegerType(64),
+                            result.operands)) {
+    return failure();
+  }
+  return success();
+}
+
 ParseResult GemmDispatchOp::parse(OpAsmParser &parser, OperationState &result) {
-  if (failed(parseInputImpl(parser, result)))
+  if (failed(parseInputImpl(parser, result)) ||
+      failed(parseDynamicMImpl(parser, result)))
     return failure();
   if (failed(parserFlagsImpl<GemmFlags>(parser, result, FLAGS_NAME)))
     return failure();
@@ -100,6 +117,23 @@ ParseResult GemmDispatchOp::parse(OpAsmParser &parser, OperationState &result) {
 
 ParseResult BrgemmDispatchOp::parse(OpAsmParser &parser,
                                     OperationState &result) {
+  if (failed(parseInputImpl(parser, result)) ||
+      failed(parseDynamicMImpl(parser, result)) ||
+      failed(parserFlagsImpl<GemmFlags>(parser, result, FLAGS_NAME)))
+    return failure();
+  return parseDataTypeImpl(parser, result);
+}
+
+ParseResult BrgemmOffsDispatchOp::parse(OpAsmParser &parser,
+                                        OperationState &result) {
+  if (failed(parseInputImpl(parser, result)) ||
+      failed(parserFlagsImpl<GemmFlags>(parser, result, FLAGS_NAME)))
+    return failure();
+  return parseDataTypeImpl(parser, result);
+}
+
+ParseResult BrgemmAddrDispatchOp::parse(OpAsmParser &parser,
+                                        OperationState &result) {
   if (failed(parseInputImpl(parser, result)) ||
       failed(parserFlagsImpl<GemmFlags>(parser, result, FLAGS_NAME)))
     return failure();
@@ -160,11 +194,37 @@ ParseResult BinaryDispatchOp::parse(OpAsmParser &parser,
   return parseDataTypeImpl(parser, result);
 }
 
+ParseResult NormDispatchOp::parse(OpAsmParser &parser,
+                                  OperationState &result) {
+  // Parse the type of normalization
+  NormKind kind;
+  if (parseEnum(kind, parser))
+    return failure();
+  auto &builder = parser.getBuilder();
+  result.addAttribute(KIND, NormKindAttr::get(builder.getContext(), kind));
+  if (failed(parseInputImpl(parser, result)))
+    return failure();
+  // Parse epsilon.
+  FloatAttr epsilon;
+  if (parser.parseKeyword(EPSILON) || parser.parseEqual() ||
+      parser.parseAttribute(epsilon, builder.getF32Type())) {
+    return failure();
+  }
+  result.addAttribute(EPSILON, epsilon);
+  return parseDataTypeImpl(parser, result);
+}
+
 template <typename OpTy>
 static void printerInputImpl(OpAsmPrinter &printer, OpTy op) {
   printer << " [" << op.getInputs() << ']';
 };
 
+template <typename OpTy>
+static void printerDynamicMImpl(OpAsmPrinter &printer, OpTy op) {
+  if (Value dynamicM = op.getDynamicM())
+    printer << " " << DYNAMIC_M << " = " << dynamicM;
+}
+
 template <typename OpTy>
 static void printerDataTypeImpl(OpAsmPrinter &printer, OpTy op) {
   printer << DATA_TYPE << " = ";
@@ -174,7 +234,7 @@ static void printerDataTypeImpl(OpAsmPrinter &printer, OpTy op) {
       op->getAttrs(),
       /*elidedAttrs=*/{DATA_TYPE, FLAGS_NAME, INPUTS, KIND, FLAGS_NAME,
                        UNARY_FLAGS_NAME, BINARY_FLAGS_NAME, BINARY_KIND,
-                       UNARY_KIND});
+                       UNARY_KIND, EPSILON});
 }
 
 template <typename AttrTy>
@@ -190,6 +250,7 @@ static void printerFlagsImpl(OpAsmPrinter &printer,
 
 void GemmDispatchOp::print(OpAsmPrinter &printer) {
   printerInputImpl<GemmDispatchOp>(printer, *this);
+  printerDynamicMImpl<GemmDispatchOp>(printer, *this);
   auto getOpFlags = [this]() -> ArrayAttr { return this->getFlags(); };
   printerFlagsImpl<GemmFlagsAttr>(printer, getOpFlags, FLAGS_NAME);
   printerDataTypeImpl<GemmDispatchOp>(printer, *this);
@@ -197,11 +258,26 @@ void GemmDispatchOp::print(OpAsmPrinter &printer) {
 
 void BrgemmDispatchOp::print(OpAsmPrinter &printer) {
   printerInputImpl<BrgemmDispatchOp>(printer, *this);
+  printerDynamicMImpl<BrgemmDispatchOp>(printer, *this);
   auto getOpFlags = [this]() -> ArrayAttr { return this->getFlags(); };
   printerFlagsImpl<GemmFlagsAttr>(printer, getOpFlags, FLAGS_NAME);
   printerDataTypeImpl<BrgemmDispatchOp>(printer, *this);
 }
 
+void BrgemmOffsDispatchOp::print(OpAsmPrinter &printer) {
+  printerInputImpl<BrgemmOffsDispatchOp>(printer, *this);
+  auto getOpFlags = [this]() -> ArrayAttr { return this->getFlags(); };
+  printerFlagsImpl<GemmFlagsAttr>(printer, getOpFlags, FLAGS_NAME);
+  printerDataTypeImpl<BrgemmOffsDispatchOp>(printer, *this);
+}
+
+void BrgemmAddrDispatchOp::print(OpAsmPrinter &printer) {
+  printerInputImpl<BrgemmAddrDispatchOp>(printer, *this);
+  auto getOpFlags = [this]() -> ArrayAttr { return this->getFlags(); };
+  printerFlagsImpl<GemmFlagsAttr>(printer, getOpFlags, FLAGS_NAME);
+  printerDataTypeImpl<BrgemmAddrDispatchOp>(printer, *this);
+}
+
 void FusedBrgemmDispatchOp::print(OpAsmPrinter &printer) {
   printerInputImpl<FusedBrgemmDispatchOp>(printer, *this);
   printer << "[" << getBinaryKind() << "," << getUnaryKind() << "] ";
@@ -235,6 +311,15 @@ void BinaryDispatchOp::print(OpAsmPrinter &printer) {
   printerDataTypeImpl<BinaryDispatchOp>(printer, *this);
 }
 
+void NormDispatchOp::print(OpAsmPrinter &printer) {
+  printer << " " << getKind();
+  printerInputImpl<NormDispatchOp>(printer, *this);
+  printer << " " << EPSILON << " = ";
+  printer.printAttributeWithoutType(getEpsilonAttr());
+  printer << " ";
+  printerDataTypeImpl<NormDispatchOp>(printer, *this);
+}
+
 void IntelAMXTileConfigDispatchOp::print(OpAsmPrinter &printer) {
   printerInputImpl<IntelAMXTileConfigDispatchOp>(printer, *this);
   auto getOpFlags = [this]() -> ArrayAttr { return this->getFlags(); };
@@ -277,7 +362,9 @@ static LogicalResult verifyGemmFlags(ArrayAttr flags, DataType dataType,
                                      OpTy op,
                                      const std::string_view &flagsName) {
   static_assert(llvm::is_one_of<OpTy, xsmm::BrgemmDispatchOp, GemmDispatchOp,
-                                xsmm::FusedBrgemmDispatchOp>::value,
+                                xsmm::FusedBrgemmDispatchOp,
+                                xsmm::BrgemmOffsDispatchOp,
+                                xsmm::BrgemmAddrDispatchOp>::value,
                 "applies to xsmm gemms dispatch operations only");
 
   // Verify flags.
@@ -304,7 +391,9 @@ template <typename OpTy>
 static LogicalResult verifyDispatchInputs(OpTy op, size_t expected) {
   static_assert(llvm::is_one_of<OpTy, xsmm::UnaryDispatchOp,
                                 xsmm::BinaryDispatchOp, GemmDispatchOp,
-                                BrgemmDispatchOp, FusedBrgemmDispatchOp>::value,
+                                BrgemmDispatchOp, FusedBrgemmDispatchOp,
+                                BrgemmOffsDispatchOp, BrgemmAddrDispatchOp,
+                                NormDispatchOp>::value,
                 "applies to xsmm dispatch operations only");
 
   // `inputs` are leading dimensions and sizes
@@ -319,6 +408,7 @@ static LogicalResult verifyDispatchInputs(OpTy op, size_t expected) {
 template <typename OpTy> static LogicalResult verifyGemmLikeOp(OpTy op) {
   // 'inputs' = [m, n, k, lda, ldb, ldc] for GEMM.
   // 'inputs' = [m, n, k, lda, ldb, ldc, stride_a, stride_b] for BRGEMM.
+  // 'inputs' = [m, n, k, lda, ldb, ldc] for BRGEMM with offsets or addresses.
   bool isBrgemm = isa<BrgemmDispatchOp>(op.getOperation()) ||
                   isa<FusedBrgemmDispatchOp>(op.getOperation());
   size_t expected = (isBrgemm) ? 8 : 6;
@@ -327,6 +417,13 @@ template <typename OpTy> static LogicalResult verifyGemmLikeOp(OpTy op) {
 
   // Verify leading dims.
   ArrayRef<int64_t> inputs = op.getInputs();
+  if constexpr (llvm::is_one_of<OpTy, GemmDispatchOp,
+                                BrgemmDispatchOp>::value) {
+    if (op.getDynamicM() && inputs[0] != 0) {
+      return op.emitOpError()
+             << "expect dimension m to be 0 with a dynamic m\n";
+    }
+  }
   int64_t n = inputs[1];
   int64_t k = inputs[2];
   int64_t lda = inputs[3];
@@ -351,6 +448,14 @@ LogicalResult BrgemmDispatchOp::verify() {
   return verifyGemmLikeOp<BrgemmDispatchOp>(*this);
 }
 
+LogicalResult BrgemmOffsDispatchOp::verify() {
+  return verifyGemmLikeOp<BrgemmOffsDispatchOp>(*this);
+}
+
+LogicalResult BrgemmAddrDispatchOp::verify() {
+  return verifyGemmLikeOp<BrgemmAddrDispatchOp>(*this);
+}
+
 LogicalResult UnaryDispatchOp::verify() {
   if (failed(verifyUniquenessAndConsistency<UnaryFlags>(
           getFlags(), getOperation(), FLAGS_NAME))) {
@@ -369,6 +474,20 @@ LogicalResult BinaryDispatchOp::verify() {
   return verifyDispatchInputs(*this, /*expected=*/5);
 }
 
+LogicalResult NormDispatchOp::verify() {
+  if (getKind() == NormKind::NONE)
+    return emitOpError() << "invalid normalization kind 'none'";
+  // 'inputs' = [m, n, ldi, ldo]
+  if (failed(verifyDispatchInputs(*this, /*expected=*/4)))
+    return failure();
+  ArrayRef<int64_t> inputs = getInputs();
+  if (inputs[2] < inputs[1] || inputs[3] < inputs[1])
+    return emitOpError() << "expect ldi and ldo to be >= of dimension n";
+  if (getEpsilon().isNegative())
+    return emitOpError() << "expect a non-negative epsilon";
+  return success();
+}
+
 LogicalResult FusedBrgemmDispatchOp::verify() {
   if (failed(verifyUniquenessAndConsistency<BinaryFlags>(
           getBinaryFlags(), getOperation(), BINARY_FLAGS_NAME)) ||
@@ -522,3 +641,129 @@ LogicalResult UnaryOp::verify() {
 LogicalResult BinaryOp::verify() {
   return verifyXsmmCommon(*this, /*expectedInputs=*/4);
 }
+
+LogicalResult NormOp::verify() {
+  // Layernorm takes a beta operand on top of the input, gamma and output.
+  size_t expected = getCallee() == NormKind::LAYERNORM ? 5 : 4;
+  if (getCallee() == NormKind::NONE)
+    return emitOpError() << "invalid normalization kind 'none'";
+  if (failed(verifyXsmmCommon(*this, expected)))
+    return failure();
+
+  auto input = dyn_cast<MemRefType>(getInput().getType());
+  auto output = dyn_cast<MemRefType>(getOutput().getType());
+  if (!input || !output || input.getRank() != 2 ||
+      input.getShape() != output.getShape()) {
+    return emitOpError() << "expect input and output to be 2d memrefs of the "
+                            "same shape";
+  }
+  for (size_t idx = 2; idx < expected - 1; idx++) {
+    auto param = dyn_cast<MemRefType>(getInputs()[idx].getType());
+    if (!param || param.getRank() != 1 ||
+        param.getShape()[0] != input.getShape()[1]) {
+      return emitOpError() << "expect a 1d memref matching the row size for "
+                              "operand at index: "
+                           << idx;
+    }
+  }
+  return success();
+}
+
+LogicalResult GemmBatchOp::verify() {
+  size_t numInputs = getInputs().size();
+  if (numInputs != 8 && numInputs != 9) {
+    return emitOpError() << "expect 8 or 9 inputs but got " << numInputs;
+  }
+
+  for (auto [idx, input] : llvm::enumerate(getInputs())) {
+    // The dispatch, the count, the strides and the batch.
+    if (idx == 0 || idx > 3) {
+      if (!input.getType().isInteger(64)) {
+        return emitOpError() << "expect an i64 but got " << input.getType()
+                             << " for operand at index: " << idx;
+      }
+      continue;
+    }
+    auto memref = dyn_cast<MemRefType>(input.getType());
+    if (!memref) {
+      return emitOpError() << "expect a memref for operand at index: " << idx;
+    }
+    Type elementType = memref.getElementType();
+    if (getDataType() == xsmm::DataType::F32 ? !elementType.isF32()
+                                             : !elementType.isBF16()) {
+      return emitOpError() << "expect "
+                           << xsmm::stringifyDataType(getDataType())
+                           << " but got: " << elementType
+                           << " for operand at index: " << idx;
+    }
+  }
+  return success();
+}
+
+// Verify that `operand` is a memref whose element type matches `dataType`.
+static LogicalResult verifyGemmListOperand(Operation *op,
+                                           xsmm::DataType dataType,
+                                           Value operand, size_t idx) {
+  auto memref = dyn_cast<MemRefType>(operand.getType());
+  if (!memref)
+    return op->emitOpError() << "expect a memref for operand at index: " << idx;
+  Type elementType = memref.getElementType();
+  if (dataType == xsmm::DataType::F32 ? !elementType.isF32()
+                                      : !elementType.isBF16()) {
+    return op->emitOpError()
+           << "expect " << xsmm::stringifyDataType(dataType)
+           << " but got: " << elementType << " for operand at index: " << idx;
+  }
+  return success();
+}
+
+LogicalResult BrgemmOffsOp::verify() {
+  size_t numInputs = getInputs().size();
+  if (numInputs != 4)
+    return emitOpError() << "expect 4 inputs but got " << numInputs;
+  if (!getDispatch().getType().isInteger(64)) {
+    return emitOpError() << "expect an i64 but got "
+                         << getDispatch().getType()
+                         << " for operand 0 (dispatch)";
+  }
+  for (size_t idx = 1; idx < numInputs; idx++) {
+    if (failed(verifyGemmListOperand(getOperation(), getDataType(),
+                                     getInputs()[idx], idx)))
+      return failure();
+  }
+
+  ArrayRef<int64_t> offsetsA = getOffsetsA();
+  ArrayRef<int64_t> offsetsB = getOffsetsB();
+  if (offsetsA.empty() || offsetsA.size() != offsetsB.size()) {
+    return emitOpError()
+           << "expect the same non-zero number of offsets for A and B";
+  }
+  auto isNegative = [](int64_t offset) { return offset < 0; };
+  if (llvm::any_of(offsetsA, isNegative) || llvm::any_of(offsetsB, isNegative))
+    return emitOpError() << "expect non-negative offsets";
+  return success();
+}
+
+LogicalResult BrgemmAddrOp::verify() {
+  size_t numInputs = getInputs().size();
+  if (numInputs != 5)
+    return emitOpError() << "expect 5 inputs but got " << numInputs;
+  for (size_t idx : {size_t(0), size_t(4)}) {
+    Type type = getInputs()[idx].getType();
+    if (!type.isInteger(64)) {
+      return emitOpError() << "expect an i64 but got " << type
+                           << " for operand at index: " << idx;
+    }
+  }
+  for (size_t idx : {size_t(1), size_t(2)}) {
+    auto memref = dyn_cast<MemRefType>(getInputs()[idx].getType());
+    if (!memref || memref.getRank() != 1 ||
+        !memref.getElementType().isInteger(64)) {
+      return emitOpError() << "expect a 1d memref of i64 addresses for "
+                              "operand at index: "
+                           << idx;
+    }
+  }
+  return verifyGemmListOperand(getOperation(), getDataType(), getOutput(),
+                               /*idx=*/3);
+}
@@ -287,6 +287,17 @@ FailureOr<BinaryFlags> getBinaryFlags(Type operandType, Type outputType,
   return failure();
 }
 
+bool isFusableUnaryKind(UnaryKind kind) {
+  return kind == UnaryKind::RELU || kind == UnaryKind::SIGMOID;
+}
+
+// Return true if `kind` is an element-wise activation that can follow the
+// brgemm and the bias add in a fused sequence.
+static bool isActivationUnaryKind(UnaryKind kind) {
+  return isFusableUnaryKind(kind) || kind == UnaryKind::TANH ||
+         kind == UnaryKind::GELU || kind == UnaryKind::EXP;
+}
+
 FailureOr<FusedMatch> getFusedBrgemmSequenceFromProducer(Operation *op) {
   // The loop is in reverse order, so we deduplicate the list making sure we
   // only have one type of each
@@ -387,8 +398,9 @@ FailureOr<FusedMatch> getFusedBrgemmSequenceFromProducer(Operation *op) {
       // We have already made sure it didn't come before this
       // unary in the binary check above
 
-      // For now we only support RELU as unary
-      if (unOp.getCallee() != UnaryKind::RELU)
+      // Activations libxsmm cannot apply on the GEMM output are kept as a
+      // separate unary after the fused brgemm.
+      if (!isActivationUnaryKind(unOp.getCallee()))
         return failure();
 
       // Make sure the op is new or the same as before
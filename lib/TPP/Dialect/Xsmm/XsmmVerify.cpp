@@ -123,11 +123,40 @@ static LogicalResult verifyFlags(xsmm::UnaryOp invokeUnaryOp,
             "invalid 'bcast_scalar' flag for input");
       }
       return success();
+    case xsmm::UnaryFlags::REDUCE_COLS:
+    case xsmm::UnaryFlags::REDUCE_ROWS:
+    case xsmm::UnaryFlags::REDUCE_INIT_ACC:
+      return invokeUnaryOp.emitOpError(
+          "invalid reduce flag for element-wise operation");
     }
   }
   return success();
 }
 
+// Reductions must tell along which dimension they reduce.
+static LogicalResult verifyReduceFlags(xsmm::UnaryOp invokeUnaryOp,
+                                       xsmm::UnaryDispatchOp dispatchUnaryOp) {
+  unsigned numReduceDims = 0;
+  for (auto flag : dispatchUnaryOp.getFlags()) {
+    switch (cast<xsmm::UnaryFlagsAttr>(flag).getValue()) {
+    case xsmm::UnaryFlags::REDUCE_COLS:
+    case xsmm::UnaryFlags::REDUCE_ROWS:
+      numReduceDims++;
+      break;
+    case xsmm::UnaryFlags::REDUCE_INIT_ACC:
+      break;
+    default:
+      return invokeUnaryOp.emitOpError(
+          "invalid broadcast flag for reduce operation");
+    }
+  }
+  if (numReduceDims != 1) {
+    return invokeUnaryOp.emitOpError(
+        "expect exactly one of 'reduce_rows' or 'reduce_cols' flags");
+  }
+  return success();
+}
+
 static LogicalResult verifyFlags(xsmm::BinaryOp invokeBinaryOp,
                                  xsmm::BinaryDispatchOp dispatchBinaryOp) {
   auto expectedFlagsLhs = xsmm::utils::getBinaryFlags(
@@ -190,7 +219,16 @@ static LogicalResult verifyFlags(xsmm::BinaryOp invokeBinaryOp,
 
 static bool hasBCastSemantics(xsmm::UnaryOp invokeOp) {
   auto callee = invokeOp.getCallee();
-  return callee == xsmm::UnaryKind::IDENTITY || callee == xsmm::UnaryKind::RELU;
+  return callee == xsmm::UnaryKind::IDENTITY ||
+         callee == xsmm::UnaryKind::RELU || callee == xsmm::UnaryKind::EXP ||
+         callee == xsmm::UnaryKind::TANH ||
+         callee == xsmm::UnaryKind::SIGMOID || callee == xsmm::UnaryKind::GELU;
+}
+
+static bool hasReduceSemantics(xsmm::UnaryOp invokeOp) {
+  auto callee = invokeOp.getCallee();
+  return callee == xsmm::UnaryKind::REDUCE_ADD ||
+         callee == xsmm::UnaryKind::REDUCE_MAX;
 }
 
 static bool hasBCastSemantics(xsmm::BinaryOp invokeOp) {
@@ -221,6 +259,24 @@ static LogicalResult verifyUnaryOrBinaryCommon(InvokeTy invokeOp) {
   return success();
 }
 
+// The dispatched sizes must match the shape of the normalized input.
+static LogicalResult verifyNormDispatchAndInvoke(xsmm::NormOp normOp) {
+  auto dispatchOp =
+      verifyDispatch<xsmm::NormDispatchOp, xsmm::NormOp>(normOp);
+  if (failed(dispatchOp))
+    return failure();
+
+  if (normOp.getCallee() != dispatchOp->getKind())
+    return normOp.emitOpError("inconsistent callee kind");
+
+  ArrayRef<int64_t> shape =
+      cast<MemRefType>(normOp.getInput().getType()).getShape();
+  ArrayRef<int64_t> inputs = dispatchOp->getInputs();
+  if (inputs[0] != shape[0] || inputs[1] != shape[1])
+    return normOp.emitOpError("inconsistent sizes with dispatch operation");
+  return success();
+}
+
 struct VerifyXsmmCalls
     : public tpp::impl::VerifyXsmmCallsBase<VerifyXsmmCalls> {
   void runOnOperation() override {
@@ -259,6 +315,12 @@ struct VerifyXsmmCalls
                   unaryOp))) {
         return WalkResult::interrupt();
       }
+      if (hasReduceSemantics(unaryOp) &&
+          failed(verifyReduceFlags(
+              unaryOp, cast<xsmm::UnaryDispatchOp>(
+                           unaryOp.getDispatch().getDefiningOp())))) {
+        return WalkResult::interrupt();
+      }
       return WalkResult::advance();
     });
     if (walkResult.wasInterrupted())
@@ -274,6 +336,14 @@ struct VerifyXsmmCalls
     });
     if (walkResult.wasInterrupted())
       return signalPassFailure();
+
+    walkResult = getOperation()->walk([&](xsmm::NormOp normOp) {
+      if (failed(verifyNormDispatchAndInvoke(normOp)))
+        return WalkResult::interrupt();
+      return WalkResult::advance();
+    });
+    if (walkResult.wasInterrupted())
+      return signalPassFailure();
   }
 };
 
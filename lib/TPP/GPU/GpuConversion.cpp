@@ -67,13 +67,14 @@ private:
     // First lower linalg using custom patterns then fall back to
     // the default lowering for any remaining ops.
     pm.addNestedPass<func::FuncOp>(createLinalgDeGeneralize());
-    pm.addNestedPass<func::FuncOp>(
-        createLinalgToGpu(LinalgToGpuOptions{useWmma, warpTile}));
+    pm.addNestedPass<func::FuncOp>(createLinalgToGpu(LinalgToGpuOptions{
+        useWmma, warpTile, kTile, registerTile, sharedMemory}));
     pm.addNestedPass<func::FuncOp>(createConvertLinalgToParallelLoopsPass());
 
     // Map loops into GPU kernels.
     pm.addNestedPass<func::FuncOp>(createGpuMapParallelLoopsPass());
     pm.addNestedPass<func::FuncOp>(createParallelLoopToGpuPass());
+    pm.addNestedPass<func::FuncOp>(createGpuWorkgroupAllocs());
 
     pm.addNestedPass<func::FuncOp>(createCleanup());
 
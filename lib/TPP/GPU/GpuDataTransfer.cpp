@@ -13,9 +13,13 @@
 #include "mlir/Dialect/GPU/IR/GPUDialect.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/IR/Dialect.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
+#include "llvm/ADT/MapVector.h"
 
 using namespace mlir;
 
@@ -112,11 +116,13 @@ static FailureOr<Value> matchTransferBuffers(RewriterBase &rewriter,
 
 // Transfer host allocated data between the host and a device.
 // Optionally, copies data back to the host after device computations.
+// If `deviceBuffers` is provided, a single device buffer is allocated per host
+// buffer and shared by all the kernel launches.
 // Returns device-allocated buffer with the moved data.
-static FailureOr<Value> transferMemref(RewriterBase &rewriter,
-                                       gpu::LaunchFuncOp launchFuncOp,
-                                       Value operand, Value hostBuffer,
-                                       bool copyDataBack = true) {
+static FailureOr<Value>
+transferMemref(RewriterBase &rewriter, gpu::LaunchFuncOp launchFuncOp,
+               Value operand, Value hostBuffer, bool copyDataBack = true,
+               DenseMap<Operation *, Value> *deviceBuffers = nullptr) {
   // A memref buffer is expected.
   assert(isa<MemRefType>(hostBuffer.getType()) &&
          "Transfer memref expects memref buffer");
@@ -128,11 +134,23 @@ static FailureOr<Value> transferMemref(RewriterBase &rewriter,
 
   OpBuilder::InsertionGuard guard(rewriter);
 
-  // Allocate device buffer.
-  rewriter.setInsertionPointToStart(&block);
-  auto gpuAlloc = rewriter.create<gpu::AllocOp>(
-      loc, TypeRange(hostBuffer), ValueRange{}, ValueRange{}, ValueRange{});
-  Value gpuBuffer = gpuAlloc.getMemref();
+  Operation *hostSource = hostBuffer.getDefiningOp();
+  Value gpuBuffer =
+      deviceBuffers ? deviceBuffers->lookup(hostSource) : Value();
+  if (!gpuBuffer) {
+    // Allocate device buffer.
+    rewriter.setInsertionPointToStart(&block);
+    auto gpuAlloc = rewriter.create<gpu::AllocOp>(
+        loc, TypeRange(hostBuffer), ValueRange{}, ValueRange{}, ValueRange{});
+    gpuBuffer = gpuAlloc.getMemref();
+
+    // Cleanup device buffer.
+    rewriter.setInsertionPoint(block.getTerminator());
+    rewriter.create<gpu::DeallocOp>(loc, std::nullopt, gpuBuffer);
+
+    if (deviceBuffers)
+      (*deviceBuffers)[hostSource] = gpuBuffer;
+  }
 
   // Copy data to the device.
   rewriter.setInsertionPoint(launchFuncOp);
@@ -156,16 +174,15 @@ static FailureOr<Value> transferMemref(RewriterBase &rewriter,
                                    gpuBuffer);
   }
 
-  // Cleanup device buffer.
-  rewriter.setInsertionPoint(block.getTerminator());
-  rewriter.create<gpu::DeallocOp>(loc, std::nullopt, gpuAlloc.getMemref());
-
   return gpuBuffer;
 }
 
 // Move host data used by GPU kernel calls to the device.
 struct TransferDataToGpu : public OpRewritePattern<gpu::LaunchFuncOp> {
-  using OpRewritePattern<gpu::LaunchFuncOp>::OpRewritePattern;
+  TransferDataToGpu(MLIRContext *ctx,
+                    DenseMap<Operation *, Value> *deviceBuffers)
+      : OpRewritePattern<gpu::LaunchFuncOp>(ctx),
+        deviceBuffers(deviceBuffers) {}
 
   LogicalResult matchAndRewrite(gpu::LaunchFuncOp launchFuncOp,
                                 PatternRewriter &rewriter) const override {
@@ -193,7 +210,7 @@ struct TransferDataToGpu : public OpRewritePattern<gpu::LaunchFuncOp> {
         // the device.
         newOperand =
             transferMemref(rewriter, launchFuncOp, operand, allocOp.getMemref(),
-                           /*copyDataBack=*/true);
+                           /*copyDataBack=*/true, deviceBuffers);
       }
       if (auto getGlobalOp = dyn_cast<memref::GetGlobalOp>(*src)) {
         // Data does not need to be updated if the global data is constant
@@ -209,7 +226,8 @@ struct TransferDataToGpu : public OpRewritePattern<gpu::LaunchFuncOp> {
         }
         newOperand = transferMemref(rewriter, launchFuncOp, operand,
                                     getGlobalOp.getResult(),
-                                    /*copyDataBack=*/!isGlobalConst);
+                                    /*copyDataBack=*/!isGlobalConst,
+                                    deviceBuffers);
       }
 
       if (failed(newOperand))
@@ -226,19 +244,236 @@ struct TransferDataToGpu : public OpRewritePattern<gpu::LaunchFuncOp> {
 
     return success();
   }
+
+private:
+  DenseMap<Operation *, Value> *deviceBuffers;
 };
 
+// Returns the buffer underlying the view `val`.
+static Value getRootBuffer(Value val) {
+  while (auto viewOp = val.getDefiningOp<ViewLikeOpInterface>())
+    val = viewOp.getViewSource();
+  return val;
+}
+
+static bool isHostBuffer(Value root) {
+  return isa_and_nonnull<memref::AllocOp, memref::GetGlobalOp>(
+      root.getDefiningOp());
+}
+
+static bool isDeviceBuffer(Value root) {
+  return isa_and_nonnull<gpu::AllocOp>(root.getDefiningOp());
+}
+
+// Returns true if the two values are the same view of the same buffer.
+static bool isSameView(Value lhs, Value rhs) {
+  if (lhs == rhs)
+    return true;
+  Operation *lhsOp = lhs.getDefiningOp();
+  Operation *rhsOp = rhs.getDefiningOp();
+  if (!lhsOp || !rhsOp || !isa<ViewLikeOpInterface>(lhsOp))
+    return false;
+  return OperationEquivalence::isEquivalentTo(
+      lhsOp, rhsOp,
+      [](Value lhsOperand, Value rhsOperand) {
+        return success(isSameView(lhsOperand, rhsOperand));
+      },
+      /*markEquivalent=*/nullptr, OperationEquivalence::IgnoreLocations);
+}
+
+// Returns true if the host buffer `root` is only accessed through data
+// transfers and kernel launches, that is, its content is never observed on
+// the host.
+static bool isDeviceOnlyBuffer(Value root) {
+  SmallVector<Value> worklist{root};
+  while (!worklist.empty()) {
+    Value val = worklist.pop_back_val();
+    for (Operation *user : val.getUsers()) {
+      if (isa<gpu::MemcpyOp, gpu::LaunchFuncOp, memref::DeallocOp>(user))
+        continue;
+      if (auto viewOp = dyn_cast<ViewLikeOpInterface>(user)) {
+        if (viewOp.getViewSource() == val) {
+          worklist.append(user->result_begin(), user->result_end());
+          continue;
+        }
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+// Erases the chain of views that defined `view` and are no longer used.
+static void eraseDeadViews(Value view) {
+  while (Operation *op = view.getDefiningOp()) {
+    auto viewOp = dyn_cast<ViewLikeOpInterface>(op);
+    if (!viewOp || !op->use_empty())
+      return;
+    view = viewOp.getViewSource();
+    op->erase();
+  }
+}
+
+// Data transfer state of a host buffer.
+struct TransferState {
+  // The host buffer was allocated in the current block and has not been
+  // written on the host yet.
+  bool hostUndefined = false;
+  // Pairs of host and device views holding the same data.
+  SmallVector<std::pair<Value, Value>> syncedViews;
+  // Device to host copies whose result has not been read on the host yet.
+  SmallVector<gpu::MemcpyOp> pendingCopies;
+
+  bool isSynced(Value hostView, Value deviceView) const {
+    return llvm::any_of(syncedViews, [&](const std::pair<Value, Value> &views) {
+      return isSameView(views.first, hostView) &&
+             isSameView(views.second, deviceView);
+    });
+  }
+
+  // The host buffer is accessed by a host operation. All the pending copies
+  // are needed and, if the host writes, the device data becomes stale.
+  void accessOnHost(bool mayWrite) {
+    hostUndefined = false;
+    pendingCopies.clear();
+    if (mayWrite)
+      syncedViews.clear();
+  }
+};
+
+// Removes the data transfers between kernel launches in `block` that are not
+// needed to keep the host and the device in sync:
+// - host to device copies of data the device already holds,
+// - device to host copies that are overwritten or whose host buffer is
+//   released before the data is read on the host.
+// The device data only gets stale through host accesses and the host data
+// only through kernel launches. Operations with regions are treated as host
+// accesses of all the buffers used within them.
+static void eliminateRedundantTransfers(Block &block) {
+  // State of each host buffer, keyed by the underlying allocation.
+  llvm::MapVector<Value, TransferState> states;
+  SmallVector<Operation *> deadOps;
+
+  auto releaseBuffer = [&](Value root) {
+    auto it = states.find(root);
+    if (it == states.end())
+      return;
+    for (gpu::MemcpyOp copyOp : it->second.pendingCopies)
+      deadOps.push_back(copyOp);
+    states.erase(it);
+  };
+
+  for (Operation &op : block) {
+    if (auto allocOp = dyn_cast<memref::AllocOp>(op)) {
+      states[allocOp.getMemref()].hostUndefined = true;
+      continue;
+    }
+
+    if (auto copyOp = dyn_cast<gpu::MemcpyOp>(op)) {
+      Value dst = copyOp.getDst();
+      Value src = copyOp.getSrc();
+      Value dstRoot = getRootBuffer(dst);
+      Value srcRoot = getRootBuffer(src);
+
+      // Host to device: redundant if the device already holds the data.
+      if (isHostBuffer(srcRoot) && isDeviceBuffer(dstRoot)) {
+        TransferState &state = states[srcRoot];
+        if (state.hostUndefined || state.isSynced(src, dst)) {
+          deadOps.push_back(copyOp);
+        } else {
+          // The copy reads the host data.
+          state.pendingCopies.clear();
+        }
+        state.syncedViews.emplace_back(src, dst);
+        continue;
+      }
+
+      // Device to host: an earlier copy of the same data that was not read in
+      // the meantime is overwritten.
+      if (isDeviceBuffer(srcRoot) && isHostBuffer(dstRoot)) {
+        TransferState &state = states[dstRoot];
+        llvm::erase_if(state.pendingCopies, [&](gpu::MemcpyOp pendingOp) {
+          if (!isSameView(pendingOp.getDst(), dst) ||
+              !isSameView(pendingOp.getSrc(), src))
+            return false;
+          deadOps.push_back(pendingOp);
+          return true;
+        });
+        state.pendingCopies.push_back(copyOp);
+        state.hostUndefined = false;
+        state.syncedViews.emplace_back(dst, src);
+        continue;
+      }
+    }
+
+    // Kernels only access device buffers.
+    if (isa<gpu::LaunchFuncOp, gpu::DeallocOp, ViewLikeOpInterface>(op))
+      continue;
+
+    if (auto deallocOp = dyn_cast<memref::DeallocOp>(op)) {
+      releaseBuffer(getRootBuffer(deallocOp.getMemref()));
+      continue;
+    }
+
+    // Any other use of a host buffer is a host access. Globals can also be
+    // accessed by operations with unknown side effects e.g., function calls.
+    bool mayAccessGlobals = !isMemoryEffectFree(&op);
+    bool mayWrite = !isa<MemoryEffectOpInterface>(op) ||
+                    hasEffect<MemoryEffects::Write>(&op);
+    for (auto &[root, state] : states) {
+      if (mayAccessGlobals && isa<memref::GetGlobalOp>(root.getDefiningOp()))
+        state.accessOnHost(mayWrite);
+    }
+    op.walk([&](Operation *nestedOp) {
+      for (Value operand : nestedOp->getOperands()) {
+        auto it = states.find(getRootBuffer(operand));
+        if (it != states.end())
+          it->second.accessOnHost(mayWrite);
+      }
+    });
+  }
+
+  // The data of a local buffer that is never read on the host does not have
+  // to be copied back at all.
+  SmallVector<Value> localBuffers;
+  for (auto &[root, state] : states) {
+    if (root.getDefiningOp()->getBlock() == &block &&
+        isa<memref::AllocOp>(root.getDefiningOp()) && isDeviceOnlyBuffer(root))
+      localBuffers.push_back(root);
+  }
+  for (Value root : localBuffers)
+    releaseBuffer(root);
+
+  for (Operation *deadOp : deadOps) {
+    SmallVector<Value> operands(deadOp->getOperands());
+    deadOp->erase();
+    for (Value operand : operands)
+      eraseDeadViews(operand);
+  }
+}
+
 // Transfer data from host to a GPU device.
 class GpuDataTransfer : public tpp::impl::GpuDataTransferBase<GpuDataTransfer> {
 public:
-  GpuDataTransfer() = default;
+  using GpuDataTransferBase::GpuDataTransferBase;
 
   void runOnOperation() override {
     MLIRContext *ctx = getOperation().getContext();
     RewritePatternSet patterns(ctx);
-    // TODO: Add cleanup patterns to minimize data copies.
-    patterns.add<TransferDataToGpu>(ctx);
+    DenseMap<Operation *, Value> deviceBuffers;
+    patterns.add<TransferDataToGpu>(ctx,
+                                    deviceResident ? &deviceBuffers : nullptr);
     (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+
+    if (!deviceResident)
+      return;
+
+    // Keep the data on the device between kernel launches and only copy it
+    // when the host needs it.
+    SmallVector<Block *> blocks;
+    getOperation()->walk([&](Block *block) { blocks.push_back(block); });
+    for (Block *block : blocks)
+      eliminateRedundantTransfers(*block);
   }
 };
 
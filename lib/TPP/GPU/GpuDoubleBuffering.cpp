@@ -0,0 +1,335 @@
+//===- GpuDoubleBuffering.cpp ------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Passes.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Async/IR/Async.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+using namespace mlir;
+using namespace mlir::tpp;
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_GPUDOUBLEBUFFERING
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+#define DEBUG_TYPE "gpu-double-buffering"
+
+namespace {
+
+// Returns the buffer underlying the view `val`.
+static Value getRootBuffer(Value val) {
+  while (auto viewOp = val.getDefiningOp<ViewLikeOpInterface>())
+    val = viewOp.getViewSource();
+  return val;
+}
+
+static bool isDeviceBuffer(Value root) {
+  return isa_and_nonnull<gpu::AllocOp>(root.getDefiningOp());
+}
+
+// Data transfers and kernel launches of a loop body split into stages.
+struct LoopStages {
+  SmallVector<gpu::MemcpyOp> hostToDevice;
+  SmallVector<Operation *> compute;
+};
+
+// Returns the dimension along which the view `val` slices its source with the
+// induction variable of `forOp`, such that the slices accessed by two
+// different iterations are disjoint. Returns std::nullopt if the view is not
+// such a slice.
+static std::optional<unsigned> getChunkDim(Value val, scf::ForOp forOp,
+                                           int64_t step) {
+  auto subview = val.getDefiningOp<memref::SubViewOp>();
+  if (!subview || subview->getBlock() != forOp.getBody() ||
+      !forOp.isDefinedOutsideOfLoop(subview.getSource())) {
+    return std::nullopt;
+  }
+
+  Value iv = forOp.getInductionVar();
+  auto isInvariant = [&](OpFoldResult ofr) {
+    auto val = dyn_cast<Value>(ofr);
+    return !val || forOp.isDefinedOutsideOfLoop(val);
+  };
+
+  std::optional<unsigned> chunkDim;
+  for (auto [dim, offset] : llvm::enumerate(subview.getMixedOffsets())) {
+    if (dyn_cast<Value>(offset) == iv) {
+      if (chunkDim)
+        return std::nullopt;
+      chunkDim = dim;
+      continue;
+    }
+    if (!isInvariant(offset))
+      return std::nullopt;
+  }
+  if (!chunkDim || !llvm::all_of(subview.getMixedSizes(), isInvariant) ||
+      !llvm::all_of(subview.getMixedStrides(), isInvariant)) {
+    return std::nullopt;
+  }
+
+  // The slice has to fit within a single step of the loop.
+  std::optional<int64_t> size =
+      getConstantIntValue(subview.getMixedSizes()[*chunkDim]);
+  std::optional<int64_t> stride =
+      getConstantIntValue(subview.getMixedStrides()[*chunkDim]);
+  if (!size || !stride || *size < 1 || *stride < 1 ||
+      (*size - 1) * *stride + 1 > step) {
+    return std::nullopt;
+  }
+  return chunkDim;
+}
+
+// Matches loops whose body copies a slice of data to the device, runs kernels
+// on it and, optionally, copies results back:
+//   scf.for %iv {
+//     gpu.memcpy %dev_slice, %host_slice
+//     gpu.launch_func args(%dev_slice, ...)
+//     gpu.memcpy %host_slice, %dev_slice
+//   }
+// Every iteration has to work on its own slice of the transferred buffers so
+// that the data transfer of the next iteration can overlap with the kernels
+// of the current one.
+static FailureOr<LoopStages> matchPipelineableLoop(scf::ForOp forOp) {
+  if (forOp.getNumResults() != 0)
+    return failure();
+
+  std::optional<int64_t> lb = getConstantIntValue(forOp.getLowerBound());
+  std::optional<int64_t> ub = getConstantIntValue(forOp.getUpperBound());
+  std::optional<int64_t> step = getConstantIntValue(forOp.getStep());
+  if (!lb || !ub || !step || *step < 1)
+    return failure();
+  // There is nothing to overlap with less than two iterations.
+  if (llvm::divideCeil(*ub - *lb, *step) < 2)
+    return failure();
+
+  LoopStages stages;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    if (auto launchOp = dyn_cast<gpu::LaunchFuncOp>(op)) {
+      if (launchOp.getAsyncToken() ||
+          !launchOp.getAsyncDependencies().empty()) {
+        return failure();
+      }
+      stages.compute.push_back(launchOp);
+      continue;
+    }
+
+    if (auto copyOp = dyn_cast<gpu::MemcpyOp>(op)) {
+      if (copyOp.getAsyncToken() || !copyOp.getAsyncDependencies().empty())
+        return failure();
+      bool toDevice = isDeviceBuffer(getRootBuffer(copyOp.getDst()));
+      bool fromDevice = isDeviceBuffer(getRootBuffer(copyOp.getSrc()));
+      if (toDevice == fromDevice)
+        return failure();
+      // Data is copied to the device before any kernel runs.
+      if (toDevice && stages.compute.empty()) {
+        stages.hostToDevice.push_back(copyOp);
+        continue;
+      }
+      // Results are copied back after the kernels.
+      if (fromDevice && !stages.compute.empty()) {
+        stages.compute.push_back(copyOp);
+        continue;
+      }
+      return failure();
+    }
+
+    // Only index computations and views are allowed in between.
+    if (op.getNumRegions() != 0 || !isMemoryEffectFree(&op))
+      return failure();
+  }
+  if (stages.hostToDevice.empty() ||
+      !llvm::any_of(stages.compute, [](Operation *op) {
+        return isa<gpu::LaunchFuncOp>(op);
+      })) {
+    return failure();
+  }
+
+  // All the accesses to a buffer copied within the loop have to be slices of
+  // the same source along the same dimension. Other buffers are not touched
+  // by the transfers and can be freely used by the kernels.
+  DenseMap<Value, std::pair<Value, unsigned>> chunkedBuffers;
+  auto addChunk = [&](Value view) -> LogicalResult {
+    std::optional<unsigned> dim = getChunkDim(view, forOp, *step);
+    if (!dim)
+      return failure();
+    Value source = view.getDefiningOp<memref::SubViewOp>().getSource();
+    auto [it, inserted] = chunkedBuffers.try_emplace(
+        getRootBuffer(view), std::make_pair(source, *dim));
+    return success(inserted || it->second == std::make_pair(source, *dim));
+  };
+  for (gpu::MemcpyOp copyOp : stages.hostToDevice) {
+    if (failed(addChunk(copyOp.getDst())) || failed(addChunk(copyOp.getSrc())))
+      return failure();
+  }
+  for (Operation *op : stages.compute) {
+    if (auto copyOp = dyn_cast<gpu::MemcpyOp>(op)) {
+      if (failed(addChunk(copyOp.getDst())) ||
+          failed(addChunk(copyOp.getSrc()))) {
+        return failure();
+      }
+    }
+  }
+  for (Operation *op : stages.compute) {
+    auto launchOp = dyn_cast<gpu::LaunchFuncOp>(op);
+    if (!launchOp)
+      continue;
+    for (Value operand : launchOp.getKernelOperands()) {
+      if (!isa<MemRefType>(operand.getType()) ||
+          !chunkedBuffers.contains(getRootBuffer(operand))) {
+        continue;
+      }
+      if (failed(addChunk(operand)))
+        return failure();
+    }
+  }
+
+  return stages;
+}
+
+// Clones `ops` together with the operations of the loop body they depend on.
+// The induction variable is remapped through `mapping`.
+static void cloneFromLoopBody(OpBuilder &builder, scf::ForOp forOp,
+                              ArrayRef<Operation *> ops, IRMapping &mapping) {
+  Block *body = forOp.getBody();
+  llvm::SmallPtrSet<Operation *, 16> slice;
+  SmallVector<Operation *> worklist(ops);
+  while (!worklist.empty()) {
+    Operation *op = worklist.pop_back_val();
+    if (!slice.insert(op).second)
+      continue;
+    for (Value operand : op->getOperands()) {
+      Operation *defOp = operand.getDefiningOp();
+      if (defOp && defOp->getBlock() == body)
+        worklist.push_back(defOp);
+    }
+  }
+
+  for (Operation &op : body->without_terminator()) {
+    if (slice.contains(&op))
+      builder.clone(op, mapping);
+  }
+}
+
+// Software pipeline the loop such that the data of the next iteration is
+// copied to the device while the kernels of the current iteration run:
+//   <copy slice lb>
+//   scf.for %iv = lb to last {
+//     %prefetch = async.execute { <copy slice %iv + step> }
+//     %compute = async.execute { <kernels, copy results slice %iv> }
+//     async.await %prefetch
+//     async.await %compute
+//   }
+//   <kernels, copy results slice last>
+// Each async region gets its own GPU stream once lowered which allows the
+// transfers to overlap with the computation.
+static void pipelineLoop(scf::ForOp forOp, const LoopStages &stages) {
+  Location loc = forOp.getLoc();
+  Block *body = forOp.getBody();
+  Value iv = forOp.getInductionVar();
+
+  int64_t lb = *getConstantIntValue(forOp.getLowerBound());
+  int64_t ub = *getConstantIntValue(forOp.getUpperBound());
+  int64_t step = *getConstantIntValue(forOp.getStep());
+  int64_t lastIv = lb + (llvm::divideCeil(ub - lb, step) - 1) * step;
+
+  SmallVector<Operation *> hostToDevice(stages.hostToDevice.begin(),
+                                        stages.hostToDevice.end());
+
+  // Prologue - bring the first slice to the device.
+  OpBuilder builder(forOp);
+  {
+    IRMapping mapping;
+    mapping.map(iv, forOp.getLowerBound());
+    cloneFromLoopBody(builder, forOp, hostToDevice, mapping);
+  }
+  Value lastIvVal = builder.create<arith::ConstantIndexOp>(loc, lastIv);
+
+  // Epilogue - the last iteration has nothing left to prefetch.
+  builder.setInsertionPointAfter(forOp);
+  {
+    IRMapping mapping;
+    mapping.map(iv, lastIvVal);
+    cloneFromLoopBody(builder, forOp, stages.compute, mapping);
+  }
+
+  // Steady state - prefetch the next slice while computing the current one.
+  forOp.setUpperBound(lastIvVal);
+
+  Operation *firstCompute = stages.compute.front();
+  builder.setInsertionPoint(firstCompute);
+  Value nextIv = builder.create<arith::AddIOp>(loc, iv, forOp.getStep());
+  auto prefetchOp = builder.create<async::ExecuteOp>(
+      loc, TypeRange{}, ValueRange{}, ValueRange{},
+      [&](OpBuilder &b, Location nestedLoc, ValueRange) {
+        IRMapping mapping;
+        mapping.map(iv, nextIv);
+        cloneFromLoopBody(b, forOp, hostToDevice, mapping);
+        b.create<async::YieldOp>(nestedLoc, ValueRange{});
+      });
+  auto computeOp = builder.create<async::ExecuteOp>(
+      loc, TypeRange{}, ValueRange{}, ValueRange{},
+      [&](OpBuilder &b, Location nestedLoc, ValueRange) {
+        b.create<async::YieldOp>(nestedLoc, ValueRange{});
+      });
+
+  // Move the kernels and everything after them into the compute region.
+  Operation *computeYield = computeOp.getBody()->getTerminator();
+  for (Operation &op : llvm::make_early_inc_range(
+           llvm::make_range(firstCompute->getIterator(),
+                            body->getTerminator()->getIterator()))) {
+    op.moveBefore(computeYield);
+  }
+
+  builder.setInsertionPoint(body->getTerminator());
+  builder.create<async::AwaitOp>(loc, prefetchOp.getToken());
+  builder.create<async::AwaitOp>(loc, computeOp.getToken());
+
+  // The current slice is already on the device.
+  for (gpu::MemcpyOp copyOp : stages.hostToDevice)
+    copyOp->erase();
+  for (Operation &op : llvm::make_early_inc_range(
+           llvm::reverse(body->without_terminator()))) {
+    if (isOpTriviallyDead(&op))
+      op.erase();
+  }
+}
+
+// Overlap host-device data transfers with kernel execution.
+struct GpuDoubleBuffering
+    : public tpp::impl::GpuDoubleBufferingBase<GpuDoubleBuffering> {
+  using GpuDoubleBufferingBase::GpuDoubleBufferingBase;
+
+  void runOnOperation() override {
+    SmallVector<std::pair<scf::ForOp, LoopStages>> loops;
+    getOperation()->walk([&](scf::ForOp forOp) {
+      FailureOr<LoopStages> stages = matchPipelineableLoop(forOp);
+      if (succeeded(stages))
+        loops.emplace_back(forOp, std::move(*stages));
+    });
+
+    for (auto &[forOp, stages] : loops)
+      pipelineLoop(forOp, stages);
+  }
+};
+
+} // namespace
@@ -50,6 +50,17 @@ llvm::cl::list<int64_t> wmmaTileSizes(
     llvm::cl::list_init<int64_t>(SmallVector<int64_t>{16, 16, 16}),
     llvm::cl::CommaSeparated);
 
+llvm::cl::list<int64_t>
+    gpuRegisterTile("gpu-register-tile",
+                    llvm::cl::desc("GPU per-thread register tile sizes MxN"),
+                    llvm::cl::list_init<int64_t>(SmallVector<int64_t>{1, 1}),
+                    llvm::cl::CommaSeparated);
+
+llvm::cl::opt<bool>
+    gpuSharedMemory("gpu-shared-memory",
+                    llvm::cl::desc("Stage GPU GEMM operands in shared memory"),
+                    llvm::cl::init(false));
+
 namespace mlir {
 namespace tpp {
 #define GEN_PASS_DEF_GPUPIPELINE
@@ -160,7 +171,8 @@ private:
 
     // Convert to generic GPU ops.
     pm.addPass(
-        createGpuConversion(GpuConversionOptions{gpuWmma, wmmaTileSizes}));
+        createGpuConversion(GpuConversionOptions{
+            gpuWmma, wmmaTileSizes, gpuRegisterTile, gpuSharedMemory}));
 
     // Lower GPU ops to the chosen GPU backend.
     switch (gpuType) {
@@ -169,6 +181,8 @@ private:
       // memory is not currently used here.
       // Vulkan runner assumes usage of GPU unified memory.
       pm.addNestedPass<func::FuncOp>(createGpuDataTransfer());
+      // Overlap the data transfers with the kernel execution where possible.
+      pm.addNestedPass<func::FuncOp>(createGpuDoubleBuffering());
       pm.addPass(createGpuToCuda(GpuToCudaOptions{
           gpuOptions.triple, gpuOptions.chip, gpuOptions.features}));
       break;
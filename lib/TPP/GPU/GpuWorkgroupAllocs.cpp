@@ -0,0 +1,71 @@
+//===- GpuWorkgroupAllocs.cpp ------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Passes.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/Pass/Pass.h"
+
+using namespace mlir;
+using namespace mlir::tpp;
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_GPUWORKGROUPALLOCS
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+namespace {
+
+// Return true if the allocation can be served by workgroup memory.
+static bool isWorkgroupAlloc(memref::AllocOp allocOp) {
+  MemRefType type = allocOp.getType();
+  auto memorySpace = dyn_cast_or_null<gpu::AddressSpaceAttr>(
+      type.getMemorySpace());
+  return memorySpace &&
+         memorySpace.getValue() == gpu::AddressSpace::Workgroup &&
+         type.hasStaticShape() && allocOp->getNumOperands() == 0;
+}
+
+// Move workgroup allocations out of a GPU launch body into its workgroup
+// memory attributions.
+static void promoteWorkgroupAllocs(gpu::LaunchOp launchOp) {
+  SmallVector<memref::AllocOp> allocs;
+  launchOp.getBody().walk([&](memref::AllocOp allocOp) {
+    if (isWorkgroupAlloc(allocOp))
+      allocs.push_back(allocOp);
+  });
+
+  for (memref::AllocOp allocOp : allocs) {
+    BlockArgument attribution = launchOp.addWorkgroupAttribution(
+        allocOp.getType(), allocOp.getLoc());
+    // Workgroup memory lives as long as the launch.
+    for (Operation *user : llvm::make_early_inc_range(allocOp->getUsers())) {
+      if (isa<memref::DeallocOp>(user))
+        user->erase();
+    }
+    allocOp.getMemref().replaceAllUsesWith(attribution);
+    allocOp->erase();
+  }
+}
+
+struct GpuWorkgroupAllocs
+    : public tpp::impl::GpuWorkgroupAllocsBase<GpuWorkgroupAllocs> {
+  using GpuWorkgroupAllocsBase::GpuWorkgroupAllocsBase;
+
+  void runOnOperation() override {
+    getOperation()->walk(
+        [](gpu::LaunchOp launchOp) { promoteWorkgroupAllocs(launchOp); });
+  }
+};
+
+} // namespace
@@ -20,6 +20,8 @@
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Dialect.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -229,63 +231,121 @@ eltwiseFusion(linalg::LinalgOp rootOp, linalg::LinalgOp consumer,
   return newStores;
 }
 
-// Fuse a consumer using scalar operations.
-// TODO: Extend scalar fusion to support multiple stores.
+// Return true if an elementwise consumer can be fused into the root op's
+// stores by inlining its body.
 //
-// Returns updated store op or nullopt if the fusion fails.
-static std::optional<memref::StoreOp> eltwiseFusion(linalg::LinalgOp rootOp,
-                                                    linalg::LinalgOp consumer,
-                                                    memref::StoreOp rootStoreOp,
-                                                    PatternRewriter &rewriter) {
-  Location loc = rootOp.getLoc();
+// The consumer has to write the root's output with an identity map. Its other
+// operands can be scalars or buffers accessed through projected permutations
+// of the output indices, e.g., a broadcasted bias. The root's output can only
+// be read at the element being stored.
+static bool isScalarFusable(linalg::LinalgOp rootOp,
+                            linalg::LinalgOp consumer) {
+  if (!consumer.hasPureBufferSemantics() || consumer.getNumDpsInits() != 1)
+    return false;
+
   auto rootOutput = rootOp.getDpsInits()[0];
-  auto outputType = cast<ShapedType>(rootOutput.getType());
+  if (!consumer.getMatchingIndexingMap(consumer.getDpsInitOperand(0))
+           .isIdentity()) {
+    return false;
+  }
 
-  // Must be a floating point type.
-  // TODO: Add integer support.
-  auto floatType = dyn_cast<FloatType>(outputType.getElementType());
-  if (!floatType)
+  for (OpOperand *operand : consumer.getDpsInputOperands()) {
+    if (!isa<ShapedType>(operand->get().getType()))
+      continue;
+    AffineMap map = consumer.getMatchingIndexingMap(operand);
+    if (operand->get() == rootOutput) {
+      if (!map.isIdentity())
+        return false;
+      continue;
+    }
+    if (!map.isProjectedPermutation(/*allowZeroInResults=*/true))
+      return false;
+  }
+
+  // The body is recreated for each stored element. Only pure computations
+  // can be safely duplicated.
+  return llvm::all_of(consumer.getBlock()->without_terminator(),
+                      [](Operation &op) {
+                        return isa<linalg::IndexOp>(op) || isPure(&op);
+                      });
+}
+
+// Fuse a consumer using scalar operations.
+//
+// The consumer's body is inlined before each store with the block arguments
+// replaced by the stored value and the matching elements of the other
+// operands.
+//
+// Returns updated store ops or nullopt if the fusion fails.
+static std::optional<SmallVector<memref::StoreOp>>
+eltwiseFusion(linalg::LinalgOp rootOp, linalg::LinalgOp consumer,
+              SmallVector<memref::StoreOp> rootStoreOps,
+              PatternRewriter &rewriter) {
+  assert(rootStoreOps.size() > 0 && "Requires at least one store op");
+
+  if (!isScalarFusable(rootOp, consumer))
     return std::nullopt;
 
-  auto storeIndices = rootStoreOp.getIndices();
+  Location loc = rootOp.getLoc();
+  auto rootOutput = rootOp.getDpsInits()[0];
+  Block *body = consumer.getBlock();
 
-  // Insert fused eltwise ops before the store and later replace the store
-  // with a new result.
+  // Insert fused eltwise ops before each store and replace the store with
+  // a new result.
   OpBuilder::InsertionGuard guard(rewriter);
-  rewriter.setInsertionPoint(rootStoreOp);
 
-  std::optional<memref::StoreOp> newStore = std::nullopt;
-  SmallVector<Value> operands;
-  if (structured_match::utils::isTwoDAddOp(consumer, &operands)) {
-    // Get the value to be added. Load the element first, if necessary.
-    auto addValue = (operands[0] != rootOutput) ? operands[0] : operands[1];
-    if (isa<ShapedType>(addValue.getType())) {
-      addValue = rewriter.create<memref::LoadOp>(loc, addValue, storeIndices)
-                     .getResult();
+  SmallVector<memref::StoreOp> newStores;
+  for (memref::StoreOp rootStoreOp : rootStoreOps) {
+    auto storeIndices = rootStoreOp.getIndices();
+    rewriter.setInsertionPoint(rootStoreOp);
+
+    IRMapping mapping;
+    for (OpOperand &operand : consumer->getOpOperands()) {
+      Value bbArg = body->getArgument(operand.getOperandNumber());
+      Value val = operand.get();
+
+      // The output's current value is the one about to be stored.
+      if (val == rootOutput) {
+        mapping.map(bbArg, rootStoreOp.getValue());
+        continue;
+      }
+      if (!isa<ShapedType>(val.getType())) {
+        mapping.map(bbArg, val);
+        continue;
+      }
+
+      // Load the element matching the stored one.
+      AffineMap map = consumer.getMatchingIndexingMap(&operand);
+      SmallVector<Value> indices;
+      for (AffineExpr expr : map.getResults()) {
+        if (auto dimExpr = dyn_cast<AffineDimExpr>(expr)) {
+          indices.push_back(storeIndices[dimExpr.getPosition()]);
+          continue;
+        }
+        indices.push_back(rewriter.create<arith::ConstantIndexOp>(loc, 0));
+      }
+      auto loadOp = rewriter.create<memref::LoadOp>(loc, val, indices);
+      mapping.map(bbArg, loadOp.getResult());
     }
-    // Fuse the add into the matmul body.
-    auto addOp =
-        rewriter.create<arith::AddFOp>(loc, rootStoreOp.getValue(), addValue);
-    // Store the new result.
-    newStore = rewriter.replaceOpWithNewOp<memref::StoreOp>(
-        rootStoreOp, addOp.getResult(), rootOutput, storeIndices);
-  } else if (structured_match::utils::isTwoDReluOp(consumer, &operands)) {
-    // Fuse the relu into the matmul body.
-    Value zeroFloat = rewriter.create<arith::ConstantFloatOp>(
-        loc, APFloat::getZero(floatType.getFloatSemantics()), floatType);
-    auto maxOp = rewriter.create<arith::MaximumFOp>(loc, rootStoreOp.getValue(),
-                                                    zeroFloat);
+
+    for (Operation &op : body->without_terminator()) {
+      if (auto indexOp = dyn_cast<linalg::IndexOp>(op)) {
+        mapping.map(indexOp.getResult(), storeIndices[indexOp.getDim()]);
+        continue;
+      }
+      rewriter.clone(op, mapping);
+    }
+    Value fusedRes =
+        mapping.lookupOrDefault(body->getTerminator()->getOperand(0));
+
     // Store the new result.
-    newStore = rewriter.replaceOpWithNewOp<memref::StoreOp>(
-        rootStoreOp, maxOp.getResult(), rootOutput, storeIndices);
-  } else {
-    // Not a fusable operation. Bail out.
-    return std::nullopt;
+    newStores.push_back(rewriter.replaceOpWithNewOp<memref::StoreOp>(
+        rootStoreOp, fusedRes, rootOutput, storeIndices));
   }
 
   rewriter.eraseOp(consumer);
 
-  return newStore;
+  return newStores;
 }
 
 // Find operations fusable with the given root op.
@@ -337,7 +397,7 @@ static StoreTy fuseEltwiseConsumers(linalg::LinalgOp rootOp,
                                     PatternRewriter &rewriter) {
   // Constrain conversion to the supported fusion types.
   static_assert(
-      llvm::is_one_of<StoreTy, memref::StoreOp,
+      llvm::is_one_of<StoreTy, SmallVector<memref::StoreOp>,
                       SmallVector<gpu::SubgroupMmaStoreMatrixOp>>::value);
 
   auto consumers = getFusableConsumers(rootOp);
@@ -696,7 +756,295 @@ static LogicalResult gemmToGpuLoops(linalg::LinalgOp linalgOp,
   auto storeOp =
       rewriter.create<memref::StoreOp>(loc, result, matC, parallelIvs);
 
-  (void)fuseEltwiseConsumers<memref::StoreOp>(linalgOp, storeOp, rewriter);
+  (void)fuseEltwiseConsumers<SmallVector<memref::StoreOp>>(
+      linalgOp, SmallVector<memref::StoreOp>{storeOp}, rewriter);
+
+  rewriter.eraseOp(linalgOp);
+
+  return success();
+}
+
+// Return true if the operation can be split into per-thread register tiles
+// of the given sizes.
+static bool isRegisterTileCompatible(linalg::LinalgOp linalgOp,
+                                     ArrayRef<int64_t> registerTile) {
+  if (registerTile.size() != 2 || registerTile[0] < 1 || registerTile[1] < 1)
+    return false;
+
+  auto cType = cast<ShapedType>(linalgOp.getDpsInits()[0].getType());
+  if (!isa<FloatType>(cType.getElementType()))
+    return false;
+
+  return (cType.getShape()[0] % registerTile[0] == 0) &&
+         (cType.getShape()[1] % registerTile[1] == 0);
+}
+
+// Return true if the operands blocks of the operation fit into shared memory
+// and can be loaded cooperatively by a single thread block.
+static bool isSharedMemoryCompatible(linalg::LinalgOp linalgOp,
+                                     ArrayRef<int64_t> registerTile,
+                                     int64_t kTile) {
+  // Hardware limits common to all the supported GPUs.
+  constexpr int64_t maxThreadsPerBlock = 1024;
+  constexpr int64_t maxSharedMemoryBytes = 48 * 1024;
+
+  auto aType = cast<ShapedType>(linalgOp.getDpsInputs()[0].getType());
+  auto bType = cast<ShapedType>(linalgOp.getDpsInputs()[1].getType());
+  auto cType = cast<ShapedType>(linalgOp.getDpsInits()[0].getType());
+
+  int64_t dimM = cType.getShape()[0];
+  int64_t dimN = cType.getShape()[1];
+  int64_t dimK = aType.getShape().back();
+  if (kTile < 1 || dimK % kTile != 0)
+    return false;
+
+  int64_t numThreads = (dimM / registerTile[0]) * (dimN / registerTile[1]);
+  if (numThreads > maxThreadsPerBlock)
+    return false;
+
+  int64_t sharedBytes =
+      dimM * kTile * aType.getElementTypeBitWidth() / 8 +
+      kTile * dimN * bType.getElementTypeBitWidth() / 8;
+  return sharedBytes <= maxSharedMemoryBytes;
+}
+
+// Create tiled loops out of matmul-like operation.
+//
+// Each GPU thread computes a micro-tile of the output of the given register
+// tile sizes. The accumulators are kept in registers through loop's iter
+// args and each loaded element of A and B is reused across the whole
+// micro-tile.
+//
+// Optionally, blocks of A and B along the reduction dimension are first
+// copied to shared memory cooperatively by all the threads of a GPU block.
+// The micro-tiles are then computed out of the shared memory.
+static LogicalResult gemmToGpuTiledLoops(linalg::LinalgOp linalgOp,
+                                         ArrayRef<int64_t> registerTile,
+                                         bool useSharedMemory, int64_t kTile,
+                                         PatternRewriter &rewriter) {
+  assert((isa<linalg::MatmulOp>(linalgOp) ||
+          isa<linalg::BatchReduceMatmulOp>(linalgOp)) &&
+         "Requires a matmul like op for loop lowering");
+
+  Location loc = linalgOp.getLoc();
+  OpBuilder::InsertionGuard guard(rewriter);
+
+  // Shared memory is only visible within a GPU block. Ensure that the
+  // threads cooperating on the operand blocks belong to the same GPU block.
+  if (useSharedMemory) {
+    auto blocksLoop = createGpuBlocksWrapper(linalgOp, {1, 1}, rewriter);
+    if (blocksLoop)
+      rewriter.setInsertionPoint(blocksLoop->getBody()->getTerminator());
+  }
+
+  auto matA = linalgOp.getDpsInputs()[0];
+  auto matB = linalgOp.getDpsInputs()[1];
+  auto matC = linalgOp.getDpsInits()[0];
+
+  auto typeA = cast<ShapedType>(matA.getType());
+  auto typeB = cast<ShapedType>(matB.getType());
+  auto typeC = cast<ShapedType>(matC.getType());
+
+  int64_t dimM = typeC.getShape()[0];
+  int64_t dimN = typeC.getShape()[1];
+  int64_t dimK = typeA.getShape().back();
+
+  int64_t tileM = registerTile[0];
+  int64_t tileN = registerTile[1];
+  int64_t threadsM = dimM / tileM;
+  int64_t threadsN = dimN / tileN;
+
+  bool isBrgemm = isa<linalg::BatchReduceMatmulOp>(linalgOp);
+
+  auto getIndex = [&](int64_t val) -> Value {
+    return rewriter.create<arith::ConstantIndexOp>(loc, val);
+  };
+  Value zero = getIndex(0);
+  Value one = getIndex(1);
+
+  // Create parallel loops over the threads.
+  auto parallelLoop = rewriter.create<scf::ParallelOp>(
+      loc, ValueRange{zero, zero},
+      ValueRange{getIndex(threadsM), getIndex(threadsN)},
+      ValueRange{one, one});
+  auto threadIvs = parallelLoop.getInductionVars();
+  rewriter.setInsertionPoint(parallelLoop.getBody()->getTerminator());
+
+  // Output rows and columns of the thread's micro-tile.
+  auto getTileIndices = [&](Value threadIv, int64_t tileSize) {
+    Value offset =
+        rewriter.create<arith::MulIOp>(loc, threadIv, getIndex(tileSize));
+    SmallVector<Value> indices{offset};
+    for (int64_t i = 1; i < tileSize; i++) {
+      indices.push_back(
+          rewriter.create<arith::AddIOp>(loc, offset, getIndex(i)));
+    }
+    return indices;
+  };
+  SmallVector<Value> rows = getTileIndices(threadIvs[0], tileM);
+  SmallVector<Value> cols = getTileIndices(threadIvs[1], tileN);
+
+  // Allocate operand blocks in shared memory.
+  Value sharedA;
+  Value sharedB;
+  Value threadId;
+  Value numThreads;
+  if (useSharedMemory) {
+    // Linearized thread index within the GPU block.
+    threadId = rewriter.create<arith::AddIOp>(
+        loc,
+        rewriter.create<arith::MulIOp>(loc, threadIvs[0], getIndex(threadsN)),
+        threadIvs[1]);
+    numThreads = getIndex(threadsM * threadsN);
+
+    auto workgroupSpace = gpu::AddressSpaceAttr::get(
+        rewriter.getContext(), gpu::AddressSpace::Workgroup);
+    auto sharedTypeA =
+        MemRefType::get({dimM, kTile}, typeA.getElementType(),
+                        MemRefLayoutAttrInterface{}, workgroupSpace);
+    auto sharedTypeB =
+        MemRefType::get({kTile, dimN}, typeB.getElementType(),
+                        MemRefLayoutAttrInterface{}, workgroupSpace);
+    sharedA = rewriter.create<memref::AllocOp>(loc, sharedTypeA);
+    sharedB = rewriter.create<memref::AllocOp>(loc, sharedTypeB);
+  }
+
+  // Fetch the inital values of the output micro-tile.
+  SmallVector<Value> accs;
+  for (Value row : rows) {
+    for (Value col : cols) {
+      accs.push_back(rewriter.create<memref::LoadOp>(loc, matC,
+                                                     ValueRange{row, col}));
+    }
+  }
+
+  // Create a loop with the accumulators as iter args and step into it.
+  auto startLoop = [&](Value lb, Value ub, Value step) -> scf::ForOp {
+    scf::ForOp loopOp = rewriter.create<scf::ForOp>(loc, lb, ub, step, accs);
+    rewriter.setInsertionPointToStart(loopOp.getBody());
+    auto iterArgs = loopOp.getRegionIterArgs();
+    accs.assign(iterArgs.begin(), iterArgs.end());
+    return loopOp;
+  };
+  // Create loop terminator and exit the loop.
+  auto terminateLoop = [&](scf::ForOp loopOp) {
+    rewriter.setInsertionPointToEnd(loopOp.getBody());
+    rewriter.create<scf::YieldOp>(loc, accs);
+    rewriter.setInsertionPointAfter(loopOp);
+    accs.assign(loopOp.getResults().begin(), loopOp.getResults().end());
+  };
+  // Accumulate outer product of the A column and the B row into the
+  // micro-tile.
+  auto accumulate = [&](ArrayRef<Value> elemsA, ArrayRef<Value> elemsB) {
+    for (int64_t m = 0; m < tileM; m++) {
+      for (int64_t n = 0; n < tileN; n++) {
+        Value mul = rewriter.create<arith::MulFOp>(loc, elemsA[m], elemsB[n]);
+        Value &acc = accs[m * tileN + n];
+        acc = rewriter.create<arith::AddFOp>(loc, acc, mul);
+      }
+    }
+  };
+  auto getOperandIndices = [&](Value batchIv, Value row, Value col) {
+    return isBrgemm ? SmallVector<Value>{batchIv, row, col}
+                    : SmallVector<Value>{row, col};
+  };
+
+  scf::ForOp batchLoop;
+  Value batchIv;
+  if (isBrgemm) {
+    batchLoop = startLoop(zero, getIndex(typeA.getShape()[0]), one);
+    batchIv = batchLoop.getInductionVar();
+  }
+
+  if (!useSharedMemory) {
+    // Compute the micro-tile with a loop over reduction dimension.
+    scf::ForOp kLoop = startLoop(zero, getIndex(dimK), one);
+    Value kIv = kLoop.getInductionVar();
+
+    SmallVector<Value> elemsA;
+    for (Value row : rows) {
+      elemsA.push_back(rewriter.create<memref::LoadOp>(
+          loc, matA, getOperandIndices(batchIv, row, kIv)));
+    }
+    SmallVector<Value> elemsB;
+    for (Value col : cols) {
+      elemsB.push_back(rewriter.create<memref::LoadOp>(
+          loc, matB, getOperandIndices(batchIv, kIv, col)));
+    }
+    accumulate(elemsA, elemsB);
+
+    terminateLoop(kLoop);
+  } else {
+    // Tile the reduction dimension to fit the operand blocks into shared
+    // memory.
+    scf::ForOp kTileLoop = startLoop(zero, getIndex(dimK), getIndex(kTile));
+    Value kTileIv = kTileLoop.getInductionVar();
+
+    // Copy a block of the source into shared memory. The elements are
+    // distributed in a round-robin fashion among all the threads of the GPU
+    // block such that the consecutive threads access consecutive elements.
+    auto copyToShared = [&](Value src, Value dst, Value srcRowOffset,
+                            Value srcColOffset) {
+      ArrayRef<int64_t> dstShape = cast<ShapedType>(dst.getType()).getShape();
+      auto copyLoop = rewriter.create<scf::ForOp>(
+          loc, threadId, getIndex(dstShape[0] * dstShape[1]), numThreads);
+      OpBuilder::InsertionGuard copyGuard(rewriter);
+      rewriter.setInsertionPoint(copyLoop.getBody()->getTerminator());
+      Value elemIv = copyLoop.getInductionVar();
+      Value row =
+          rewriter.create<arith::DivUIOp>(loc, elemIv, getIndex(dstShape[1]));
+      Value col =
+          rewriter.create<arith::RemUIOp>(loc, elemIv, getIndex(dstShape[1]));
+      Value srcRow = rewriter.create<arith::AddIOp>(loc, row, srcRowOffset);
+      Value srcCol = rewriter.create<arith::AddIOp>(loc, col, srcColOffset);
+      Value elem = rewriter.create<memref::LoadOp>(
+          loc, src, getOperandIndices(batchIv, srcRow, srcCol));
+      rewriter.create<memref::StoreOp>(loc, elem, dst, ValueRange{row, col});
+    };
+    copyToShared(matA, sharedA, zero, kTileIv);
+    copyToShared(matB, sharedB, kTileIv, zero);
+    // Wait until the whole blocks are available.
+    rewriter.create<gpu::BarrierOp>(loc);
+
+    // Compute the micro-tile out of the shared memory blocks.
+    scf::ForOp kLoop = startLoop(zero, getIndex(kTile), one);
+    Value kIv = kLoop.getInductionVar();
+
+    SmallVector<Value> elemsA;
+    for (Value row : rows) {
+      elemsA.push_back(rewriter.create<memref::LoadOp>(loc, sharedA,
+                                                       ValueRange{row, kIv}));
+    }
+    SmallVector<Value> elemsB;
+    for (Value col : cols) {
+      elemsB.push_back(rewriter.create<memref::LoadOp>(loc, sharedB,
+                                                       ValueRange{kIv, col}));
+    }
+    accumulate(elemsA, elemsB);
+
+    terminateLoop(kLoop);
+
+    // Wait until all the threads are done with the current blocks before
+    // they are overwritten.
+    rewriter.create<gpu::BarrierOp>(loc);
+
+    terminateLoop(kTileLoop);
+  }
+
+  if (isBrgemm)
+    terminateLoop(batchLoop);
+
+  // Write back the micro-tile to the output buffer.
+  SmallVector<memref::StoreOp> storeOps;
+  for (auto [m, row] : llvm::enumerate(rows)) {
+    for (auto [n, col] : llvm::enumerate(cols)) {
+      storeOps.push_back(rewriter.create<memref::StoreOp>(
+          loc, accs[m * tileN + n], matC, ValueRange{row, col}));
+    }
+  }
+
+  (void)fuseEltwiseConsumers<SmallVector<memref::StoreOp>>(linalgOp, storeOps,
+                                                            rewriter);
 
   rewriter.eraseOp(linalgOp);
 
@@ -734,7 +1082,23 @@ struct ConvertGemmLikeToGpu : public OpRewritePattern<LinalgOpTy> {
         isMMACompatible(gemmLikeOp, options.warpTile, kTile)) {
       return gemmToGpuMMA(gemmLikeOp, options.warpTile, kTile, rewriter);
     }
-    // TODO: Add warp and K dim tiling to looped implementation.
+
+    SmallVector<int64_t> registerTile(options.registerTile.begin(),
+                                      options.registerTile.end());
+    if (registerTile.empty())
+      registerTile = {1, 1};
+    bool isUnitTile = llvm::all_of(registerTile,
+                                   [](int64_t tile) { return tile == 1; });
+    if ((!isUnitTile || options.sharedMemory) &&
+        isRegisterTileCompatible(gemmLikeOp, registerTile)) {
+      bool useSharedMemory =
+          options.sharedMemory &&
+          isSharedMemoryCompatible(gemmLikeOp, registerTile, kTile);
+      if (!isUnitTile || useSharedMemory) {
+        return gemmToGpuTiledLoops(gemmLikeOp, registerTile, useSharedMemory,
+                                   kTile, rewriter);
+      }
+    }
     return gemmToGpuLoops(gemmLikeOp, rewriter);
   }
 
@@ -754,8 +1118,9 @@ struct LinalgToGpu : public tpp::impl::LinalgToGpuBase<LinalgToGpu> {
 
   void runOnOperation() override {
     RewritePatternSet patterns(&getContext());
-    populateLinalgToGpuPatterns(patterns,
-                                LinalgToGpuOptions{useWmma, warpTile, kTile});
+    populateLinalgToGpuPatterns(
+        patterns, LinalgToGpuOptions{useWmma, warpTile, kTile, registerTile,
+                                     sharedMemory});
     (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
   }
 };
@@ -11,6 +11,10 @@
 #include "TPP/Transforms/Utils/ValueUtils.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/IR/Matchers.h"
+
+#include <cmath>
 
 namespace mlir {
 namespace structured_match {
@@ -217,6 +221,10 @@ bool isTwoDMulOp(linalg::LinalgOp linalgOp, SmallVectorImpl<Value> *operands) {
   return isTwoDEltWiseOpOfTypeTy<arith::MulFOp>(linalgOp, operands);
 }
 
+bool isTwoDDivOp(linalg::LinalgOp linalgOp, SmallVectorImpl<Value> *operands) {
+  return isTwoDEltWiseOpOfTypeTy<arith::DivFOp>(linalgOp, operands);
+}
+
 static bool hasReluBody(Operation *op, SmallVectorImpl<Value> *captured) {
   if (!isa<linalg::LinalgOp>(op))
     return false;
@@ -357,6 +365,686 @@ bool isTwoDReluOp(linalg::LinalgOp linalgOp, SmallVectorImpl<Value> *operands) {
   return isTppUnaryOp(linalgOp) && reluMatcher.match(linalgOp);
 }
 
+// Return true if the body of `linalgOp` is a single OpTy applied to the input
+// block argument and yielded. Captures the input and the output.
+template <typename OpTy>
+static bool hasSingleUnaryOpBody(linalg::LinalgOp linalgOp,
+                                 SmallVectorImpl<Value> *captured) {
+  Region &region = linalgOp->getRegion(0);
+  if (!region.hasOneBlock() || linalgOp.getNumDpsInputs() != 1 ||
+      linalgOp.getNumDpsInits() != 1)
+    return false;
+  Block *body = linalgOp.getBlock();
+  if (std::distance(body->begin(), body->end()) != 2)
+    return false;
+  auto innerOp = dyn_cast<OpTy>(&body->front());
+  if (!innerOp || innerOp->getNumOperands() != 1)
+    return false;
+  Operation *yieldOp = body->getTerminator();
+  if (yieldOp->getNumOperands() != 1 ||
+      yieldOp->getOperand(0).getDefiningOp() != innerOp.getOperation())
+    return false;
+  auto arg = dyn_cast<BlockArgument>(innerOp->getOperand(0));
+  if (!arg || arg.getParentBlock() != body ||
+      arg != linalgOp.getMatchingBlockArgument(linalgOp.getDpsInputOperand(0)))
+    return false;
+  if (captured) {
+    captured->push_back(linalgOp.getDpsInputs()[0]);
+    captured->push_back(linalgOp.getDpsInits()[0]);
+  }
+  return true;
+}
+
+// Return true if the linalg.generic can be mapped to an exp unary.
+bool isTwoDExpOp(linalg::LinalgOp linalgOp, SmallVectorImpl<Value> *operands) {
+  // clang-format off
+  auto expMatcher =
+    StructuredOpMatcher::make<linalg::GenericOp>()
+    .output(MatchAll(), HasMap(Identity()))
+    .input(MatchAll(), HasMap(BroadcastableProjectedPermutation()));
+  // clang-format on
+  return isTppUnaryOp(linalgOp) && expMatcher.match(linalgOp) &&
+         hasSingleUnaryOpBody<math::ExpOp>(linalgOp, operands);
+}
+
+// Return true if `value` is a floating point constant equal to `expected`
+// rounded to the type of the constant.
+static bool isFloatConstant(Value value, double expected) {
+  APFloat constant(0.0);
+  if (!matchPattern(value, m_ConstantFloat(&constant)))
+    return false;
+  APFloat rounded(expected);
+  bool losesInfo = false;
+  rounded.convert(constant.getSemantics(), APFloat::rmNearestTiesToEven,
+                  &losesInfo);
+  return constant.bitwiseIsEqual(rounded);
+}
+
+// Return the op of type OpTy defining `value` in `body`, null otherwise.
+template <typename OpTy> static OpTy getBodyOp(Value value, Block *body) {
+  auto op = value.getDefiningOp<OpTy>();
+  if (!op || op->getBlock() != body)
+    return nullptr;
+  return op;
+}
+
+// If one of the operands of the binary `op` is the constant `expected`, return
+// the other one.
+static Value getOperandOtherThanConstant(Operation *op, double expected) {
+  if (isFloatConstant(op->getOperand(0), expected))
+    return op->getOperand(1);
+  if (isFloatConstant(op->getOperand(1), expected))
+    return op->getOperand(0);
+  return Value();
+}
+
+// Match 1 + exp(-x) and return x.
+static Value matchOnePlusExpOfNeg(Value value, Block *body) {
+  auto addOp = getBodyOp<arith::AddFOp>(value, body);
+  if (!addOp)
+    return Value();
+  Value expValue = getOperandOtherThanConstant(addOp, 1.0);
+  auto expOp = expValue ? getBodyOp<math::ExpOp>(expValue, body) : nullptr;
+  if (!expOp)
+    return Value();
+  auto negOp = getBodyOp<arith::NegFOp>(expOp.getOperand(), body);
+  if (!negOp)
+    return Value();
+  return negOp.getOperand();
+}
+
+// Match tanh(x) and return x.
+static Value matchTanh(Value value, Block *body) {
+  auto tanhOp = getBodyOp<math::TanhOp>(value, body);
+  if (!tanhOp)
+    return Value();
+  return tanhOp.getOperand();
+}
+
+// Match 1 / (1 + exp(-x)) and return x.
+static Value matchSigmoid(Value value, Block *body) {
+  auto divOp = getBodyOp<arith::DivFOp>(value, body);
+  if (!divOp || !isFloatConstant(divOp.getLhs(), 1.0))
+    return Value();
+  return matchOnePlusExpOfNeg(divOp.getRhs(), body);
+}
+
+// Match x / (1 + exp(-x)) or x * sigmoid(x) and return x.
+static Value matchSilu(Value value, Block *body) {
+  if (auto divOp = getBodyOp<arith::DivFOp>(value, body)) {
+    Value x = matchOnePlusExpOfNeg(divOp.getRhs(), body);
+    return (x && x == divOp.getLhs()) ? x : Value();
+  }
+  auto mulOp = getBodyOp<arith::MulFOp>(value, body);
+  if (!mulOp)
+    return Value();
+  Value lhs = mulOp.getLhs();
+  Value rhs = mulOp.getRhs();
+  if (Value x = matchSigmoid(rhs, body); x && x == lhs)
+    return x;
+  if (Value x = matchSigmoid(lhs, body); x && x == rhs)
+    return x;
+  return Value();
+}
+
+// Collect the factors of a tree of multiplications in `body`.
+static void collectFactors(Value value, Block *body,
+                           SmallVectorImpl<Value> &factors) {
+  if (auto mulOp = getBodyOp<arith::MulFOp>(value, body)) {
+    collectFactors(mulOp.getLhs(), body, factors);
+    collectFactors(mulOp.getRhs(), body, factors);
+    return;
+  }
+  factors.push_back(value);
+}
+
+// Match 0.5 * x * (1 + erf(x / sqrt(2))), with the factors in any order, and
+// return x. The division may also be a multiplication by 1 / sqrt(2).
+static Value matchGelu(Value value, Block *body) {
+  SmallVector<Value, 3> factors;
+  collectFactors(value, body, factors);
+  if (factors.size() != 3)
+    return Value();
+
+  Value half, x, erfTerm;
+  for (Value factor : factors) {
+    if (!half && isFloatConstant(factor, 0.5))
+      half = factor;
+    else if (!x && isa<BlockArgument>(factor))
+      x = factor;
+    else if (!erfTerm)
+      erfTerm = factor;
+    else
+      return Value();
+  }
+  if (!half || !x || !erfTerm)
+    return Value();
+
+  auto addOp = getBodyOp<arith::AddFOp>(erfTerm, body);
+  if (!addOp)
+    return Value();
+  Value erfValue = getOperandOtherThanConstant(addOp, 1.0);
+  auto erfOp = erfValue ? getBodyOp<math::ErfOp>(erfValue, body) : nullptr;
+  if (!erfOp)
+    return Value();
+
+  const double sqrt2 = 1.41421356237309504880;
+  const double invSqrt2 = 0.70710678118654752440;
+  Value erfArg = erfOp.getOperand();
+  if (auto mulOp = getBodyOp<arith::MulFOp>(erfArg, body))
+    return (getOperandOtherThanConstant(mulOp, invSqrt2) == x) ? x : Value();
+  if (auto divOp = getBodyOp<arith::DivFOp>(erfArg, body)) {
+    return (divOp.getLhs() == x && isFloatConstant(divOp.getRhs(), sqrt2))
+               ? x
+               : Value();
+  }
+  return Value();
+}
+
+// Return true if the linalg.generic is a 2d unary whose body yields the
+// activation recognized by `matchFn` of a single block argument. Like relu,
+// the activation may be computed in-place on the output. Captures the operand
+// bound to the block argument and the output.
+static bool isTwoDActivationOp(linalg::LinalgOp linalgOp,
+                               SmallVectorImpl<Value> *operands,
+                               function_ref<Value(Value, Block *)> matchFn) {
+  // clang-format off
+  auto activationMatcher =
+    StructuredOpMatcher::make<linalg::LinalgOp>()
+    .output(MatchAll(), HasMap(Identity()))
+    .input(MatchAll(), HasMap(BroadcastableProjectedPermutation()));
+  // clang-format on
+  if (!isTppUnaryOp(linalgOp) || !activationMatcher.match(linalgOp) ||
+      !linalgOp->getRegion(0).hasOneBlock())
+    return false;
+
+  Block *body = linalgOp.getBlock();
+  Operation *yieldOp = body->getTerminator();
+  if (yieldOp->getNumOperands() != 1)
+    return false;
+  Value x = matchFn(yieldOp->getOperand(0), body);
+  auto blockArg = x ? dyn_cast<BlockArgument>(x) : BlockArgument();
+  if (!blockArg || blockArg.getParentBlock() != body)
+    return false;
+  // With an input, the activation must not read the output.
+  OpOperand *operand = linalgOp.getMatchingOpOperand(blockArg);
+  if (linalgOp.getNumDpsInputs() != 0 && !linalgOp.isDpsInput(operand))
+    return false;
+
+  if (operands) {
+    operands->push_back(operand->get());
+    operands->push_back(linalgOp.getDpsInits()[0]);
+  }
+  return true;
+}
+
+bool isTwoDTanhOp(linalg::LinalgOp linalgOp, SmallVectorImpl<Value> *operands) {
+  return isTwoDActivationOp(linalgOp, operands, matchTanh);
+}
+
+bool isTwoDSigmoidOp(linalg::LinalgOp linalgOp,
+                     SmallVectorImpl<Value> *operands) {
+  return isTwoDActivationOp(linalgOp, operands, matchSigmoid);
+}
+
+bool isTwoDGeluOp(linalg::LinalgOp linalgOp, SmallVectorImpl<Value> *operands) {
+  return isTwoDActivationOp(linalgOp, operands, matchGelu);
+}
+
+bool isTwoDSiluOp(linalg::LinalgOp linalgOp, SmallVectorImpl<Value> *operands) {
+  return isTwoDActivationOp(linalgOp, operands, matchSilu);
+}
+
+// Return true if the linalg.generic computes exp(lhs - rhs). Captures lhs, rhs
+// and the output.
+bool isTwoDSubExpOp(linalg::LinalgOp linalgOp,
+                    SmallVectorImpl<Value> *operands) {
+  SmallVector<Value, 2> linalgOperands;
+  // clang-format off
+  auto subExpMatcher =
+    StructuredOpMatcher::make<linalg::GenericOp>()
+      .operation(NumDpsInputs(EqualsTo(2)))
+      .region(MatchOne(0),
+              WithOpChain<arith::SubFOp, math::ExpOp>(&linalgOperands));
+  // clang-format on
+  if (!isTppBinaryOp(linalgOp) || !subExpMatcher.match(linalgOp) ||
+      linalgOperands.size() != 2)
+    return false;
+
+  // The exponential must consume the difference, not another argument.
+  Block *body = linalgOp.getBlock();
+  auto expOp = cast<math::ExpOp>(*std::next(body->begin()));
+  if (expOp.getOperand().getDefiningOp() != &body->front())
+    return false;
+
+  if (operands) {
+    operands->append(linalgOperands.begin(), linalgOperands.end());
+    operands->push_back(linalgOp.getDpsInits()[0]);
+  }
+  return true;
+}
+
+// Return true if the linalg.generic is a 2d reduction of its single input
+// whose body combines the input and the accumulator with one of OpTys.
+template <typename... OpTys>
+static bool isTwoDReduceOpOfTypeTy(linalg::LinalgOp linalgOp,
+                                   SmallVectorImpl<Value> *operands) {
+  // clang-format off
+  auto reduceMatcher =
+    StructuredOpMatcher::make<linalg::GenericOp>()
+      .operation(NumDpsInits(EqualsTo(1)))
+      .operation(NumDpsInputs(EqualsTo(1)))
+      .operation(NumOfLoops(EqualsTo(2)))
+      .input(MatchAll(), HasRank({2}))
+      .input(MatchAll(), HasMap(Identity()))
+      .output(MatchAll(), HasRank({1, 2}));
+  // clang-format on
+  if (!isTppOp(linalgOp) || !reduceMatcher.match(linalgOp))
+    return false;
+  if (!getTwoDReductionDim(linalgOp))
+    return false;
+
+  Block *body = linalgOp.getBlock();
+  if (std::distance(body->begin(), body->end()) != 2)
+    return false;
+  Operation *innerOp = &body->front();
+  if (!isa<OpTys...>(innerOp) || innerOp->getNumOperands() != 2)
+    return false;
+  Operation *yieldOp = body->getTerminator();
+  if (yieldOp->getNumOperands() != 1 ||
+      yieldOp->getOperand(0).getDefiningOp() != innerOp)
+    return false;
+
+  // The combiner is commutative, accept both operand orders.
+  Value in = linalgOp.getMatchingBlockArgument(linalgOp.getDpsInputOperand(0));
+  Value acc = linalgOp.getMatchingBlockArgument(linalgOp.getDpsInitOperand(0));
+  Value lhs = innerOp->getOperand(0);
+  Value rhs = innerOp->getOperand(1);
+  if (!((lhs == in && rhs == acc) || (lhs == acc && rhs == in)))
+    return false;
+
+  if (operands) {
+    operands->push_back(linalgOp.getDpsInputs()[0]);
+    operands->push_back(linalgOp.getDpsInits()[0]);
+  }
+  return true;
+}
+
+bool isTwoDReduceAddOp(linalg::LinalgOp linalgOp,
+                       SmallVectorImpl<Value> *operands) {
+  return isTwoDReduceOpOfTypeTy<arith::AddFOp>(linalgOp, operands);
+}
+
+bool isTwoDReduceMaxOp(linalg::LinalgOp linalgOp,
+                       SmallVectorImpl<Value> *operands) {
+  return isTwoDReduceOpOfTypeTy<arith::MaximumFOp, arith::MaxNumFOp>(
+      linalgOp, operands);
+}
+
+std::optional<unsigned> getTwoDReductionDim(linalg::LinalgOp linalgOp) {
+  if (linalgOp.getNumLoops() != 2 || linalgOp.getNumReductionLoops() != 1 ||
+      linalgOp.getNumDpsInits() != 1)
+    return std::nullopt;
+  SmallVector<unsigned> reductionDims;
+  linalgOp.getReductionDims(reductionDims);
+  unsigned redDim = reductionDims[0];
+  unsigned parDim = 1 - redDim;
+
+  AffineMap outMap =
+      linalgOp.getMatchingIndexingMap(linalgOp.getDpsInitOperand(0));
+  auto isParDim = [&](AffineExpr expr) {
+    auto dim = dyn_cast<AffineDimExpr>(expr);
+    return dim && dim.getPosition() == parDim;
+  };
+  auto isZero = [](AffineExpr expr) {
+    auto cst = dyn_cast<AffineConstantExpr>(expr);
+    return cst && cst.getValue() == 0;
+  };
+  if (outMap.getNumResults() == 1 && isParDim(outMap.getResult(0)))
+    return redDim;
+  if (outMap.getNumResults() == 2 && isZero(outMap.getResult(redDim)) &&
+      isParDim(outMap.getResult(parDim)))
+    return redDim;
+  return std::nullopt;
+}
+
+// Return the input operand bound to `value` if it is a block argument of the
+// body of `linalgOp`, null otherwise.
+static OpOperand *getInputOperand(linalg::LinalgOp linalgOp, Value value) {
+  auto arg = dyn_cast<BlockArgument>(value);
+  if (!arg || arg.getParentBlock() != linalgOp.getBlock())
+    return nullptr;
+  OpOperand *operand = linalgOp.getMatchingOpOperand(arg);
+  return linalgOp.isDpsInput(operand) ? operand : nullptr;
+}
+
+// Return true if `map` broadcasts a per-row value along the columns, i.e.
+// (d0, d1) -> (d0) or (d0, d1) -> (d0, 0).
+static bool isRowMap(AffineMap map) {
+  if (map.getNumDims() != 2 || map.getNumResults() == 0 ||
+      map.getResult(0) != getAffineDimExpr(0, map.getContext()))
+    return false;
+  if (map.getNumResults() == 1)
+    return true;
+  auto cst = dyn_cast<AffineConstantExpr>(map.getResult(1));
+  return map.getNumResults() == 2 && cst && cst.getValue() == 0;
+}
+
+// Return true if `map` broadcasts a per-column value along the rows, i.e.
+// (d0, d1) -> (d1).
+static bool isColMap(AffineMap map) {
+  return map.getNumDims() == 2 && map.getNumResults() == 1 &&
+         map.getResult(0) == getAffineDimExpr(1, map.getContext());
+}
+
+// Return true if the linalg.generic reduces the rows of its first input, a 2d
+// tensor, by accumulating `acc + term` into its single output. Return the term.
+static Value matchRowReduction(linalg::LinalgOp linalgOp, unsigned numInputs) {
+  // clang-format off
+  auto reduceMatcher =
+    StructuredOpMatcher::make<linalg::GenericOp>()
+      .operation(NumDpsInits(EqualsTo(1)))
+      .operation(NumDpsInputs(EqualsTo(numInputs)))
+      .operation(NumOfLoops(EqualsTo(2)))
+      .input(MatchOne(0), HasRank({2}))
+      .input(MatchOne(0), HasMap(Identity()))
+      .output(MatchAll(), HasRank({1, 2}));
+  // clang-format on
+  if (!isTppOp(linalgOp) || !reduceMatcher.match(linalgOp) ||
+      getTwoDReductionDim(linalgOp) != 1u)
+    return Value();
+
+  Block *body = linalgOp.getBlock();
+  Value acc = linalgOp.getMatchingBlockArgument(linalgOp.getDpsInitOperand(0));
+  auto addOp =
+      getBodyOp<arith::AddFOp>(body->getTerminator()->getOperand(0), body);
+  if (!addOp || !acc.hasOneUse())
+    return Value();
+  if (addOp.getLhs() == acc)
+    return addOp.getRhs();
+  if (addOp.getRhs() == acc)
+    return addOp.getLhs();
+  return Value();
+}
+
+// Match `term / n` or a product of factors one of which is 1 / n. Return the
+// other factors.
+static bool matchScaledByInverse(Value term, Block *body, int64_t n,
+                                 SmallVectorImpl<Value> &factors) {
+  if (auto divOp = getBodyOp<arith::DivFOp>(term, body)) {
+    if (!isFloatConstant(divOp.getRhs(), static_cast<double>(n)))
+      return false;
+    collectFactors(divOp.getLhs(), body, factors);
+    return true;
+  }
+  SmallVector<Value> allFactors;
+  collectFactors(term, body, allFactors);
+  auto *it = llvm::find_if(allFactors, [&](Value factor) {
+    return isFloatConstant(factor, 1.0 / static_cast<double>(n));
+  });
+  if (it == allFactors.end())
+    return false;
+  allFactors.erase(it);
+  factors.append(allFactors.begin(), allFactors.end());
+  return true;
+}
+
+// Return the number of columns reduced by a row reduction.
+static int64_t getRowSize(linalg::LinalgOp linalgOp) {
+  return cast<ShapedType>(linalgOp.getDpsInputs()[0].getType()).getDimSize(1);
+}
+
+bool isTwoDRowMeanOp(linalg::LinalgOp linalgOp,
+                     SmallVectorImpl<Value> *operands) {
+  Value term = matchRowReduction(linalgOp, /*numInputs=*/1);
+  SmallVector<Value, 1> factors;
+  if (!term || !matchScaledByInverse(term, linalgOp.getBlock(),
+                                     getRowSize(linalgOp), factors))
+    return false;
+  Value x = linalgOp.getMatchingBlockArgument(linalgOp.getDpsInputOperand(0));
+  if (factors.size() != 1 || factors[0] != x)
+    return false;
+
+  if (operands) {
+    operands->push_back(linalgOp.getDpsInputs()[0]);
+    operands->push_back(linalgOp.getDpsInits()[0]);
+  }
+  return true;
+}
+
+bool isTwoDRowMeanSquareOp(linalg::LinalgOp linalgOp,
+                           SmallVectorImpl<Value> *operands) {
+  Value term = matchRowReduction(linalgOp, /*numInputs=*/1);
+  SmallVector<Value, 2> factors;
+  if (!term || !matchScaledByInverse(term, linalgOp.getBlock(),
+                                     getRowSize(linalgOp), factors))
+    return false;
+  Value x = linalgOp.getMatchingBlockArgument(linalgOp.getDpsInputOperand(0));
+  if (factors.size() != 2 || factors[0] != x || factors[1] != x)
+    return false;
+
+  if (operands) {
+    operands->push_back(linalgOp.getDpsInputs()[0]);
+    operands->push_back(linalgOp.getDpsInits()[0]);
+  }
+  return true;
+}
+
+bool isTwoDRowVarianceOp(linalg::LinalgOp linalgOp,
+                         SmallVectorImpl<Value> *operands) {
+  Value term = matchRowReduction(linalgOp, /*numInputs=*/2);
+  if (!term)
+    return false;
+  Block *body = linalgOp.getBlock();
+  SmallVector<Value, 2> factors;
+  if (!matchScaledByInverse(term, body, getRowSize(linalgOp), factors) ||
+      factors.size() != 2 || factors[0] != factors[1])
+    return false;
+
+  // The squared value is the input centered on the per-row mean.
+  OpOperand *meanOperand = linalgOp.getDpsInputOperand(1);
+  auto subOp = getBodyOp<arith::SubFOp>(factors[0], body);
+  if (!subOp ||
+      subOp.getLhs() !=
+          linalgOp.getMatchingBlockArgument(linalgOp.getDpsInputOperand(0)) ||
+      subOp.getRhs() != linalgOp.getMatchingBlockArgument(meanOperand) ||
+      !isRowMap(linalgOp.getMatchingIndexingMap(meanOperand)))
+    return false;
+
+  if (operands) {
+    operands->push_back(linalgOp.getDpsInputs()[0]);
+    operands->push_back(meanOperand->get());
+    operands->push_back(linalgOp.getDpsInits()[0]);
+  }
+  return true;
+}
+
+// Match rsqrt(stat + eps), or 1 / sqrt(stat + eps) when `isDenominator` is set,
+// and return stat. Sets `epsilon`.
+static Value matchInvStdDev(Value value, Block *body, bool isDenominator,
+                            double &epsilon) {
+  Value addValue;
+  if (isDenominator) {
+    auto sqrtOp = getBodyOp<math::SqrtOp>(value, body);
+    addValue = sqrtOp ? sqrtOp.getOperand() : Value();
+  } else {
+    auto rsqrtOp = getBodyOp<math::RsqrtOp>(value, body);
+    addValue = rsqrtOp ? rsqrtOp.getOperand() : Value();
+  }
+  auto addOp = addValue ? getBodyOp<arith::AddFOp>(addValue, body) : nullptr;
+  if (!addOp)
+    return Value();
+  APFloat eps(0.0);
+  Value stat;
+  if (matchPattern(addOp.getRhs(), m_ConstantFloat(&eps)))
+    stat = addOp.getLhs();
+  else if (matchPattern(addOp.getLhs(), m_ConstantFloat(&eps)))
+    stat = addOp.getRhs();
+  else
+    return Value();
+  bool losesInfo = false;
+  eps.convert(APFloat::IEEEdouble(), APFloat::rmNearestTiesToEven, &losesInfo);
+  epsilon = eps.convertToDouble();
+  return epsilon >= 0.0 ? stat : Value();
+}
+
+// Match `centered * invStdDev * gamma` with the factors in any order, where
+// invStdDev is rsqrt(stat + eps). `centered / sqrt(stat + eps) * gamma` is
+// accepted as well. Return `centered`, `stat` and `gamma`; when both `centered`
+// and `gamma` are block arguments the caller tells them apart.
+static bool matchNormalizedAndScaled(Value value, Block *body, Value &centered,
+                                     Value &stat, Value &gamma,
+                                     double &epsilon) {
+  SmallVector<Value, 3> factors;
+  collectFactors(value, body, factors);
+  SmallVector<Value, 2> others;
+  for (Value factor : factors) {
+    if (stat) {
+      others.push_back(factor);
+      continue;
+    }
+    if (Value s = matchInvStdDev(factor, body, /*isDenominator=*/false,
+                                 epsilon)) {
+      stat = s;
+      continue;
+    }
+    auto divOp = getBodyOp<arith::DivFOp>(factor, body);
+    if (Value s = divOp ? matchInvStdDev(divOp.getRhs(), body,
+                                         /*isDenominator=*/true, epsilon)
+                        : Value()) {
+      stat = s;
+      others.push_back(divOp.getLhs());
+      continue;
+    }
+    others.push_back(factor);
+  }
+  if (!stat || others.size() != 2)
+    return false;
+  centered = others[0];
+  gamma = others[1];
+  if (isa<BlockArgument>(centered) && !isa<BlockArgument>(gamma))
+    std::swap(centered, gamma);
+  return true;
+}
+
+// Common checks of the normalization roots: a 2d element-wise operation with
+// an identity output. The row statistics are broadcast along the columns and
+// the scale and shift along the rows.
+static bool isTwoDNormRoot(linalg::LinalgOp linalgOp, unsigned numInputs) {
+  // clang-format off
+  auto normMatcher =
+    StructuredOpMatcher::make<linalg::GenericOp>()
+      .operation(NumDpsInits(EqualsTo(1)))
+      .operation(NumDpsInputs(EqualsTo(numInputs)))
+      .operation(NumOfLoops(EqualsTo(2)))
+      .dim(MatchAll(), mlir::utils::IteratorType::parallel)
+      .output(MatchAll(), HasRank({2}))
+      .output(MatchAll(), HasMap(Identity()));
+  // clang-format on
+  return isTppOp(linalgOp) && normMatcher.match(linalgOp) &&
+         linalgOp->getRegion(0).hasOneBlock();
+}
+
+bool isTwoDLayerNormOp(linalg::LinalgOp linalgOp,
+                       SmallVectorImpl<Value> *operands, double *epsilon) {
+  if (!isTwoDNormRoot(linalgOp, /*numInputs=*/5))
+    return false;
+
+  // out = (x - mean) * rsqrt(var + eps) * gamma + beta
+  Block *body = linalgOp.getBlock();
+  auto addOp =
+      getBodyOp<arith::AddFOp>(body->getTerminator()->getOperand(0), body);
+  if (!addOp)
+    return false;
+  Value centered, var, gamma, beta;
+  double eps = 0.0;
+  for (auto [scaled, shift] : {std::make_pair(addOp.getLhs(), addOp.getRhs()),
+                               std::make_pair(addOp.getRhs(), addOp.getLhs())}) {
+    centered = var = gamma = Value();
+    if (matchNormalizedAndScaled(scaled, body, centered, var, gamma, eps)) {
+      beta = shift;
+      break;
+    }
+  }
+  auto subOp =
+      centered ? getBodyOp<arith::SubFOp>(centered, body) : arith::SubFOp();
+  if (!beta || !subOp)
+    return false;
+
+  OpOperand *xOperand = getInputOperand(linalgOp, subOp.getLhs());
+  OpOperand *meanOperand = getInputOperand(linalgOp, subOp.getRhs());
+  OpOperand *varOperand = getInputOperand(linalgOp, var);
+  OpOperand *gammaOperand = getInputOperand(linalgOp, gamma);
+  OpOperand *betaOperand = getInputOperand(linalgOp, beta);
+  if (!xOperand || !meanOperand || !varOperand || !gammaOperand ||
+      !betaOperand)
+    return false;
+  // Each input plays a single role.
+  llvm::SmallPtrSet<OpOperand *, 5> roles = {
+      xOperand, meanOperand, varOperand, gammaOperand, betaOperand};
+  if (roles.size() != 5)
+    return false;
+  if (!linalgOp.getMatchingIndexingMap(xOperand).isIdentity() ||
+      !isRowMap(linalgOp.getMatchingIndexingMap(meanOperand)) ||
+      !isRowMap(linalgOp.getMatchingIndexingMap(varOperand)) ||
+      !isColMap(linalgOp.getMatchingIndexingMap(gammaOperand)) ||
+      !isColMap(linalgOp.getMatchingIndexingMap(betaOperand)))
+    return false;
+
+  if (operands) {
+    operands->push_back(xOperand->get());
+    operands->push_back(meanOperand->get());
+    operands->push_back(varOperand->get());
+    operands->push_back(gammaOperand->get());
+    operands->push_back(betaOperand->get());
+    operands->push_back(linalgOp.getDpsInits()[0]);
+  }
+  if (epsilon)
+    *epsilon = eps;
+  return true;
+}
+
+bool isTwoDRmsNormOp(linalg::LinalgOp linalgOp,
+                     SmallVectorImpl<Value> *operands, double *epsilon) {
+  if (!isTwoDNormRoot(linalgOp, /*numInputs=*/3))
+    return false;
+
+  // out = x * rsqrt(mean(x * x) + eps) * gamma
+  Block *body = linalgOp.getBlock();
+  Value x, meanSquare, gamma;
+  double eps = 0.0;
+  if (!matchNormalizedAndScaled(body->getTerminator()->getOperand(0), body, x,
+                                meanSquare, gamma, eps))
+    return false;
+
+  OpOperand *xOperand = getInputOperand(linalgOp, x);
+  OpOperand *msOperand = getInputOperand(linalgOp, meanSquare);
+  OpOperand *gammaOperand = getInputOperand(linalgOp, gamma);
+  if (!xOperand || !msOperand || !gammaOperand)
+    return false;
+  // x and gamma are interchangeable factors, tell them apart by their maps.
+  if (isColMap(linalgOp.getMatchingIndexingMap(xOperand)))
+    std::swap(xOperand, gammaOperand);
+  llvm::SmallPtrSet<OpOperand *, 3> roles = {xOperand, msOperand,
+                                             gammaOperand};
+  if (roles.size() != 3)
+    return false;
+  if (!linalgOp.getMatchingIndexingMap(xOperand).isIdentity() ||
+      !isRowMap(linalgOp.getMatchingIndexingMap(msOperand)) ||
+      !isColMap(linalgOp.getMatchingIndexingMap(gammaOperand)))
+    return false;
+
+  if (operands) {
+    operands->push_back(xOperand->get());
+    operands->push_back(msOperand->get());
+    operands->push_back(gammaOperand->get());
+    operands->push_back(linalgOp.getDpsInits()[0]);
+  }
+  if (epsilon)
+    *epsilon = eps;
+  return true;
+}
+
 // Return true if the linalg.generic can be mapped to a tpp.identity.
 bool isTwoDIdentityOp(linalg::LinalgOp linalgOp,
                       SmallVectorImpl<Value> *operands) {
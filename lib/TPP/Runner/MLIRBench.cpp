@@ -46,6 +46,7 @@
 #include "TPP/Transforms/Utils/TensorInit.h"
 #include "TPP/Transforms/Utils/TensorInitFloat.h"
 #include "TPP/Transforms/Utils/TensorInitInt.h"
+#include "TPP/Transforms/Utils/TransformUtils.h"
 #include "mlir/Transforms/Passes.h"
 
 #include <algorithm>
@@ -59,6 +60,7 @@ MLIRBench::MLIRBench(mlir::Operation *op, const MLIRBenchConfig &config)
   backend = config.backend;
   initType = config.initType;
   offloadToDevice = config.offloadToDevice;
+  blockedAbi = config.blockedAbi;
 
   module = dyn_cast<ModuleOp>(op);
   assert(module && "expected a 'builtin.Module' op");
@@ -213,6 +215,13 @@ LogicalResult MLIRBench::createKernelArgs() {
   // Clear current args and rebuild them from scratch
   kernelArgs.clear();
 
+  // Request the blocked layout ABI. The kernel signature is rewritten once
+  // the compiler picks the blocked layouts, and the packing of the arguments
+  // created below is moved right after their creation, outside of the
+  // benchmarking loops.
+  if (blockedAbi)
+    kernel->setAttr(linalgx::utils::kBlockedAbi, builder.getUnitAttr());
+
   // Create global dense memrefs (Module insertion point)
   auto &mainBody = getMainBlock();
   builder.setInsertionPointToStart(&mainBody);
@@ -21,6 +21,7 @@
 
 #include "TPP/Dialect/Perf/PerfDialect.h"
 #include "TPP/Runner/MLIRBench.h"
+#include "TPP/Transforms/Transforms.h"
 #include "TPP/Transforms/Utils/TensorInit.h"
 #include "TPP/Transforms/Utils/TensorInitFloat.h"
 #include "TPP/Transforms/Utils/TensorInitInt.h"
@@ -56,7 +57,8 @@ struct TppRunnerWrapper
     }
 
     // Benchmark object.
-    MLIRBenchConfig config(seed, tensorInitType, backend, offloadToDevice);
+    MLIRBenchConfig config(seed, tensorInitType, backend, offloadToDevice,
+                           blockedAbi);
     MLIRBench bench(module, config);
 
     // Can only either print or run benchmarks, make this clear before we try to
@@ -76,8 +78,25 @@ struct TppRunnerWrapper
       return;
     }
 
-    if (failed(bench.findKernel(kernelName))) {
-      (void)bench.emitError("Cannot find kernel '" + kernelName + "'");
+    // Benchmark the static version of the kernel for the requested bucket.
+    std::string name = kernelName;
+    if (shapeBucket > 0) {
+      auto func = module.lookupSymbol<func::FuncOp>(kernelName);
+      IRRewriter rewriter(module.getContext());
+      FailureOr<func::FuncOp> version =
+          func ? tpp::createShapeBucketVersion(rewriter, func, shapeBucket)
+               : FailureOr<func::FuncOp>(failure());
+      if (failed(version)) {
+        (void)bench.emitError("Cannot specialize kernel '" + kernelName +
+                              "' for shape bucket " +
+                              std::to_string(shapeBucket));
+        return;
+      }
+      name = version->getSymName().str();
+    }
+
+    if (failed(bench.findKernel(name))) {
+      (void)bench.emitError("Cannot find kernel '" + name + "'");
       return;
     }
 
@@ -0,0 +1,332 @@
+//===- BlockedLayoutABI.cpp --------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the blocked layout ABI: kernel arguments and results
+// that are only packed/unpacked at the function boundary are passed directly
+// in the blocked layout, and the conversions move to the callers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Passes.h"
+#include "TPP/Transforms/Utils/TransformUtils.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/Support/Debug.h"
+
+using namespace mlir;
+
+#define DEBUG_TYPE "blocked-layout-abi"
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_BLOCKEDLAYOUTABI
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+namespace {
+
+// Layout of a single pack/unpack.
+struct PackLayout {
+  SmallVector<int64_t> innerDimsPos;
+  SmallVector<int64_t> innerTiles;
+  SmallVector<int64_t> outerDimsPerm;
+};
+
+// Blocked layout of a converted argument or result. Arguments can go through
+// a chain of packs (e.g., blocking followed by VNNI), results through a single
+// unpack.
+struct BlockedLayout {
+  RankedTensorType plainType;
+  SmallVector<PackLayout> packs;
+};
+
+template <typename OpTy> static PackLayout getPackLayout(OpTy packingOp) {
+  static_assert(llvm::is_one_of<OpTy, tensor::PackOp, tensor::UnPackOp>::value,
+                "applies to only pack or unpack operations");
+  PackLayout layout;
+  layout.innerDimsPos = llvm::to_vector(packingOp.getInnerDimsPos());
+  layout.innerTiles = llvm::to_vector(packingOp.getStaticInnerTiles());
+  layout.outerDimsPerm = llvm::to_vector(packingOp.getOuterDimsPerm());
+  return layout;
+}
+
+static DictionaryAttr getPackLayoutAttr(Builder &builder,
+                                        const PackLayout &layout) {
+  SmallVector<NamedAttribute> attrs;
+  attrs.push_back(builder.getNamedAttr(
+      "inner_dims_pos", builder.getDenseI64ArrayAttr(layout.innerDimsPos)));
+  attrs.push_back(builder.getNamedAttr(
+      "inner_tiles", builder.getDenseI64ArrayAttr(layout.innerTiles)));
+  attrs.push_back(builder.getNamedAttr(
+      "outer_dims_perm", builder.getDenseI64ArrayAttr(layout.outerDimsPerm)));
+  return builder.getDictionaryAttr(attrs);
+}
+
+static Attribute getLayoutAttr(Builder &builder, const BlockedLayout &layout) {
+  if (layout.packs.size() == 1)
+    return getPackLayoutAttr(builder, layout.packs.front());
+  SmallVector<Attribute> packs;
+  for (const PackLayout &pack : layout.packs)
+    packs.push_back(getPackLayoutAttr(builder, pack));
+  return builder.getArrayAttr(packs);
+}
+
+static bool isStaticPack(tensor::PackOp packOp) {
+  return !packOp.getPaddingValue() && packOp.getSourceType().hasStaticShape() &&
+         packOp.getDestType().hasStaticShape();
+}
+
+// Collect in `packs` the chain of packs converting `arg` to the blocked
+// layout, if each pack is the only user of the value it packs.
+static bool getBoundaryPacks(BlockArgument arg,
+                             SmallVectorImpl<tensor::PackOp> &packs) {
+  if (!isa<RankedTensorType>(arg.getType()))
+    return false;
+  Value current = arg;
+  while (current.hasOneUse()) {
+    auto packOp = dyn_cast<tensor::PackOp>(*current.getUsers().begin());
+    if (!packOp || packOp.getSource() != current || !isStaticPack(packOp))
+      break;
+    packs.push_back(packOp);
+    current = packOp.getResult();
+  }
+  return !packs.empty();
+}
+
+// Return the unpack converting `result` back from the blocked layout if the
+// return is its only user.
+static tensor::UnPackOp getBoundaryUnPack(Value result) {
+  auto unPackOp = result.getDefiningOp<tensor::UnPackOp>();
+  if (!unPackOp || !result.hasOneUse())
+    return nullptr;
+  if (!unPackOp.getSourceType().hasStaticShape() ||
+      !unPackOp.getDestType().hasStaticShape()) {
+    return nullptr;
+  }
+  return unPackOp;
+}
+
+static Value createPack(OpBuilder &builder, Location loc, Value source,
+                        const PackLayout &pack) {
+  SmallVector<OpFoldResult> tiles =
+      getAsIndexOpFoldResult(builder.getContext(), pack.innerTiles);
+  Value dest = tensor::PackOp::createDestinationTensor(
+      builder, loc, source, tiles, pack.innerDimsPos, pack.outerDimsPerm);
+  return builder.create<tensor::PackOp>(loc, source, dest, pack.innerDimsPos,
+                                        tiles, /*paddingValue=*/std::nullopt,
+                                        pack.outerDimsPerm);
+}
+
+// Carry `blocked`, the blocked version of `plain`, through the loops that only
+// pass `plain` to their next iteration, so that it is unpacked once after the
+// outermost of them instead of in every iteration. Return the blocked value to
+// unpack and set `plain` to the value it replaces.
+static Value carryBlockedThroughLoops(OpBuilder &builder, Location loc,
+                                      Value &plain, Value blocked,
+                                      const PackLayout &pack) {
+  while (plain.hasOneUse()) {
+    OpOperand &use = *plain.getUses().begin();
+    if (!isa<scf::YieldOp>(use.getOwner()))
+      break;
+    auto forOp = dyn_cast<scf::ForOp>(use.getOwner()->getParentOp());
+    if (!forOp)
+      break;
+    unsigned idx = use.getOperandNumber();
+    BlockArgument iterArg = forOp.getRegionIterArgs()[idx];
+    if (!iterArg.use_empty())
+      break;
+
+    OpBuilder::InsertionGuard guard(builder);
+    builder.setInsertionPoint(forOp);
+    OpOperand &init = forOp.getInitArgsMutable()[idx];
+    init.set(createPack(builder, loc, init.get(), pack));
+    iterArg.setType(blocked.getType());
+    use.set(blocked);
+    plain = forOp.getResult(idx);
+    plain.setType(blocked.getType());
+    blocked = plain;
+  }
+  return blocked;
+}
+
+// Convert the operands and results of `callOp` to match the blocked signature
+// of its callee. The packs are created right after the operand definitions and
+// the unpacks after the loops carrying the results, so that they are not
+// repeated if the call sits in a loop. Unused results are not unpacked at all.
+static void updateCallSite(func::CallOp callOp, func::FuncOp callee,
+                           ArrayRef<std::optional<BlockedLayout>> argLayouts,
+                           ArrayRef<std::optional<BlockedLayout>> resLayouts) {
+  OpBuilder builder(callOp);
+  Location loc = callOp.getLoc();
+
+  SmallVector<Value> operands = llvm::to_vector(callOp.getOperands());
+  for (auto [idx, layout] : llvm::enumerate(argLayouts)) {
+    if (!layout)
+      continue;
+    OpBuilder::InsertionGuard guard(builder);
+    builder.setInsertionPointAfterValue(operands[idx]);
+    for (const PackLayout &pack : layout->packs)
+      operands[idx] = createPack(builder, loc, operands[idx], pack);
+  }
+
+  auto newCallOp = builder.create<func::CallOp>(loc, callee, operands);
+  for (auto [idx, layout] : llvm::enumerate(resLayouts)) {
+    Value plain = callOp.getResult(idx);
+    Value result = newCallOp.getResult(idx);
+    if (!layout || plain.use_empty()) {
+      plain.replaceAllUsesWith(result);
+      continue;
+    }
+    const PackLayout &unpack = layout->packs.front();
+    Value blocked =
+        carryBlockedThroughLoops(builder, loc, plain, result, unpack);
+
+    OpBuilder::InsertionGuard guard(builder);
+    builder.setInsertionPointAfterValue(blocked);
+    SmallVector<OpFoldResult> tiles =
+        getAsIndexOpFoldResult(builder.getContext(), unpack.innerTiles);
+    Value dest = builder.create<tensor::EmptyOp>(
+        loc, layout->plainType.getShape(), layout->plainType.getElementType());
+    auto unPackOp = builder.create<tensor::UnPackOp>(
+        loc, blocked, dest, unpack.innerDimsPos, tiles, unpack.outerDimsPerm);
+    plain.replaceAllUsesExcept(unPackOp.getResult(), unPackOp);
+  }
+  callOp.erase();
+}
+
+// Rewrite the signature of `func` to accept and return blocked tensors. If
+// `onlyPrepacked` is set, only arguments marked as prepacked are converted.
+// Return true if the signature changed.
+static bool convertToBlockedABI(func::FuncOp func, ModuleOp module,
+                                bool onlyPrepacked) {
+  if (func.isExternal() || !func.getBody().hasOneBlock())
+    return false;
+  auto returnOp =
+      dyn_cast<func::ReturnOp>(func.getBody().front().getTerminator());
+  if (!returnOp)
+    return false;
+
+  OpBuilder builder(func.getContext());
+  SmallVector<std::optional<BlockedLayout>> argLayouts(func.getNumArguments());
+  SmallVector<std::optional<BlockedLayout>> resLayouts(func.getNumResults());
+
+  // Step 1. Return results in the blocked layout. This runs first as the
+  // unpack usually writes into an argument, which is packed as well. Prepacked
+  // inputs do not change the results.
+  for (OpOperand &operand : returnOp->getOpOperands()) {
+    tensor::UnPackOp unPackOp =
+        onlyPrepacked ? nullptr : getBoundaryUnPack(operand.get());
+    if (!unPackOp)
+      continue;
+    resLayouts[operand.getOperandNumber()] =
+        BlockedLayout{unPackOp.getDestType(), {getPackLayout(unPackOp)}};
+    operand.set(unPackOp.getSource());
+    unPackOp.erase();
+  }
+
+  // Step 2. Pass arguments in the blocked layout.
+  for (BlockArgument arg : func.getArguments()) {
+    if (onlyPrepacked &&
+        !func.getArgAttr(arg.getArgNumber(), linalgx::utils::kPrepacked)) {
+      continue;
+    }
+    SmallVector<tensor::PackOp> packs;
+    if (!getBoundaryPacks(arg, packs))
+      continue;
+    BlockedLayout layout{cast<RankedTensorType>(arg.getType()), {}};
+    for (tensor::PackOp packOp : packs)
+      layout.packs.push_back(getPackLayout(packOp));
+    argLayouts[arg.getArgNumber()] = layout;
+
+    arg.setType(packs.back().getDestType());
+    packs.back().getResult().replaceAllUsesWith(arg);
+    for (tensor::PackOp packOp : llvm::reverse(packs)) {
+      Value dest = packOp.getDest();
+      packOp.erase();
+      if (auto emptyOp = dest.getDefiningOp<tensor::EmptyOp>()) {
+        if (emptyOp->use_empty())
+          emptyOp.erase();
+      }
+    }
+  }
+
+  auto isBlocked = [](const std::optional<BlockedLayout> &layout) {
+    return layout.has_value();
+  };
+  if (llvm::none_of(argLayouts, isBlocked) &&
+      llvm::none_of(resLayouts, isBlocked)) {
+    return false;
+  }
+
+  // Step 3. Update the function type and record the layouts.
+  func.setType(builder.getFunctionType(func.getBody().getArgumentTypes(),
+                                       returnOp.getOperandTypes()));
+  for (auto [idx, layout] : llvm::enumerate(argLayouts)) {
+    if (layout) {
+      func.setArgAttr(idx, linalgx::utils::kBlockedLayout,
+                      getLayoutAttr(builder, *layout));
+    }
+  }
+  for (auto [idx, layout] : llvm::enumerate(resLayouts)) {
+    if (layout) {
+      func.setResultAttr(idx, linalgx::utils::kBlockedLayout,
+                         getLayoutAttr(builder, *layout));
+    }
+  }
+  LLVM_DEBUG(llvm::dbgs() << "Blocked ABI for: " << func.getSymName() << "\n");
+
+  // Step 4. Move the conversions to the callers.
+  std::optional<SymbolTable::UseRange> uses = func.getSymbolUses(module);
+  if (!uses)
+    return true;
+  SmallVector<func::CallOp> callOps;
+  for (const SymbolTable::SymbolUse &use : *uses) {
+    if (auto callOp = dyn_cast<func::CallOp>(use.getUser()))
+      callOps.push_back(callOp);
+  }
+  for (func::CallOp callOp : callOps)
+    updateCallSite(callOp, func, argLayouts, resLayouts);
+  return true;
+}
+
+static bool hasPrepackedArgs(func::FuncOp func) {
+  for (unsigned idx = 0, e = func.getNumArguments(); idx < e; ++idx) {
+    if (func.getArgAttr(idx, linalgx::utils::kPrepacked))
+      return true;
+  }
+  return false;
+}
+
+struct BlockedLayoutABI
+    : public tpp::impl::BlockedLayoutABIBase<BlockedLayoutABI> {
+  using BlockedLayoutABIBase::BlockedLayoutABIBase;
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SmallVector<std::pair<func::FuncOp, bool>> funcs;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      bool isPublic = func.isPublic() && !func.isExternal();
+      if (func->hasAttr(linalgx::utils::kBlockedAbi) ||
+          (allPublicFunctions && isPublic)) {
+        funcs.emplace_back(func, /*onlyPrepacked=*/false);
+      } else if (hasPrepackedArgs(func)) {
+        funcs.emplace_back(func, /*onlyPrepacked=*/true);
+      }
+    }
+    for (auto [func, onlyPrepacked] : funcs)
+      (void)convertToBlockedABI(func, module, onlyPrepacked);
+  }
+};
+
+} // namespace
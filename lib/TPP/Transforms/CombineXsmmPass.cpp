@@ -37,6 +37,11 @@ struct CombineXsmmOp : public OpRewritePattern<xsmm::BrgemmOp> {
     auto *output = brgemmOp.getOperand(3).getDefiningOp();
     if (!output)
       return failure();
+    // The fused dispatch does not take a runtime m.
+    auto brgemmDispatchOp = dyn_cast_or_null<xsmm::BrgemmDispatchOp>(
+        brgemmOp.getOperand(0).getDefiningOp());
+    if (!brgemmDispatchOp || brgemmDispatchOp.getDynamicM())
+      return failure();
 
     // First, match the required fused ops
     auto result = xsmm::utils::getFusedBrgemmSequenceFromProducer(output);
@@ -46,11 +51,16 @@ struct CombineXsmmOp : public OpRewritePattern<xsmm::BrgemmOp> {
     // TODO: Support BRGEMM + BINARY && BRGEMM + UNARY patterns
     if (!fusedMatch.binaryOp || !fusedMatch.unaryOp)
       return failure();
+    // Activations libxsmm cannot apply on the GEMM output (e.g. gelu, tanh)
+    // stay as a separate unary after the fused brgemm + bias.
+    bool fuseUnary = xsmm::utils::isFusableUnaryKind(fusedMatch.unaryKind);
+    xsmm::UnaryKind unaryKind =
+        fuseUnary ? fusedMatch.unaryKind : xsmm::UnaryKind::NONE;
     // Validate broadcast flags
     auto unaryFlags =
         xsmm::utils::getUnaryFlags(fusedMatch.unaryOp.getOperand(0).getType(),
                                    fusedMatch.unaryOp.getOperand(2).getType());
-    if (unaryFlags != mlir::xsmm::UnaryFlags::BCAST_SCALAR &&
+    if (fuseUnary && unaryFlags != mlir::xsmm::UnaryFlags::BCAST_SCALAR &&
         unaryFlags != mlir::xsmm::UnaryFlags::NONE)
       return failure();
 
@@ -104,7 +114,7 @@ struct CombineXsmmOp : public OpRewritePattern<xsmm::BrgemmOp> {
     Value dispatched = rewriter.create<xsmm::FusedBrgemmDispatchOp>(
         loc, integer64, dims,
         xsmm::BinaryKindAttr::get(rewriter.getContext(), fusedMatch.binaryKind),
-        xsmm::UnaryKindAttr::get(rewriter.getContext(), fusedMatch.unaryKind),
+        xsmm::UnaryKindAttr::get(rewriter.getContext(), unaryKind),
         rewriter.getArrayAttr(attributes),
         rewriter.getArrayAttr(xsmm::UnaryFlagsAttr::get(
             rewriter.getContext(), xsmm::UnaryFlags::NONE)),
@@ -132,7 +142,7 @@ struct CombineXsmmOp : public OpRewritePattern<xsmm::BrgemmOp> {
       rewriter.eraseOp(fusedMatch.binaryOp);
       rewriter.eraseOp(fusedMatch.binaryOp->getOperand(0).getDefiningOp());
     }
-    if (fusedMatch.unaryOp) {
+    if (fusedMatch.unaryOp && fuseUnary) {
       rewriter.eraseOp(fusedMatch.unaryOp);
       rewriter.eraseOp(fusedMatch.unaryOp->getOperand(0).getDefiningOp());
     }
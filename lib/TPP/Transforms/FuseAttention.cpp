@@ -0,0 +1,370 @@
+//===- FuseAttention.cpp -----------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the fusion of attention, softmax(Q x K^T) x V, into a
+// single tiled loop nest with an online softmax (flash attention).
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Passes.h"
+#include "TPP/Transforms/Utils/ValueUtils.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/PatternMatch.h"
+#include "llvm/Support/Debug.h"
+
+using namespace mlir;
+
+#define DEBUG_TYPE "fuse-attention"
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_FUSEATTENTION
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+namespace {
+
+// The three stages of an attention head:
+// S = Q x K^T, P = softmax(S) and O = P x V.
+struct AttentionOps {
+  linalg::LinalgOp queryTimesKey;
+  linalg::SoftmaxOp softmax;
+  linalg::LinalgOp softmaxTimesValue;
+};
+
+} // namespace
+
+// Match the attention chain ending with `softmax`. Both contractions must
+// start from zero and all the intermediate values must have a single use.
+static FailureOr<AttentionOps> matchAttention(linalg::SoftmaxOp softmax) {
+  auto outputType = cast<ShapedType>(softmax.getOutput().getType());
+  if (!isa<RankedTensorType>(outputType) || !outputType.hasStaticShape() ||
+      !isa<FloatType>(outputType.getElementType())) {
+    return failure();
+  }
+  int64_t rank = outputType.getRank();
+  if ((rank != 2 && rank != 3) ||
+      softmax.getDimension() != static_cast<uint64_t>(rank - 1)) {
+    return failure();
+  }
+
+  auto queryTimesKey = softmax.getInput().getDefiningOp<linalg::LinalgOp>();
+  if (!queryTimesKey ||
+      !isa<linalg::MatmulTransposeBOp, linalg::BatchMatmulTransposeBOp>(
+          queryTimesKey.getOperation()) ||
+      !queryTimesKey->hasOneUse() ||
+      !utils::isZeroTensor(queryTimesKey.getDpsInits()[0])) {
+    return failure();
+  }
+
+  if (!softmax->hasOneUse())
+    return failure();
+  auto softmaxTimesValue =
+      dyn_cast<linalg::LinalgOp>(*softmax->getUsers().begin());
+  if (!softmaxTimesValue ||
+      !isa<linalg::MatmulOp, linalg::BatchMatmulOp>(
+          softmaxTimesValue.getOperation()) ||
+      softmaxTimesValue.getDpsInputs()[0] != softmax->getResult(0) ||
+      !utils::isZeroTensor(softmaxTimesValue.getDpsInits()[0]) ||
+      !softmaxTimesValue.hasPureTensorSemantics()) {
+    return failure();
+  }
+
+  for (Value operand : llvm::concat<Value>(queryTimesKey->getOperands(),
+                                           softmaxTimesValue->getOperands())) {
+    auto type = dyn_cast<RankedTensorType>(operand.getType());
+    if (!type || !type.hasStaticShape() ||
+        type.getElementType() != outputType.getElementType()) {
+      return failure();
+    }
+  }
+
+  // Each head of softmax x V must use the values of the head of Q x K^T.
+  if (rank == 3) {
+    int64_t batch = outputType.getShape().front();
+    for (Value operand : llvm::concat<Value>(
+             queryTimesKey->getOperands(), softmaxTimesValue->getOperands())) {
+      if (cast<RankedTensorType>(operand.getType()).getShape().front() !=
+          batch) {
+        return failure();
+      }
+    }
+  }
+  return AttentionOps{queryTimesKey, softmax, softmaxTimesValue};
+}
+
+// Return a tensor of `shape` filled with `value`.
+static Value createFilledTensor(OpBuilder &builder, Location loc,
+                                ArrayRef<int64_t> shape, TypedAttr value) {
+  Value empty = builder.create<tensor::EmptyOp>(loc, shape, value.getType());
+  Value cst = builder.create<arith::ConstantOp>(loc, value);
+  return builder.create<linalg::FillOp>(loc, cst, empty).getResult(0);
+}
+
+// Return a linalg.generic writing into `output`, whose body yields the value
+// produced by `bodyFn` from the block arguments.
+static Value
+createGeneric(OpBuilder &builder, Location loc, ValueRange inputs, Value output,
+              ArrayRef<AffineMap> maps,
+              ArrayRef<utils::IteratorType> iterators,
+              function_ref<Value(OpBuilder &, Location, ValueRange)> bodyFn) {
+  auto genericOp = builder.create<linalg::GenericOp>(
+      loc, output.getType(), inputs, output, maps, iterators,
+      [&](OpBuilder &b, Location loc, ValueRange args) {
+        b.create<linalg::YieldOp>(loc, bodyFn(b, loc, args));
+      });
+  return genericOp.getResult(0);
+}
+
+// Extract the `rows` x `cols` block at (`rowOffset`, `colOffset`) of `source`,
+// for the batch `batchIv` if the source is batched.
+static Value extractBlock(OpBuilder &builder, Location loc, Value source,
+                          Value batchIv, OpFoldResult rowOffset,
+                          OpFoldResult colOffset, int64_t rows, int64_t cols) {
+  auto sourceType = cast<RankedTensorType>(source.getType());
+  SmallVector<OpFoldResult> offsets = {rowOffset, colOffset};
+  SmallVector<OpFoldResult> sizes = {builder.getIndexAttr(rows),
+                                     builder.getIndexAttr(cols)};
+  if (batchIv) {
+    offsets.insert(offsets.begin(), batchIv);
+    sizes.insert(sizes.begin(), builder.getIndexAttr(1));
+  }
+  SmallVector<OpFoldResult> strides(sizes.size(), builder.getIndexAttr(1));
+  auto blockType =
+      RankedTensorType::get({rows, cols}, sourceType.getElementType());
+  return builder.create<tensor::ExtractSliceOp>(loc, blockType, source,
+                                                offsets, sizes, strides);
+}
+
+// Rewrite the attention chain into a scf.forall over the batch and the query
+// blocks. Each iteration walks the key blocks with a scf.for, carrying the
+// output block, the running row max and the running row sum:
+//
+//   S     = Q_i x K_j^T
+//   m'    = max(m, rowmax(S))
+//   P     = exp(S - m')
+//   alpha = exp(m - m')
+//   l'    = l * alpha + rowsum(P)
+//   O'    = O * alpha + P x V_j
+//
+// and the output block is O / l once all the key blocks are consumed. Only a
+// block of the score matrix is live at any time. K is transposed once, before
+// the loops, and the key blocks are column blocks of K^T.
+static LogicalResult fuseAttention(RewriterBase &rewriter,
+                                   AttentionOps attention, int64_t queryTile,
+                                   int64_t keyTile) {
+  Value query = attention.queryTimesKey.getDpsInputs()[0];
+  Value key = attention.queryTimesKey.getDpsInputs()[1];
+  Value value = attention.softmaxTimesValue.getDpsInputs()[1];
+  Value output = attention.softmaxTimesValue.getDpsInits()[0];
+
+  auto queryType = cast<RankedTensorType>(query.getType());
+  auto keyType = cast<RankedTensorType>(key.getType());
+  auto valueType = cast<RankedTensorType>(value.getType());
+  bool isBatched = queryType.getRank() == 3;
+  int64_t seqLenQ = queryType.getShape().drop_back().back();
+  int64_t seqLenKV = keyType.getShape().drop_back().back();
+  int64_t headDim = queryType.getShape().back();
+  int64_t valueDim = valueType.getShape().back();
+  queryTile = std::min(queryTile, seqLenQ);
+  keyTile = std::min(keyTile, seqLenKV);
+  if (seqLenQ % queryTile != 0 || seqLenKV % keyTile != 0)
+    return failure();
+
+  MLIRContext *ctx = rewriter.getContext();
+  Location loc = attention.softmaxTimesValue.getLoc();
+  auto elementType = cast<FloatType>(queryType.getElementType());
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(attention.softmaxTimesValue);
+
+  // K^T, shared by all the query blocks.
+  SmallVector<int64_t> keyTShape = {headDim, seqLenKV};
+  SmallVector<int64_t> keyTPerm = {1, 0};
+  if (isBatched) {
+    keyTShape.insert(keyTShape.begin(), keyType.getShape().front());
+    keyTPerm = {0, 2, 1};
+  }
+  Value keyT = rewriter.create<tensor::EmptyOp>(loc, keyTShape, elementType);
+  keyT = rewriter.create<linalg::TransposeOp>(loc, key, keyT, keyTPerm)
+             .getResult()[0];
+
+  // Parallel loops over the batch and the query blocks.
+  SmallVector<OpFoldResult> lbs, ubs, steps;
+  if (isBatched) {
+    lbs.push_back(rewriter.getIndexAttr(0));
+    ubs.push_back(rewriter.getIndexAttr(queryType.getShape().front()));
+    steps.push_back(rewriter.getIndexAttr(1));
+  }
+  lbs.push_back(rewriter.getIndexAttr(0));
+  ubs.push_back(rewriter.getIndexAttr(seqLenQ));
+  steps.push_back(rewriter.getIndexAttr(queryTile));
+  auto forallOp = rewriter.create<scf::ForallOp>(
+      loc, lbs, ubs, steps, ValueRange{output}, /*mapping=*/std::nullopt);
+  rewriter.setInsertionPointToStart(forallOp.getBody());
+  Value batchIv = isBatched ? forallOp.getInductionVar(0) : Value();
+  Value queryIv = forallOp.getInductionVars().back();
+  Value queryBlock =
+      extractBlock(rewriter, loc, query, batchIv, queryIv,
+                   rewriter.getIndexAttr(0), queryTile, headDim);
+
+  AffineMap identity = rewriter.getMultiDimIdentityMap(2);
+  AffineMap rowMap = AffineMap::get(2, 0, {getAffineDimExpr(0, ctx)}, ctx);
+  AffineMap vectorMap = rewriter.getMultiDimIdentityMap(1);
+  SmallVector<utils::IteratorType> parallel2D(2, utils::IteratorType::parallel);
+  SmallVector<utils::IteratorType> rowReduction = {
+      utils::IteratorType::parallel, utils::IteratorType::reduction};
+  SmallVector<utils::IteratorType> parallel1D = {utils::IteratorType::parallel};
+
+  TypedAttr zero = rewriter.getFloatAttr(elementType, 0.0);
+  TypedAttr minusInf = rewriter.getFloatAttr(
+      elementType,
+      APFloat::getInf(elementType.getFloatSemantics(), /*Negative=*/true));
+  Value initOut =
+      createFilledTensor(rewriter, loc, {queryTile, valueDim}, zero);
+  Value initMax = createFilledTensor(rewriter, loc, {queryTile}, minusInf);
+  Value initSum = createFilledTensor(rewriter, loc, {queryTile}, zero);
+
+  // Sequential loop over the key blocks.
+  Value lb = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+  Value ub = rewriter.create<arith::ConstantIndexOp>(loc, seqLenKV);
+  Value step = rewriter.create<arith::ConstantIndexOp>(loc, keyTile);
+  auto keyLoop = rewriter.create<scf::ForOp>(
+      loc, lb, ub, step, ValueRange{initOut, initMax, initSum},
+      [&](OpBuilder &b, Location loc, Value keyIv, ValueRange iterArgs) {
+        Value out = iterArgs[0];
+        Value rowMax = iterArgs[1];
+        Value rowSum = iterArgs[2];
+        Value keyTBlock = extractBlock(b, loc, keyT, batchIv,
+                                       b.getIndexAttr(0), keyIv, headDim,
+                                       keyTile);
+        Value valueBlock = extractBlock(b, loc, value, batchIv, keyIv,
+                                        b.getIndexAttr(0), keyTile, valueDim);
+
+        // S = Q_i x K_j^T
+        Value scores =
+            createFilledTensor(b, loc, {queryTile, keyTile}, zero);
+        scores = b.create<linalg::MatmulOp>(
+                      loc, ValueRange{queryBlock, keyTBlock}, scores)
+                     .getResult(0);
+
+        // m' = max(m, rowmax(S))
+        Value newMax = createGeneric(
+            b, loc, scores, rowMax, {identity, rowMap}, rowReduction,
+            [](OpBuilder &b, Location loc, ValueRange args) -> Value {
+              return b.create<arith::MaximumFOp>(loc, args[0], args[1]);
+            });
+
+        // P = exp(S - m')
+        Value probs = createGeneric(
+            b, loc, ValueRange{scores, newMax},
+            b.create<tensor::EmptyOp>(
+                loc, ArrayRef<int64_t>{queryTile, keyTile}, elementType),
+            {identity, rowMap, identity}, parallel2D,
+            [](OpBuilder &b, Location loc, ValueRange args) -> Value {
+              Value diff = b.create<arith::SubFOp>(loc, args[0], args[1]);
+              return b.create<math::ExpOp>(loc, diff);
+            });
+
+        // alpha = exp(m - m')
+        Value alpha = createGeneric(
+            b, loc, ValueRange{rowMax, newMax},
+            b.create<tensor::EmptyOp>(loc, ArrayRef<int64_t>{queryTile},
+                                      elementType),
+            {vectorMap, vectorMap, vectorMap}, parallel1D,
+            [](OpBuilder &b, Location loc, ValueRange args) -> Value {
+              Value diff = b.create<arith::SubFOp>(loc, args[0], args[1]);
+              return b.create<math::ExpOp>(loc, diff);
+            });
+
+        // l' = l * alpha + rowsum(P)
+        Value newSum = createGeneric(
+            b, loc, alpha, rowSum, {vectorMap, vectorMap}, parallel1D,
+            [](OpBuilder &b, Location loc, ValueRange args) -> Value {
+              return b.create<arith::MulFOp>(loc, args[1], args[0]);
+            });
+        newSum = createGeneric(
+            b, loc, probs, newSum, {identity, rowMap}, rowReduction,
+            [](OpBuilder &b, Location loc, ValueRange args) -> Value {
+              return b.create<arith::AddFOp>(loc, args[0], args[1]);
+            });
+
+        // O' = O * alpha + P x V_j
+        Value newOut = createGeneric(
+            b, loc, alpha, out, {rowMap, identity}, parallel2D,
+            [](OpBuilder &b, Location loc, ValueRange args) -> Value {
+              return b.create<arith::MulFOp>(loc, args[1], args[0]);
+            });
+        newOut = b.create<linalg::MatmulOp>(
+                      loc, ValueRange{probs, valueBlock}, newOut)
+                     .getResult(0);
+        b.create<scf::YieldOp>(loc, ValueRange{newOut, newMax, newSum});
+      });
+
+  // O = O / l
+  Value outBlock = createGeneric(
+      rewriter, loc, keyLoop.getResult(2), keyLoop.getResult(0),
+      {rowMap, identity}, parallel2D,
+      [](OpBuilder &b, Location loc, ValueRange args) -> Value {
+        return b.create<arith::DivFOp>(loc, args[1], args[0]);
+      });
+
+  // Write the output block back.
+  SmallVector<OpFoldResult> offsets = {queryIv, rewriter.getIndexAttr(0)};
+  SmallVector<OpFoldResult> sizes = {rewriter.getIndexAttr(queryTile),
+                                     rewriter.getIndexAttr(valueDim)};
+  if (isBatched) {
+    offsets.insert(offsets.begin(), batchIv);
+    sizes.insert(sizes.begin(), rewriter.getIndexAttr(1));
+  }
+  SmallVector<OpFoldResult> strides(sizes.size(), rewriter.getIndexAttr(1));
+  rewriter.setInsertionPointToStart(forallOp.getTerminator().getBody());
+  rewriter.create<tensor::ParallelInsertSliceOp>(
+      loc, outBlock, forallOp.getRegionIterArgs()[0], offsets, sizes, strides);
+
+  rewriter.replaceOp(attention.softmaxTimesValue.getOperation(),
+                     forallOp.getResults());
+  rewriter.eraseOp(attention.softmax);
+  rewriter.eraseOp(attention.queryTimesKey.getOperation());
+  LLVM_DEBUG(llvm::dbgs() << "Fused attention: " << forallOp << "\n");
+  return success();
+}
+
+namespace {
+
+struct FuseAttention : public tpp::impl::FuseAttentionBase<FuseAttention> {
+  using FuseAttentionBase::FuseAttentionBase;
+
+  void runOnOperation() override {
+    SmallVector<int64_t> tiles = llvm::to_vector(tileSizes);
+    if (tiles.empty())
+      tiles = {32, 32};
+    if (tiles.size() != 2 || tiles[0] <= 0 || tiles[1] <= 0) {
+      getOperation().emitError("expect two positive tile sizes");
+      return signalPassFailure();
+    }
+
+    SmallVector<AttentionOps> candidates;
+    getOperation()->walk([&](linalg::SoftmaxOp softmax) {
+      FailureOr<AttentionOps> attention = matchAttention(softmax);
+      if (succeeded(attention))
+        candidates.push_back(*attention);
+    });
+
+    IRRewriter rewriter(&getContext());
+    for (AttentionOps attention : candidates)
+      (void)fuseAttention(rewriter, attention, tiles[0], tiles[1]);
+  }
+};
+
+} // namespace
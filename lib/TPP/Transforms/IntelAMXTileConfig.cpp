@@ -38,6 +38,15 @@ struct IntelAMXTileConfig : OpRewritePattern<InvokeOpTy> {
     if (xsmm::utils::getDataType(rewriter, op.getOperand(1).getType()) !=
         xsmm::DataTypeAttr::get(rewriter.getContext(), xsmm::DataType::BF16))
       return failure();
+    // The tile configuration is dispatched for a static m only.
+    auto dispatchOp =
+        dyn_cast_or_null<DispatchOpTy>(op.getOperand(0).getDefiningOp());
+    if (!dispatchOp)
+      return failure();
+    if constexpr (std::is_same_v<DispatchOpTy, xsmm::BrgemmDispatchOp>) {
+      if (dispatchOp.getDynamicM())
+        return failure();
+    }
     auto flags =
         dyn_cast<DispatchOpTy>(op.getOperand(0).getDefiningOp()).getFlags();
     for (auto flagItr : flags)
@@ -0,0 +1,556 @@
+//===- LayoutAssignment.cpp --------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a function-wide layout assignment that picks a single
+// layout for the values connected by element-wise operations, keeping them in
+// blocked layout between packed contractions. Conversions are only left where
+// a value enters or leaves the blocked region.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Passes.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/PatternMatch.h"
+#include "llvm/Support/Debug.h"
+
+using namespace mlir;
+
+#define DEBUG_TYPE "layout-assignment"
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_LAYOUTASSIGNMENT
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+namespace {
+
+// Blocked layout of a value, as described by the tensor.pack producing it.
+// Only layouts without an outer dimensions permutation are assigned.
+struct BlockedLayout {
+  SmallVector<int64_t> innerDimsPos;
+  SmallVector<int64_t> innerTiles;
+
+  bool operator==(const BlockedLayout &other) const {
+    return innerDimsPos == other.innerDimsPos &&
+           innerTiles == other.innerTiles;
+  }
+};
+
+static std::optional<BlockedLayout>
+getBlockedLayout(ArrayRef<int64_t> innerDimsPos, ArrayRef<int64_t> innerTiles,
+                 ArrayRef<int64_t> outerDimsPerm) {
+  if (!outerDimsPerm.empty() &&
+      !llvm::equal(outerDimsPerm,
+                   llvm::seq<int64_t>(0, outerDimsPerm.size())))
+    return std::nullopt;
+  if (ShapedType::isDynamicShape(innerTiles))
+    return std::nullopt;
+  return BlockedLayout{llvm::to_vector(innerDimsPos),
+                       llvm::to_vector(innerTiles)};
+}
+
+static std::optional<BlockedLayout> getBlockedLayout(tensor::PackOp packOp) {
+  if (packOp.getPaddingValue())
+    return std::nullopt;
+  return getBlockedLayout(packOp.getInnerDimsPos(),
+                          packOp.getStaticInnerTiles(),
+                          packOp.getOuterDimsPerm());
+}
+
+static std::optional<BlockedLayout>
+getBlockedLayout(tensor::UnPackOp unPackOp) {
+  return getBlockedLayout(unPackOp.getInnerDimsPos(),
+                          unPackOp.getStaticInnerTiles(),
+                          unPackOp.getOuterDimsPerm());
+}
+
+// Return true if `type` is a static tensor that `layout` tiles exactly.
+static bool isTiledBy(Type type, ArrayRef<int64_t> innerDimsPos,
+                      ArrayRef<int64_t> innerTiles) {
+  auto tensorType = dyn_cast<RankedTensorType>(type);
+  if (!tensorType || !tensorType.hasStaticShape())
+    return false;
+  for (auto [dim, tile] : llvm::zip(innerDimsPos, innerTiles)) {
+    if (dim >= tensorType.getRank() || tile <= 0 ||
+        tensorType.getDimSize(dim) % tile != 0)
+      return false;
+  }
+  return true;
+}
+
+// Return true if `genericOp` is an element-wise operation whose iteration
+// space is the shape of its result, such that it can run in the blocked
+// layout of its result. Other operands can be broadcasted.
+static bool isElementwise(linalg::GenericOp genericOp) {
+  if (!genericOp.hasPureTensorSemantics() || genericOp->getNumResults() != 1 ||
+      genericOp.getNumDpsInits() != 1 || genericOp.hasIndexSemantics())
+    return false;
+  if (genericOp.getNumLoops() != genericOp.getNumParallelLoops())
+    return false;
+  OpOperand *init = genericOp.getDpsInitOperand(0);
+  if (!genericOp.getMatchingIndexingMap(init).isIdentity())
+    return false;
+  return llvm::all_of(genericOp.getIndexingMapsArray(), [](AffineMap map) {
+    return map.isProjectedPermutation();
+  });
+}
+
+// Return true if `operand` has the shape and layout of the result of the
+// element-wise `genericOp`.
+static bool isFullOperand(linalg::GenericOp genericOp, OpOperand &operand) {
+  return operand.get().getType() == genericOp->getResult(0).getType() &&
+         genericOp.getMatchingIndexingMap(&operand).isIdentity();
+}
+
+// Pack layout of an operand of an element-wise op accessed through `map`,
+// when the iteration space is blocked with `layout`.
+static void getOperandLayout(AffineMap map, const BlockedLayout &layout,
+                             SmallVectorImpl<int64_t> &innerDimsPos,
+                             SmallVectorImpl<int64_t> &innerTiles) {
+  for (auto [dim, tile] : llvm::zip(layout.innerDimsPos, layout.innerTiles)) {
+    std::optional<unsigned> pos =
+        map.getResultPosition(getAffineDimExpr(dim, map.getContext()));
+    if (!pos)
+      continue;
+    innerDimsPos.push_back(*pos);
+    innerTiles.push_back(tile);
+  }
+}
+
+// Indexing map of an operand accessed through `map` in the iteration space
+// blocked with `layout`. The outer dimensions keep the original loops, the
+// tiles of the blocked dimensions come last.
+static AffineMap getBlockedMap(AffineMap map, const BlockedLayout &layout) {
+  MLIRContext *ctx = map.getContext();
+  unsigned numLoops = map.getNumDims();
+  SmallVector<AffineExpr> results(map.getResults().begin(),
+                                  map.getResults().end());
+  for (auto [idx, dim] : llvm::enumerate(layout.innerDimsPos)) {
+    if (map.getResultPosition(getAffineDimExpr(dim, ctx)))
+      results.push_back(getAffineDimExpr(numLoops + idx, ctx));
+  }
+  return AffineMap::get(numLoops + layout.innerDimsPos.size(), 0, results,
+                        ctx);
+}
+
+static Value createPack(OpBuilder &builder, Location loc, Value source,
+                        ArrayRef<int64_t> innerDimsPos,
+                        ArrayRef<int64_t> innerTiles) {
+  SmallVector<OpFoldResult> tiles =
+      getAsIndexOpFoldResult(builder.getContext(), innerTiles);
+  Value dest = tensor::PackOp::createDestinationTensor(
+      builder, loc, source, tiles, innerDimsPos, /*outerDimsPerm=*/{});
+  return builder.create<tensor::PackOp>(loc, source, dest, innerDimsPos, tiles,
+                                        /*paddingValue=*/std::nullopt,
+                                        /*outerDimsPerm=*/ArrayRef<int64_t>{});
+}
+
+// Values connected by element-wise ops, which must share their layout.
+struct LayoutClass {
+  SmallVector<Value> members;
+  // Element-wise ops of the class, in program order.
+  SmallVector<linalg::GenericOp> ops;
+  // Layouts requested by the unpacks producing members and the packs
+  // consuming them.
+  SmallVector<BlockedLayout> requests;
+};
+
+// Union-find over the values of a function.
+class ValueClasses {
+public:
+  Value find(Value value) {
+    auto it = leaders.find(value);
+    if (it == leaders.end()) {
+      leaders[value] = value;
+      return value;
+    }
+    if (it->second == value)
+      return value;
+    Value leader = find(it->second);
+    leaders[value] = leader;
+    return leader;
+  }
+
+  void join(Value lhs, Value rhs) {
+    Value lhsLeader = find(lhs);
+    Value rhsLeader = find(rhs);
+    if (lhsLeader != rhsLeader)
+      leaders[rhsLeader] = lhsLeader;
+  }
+
+  bool contains(Value value) const { return leaders.count(value); }
+
+private:
+  DenseMap<Value, Value> leaders;
+};
+
+// Assign the blocked layout to the values of `layoutClass` and rewrite its
+// element-wise ops in that layout. Conversions are left only where a value
+// comes from or goes to an op that does not take the layout: function
+// arguments, results and other operations.
+class BlockedClassRewriter {
+public:
+  BlockedClassRewriter(const LayoutClass &layoutClass,
+                       const BlockedLayout &layout)
+      : layoutClass(layoutClass), layout(layout) {
+    for (linalg::GenericOp genericOp : layoutClass.ops)
+      ops.insert(genericOp);
+  }
+
+  // Return true if `value` is a member defined by an unpack from `layout`.
+  bool isUnpackedFromLayout(Value value) const {
+    auto unPackOp = value.getDefiningOp<tensor::UnPackOp>();
+    return unPackOp && getBlockedLayout(unPackOp) == layout;
+  }
+
+  bool isPackedToLayout(OpOperand &use) const {
+    auto packOp = dyn_cast<tensor::PackOp>(use.getOwner());
+    return packOp && use.getOperandNumber() == 0 &&
+           getBlockedLayout(packOp) == layout;
+  }
+
+  // Return true if `use` reads the member in the layout of the class.
+  bool isBlockedUse(OpOperand &use) const {
+    auto genericOp = dyn_cast<linalg::GenericOp>(use.getOwner());
+    if (genericOp && ops.count(genericOp))
+      return isFullOperand(genericOp, use);
+    return isPackedToLayout(use);
+  }
+
+  bool hasPlainUses(Value value) const {
+    return llvm::any_of(value.getUses(),
+                        [&](OpOperand &use) { return !isBlockedUse(use); });
+  }
+
+  // Return true if the layout can be assigned to the whole class.
+  bool isLegal() const {
+    for (Value member : layoutClass.members) {
+      if (!isTiledBy(member.getType(), layout.innerDimsPos, layout.innerTiles))
+        return false;
+    }
+    for (linalg::GenericOp genericOp : layoutClass.ops) {
+      for (OpOperand &operand : genericOp->getOpOperands()) {
+        if (!isa<ShapedType>(operand.get().getType()) ||
+            isFullOperand(genericOp, operand))
+          continue;
+        SmallVector<int64_t> innerDimsPos, innerTiles;
+        getOperandLayout(genericOp.getMatchingIndexingMap(&operand), layout,
+                         innerDimsPos, innerTiles);
+        if (!isTiledBy(operand.get().getType(), innerDimsPos, innerTiles))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // Return the number of conversions removed minus the number of
+  // conversions added by the assignment. Packs of broadcasted operands are
+  // smaller than the members and not counted.
+  int64_t getBenefit() const {
+    int64_t benefit = 0;
+    for (Value member : layoutClass.members) {
+      for (OpOperand &use : member.getUses()) {
+        if (isPackedToLayout(use))
+          benefit++;
+      }
+      if (isUnpackedFromLayout(member)) {
+        if (!hasPlainUses(member))
+          benefit++;
+        continue;
+      }
+      if (member.getDefiningOp<tensor::EmptyOp>())
+        continue;
+      auto genericOp = member.getDefiningOp<linalg::GenericOp>();
+      if (genericOp && ops.count(genericOp)) {
+        if (hasPlainUses(member))
+          benefit--;
+        continue;
+      }
+      // Packed from the plain layout.
+      benefit--;
+    }
+    return benefit;
+  }
+
+  void rewrite(RewriterBase &rewriter) {
+    for (linalg::GenericOp genericOp : layoutClass.ops)
+      rewriteOp(rewriter, genericOp);
+
+    for (Value member : layoutClass.members) {
+      for (OpOperand &use : llvm::make_early_inc_range(member.getUses())) {
+        if (isPackedToLayout(use))
+          rewriter.replaceOp(use.getOwner(), getBlocked(rewriter, member));
+      }
+    }
+
+    // The results of the rewritten ops are unpacked for the other users.
+    for (linalg::GenericOp genericOp : layoutClass.ops) {
+      Value result = genericOp->getResult(0);
+      if (!hasPlainUses(result))
+        continue;
+      Value blocked = getBlocked(rewriter, result);
+      rewriter.setInsertionPointAfterValue(blocked);
+      auto plainType = cast<RankedTensorType>(result.getType());
+      Value dest = rewriter.create<tensor::EmptyOp>(
+          result.getLoc(), plainType.getShape(), plainType.getElementType());
+      Value unpacked = rewriter.create<tensor::UnPackOp>(
+          result.getLoc(), blocked, dest, layout.innerDimsPos,
+          getAsIndexOpFoldResult(rewriter.getContext(), layout.innerTiles),
+          /*outerDimsPerm=*/ArrayRef<int64_t>{});
+      rewriter.replaceUsesWithIf(result, unpacked, [&](OpOperand &use) {
+        return !isBlockedUse(use);
+      });
+    }
+
+    for (linalg::GenericOp genericOp : llvm::reverse(layoutClass.ops))
+      rewriter.eraseOp(genericOp);
+    for (Value member : layoutClass.members) {
+      if (auto unPackOp = member.getDefiningOp<tensor::UnPackOp>();
+          unPackOp && unPackOp->use_empty())
+        rewriter.eraseOp(unPackOp);
+    }
+  }
+
+private:
+  // Return the member `value` in the blocked layout, converting it if needed.
+  Value getBlocked(RewriterBase &rewriter, Value value) {
+    auto it = blockedValues.find(value);
+    if (it != blockedValues.end())
+      return it->second;
+
+    OpBuilder::InsertionGuard guard(rewriter);
+    Value blocked;
+    if (isUnpackedFromLayout(value)) {
+      blocked = value.getDefiningOp<tensor::UnPackOp>().getSource();
+    } else if (auto emptyOp = value.getDefiningOp<tensor::EmptyOp>()) {
+      rewriter.setInsertionPoint(emptyOp);
+      RankedTensorType blockedType = tensor::PackOp::inferPackedType(
+          emptyOp.getType(), layout.innerTiles, layout.innerDimsPos);
+      blocked = rewriter.create<tensor::EmptyOp>(
+          emptyOp.getLoc(), blockedType.getShape(),
+          blockedType.getElementType());
+    } else {
+      rewriter.setInsertionPointAfterValue(value);
+      blocked = createPack(rewriter, value.getLoc(), value,
+                           layout.innerDimsPos, layout.innerTiles);
+    }
+    blockedValues[value] = blocked;
+    return blocked;
+  }
+
+  void rewriteOp(RewriterBase &rewriter, linalg::GenericOp genericOp) {
+    rewriter.setInsertionPoint(genericOp);
+    Location loc = genericOp.getLoc();
+
+    SmallVector<Value> operands;
+    SmallVector<AffineMap> maps;
+    for (OpOperand &operand : genericOp->getOpOperands()) {
+      AffineMap map = genericOp.getMatchingIndexingMap(&operand);
+      maps.push_back(getBlockedMap(map, layout));
+      if (isFullOperand(genericOp, operand)) {
+        operands.push_back(getBlocked(rewriter, operand.get()));
+        continue;
+      }
+      if (!isa<ShapedType>(operand.get().getType())) {
+        operands.push_back(operand.get());
+        continue;
+      }
+      SmallVector<int64_t> innerDimsPos, innerTiles;
+      getOperandLayout(map, layout, innerDimsPos, innerTiles);
+      operands.push_back(innerDimsPos.empty()
+                             ? operand.get()
+                             : createPack(rewriter, loc, operand.get(),
+                                          innerDimsPos, innerTiles));
+    }
+
+    unsigned numInputs = genericOp.getNumDpsInputs();
+    ValueRange inputs = ValueRange(operands).take_front(numInputs);
+    ValueRange outputs = ValueRange(operands).drop_front(numInputs);
+    SmallVector<utils::IteratorType> iterators(maps.front().getNumDims(),
+                                               utils::IteratorType::parallel);
+    auto blockedOp = rewriter.create<linalg::GenericOp>(
+        loc, outputs.getTypes(), inputs, outputs, maps, iterators);
+    rewriter.cloneRegionBefore(genericOp.getRegion(), blockedOp.getRegion(),
+                               blockedOp.getRegion().begin());
+    blockedValues[genericOp->getResult(0)] = blockedOp->getResult(0);
+  }
+
+  const LayoutClass &layoutClass;
+  const BlockedLayout &layout;
+  llvm::SmallDenseSet<Operation *> ops;
+  DenseMap<Value, Value> blockedValues;
+};
+
+// Group the values of the body of `func` connected by element-wise ops and
+// record the layouts requested at their boundaries.
+static SmallVector<LayoutClass> collectLayoutClasses(func::FuncOp func) {
+  Block &body = func.getBody().front();
+  ValueClasses classes;
+  SmallVector<linalg::GenericOp> elementwiseOps;
+  for (Operation &op : body) {
+    auto genericOp = dyn_cast<linalg::GenericOp>(op);
+    if (!genericOp || !isElementwise(genericOp))
+      continue;
+    elementwiseOps.push_back(genericOp);
+    Value result = genericOp->getResult(0);
+    classes.find(result);
+    for (OpOperand &operand : genericOp->getOpOperands()) {
+      if (isFullOperand(genericOp, operand))
+        classes.join(result, operand.get());
+    }
+  }
+
+  SmallVector<LayoutClass> layoutClasses;
+  DenseMap<Value, unsigned> classIds;
+  auto getClass = [&](Value value) -> LayoutClass & {
+    auto [it, inserted] =
+        classIds.try_emplace(classes.find(value), layoutClasses.size());
+    if (inserted)
+      layoutClasses.emplace_back();
+    return layoutClasses[it->second];
+  };
+  llvm::SmallDenseSet<Value> visited;
+  auto addMember = [&](Value value) {
+    if (visited.insert(value).second)
+      getClass(value).members.push_back(value);
+  };
+  for (linalg::GenericOp genericOp : elementwiseOps) {
+    Value result = genericOp->getResult(0);
+    getClass(result).ops.push_back(genericOp);
+    addMember(result);
+    for (OpOperand &operand : genericOp->getOpOperands()) {
+      if (isFullOperand(genericOp, operand))
+        addMember(operand.get());
+    }
+  }
+
+  for (Operation &op : body) {
+    if (auto unPackOp = dyn_cast<tensor::UnPackOp>(op)) {
+      std::optional<BlockedLayout> layout = getBlockedLayout(unPackOp);
+      if (layout && classes.contains(unPackOp.getResult()))
+        getClass(unPackOp.getResult()).requests.push_back(*layout);
+    } else if (auto packOp = dyn_cast<tensor::PackOp>(op)) {
+      std::optional<BlockedLayout> layout = getBlockedLayout(packOp);
+      if (layout && classes.contains(packOp.getSource()))
+        getClass(packOp.getSource()).requests.push_back(*layout);
+    }
+  }
+  return layoutClasses;
+}
+
+// Return the layout requested the most by `layoutClass`, the first one
+// requested on ties.
+static std::optional<BlockedLayout>
+getPreferredLayout(const LayoutClass &layoutClass) {
+  std::optional<BlockedLayout> preferred;
+  int64_t preferredCount = 0;
+  for (const BlockedLayout &layout : layoutClass.requests) {
+    int64_t count = llvm::count(layoutClass.requests, layout);
+    if (count > preferredCount) {
+      preferred = layout;
+      preferredCount = count;
+    }
+  }
+  return preferred;
+}
+
+// Per-function statistics.
+struct LayoutSummary {
+  int64_t numGroups = 0;
+  int64_t numPacksBefore = 0;
+  int64_t numUnPacksBefore = 0;
+  int64_t numPacksAfter = 0;
+  int64_t numUnPacksAfter = 0;
+};
+
+static void countConversions(func::FuncOp func, int64_t &numPacks,
+                             int64_t &numUnPacks) {
+  numPacks = 0;
+  numUnPacks = 0;
+  func->walk([&](Operation *op) {
+    if (isa<tensor::PackOp>(op))
+      numPacks++;
+    else if (isa<tensor::UnPackOp>(op))
+      numUnPacks++;
+  });
+}
+
+struct LayoutAssignment
+    : public tpp::impl::LayoutAssignmentBase<LayoutAssignment> {
+  using LayoutAssignmentBase::LayoutAssignmentBase;
+
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    MLIRContext *ctx = &getContext();
+
+    LayoutSummary summary;
+    countConversions(func, summary.numPacksBefore, summary.numUnPacksBefore);
+
+    // Only straight-line functions are handled, the others are reported
+    // untouched.
+    if (!func.getBody().hasOneBlock()) {
+      summary.numPacksAfter = summary.numPacksBefore;
+      summary.numUnPacksAfter = summary.numUnPacksBefore;
+      printLayoutSummary(func, summary,
+                         func.isExternal() ? "declaration" : "multi-block");
+      return;
+    }
+
+    // Step 1. Assign layouts. Values connected by element-wise ops share
+    // their layout. Each group takes the blocked layout requested the most by
+    // the unpacks producing it and the packs consuming it, if that layout
+    // tiles all its values and removes more conversions than it adds.
+    SmallVector<LayoutClass> layoutClasses = collectLayoutClasses(func);
+    SmallVector<std::pair<const LayoutClass *, BlockedLayout>> assignments;
+    for (const LayoutClass &layoutClass : layoutClasses) {
+      std::optional<BlockedLayout> layout = getPreferredLayout(layoutClass);
+      if (!layout)
+        continue;
+      BlockedClassRewriter classRewriter(layoutClass, *layout);
+      if (!classRewriter.isLegal() || classRewriter.getBenefit() <= 0)
+        continue;
+      LLVM_DEBUG(llvm::dbgs() << "Blocked group of "
+                              << layoutClass.ops.size() << " ops\n");
+      assignments.emplace_back(&layoutClass, *layout);
+    }
+    summary.numGroups = assignments.size();
+
+    // Step 2. Rewrite the groups in their layout. Conversions remain at the
+    // function boundaries and around the ops that do not take the layout.
+    IRRewriter rewriter(ctx);
+    for (auto &[layoutClass, layout] : assignments)
+      BlockedClassRewriter(*layoutClass, layout).rewrite(rewriter);
+
+    countConversions(func, summary.numPacksAfter, summary.numUnPacksAfter);
+    printLayoutSummary(func, summary);
+  }
+
+private:
+  // Print one summary line per function, `skipped` gives the reason if the
+  // function was not rewritten.
+  void printLayoutSummary(func::FuncOp func, const LayoutSummary &summary,
+                          StringRef skipped = "") {
+    if (!printSummary)
+      return;
+    llvm::errs() << "layout-assignment: @" << func.getSymName() << ": "
+                 << summary.numGroups << " blocked group(s)";
+    if (!skipped.empty())
+      llvm::errs() << " (skipped: " << skipped << ")";
+    llvm::errs() << ", packs " << summary.numPacksBefore << " -> "
+                 << summary.numPacksAfter << ", unpacks "
+                 << summary.numUnPacksBefore << " -> "
+                 << summary.numUnPacksAfter << "\n";
+  }
+};
+
+} // namespace
@@ -0,0 +1,166 @@
+//===- LinalgVectorization.cpp -----------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Passes.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/Math/Transforms/Passes.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/Dialect/Vector/Transforms/LoweringPatterns.h"
+#include "mlir/Dialect/Vector/Transforms/VectorRewritePatterns.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+using namespace mlir;
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_LINALGVECTORIZATION
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+#define DEBUG_TYPE "linalg-vectorization"
+
+namespace {
+
+// Return true if `genericOp` is an element-wise or reduction operation the
+// vectorizer can handle. Contractions are left to XSMM or loops.
+static bool isVectorizationCandidate(linalg::GenericOp genericOp) {
+  if (!genericOp.hasPureBufferSemantics() || genericOp.hasDynamicShape())
+    return false;
+  if (linalg::isaContractionOpInterface(genericOp) ||
+      linalg::isaConvolutionOpInterface(genericOp)) {
+    return false;
+  }
+  if (!llvm::all_of(genericOp.getIndexingMapsArray(), [](AffineMap map) {
+        return map.isProjectedPermutation(/*allowZeroInResults=*/true);
+      })) {
+    return false;
+  }
+  Type elementType =
+      getElementTypeOrSelf(genericOp.getDpsInits()[0].getType());
+  if (!elementType.isIntOrFloat())
+    return false;
+  return succeeded(linalg::vectorizeOpPrecondition(genericOp));
+}
+
+// Return the number of elements of `genericOp` fitting in a vector register.
+static int64_t getVectorLength(linalg::GenericOp genericOp,
+                               unsigned vectorWidth) {
+  Type elementType =
+      getElementTypeOrSelf(genericOp.getDpsInits()[0].getType());
+  return std::max<int64_t>(vectorWidth / elementType.getIntOrFloatBitWidth(),
+                           1);
+}
+
+// Split the innermost loop of `genericOp` at the last multiple of the vector
+// length, if the vector length does not divide it. Return the part covering
+// the full vectors, the remainder is left to scalar code. Loops shorter than
+// a vector are returned whole.
+static linalg::GenericOp splitPartialVector(RewriterBase &rewriter,
+                                            linalg::GenericOp genericOp,
+                                            int64_t vectorLength) {
+  SmallVector<int64_t> ranges = genericOp.getStaticLoopRanges();
+  if (ranges.empty() || ranges.back() <= vectorLength ||
+      ranges.back() % vectorLength == 0) {
+    return genericOp;
+  }
+  rewriter.setInsertionPoint(genericOp);
+  int64_t splitPoint = ranges.back() - ranges.back() % vectorLength;
+  auto [fullVectors, remainder] = linalg::splitOp(
+      rewriter, cast<TilingInterface>(genericOp.getOperation()),
+      ranges.size() - 1, rewriter.getIndexAttr(splitPoint));
+  (void)remainder;
+  return dyn_cast_or_null<linalg::GenericOp>(fullVectors.getOperation());
+}
+
+// Tile all the loops by one but the innermost one, which is tiled by the
+// number of elements fitting in a vector register. An innermost loop shorter
+// than the vector length is kept whole. A zero tile size leaves the loop
+// untiled.
+static SmallVector<int64_t> getTileSizes(linalg::GenericOp genericOp,
+                                         int64_t vectorLength) {
+  SmallVector<int64_t> ranges = genericOp.getStaticLoopRanges();
+  SmallVector<int64_t> tiles(ranges.size(), 1);
+  if (tiles.empty())
+    return tiles;
+
+  tiles.back() = std::min(ranges.back(), vectorLength);
+  for (auto [tile, range] : llvm::zip(tiles, ranges)) {
+    if (tile == range)
+      tile = 0;
+  }
+  return tiles;
+}
+
+struct LinalgVectorization
+    : public tpp::impl::LinalgVectorizationBase<LinalgVectorization> {
+  using LinalgVectorizationBase::LinalgVectorizationBase;
+
+  void runOnOperation() override {
+    MLIRContext *ctx = &getContext();
+    if (vectorWidth == 0)
+      return;
+
+    SmallVector<linalg::GenericOp> candidates;
+    getOperation()->walk([&](linalg::GenericOp genericOp) {
+      if (isVectorizationCandidate(genericOp))
+        candidates.push_back(genericOp);
+    });
+
+    IRRewriter rewriter(ctx);
+    for (linalg::GenericOp genericOp : candidates) {
+      int64_t vectorLength = getVectorLength(genericOp, vectorWidth);
+      genericOp = splitPartialVector(rewriter, genericOp, vectorLength);
+      if (!genericOp)
+        continue;
+      SmallVector<int64_t> tiles = getTileSizes(genericOp, vectorLength);
+      Operation *tiledOp = genericOp;
+      if (llvm::any_of(tiles, [](int64_t tile) { return tile != 0; })) {
+        rewriter.setInsertionPoint(genericOp);
+        auto options = scf::SCFTilingOptions().setTileSizes(
+            getAsIndexOpFoldResult(ctx, tiles));
+        FailureOr<scf::SCFTilingResult> tilingResult = scf::tileUsingSCF(
+            rewriter, cast<TilingInterface>(genericOp.getOperation()),
+            options);
+        if (failed(tilingResult) || tilingResult->tiledOps.size() != 1)
+          continue;
+        tiledOp = tilingResult->tiledOps[0];
+        rewriter.eraseOp(genericOp);
+      }
+      rewriter.setInsertionPoint(tiledOp);
+      (void)linalg::vectorize(rewriter, tiledOp);
+    }
+
+    // Bring the vectors down to the innermost dimension and lower the
+    // reductions to 1-d horizontal reductions. math.tanh has no direct LLVM
+    // lowering, expand it into exponentials which do vectorize.
+    RewritePatternSet patterns(ctx);
+    vector::populateCastAwayVectorLeadingOneDimPatterns(patterns);
+    vector::populateVectorTransferPermutationMapLoweringPatterns(patterns);
+    vector::populateVectorMultiReductionLoweringPatterns(
+        patterns, vector::VectorMultiReductionLowering::InnerReduction);
+    populateExpandTanhPattern(patterns);
+    vector::TransferReadOp::getCanonicalizationPatterns(patterns, ctx);
+    vector::TransferWriteOp::getCanonicalizationPatterns(patterns, ctx);
+    memref::SubViewOp::getCanonicalizationPatterns(patterns, ctx);
+    scf::ForOp::getCanonicalizationPatterns(patterns, ctx);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns)))) {
+      return signalPassFailure();
+    }
+  }
+};
+
+} // namespace
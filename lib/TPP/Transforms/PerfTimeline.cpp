@@ -0,0 +1,91 @@
+//===- PerfTimeline.cpp ------------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the recording of the benchmark and parallel loop
+// iterations as timeline events.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Dialect/Perf/PerfOps.h"
+#include "TPP/Passes.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_PERFTIMELINE
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+using namespace mlir;
+
+namespace {
+
+// Return the index of the current iteration of `loop`, counted in row-major
+// order over its induction variables.
+static Value getLinearIndex(OpBuilder &builder, scf::ParallelOp loop) {
+  Location loc = loop.getLoc();
+  Value index;
+  for (auto [iv, lb, ub, step] :
+       llvm::zip(loop.getInductionVars(), loop.getLowerBound(),
+                 loop.getUpperBound(), loop.getStep())) {
+    Value pos = builder.create<arith::DivSIOp>(
+        loc, builder.create<arith::SubIOp>(loc, iv, lb), step);
+    if (!index) {
+      index = pos;
+      continue;
+    }
+    Value tripCount = builder.create<arith::CeilDivSIOp>(
+        loc, builder.create<arith::SubIOp>(loc, ub, lb), step);
+    index = builder.create<arith::AddIOp>(
+        loc, builder.create<arith::MulIOp>(loc, index, tripCount), pos);
+  }
+  return builder.create<arith::IndexCastOp>(loc, builder.getI64Type(), index);
+}
+
+// Record the execution of `block` as an event of `kind`. The event argument
+// is built right before the terminator.
+static void recordEvent(OpBuilder &builder, Location loc, Block *block,
+                        perf::TimelineEndOp::Kind kind,
+                        function_ref<Value(OpBuilder &)> buildArg) {
+  builder.setInsertionPointToStart(block);
+  Value begin =
+      builder.create<perf::TimelineBeginOp>(loc, builder.getI64Type());
+  builder.setInsertionPoint(block->getTerminator());
+  builder.create<perf::TimelineEndOp>(loc, begin, buildArg(builder),
+                                      builder.getI64IntegerAttr(kind));
+}
+
+struct PerfTimeline : public tpp::impl::PerfTimelineBase<PerfTimeline> {
+  using PerfTimelineBase::PerfTimelineBase;
+
+  void runOnOperation() override {
+    OpBuilder builder(&getContext());
+    getOperation()->walk([&](perf::BenchOp benchOp) {
+      Location loc = benchOp.getLoc();
+      recordEvent(builder, loc, &benchOp.getRegion().front(),
+                  perf::TimelineEndOp::BenchIteration,
+                  [&](OpBuilder &b) -> Value {
+                    return b.create<arith::ConstantIntOp>(loc, 0, 64);
+                  });
+    });
+
+    // Nested parallel loops run within an iteration of the outermost one.
+    getOperation()->walk([&](scf::ParallelOp loop) {
+      if (loop->getParentOfType<scf::ParallelOp>())
+        return;
+      recordEvent(builder, loop.getLoc(), loop.getBody(),
+                  perf::TimelineEndOp::ParallelIteration,
+                  [&](OpBuilder &b) { return getLinearIndex(b, loop); });
+    });
+  }
+};
+
+} // namespace
@@ -90,6 +90,8 @@ struct RewriteBatchMatmulToMatmulImpl
 struct RewriteBatchMatmulToMatmul
     : public tpp::impl::RewriteBatchMatmulToMatmulBase<
           RewriteBatchMatmulToMatmul> {
+  using RewriteBatchMatmulToMatmulBase::RewriteBatchMatmulToMatmulBase;
+
   void runOnOperation() override {
     auto &ctx = getContext();
     IRRewriter rewriter(&ctx);
@@ -97,6 +99,9 @@ struct RewriteBatchMatmulToMatmul
     getOperation()->walk([&](linalg::BatchMatmulOp batchMatmulOp) {
       if (batchMatmulOp.hasPureBufferSemantics())
         return signalPassFailure();
+      // Small products are lowered as a whole to a parallel loop of GEMMs.
+      if (linalgx::utils::isSmallBatchMatmul(batchMatmulOp, smallGemmSize))
+        return;
       SmallVector<OpFoldResult> tiles(
           batchMatmulOp.getNumLoops(),
           getAsIndexOpFoldResult(rewriter.getContext(), 0));
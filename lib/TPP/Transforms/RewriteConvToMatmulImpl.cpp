@@ -9,9 +9,14 @@
 #include "TPP/IR/StructuredOpMatcher.h"
 #include "TPP/Transforms/Transforms.h"
 #include "TPP/Transforms/Utils/TransformUtils.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Utils/Utils.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/IRMapping.h"
 
 using namespace mlir;
 
@@ -44,55 +49,34 @@ computeSizeGemmForImage(OpBuilder &builder, linalg::LinalgOp linalgOp) {
   return sizes;
 }
 
-// Return success if `expr` is either a dimExpr or a mul expression dim * cst OR
-// cst * dim.
-static LogicalResult isDimExprOrMulExpr(AffineExpr expr,
-                                        AffineExpr &multiplicativeFactor) {
+// Return the constant multiplicative factor of dimension `dimPos` in `expr`,
+// zero if the dimension is not used. By definition a convolution affine
+// expression is a sum of AffineDimExpr, possibly multiplied by an
+// AffineConstantExpr (i.e., p * stride + r * dilation). Return failure for
+// any other expression.
+static FailureOr<int64_t> getDimCoefficient(AffineExpr expr, unsigned dimPos) {
   if (auto dimExpr = dyn_cast<AffineDimExpr>(expr))
-    return success();
-  if (auto mulExpr = dyn_cast<AffineBinaryOpExpr>(expr)) {
-    if (mulExpr.getKind() != AffineExprKind::Mul)
-      return failure();
-    auto lhs = mulExpr.getLHS();
-    auto rhs = mulExpr.getRHS();
-    // Assert if we find a symbol. We need to check that we don't have them in
-    // the preconditions for this pattern. `verifyConvolutionInterface` allows
-    // them.
-    if (auto symbol = dyn_cast<AffineSymbolExpr>(lhs))
-      assert(false && "unexpected symbol expr");
-    if (auto symbol = dyn_cast<AffineSymbolExpr>(rhs))
-      assert(false && "unexpected symbol expr");
-    // If the lhs is a constant the rhs is a dim and viceversa.
-    if (auto constant = dyn_cast<AffineConstantExpr>(lhs)) {
-      if (auto dim = dyn_cast<AffineDimExpr>(rhs)) {
-        multiplicativeFactor = multiplicativeFactor * constant.getValue();
-        return success();
-      }
-      return failure();
-    }
-    if (auto constant = dyn_cast<AffineConstantExpr>(rhs)) {
-      if (auto dim = dyn_cast<AffineDimExpr>(lhs)) {
-        multiplicativeFactor = multiplicativeFactor * constant.getValue();
-        return success();
-      }
-      return failure();
-    }
+    return dimExpr.getPosition() == dimPos ? 1 : 0;
+  auto binExpr = dyn_cast<AffineBinaryOpExpr>(expr);
+  if (!binExpr)
     return failure();
+  AffineExpr lhs = binExpr.getLHS();
+  AffineExpr rhs = binExpr.getRHS();
+  if (binExpr.getKind() == AffineExprKind::Add) {
+    FailureOr<int64_t> lhsCoefficient = getDimCoefficient(lhs, dimPos);
+    FailureOr<int64_t> rhsCoefficient = getDimCoefficient(rhs, dimPos);
+    if (failed(lhsCoefficient) || failed(rhsCoefficient))
+      return failure();
+    return *lhsCoefficient + *rhsCoefficient;
   }
-  return failure();
-}
-
-// Walk `convExpr` in pre-order and extract a constant if any.
-[[maybe_unused]] static LogicalResult walkConvExpr(AffineExpr convExpr,
-                                  AffineExpr &multiplicativeFactor) {
-  if (auto dimExpr = dyn_cast<AffineDimExpr>(convExpr))
-    return success();
-  if (auto binExpr = dyn_cast<AffineBinaryOpExpr>(convExpr)) {
-    if (binExpr.getKind() != AffineExprKind::Add)
+  if (binExpr.getKind() == AffineExprKind::Mul) {
+    if (isa<AffineConstantExpr>(lhs))
+      std::swap(lhs, rhs);
+    auto dim = dyn_cast<AffineDimExpr>(lhs);
+    auto constant = dyn_cast<AffineConstantExpr>(rhs);
+    if (!dim || !constant)
       return failure();
-    return success(
-        succeeded(isDimExprOrMulExpr(binExpr.getLHS(), multiplicativeFactor)) &&
-        succeeded(isDimExprOrMulExpr(binExpr.getRHS(), multiplicativeFactor)));
+    return dim.getPosition() == dimPos ? constant.getValue() : 0;
   }
   return failure();
 }
@@ -132,23 +116,20 @@ static FailureOr<Value> getSlicedConvOperandImpl(OpBuilder &builder,
                                                 operand->get(), idx));
   }
 
-  // We need to take into accound possible strides on W. Strides on the H
-  // are already computed using affine maps as the loops iterating over H are
-  // materialized. The W dimension is the last - 1 dimension.
+  // We need to take into accound possible strides on W. Strides and
+  // dilations on the H, as well as dilations on W, are already computed using
+  // affine maps as the loops iterating over H and over the filter are
+  // materialized. The W dimension is the last - 1 dimension, and its stride
+  // is the factor of the GEMM m dimension (the third innermost loop).
   SmallVector<OpFoldResult> strides(rank, builder.getIndexAttr(1));
   if (isImage) {
     AffineMap imageMap = linalgOp.getMatchingIndexingMap(operand);
-    [[maybe_unused]] AffineExpr wExpr = imageMap.getResult(imageMap.getNumResults() - 2);
-    AffineExpr multiplicativeFactor =
-        getAffineConstantExpr(1, linalgOp.getContext());
-    // By definition a convolution affine expression can either be:
-    // a) AffineDimExpr
-    // b) AffineDimExpr + AffineDimExpr
-    // c) AffineDimExpr * AffineConstantExpr/AffineSymbolExpr + AffineDimExpr
-    assert(succeeded(walkConvExpr(wExpr, multiplicativeFactor)) &&
-           "something went really wrong");
-    strides[strides.size() - 2] = builder.getIndexAttr(
-        cast<AffineConstantExpr>(multiplicativeFactor).getValue());
+    AffineExpr wExpr = imageMap.getResult(imageMap.getNumResults() - 2);
+    FailureOr<int64_t> stride =
+        getDimCoefficient(wExpr, linalgOp.getNumLoops() - /*GEMM loops=*/3);
+    if (failed(stride) || *stride <= 0)
+      return failure();
+    strides[strides.size() - 2] = builder.getIndexAttr(*stride);
   }
   return linalgx::utils::getSliceOperand(builder, linalgOp, operandToUse,
                                          offsets, sizes, strides,
@@ -236,6 +217,14 @@ mlir::linalgx::rewriteConvToMatmul(RewriterBase &rewriter,
     return rewriter.notifyMatchFailure(
         linalgOp, "cannot match operation iterators with matmul iterators");
 
+  AffineMap imageMap =
+      linalgOp.getMatchingIndexingMap(linalgOp.getDpsInputOperands()[0]);
+  FailureOr<int64_t> strideOnW =
+      getDimCoefficient(imageMap.getResult(imageMap.getNumResults() - 2),
+                        linalgOp.getNumLoops() - /*GEMM loops=*/3);
+  if (failed(strideOnW) || *strideOnW <= 0)
+    return rewriter.notifyMatchFailure(linalgOp, "unsupported image access");
+
   // peel-out all loops but the three innermost.
   unsigned upTo = linalgOp.getNumLoops() - /*GEMM loops=*/3;
   FailureOr<SmallVector<Range>> maybeLoopRanges =
@@ -310,3 +299,320 @@ mlir::linalgx::rewriteConvToMatmul(RewriterBase &rewriter,
   assert(matmul && "invalid return");
   return matmul;
 }
+
+//===----------------------------------------------------------------------===//
+// Blocked convolution to BRGEMM
+//===----------------------------------------------------------------------===//
+
+// Strides and dilations of a blocked convolution, extracted from the image
+// access map [N][C'][P * strideH + R * dilationH][Q * strideW + S * dilationW]
+// [c] with loops (N, K', P, Q, k, C', R, S, c).
+struct BlockedConvWindow {
+  int64_t strideH;
+  int64_t strideW;
+  int64_t dilationH;
+  int64_t dilationW;
+};
+
+// Check the body only, the iterators are checked with the access maps.
+static bool hasMatmulBody(linalg::LinalgOp linalgOp) {
+  // clang-format off
+  using namespace mlir::structured_match;
+  auto hasMulAddChain =
+    StructuredOpMatcher::make<linalg::LinalgOp>()
+      .region(MatchOne(0), WithOpChain<KindMul, KindAdd>(
+                                     /*captures=*/nullptr));
+  // clang-format on
+  return hasMulAddChain.match(linalgOp);
+}
+
+static FailureOr<BlockedConvWindow>
+getBlockedConvWindow(linalg::LinalgOp linalgOp) {
+  if (linalgOp.getNumLoops() != 9 || linalgOp.getNumDpsInputs() != 2 ||
+      linalgOp.getNumDpsInits() != 1) {
+    return failure();
+  }
+  enum { N, TileK, P, Q, K, TileC, R, S, C };
+  AffineMap imageMap =
+      linalgOp.getMatchingIndexingMap(linalgOp.getDpsInputOperands()[0]);
+  if (imageMap.getNumResults() != 5)
+    return failure();
+  AffineExpr hExpr = imageMap.getResult(2);
+  AffineExpr wExpr = imageMap.getResult(3);
+  FailureOr<int64_t> strideH = getDimCoefficient(hExpr, P);
+  FailureOr<int64_t> dilationH = getDimCoefficient(hExpr, R);
+  FailureOr<int64_t> strideW = getDimCoefficient(wExpr, Q);
+  FailureOr<int64_t> dilationW = getDimCoefficient(wExpr, S);
+  if (failed(strideH) || failed(dilationH) || failed(strideW) ||
+      failed(dilationW)) {
+    return failure();
+  }
+  BlockedConvWindow window{*strideH, *strideW, *dilationH, *dilationW};
+  if (window.strideH <= 0 || window.strideW <= 0 || window.dilationH <= 0 ||
+      window.dilationW <= 0) {
+    return failure();
+  }
+
+  // The other operands must follow the blocked layout.
+  MLIRContext *ctx = linalgOp.getContext();
+  AffineExpr n, tileK, p, q, k, tileC, r, s, c;
+  bindDims(ctx, n, tileK, p, q, k, tileC, r, s, c);
+  AffineMap expectedImage = AffineMap::get(
+      9, 0,
+      {n, tileC, p * window.strideH + r * window.dilationH,
+       q * window.strideW + s * window.dilationW, c},
+      ctx);
+  AffineMap expectedFilter =
+      AffineMap::get(9, 0, {tileK, tileC, r, s, c, k}, ctx);
+  AffineMap expectedOutput = AffineMap::get(9, 0, {n, tileK, p, q, k}, ctx);
+  if (linalgOp.getIndexingMapsArray() !=
+      SmallVector<AffineMap>{expectedImage, expectedFilter, expectedOutput}) {
+    return failure();
+  }
+  return window;
+}
+
+static FailureOr<BlockedConvWindow>
+matchBlockedConv(RewriterBase &rewriter, linalg::LinalgOp linalgOp) {
+  if (!llvm::isa_and_nonnull<linalg::GenericOp>(linalgOp))
+    return rewriter.notifyMatchFailure(linalgOp, "require a linalg.generic");
+  if (!linalgOp.hasPureTensorSemantics())
+    return rewriter.notifyMatchFailure(linalgOp, "require tensor semantics");
+  if (linalgOp.hasDynamicShape())
+    return rewriter.notifyMatchFailure(linalgOp, "require static shape");
+  if (!hasMatmulBody(linalgOp))
+    return rewriter.notifyMatchFailure(linalgOp, "require a GEMM-like body");
+  FailureOr<BlockedConvWindow> window = getBlockedConvWindow(linalgOp);
+  if (failed(window))
+    return rewriter.notifyMatchFailure(linalgOp, "not a blocked convolution");
+  return window;
+}
+
+FailureOr<linalg::BatchReduceMatmulOp>
+mlir::linalgx::rewriteBlockedConvToBRGemm(RewriterBase &rewriter,
+                                          linalg::LinalgOp linalgOp) {
+  FailureOr<BlockedConvWindow> window = matchBlockedConv(rewriter, linalgOp);
+  if (failed(window))
+    return failure();
+
+  Value image = linalgOp.getDpsInputOperands()[0]->get();
+  Value filter = linalgOp.getDpsInputOperands()[1]->get();
+  Value output = linalgOp.getDpsInits()[0];
+  auto imageType = cast<RankedTensorType>(image.getType());
+  auto filterType = cast<RankedTensorType>(filter.getType());
+  auto outputType = cast<RankedTensorType>(output.getType());
+  // [N][C'][H][W][c]
+  int64_t tileC = imageType.getDimSize(1);
+  int64_t blockC = imageType.getDimSize(4);
+  // [K'][C'][R][S][c][k]
+  int64_t filterR = filterType.getDimSize(2);
+  int64_t filterS = filterType.getDimSize(3);
+  // [N][K'][P][Q][k]
+  int64_t outN = outputType.getDimSize(0);
+  int64_t tileK = outputType.getDimSize(1);
+  int64_t outP = outputType.getDimSize(2);
+  int64_t outQ = outputType.getDimSize(3);
+  int64_t blockK = outputType.getDimSize(4);
+
+  // Materialize the loops over N, K', P, R and S. The BRGEMM reduces over C'
+  // and computes a [Q][k] row of the output:
+  // O[n][K'][p][Q][k] += I[n][C'][p * sh + r * dh][s * dw + Q * sw][c] *
+  //                      F[K'][C'][r][s][c][k]
+  // The image slice is strided on W, the stride becomes its leading dimension
+  // and C' the batch-reduce offset.
+  Location loc = linalgOp.getLoc();
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(linalgOp);
+  Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+  SmallVector<Value> lbs(5, zero), steps(5, one);
+  SmallVector<Value> ubs;
+  for (int64_t ub : {outN, tileK, outP, filterR, filterS})
+    ubs.push_back(rewriter.create<arith::ConstantIndexOp>(loc, ub));
+
+  Type elementType = outputType.getElementType();
+  linalg::BatchReduceMatmulOp brgemm = nullptr;
+  scf::LoopNest loopNest = scf::buildLoopNest(
+      rewriter, loc, lbs, ubs, steps, ValueRange{output},
+      [&](OpBuilder &builder, Location nestedLoc, ValueRange ivs,
+          ValueRange iterArgs) -> scf::ValueVector {
+        Value n = ivs[0], k = ivs[1], p = ivs[2], r = ivs[3], s = ivs[4];
+        AffineExpr d0, d1;
+        bindDims(builder.getContext(), d0, d1);
+        Value h = affine::makeComposedAffineApply(
+                      builder, nestedLoc,
+                      d0 * window->strideH + d1 * window->dilationH, {p, r})
+                      .getResult();
+        Value w = affine::makeComposedAffineApply(
+                      builder, nestedLoc, d0 * window->dilationW, {s})
+                      .getResult();
+        auto idx = [&](int64_t val) -> OpFoldResult {
+          return builder.getIndexAttr(val);
+        };
+
+        SmallVector<OpFoldResult> imageOffsets = {n, idx(0), h, w, idx(0)};
+        SmallVector<OpFoldResult> imageSizes = {idx(1), idx(tileC), idx(1),
+                                                idx(outQ), idx(blockC)};
+        SmallVector<OpFoldResult> imageStrides = {
+            idx(1), idx(1), idx(1), idx(window->strideW), idx(1)};
+        Value imageSlice = builder.create<tensor::ExtractSliceOp>(
+            nestedLoc,
+            RankedTensorType::get({tileC, outQ, blockC}, elementType), image,
+            imageOffsets, imageSizes, imageStrides);
+
+        SmallVector<OpFoldResult> filterOffsets = {k,      idx(0), r,
+                                                   s,      idx(0), idx(0)};
+        SmallVector<OpFoldResult> filterSizes = {
+            idx(1), idx(tileC), idx(1), idx(1), idx(blockC), idx(blockK)};
+        SmallVector<OpFoldResult> filterStrides(6, idx(1));
+        Value filterSlice = builder.create<tensor::ExtractSliceOp>(
+            nestedLoc,
+            RankedTensorType::get({tileC, blockC, blockK}, elementType),
+            filter, filterOffsets, filterSizes, filterStrides);
+
+        SmallVector<OpFoldResult> outOffsets = {n, k, p, idx(0), idx(0)};
+        SmallVector<OpFoldResult> outSizes = {idx(1), idx(1), idx(1),
+                                              idx(outQ), idx(blockK)};
+        SmallVector<OpFoldResult> outStrides(5, idx(1));
+        Value outSlice = builder.create<tensor::ExtractSliceOp>(
+            nestedLoc, RankedTensorType::get({outQ, blockK}, elementType),
+            iterArgs[0], outOffsets, outSizes, outStrides);
+
+        brgemm = builder.create<linalg::BatchReduceMatmulOp>(
+            nestedLoc, outSlice.getType(), ValueRange{imageSlice, filterSlice},
+            ValueRange{outSlice});
+        Value inserted = builder.create<tensor::InsertSliceOp>(
+            nestedLoc, brgemm->getResult(0), iterArgs[0], outOffsets, outSizes,
+            outStrides);
+        return {inserted};
+      });
+
+  rewriter.replaceOp(linalgOp, loopNest.results);
+  return brgemm;
+}
+
+FailureOr<linalg::GenericOp>
+mlir::linalgx::rewriteBlockedConvToOffsetBRGemm(RewriterBase &rewriter,
+                                                linalg::LinalgOp linalgOp) {
+  FailureOr<BlockedConvWindow> window = matchBlockedConv(rewriter, linalgOp);
+  if (failed(window))
+    return failure();
+
+  Value image = linalgOp.getDpsInputOperands()[0]->get();
+  Value filter = linalgOp.getDpsInputOperands()[1]->get();
+  Value output = linalgOp.getDpsInits()[0];
+  auto imageType = cast<RankedTensorType>(image.getType());
+  auto filterType = cast<RankedTensorType>(filter.getType());
+  auto outputType = cast<RankedTensorType>(output.getType());
+  // [N][C'][H][W][c]
+  int64_t tileC = imageType.getDimSize(1);
+  int64_t imageW = imageType.getDimSize(3);
+  int64_t blockC = imageType.getDimSize(4);
+  // [K'][C'][R][S][c][k]
+  int64_t filterR = filterType.getDimSize(2);
+  int64_t filterS = filterType.getDimSize(3);
+  // [N][K'][P][Q][k]
+  int64_t outN = outputType.getDimSize(0);
+  int64_t tileK = outputType.getDimSize(1);
+  int64_t outP = outputType.getDimSize(2);
+  int64_t outQ = outputType.getDimSize(3);
+  int64_t blockK = outputType.getDimSize(4);
+  int64_t windowH = (filterR - 1) * window->dilationH + 1;
+
+  // Materialize the loops over N, K' and P. The filter window is folded into
+  // the reduction together with C', each (C', r, s) block of the image is at a
+  // static offset in the slice of the input rows read by an output row:
+  // O[n][K'][p][Q][k] += I[n][C'][p * sh + r * dh][Q * sw + s * dw][c] *
+  //                      F[K'][C'][r][s][c][k]
+  Location loc = linalgOp.getLoc();
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(linalgOp);
+  Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+  SmallVector<Value> lbs(3, zero), steps(3, one);
+  SmallVector<Value> ubs;
+  for (int64_t ub : {outN, tileK, outP})
+    ubs.push_back(rewriter.create<arith::ConstantIndexOp>(loc, ub));
+
+  MLIRContext *ctx = rewriter.getContext();
+  AffineExpr q, k, tileCExpr, r, s, c;
+  bindDims(ctx, q, k, tileCExpr, r, s, c);
+  SmallVector<AffineMap> maps = {
+      AffineMap::get(6, 0,
+                     {tileCExpr, r * window->dilationH,
+                      q * window->strideW + s * window->dilationW, c},
+                     ctx),
+      AffineMap::get(6, 0, {tileCExpr, r, s, c, k}, ctx),
+      AffineMap::get(6, 0, {q, k}, ctx)};
+  SmallVector<utils::IteratorType> iterators = {
+      utils::IteratorType::parallel,  utils::IteratorType::parallel,
+      utils::IteratorType::reduction, utils::IteratorType::reduction,
+      utils::IteratorType::reduction, utils::IteratorType::reduction};
+
+  Type elementType = outputType.getElementType();
+  linalg::GenericOp brgemm = nullptr;
+  scf::LoopNest loopNest = scf::buildLoopNest(
+      rewriter, loc, lbs, ubs, steps, ValueRange{output},
+      [&](OpBuilder &builder, Location nestedLoc, ValueRange ivs,
+          ValueRange iterArgs) -> scf::ValueVector {
+        Value n = ivs[0], tileKIv = ivs[1], p = ivs[2];
+        AffineExpr d0;
+        bindDims(builder.getContext(), d0);
+        Value h = affine::makeComposedAffineApply(builder, nestedLoc,
+                                                  d0 * window->strideH, {p})
+                      .getResult();
+        auto idx = [&](int64_t val) -> OpFoldResult {
+          return builder.getIndexAttr(val);
+        };
+
+        SmallVector<OpFoldResult> imageOffsets = {n, idx(0), h, idx(0),
+                                                  idx(0)};
+        SmallVector<OpFoldResult> imageSizes = {
+            idx(1), idx(tileC), idx(windowH), idx(imageW), idx(blockC)};
+        SmallVector<OpFoldResult> imageStrides(5, idx(1));
+        Value imageSlice = builder.create<tensor::ExtractSliceOp>(
+            nestedLoc,
+            RankedTensorType::get({tileC, windowH, imageW, blockC},
+                                  elementType),
+            image, imageOffsets, imageSizes, imageStrides);
+
+        SmallVector<OpFoldResult> filterOffsets = {tileKIv, idx(0), idx(0),
+                                                   idx(0),  idx(0), idx(0)};
+        SmallVector<OpFoldResult> filterSizes = {
+            idx(1),       idx(tileC),  idx(filterR),
+            idx(filterS), idx(blockC), idx(blockK)};
+        SmallVector<OpFoldResult> filterStrides(6, idx(1));
+        Value filterSlice = builder.create<tensor::ExtractSliceOp>(
+            nestedLoc,
+            RankedTensorType::get({tileC, filterR, filterS, blockC, blockK},
+                                  elementType),
+            filter, filterOffsets, filterSizes, filterStrides);
+
+        SmallVector<OpFoldResult> outOffsets = {n, tileKIv, p, idx(0),
+                                                idx(0)};
+        SmallVector<OpFoldResult> outSizes = {idx(1), idx(1), idx(1),
+                                              idx(outQ), idx(blockK)};
+        SmallVector<OpFoldResult> outStrides(5, idx(1));
+        Value outSlice = builder.create<tensor::ExtractSliceOp>(
+            nestedLoc, RankedTensorType::get({outQ, blockK}, elementType),
+            iterArgs[0], outOffsets, outSizes, outStrides);
+
+        brgemm = builder.create<linalg::GenericOp>(
+            nestedLoc, outSlice.getType(), ValueRange{imageSlice, filterSlice},
+            ValueRange{outSlice}, maps, iterators,
+            [&](OpBuilder &nestedBuilder, Location, ValueRange args) {
+              Block &body = linalgOp->getRegion(0).front();
+              IRMapping mapping;
+              mapping.map(body.getArguments(), args);
+              for (Operation &op : body)
+                nestedBuilder.clone(op, mapping);
+            });
+        Value inserted = builder.create<tensor::InsertSliceOp>(
+            nestedLoc, brgemm->getResult(0), iterArgs[0], outOffsets,
+            outSizes, outStrides);
+        return {inserted};
+      });
+
+  rewriter.replaceOp(linalgOp, loopNest.results);
+  return brgemm;
+}
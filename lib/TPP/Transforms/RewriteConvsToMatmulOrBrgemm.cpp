@@ -41,32 +41,6 @@ static bool hasStaticShape(Value image, Value filter, Value output) {
            (!outputType.hasStaticShape()));
 }
 
-// return true if the conv has stride != 1.
-template <typename CONVOP> static bool hasStride(CONVOP convOp) {
-  if (DenseIntElementsAttr strides = convOp.getStrides()) {
-    auto values = strides.getValues<APInt>();
-    if (llvm::any_of(values, [](const APInt &value) {
-          return value.getSExtValue() != 1;
-        })) {
-      return true;
-    }
-  }
-  return false;
-}
-
-// return true if the conv has dilation != 1.
-template <typename CONVOP> static bool hasDilation(CONVOP convOp) {
-  if (DenseIntElementsAttr dilations = convOp.getDilations()) {
-    auto values = dilations.getValues<APInt>();
-    if (llvm::any_of(values, [](const APInt &value) {
-          return value.getSExtValue() != 1;
-        })) {
-      return true;
-    }
-  }
-  return false;
-}
-
 // Check dimension at index 'i' and 'j'. If both are '1' return true
 // otherwise false. The operand is expected to have static shape.
 static bool hasFilterWithRandSEqualOne(OpOperand *filter, unsigned i,
@@ -167,10 +141,6 @@ struct GeneralizeConv2DNhwcHwcf : OpRewritePattern<linalg::Conv2DNhwcHwcfOp> {
 
   LogicalResult matchAndRewrite(linalg::Conv2DNhwcHwcfOp convOp,
                                 PatternRewriter &rewriter) const override {
-    // Do not handle convolutions with dilation.
-    if (hasDilation<linalg::Conv2DNhwcHwcfOp>(convOp))
-      return failure();
-
     // [N][H][W][C]
     Value image = convOp.image();
     // [R][S][C][K]
@@ -201,11 +171,6 @@ struct BlockConv2DNchwFchw : OpRewritePattern<linalg::Conv2DNchwFchwOp> {
 
   LogicalResult
   blockConv2DNchwFchwPreconditions(linalg::Conv2DNchwFchwOp convOp) const {
-    // do not handle convolutions with dilation and strides.
-    if (hasStride<linalg::Conv2DNchwFchwOp>(convOp) ||
-        hasDilation<linalg::Conv2DNchwFchwOp>(convOp))
-      return failure();
-
     // [N][C][H][W]
     Value image = convOp.image();
     // [K][C][R][S]
@@ -336,16 +301,31 @@ struct RewriteConv2DNchwFchwToMatmul : OpRewritePattern<linalg::GenericOp> {
   }
 };
 
-// Prepare for BRGEMM. Requires R = S = 1. The pattern collapses
-// H and W on the image and P and Q on the output.
+// Return true if the blocked convolution has R = S = 1 and unit strides,
+// such that P * Q == H * W and the image can be collapsed.
+static bool isCollapsibleBlockedConv(linalg::GenericOp linalgOp) {
+  if (linalgOp.getNumLoops() != 9)
+    return false;
+  OpOperand *filter = linalgOp.getDpsInputOperands()[1];
+  if (!hasFilterWithRandSEqualOne(filter, /*Rpos=*/2, /*Spos=*/3))
+    return false;
+  // [N][C'][H][W][c] and [N][K'][P][Q][k].
+  auto imageShape =
+      cast<ShapedType>(linalgOp.getDpsInputs()[0].getType()).getShape();
+  auto outputShape =
+      cast<ShapedType>(linalgOp.getDpsInits()[0].getType()).getShape();
+  return imageShape[2] == outputShape[2] && imageShape[3] == outputShape[3];
+}
+
+// Prepare for BRGEMM. Requires R = S = 1 and unit strides. The pattern
+// collapses H and W on the image and P and Q on the output.
 struct CollapseFilterAndImage : OpRewritePattern<linalg::GenericOp> {
   using OpRewritePattern::OpRewritePattern;
 
   LogicalResult collapseFilterPreconditions(linalg::GenericOp linalgOp) const {
     if (!isMarkedWithTpp(linalgOp, "tpp.BlockedConv2DNchwFchwOp"))
       return failure();
-    OpOperand *filter = linalgOp.getDpsInputOperands()[1];
-    if (!hasFilterWithRandSEqualOne(filter, /*Rpos=*/2, /*Spos=*/3))
+    if (!isCollapsibleBlockedConv(linalgOp))
       return failure();
     return success();
   }
@@ -527,6 +507,35 @@ struct MapToBRGEMM : OpRewritePattern<linalg::GenericOp> {
   }
 };
 
+// Map a blocked convolution that cannot be collapsed (i.e., with strides,
+// dilations or R and S not 1) to BRGEMMs over the blocked input channels. With
+// `useOffsets` the filter window is reduced by the BRGEMM as well.
+struct MapStridedConvToBRGEMM : OpRewritePattern<linalg::GenericOp> {
+  MapStridedConvToBRGEMM(MLIRContext *ctx, bool useOffsets)
+      : OpRewritePattern<linalg::GenericOp>(ctx), useOffsets(useOffsets) {}
+
+  LogicalResult matchAndRewrite(linalg::GenericOp linalgOp,
+                                PatternRewriter &rewriter) const override {
+    if (!linalgx::utils::isBlockedConvolution(linalgOp) ||
+        isCollapsibleBlockedConv(linalgOp)) {
+      return failure();
+    }
+    if (useOffsets) {
+      FailureOr<linalg::GenericOp> brgemm =
+          mlir::linalgx::rewriteBlockedConvToOffsetBRGemm(rewriter, linalgOp);
+      return success(succeeded(brgemm));
+    }
+    FailureOr<linalg::BatchReduceMatmulOp> brgemm =
+        mlir::linalgx::rewriteBlockedConvToBRGemm(rewriter, linalgOp);
+    if (failed(brgemm))
+      return failure();
+    return success();
+  }
+
+private:
+  bool useOffsets;
+};
+
 // patterns for mapping a Conv2DNhwcHwcfOp to a GEMM operation.
 void populateRewrite2DNhwcHwcfConvPatterns(RewritePatternSet &patterns) {
   patterns.insert<GeneralizeConv2DNhwcHwcf, RewriteConv2DNhwcHwcfToMatmul,
@@ -535,7 +544,8 @@ void populateRewrite2DNhwcHwcfConvPatterns(RewritePatternSet &patterns) {
 
 // patterns for mapping a blocked convolutions to a GEMM/BRGEMM operations.
 void populateRewriteBlockedConvPatterns(RewritePatternSet &patterns,
-                                        bool enableBrgemm) {
+                                        bool enableBrgemm,
+                                        bool brgemmOffsets) {
   // clang-format off
   //
   // blocked conv: [N][K'][P][Q][k] = [N][C'][H][W][c] * [K'][C'][R][S][c][k]
@@ -546,6 +556,14 @@ void populateRewriteBlockedConvPatterns(RewritePatternSet &patterns,
   // [*][* ][P * Q][k] = [*][* ][H * W][c] * [* ][* ][c][k] // GEMM with c as red.
   // [*][* ][P * Q][k] = [*][C'][H * W][c] * [* ][C'][c][k] // BRGEMM with C' as red.
   //
+  // otherwise (strides, dilations or R, S != 1), loop over N, K', P, R, S:
+  // [*][* ][*][Q][k] = [*][C'][*][Q * sw][c] * [* ][C'][*][*][c][k] // BRGEMM
+  // with C' as red. and leading dimension sw * c on the image.
+  //
+  // with offsets, loop over N, K', P only:
+  // [*][* ][*][Q][k] = [*][C'][R * dh][W][c] * [* ][C'][R][S][c][k] // BRGEMM
+  // with C', R and S as red. at static offsets on the image.
+  //
   // clang-format on
 
   // Rewrite to GEMM.
@@ -558,6 +576,8 @@ void populateRewriteBlockedConvPatterns(RewritePatternSet &patterns,
     patterns.insert<CollapseFilterAndImage,
                     InterchangeAfterBlockingAndCollapsing, MapToBRGEMM>(
         patterns.getContext());
+    patterns.insert<MapStridedConvToBRGEMM>(patterns.getContext(),
+                                            brgemmOffsets);
   }
 }
 
@@ -569,7 +589,8 @@ struct RewriteConvToMatmulOrBrgemm
   void runOnOperation() override {
     RewritePatternSet patterns(getOperation().getContext());
     populateRewrite2DNhwcHwcfConvPatterns(patterns);
-    populateRewriteBlockedConvPatterns(patterns, this->enableBrgemm);
+    populateRewriteBlockedConvPatterns(patterns, this->enableBrgemm,
+                                       this->brgemmOffsets);
     tensor::populateMergeConsecutiveInsertExtractSlicePatterns(patterns);
     (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
   }
@@ -0,0 +1,411 @@
+//===- ShapeBucketing.cpp ----------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements multi-versioning of kernels with a dynamic dimension:
+// one static version is created for each shape bucket and a dispatcher picks
+// the smallest one that fits at runtime.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Passes.h"
+#include "TPP/Transforms/Transforms.h"
+#include "TPP/Transforms/Utils/TransformUtils.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Tensor/Utils/Utils.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/Support/Debug.h"
+
+using namespace mlir;
+
+#define DEBUG_TYPE "shape-bucketing"
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_SHAPEBUCKETING
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+namespace {
+
+// Position of the dynamic size in the function arguments.
+struct DynamicSizePos {
+  unsigned argNumber;
+  unsigned dim;
+};
+
+} // namespace
+
+// Return the first dynamic dimension of the arguments of `func`, if all the
+// shaped arguments and results are ranked tensors.
+static std::optional<DynamicSizePos> getDynamicSizePos(func::FuncOp func) {
+  if (func.isExternal() || !func.getBody().hasOneBlock())
+    return std::nullopt;
+  FunctionType funcType = func.getFunctionType();
+  for (Type type : llvm::concat<const Type>(funcType.getInputs(),
+                                            funcType.getResults())) {
+    if (isa<ShapedType>(type) && !isa<RankedTensorType>(type))
+      return std::nullopt;
+  }
+  for (auto [idx, type] : llvm::enumerate(funcType.getInputs())) {
+    auto tensorType = dyn_cast<RankedTensorType>(type);
+    if (!tensorType || tensorType.hasStaticShape())
+      continue;
+    for (auto [dim, size] : llvm::enumerate(tensorType.getShape())) {
+      if (ShapedType::isDynamic(size))
+        return DynamicSizePos{static_cast<unsigned>(idx),
+                              static_cast<unsigned>(dim)};
+    }
+  }
+  return std::nullopt;
+}
+
+// Replace the dynamic dimensions of `type` with `bucket`.
+static Type getBucketType(Type type, int64_t bucket) {
+  auto tensorType = dyn_cast<RankedTensorType>(type);
+  if (!tensorType || tensorType.hasStaticShape())
+    return type;
+  SmallVector<int64_t> shape = llvm::to_vector(tensorType.getShape());
+  for (int64_t &size : shape) {
+    if (ShapedType::isDynamic(size))
+      size = bucket;
+  }
+  return tensorType.clone(shape);
+}
+
+// Return true if all the dynamic dimensions of the arguments and results of
+// `func` have the same size. Dimensions are tied through the indexing maps of
+// linalg ops, the inits of destination style ops, casts and the tensor.dim
+// sizes of tensor.empty.
+static bool hasTiedDynamicDims(func::FuncOp func) {
+  using DimRef = std::pair<void *, unsigned>;
+  llvm::EquivalenceClasses<DimRef> dims;
+  auto getDimRef = [](Value value, unsigned dim) {
+    return DimRef(value.getAsOpaquePointer(), dim);
+  };
+  auto getRank = [](Value value) -> unsigned {
+    auto tensorType = dyn_cast<RankedTensorType>(value.getType());
+    return tensorType ? tensorType.getRank() : 0;
+  };
+  auto tieAll = [&](Value lhs, Value rhs) {
+    if (getRank(lhs) != getRank(rhs))
+      return;
+    for (unsigned dim = 0, e = getRank(lhs); dim < e; ++dim)
+      dims.unionSets(getDimRef(lhs, dim), getDimRef(rhs, dim));
+  };
+
+  func.walk([&](Operation *op) {
+    if (auto castOp = dyn_cast<tensor::CastOp>(op))
+      tieAll(castOp.getSource(), castOp.getResult());
+    if (auto dpsOp = dyn_cast<DestinationStyleOpInterface>(op)) {
+      if (dpsOp.hasPureTensorSemantics()) {
+        for (OpResult result : op->getResults())
+          tieAll(result, dpsOp.getTiedOpOperand(result)->get());
+      }
+    }
+    if (auto linalgOp = dyn_cast<linalg::LinalgOp>(op)) {
+      DenseMap<unsigned, DimRef> loopDims;
+      for (OpOperand &operand : op->getOpOperands()) {
+        if (!isa<RankedTensorType>(operand.get().getType()))
+          continue;
+        AffineMap map = linalgOp.getMatchingIndexingMap(&operand);
+        for (auto [dim, expr] : llvm::enumerate(map.getResults())) {
+          auto dimExpr = dyn_cast<AffineDimExpr>(expr);
+          if (!dimExpr)
+            continue;
+          DimRef ref = getDimRef(operand.get(), dim);
+          auto [it, inserted] =
+              loopDims.try_emplace(dimExpr.getPosition(), ref);
+          if (!inserted)
+            dims.unionSets(it->second, ref);
+        }
+      }
+    }
+    if (auto emptyOp = dyn_cast<tensor::EmptyOp>(op)) {
+      RankedTensorType type = emptyOp.getType();
+      for (unsigned dim = 0, e = type.getRank(); dim < e; ++dim) {
+        if (!type.isDynamicDim(dim))
+          continue;
+        auto dimOp = emptyOp.getDynamicSize(dim).getDefiningOp<tensor::DimOp>();
+        std::optional<int64_t> index =
+            dimOp ? getConstantIntValue(dimOp.getIndex()) : std::nullopt;
+        if (index) {
+          dims.unionSets(getDimRef(emptyOp.getResult(), dim),
+                         getDimRef(dimOp.getSource(), *index));
+        }
+      }
+    }
+  });
+
+  SmallVector<DimRef> dynamicDims;
+  auto collectDynamicDims = [&](Value value) {
+    auto tensorType = dyn_cast<RankedTensorType>(value.getType());
+    if (!tensorType)
+      return;
+    for (unsigned dim = 0, e = tensorType.getRank(); dim < e; ++dim) {
+      if (!tensorType.isDynamicDim(dim))
+        continue;
+      dynamicDims.push_back(getDimRef(value, dim));
+      dims.insert(dynamicDims.back());
+    }
+  };
+  for (BlockArgument arg : func.getArguments())
+    collectDynamicDims(arg);
+  for (Value result : func.getBody().front().getTerminator()->getOperands())
+    collectDynamicDims(result);
+  return llvm::all_of(dynamicDims, [&](const DimRef &dim) {
+    return dims.getLeaderValue(dim) ==
+           dims.getLeaderValue(dynamicDims.front());
+  });
+}
+
+// Propagate the static shapes of the arguments through the body. Only the
+// patterns folding casts and dims into static shapes run, the rest of the body
+// is left as is for the pipeline.
+static void propagateStaticShapes(func::FuncOp func) {
+  MLIRContext *ctx = func.getContext();
+  RewritePatternSet patterns(ctx);
+  tensor::CastOp::getCanonicalizationPatterns(patterns, ctx);
+  tensor::DimOp::getCanonicalizationPatterns(patterns, ctx);
+  tensor::EmptyOp::getCanonicalizationPatterns(patterns, ctx);
+  tensor::ExtractSliceOp::getCanonicalizationPatterns(patterns, ctx);
+  tensor::InsertSliceOp::getCanonicalizationPatterns(patterns, ctx);
+  // Static shape inference of the linalg operands.
+  if (Dialect *linalgDialect = ctx->getLoadedDialect<linalg::LinalgDialect>())
+    linalgDialect->getCanonicalizationPatterns(patterns);
+  (void)applyPatternsAndFoldGreedily(func, std::move(patterns));
+}
+
+FailureOr<func::FuncOp> mlir::tpp::createShapeBucketVersion(
+    RewriterBase &rewriter, func::FuncOp func, int64_t bucket) {
+  if (bucket <= 0 || !getDynamicSizePos(func) || !hasTiedDynamicDims(func))
+    return failure();
+
+  std::string name = (func.getSymName() + "_b" + Twine(bucket)).str();
+  if (auto version = SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(
+          func, rewriter.getStringAttr(name))) {
+    return version;
+  }
+
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPointAfter(func);
+  auto version = cast<func::FuncOp>(rewriter.clone(*func));
+  version.setSymName(name);
+  version->removeAttr(linalgx::utils::kShapeBuckets);
+  Location loc = version.getLoc();
+
+  // Arguments are passed with the bucket shape and cast back to the original
+  // type, the casts fold away once the shapes are propagated.
+  Block &entry = version.getBody().front();
+  rewriter.setInsertionPointToStart(&entry);
+  for (BlockArgument arg : entry.getArguments()) {
+    Type type = arg.getType();
+    Type bucketType = getBucketType(type, bucket);
+    if (type == bucketType)
+      continue;
+    arg.setType(bucketType);
+    auto castOp = rewriter.create<tensor::CastOp>(loc, type, arg);
+    rewriter.replaceAllUsesExcept(arg, castOp.getResult(), castOp);
+  }
+
+  auto returnOp = cast<func::ReturnOp>(entry.getTerminator());
+  rewriter.setInsertionPoint(returnOp);
+  for (OpOperand &operand : returnOp->getOpOperands()) {
+    Type type = operand.get().getType();
+    Type bucketType = getBucketType(type, bucket);
+    if (type == bucketType)
+      continue;
+    Value castOp = rewriter.create<tensor::CastOp>(loc, bucketType,
+                                                   operand.get());
+    rewriter.modifyOpInPlace(returnOp, [&]() { operand.set(castOp); });
+  }
+  version.setType(rewriter.getFunctionType(entry.getArgumentTypes(),
+                                           returnOp.getOperandTypes()));
+  propagateStaticShapes(version);
+  LLVM_DEBUG(llvm::dbgs() << "Shape bucket version: " << name << "\n");
+  return version;
+}
+
+// Call `callee`, a version for `bucket`, padding the dynamic arguments to the
+// bucket size and slicing the results back to `size`.
+static SmallVector<Value> callBucketVersion(OpBuilder &builder, Location loc,
+                                            func::FuncOp callee, int64_t bucket,
+                                            ValueRange args, Value size,
+                                            TypeRange resultTypes) {
+  SmallVector<Value> operands;
+  for (Value arg : args) {
+    auto bucketType =
+        dyn_cast<RankedTensorType>(getBucketType(arg.getType(), bucket));
+    if (!bucketType || bucketType == arg.getType()) {
+      operands.push_back(arg);
+      continue;
+    }
+    Value zero = builder.create<arith::ConstantOp>(
+        loc, builder.getZeroAttr(bucketType.getElementType()));
+    operands.push_back(tensor::createPadHighOp(bucketType, arg, zero,
+                                               /*nofold=*/false, loc, builder));
+  }
+
+  auto callOp = builder.create<func::CallOp>(loc, callee, operands);
+  SmallVector<Value> results;
+  for (auto [result, type] :
+       llvm::zip_equal(callOp.getResults(), resultTypes)) {
+    auto tensorType = dyn_cast<RankedTensorType>(type);
+    if (!tensorType || tensorType.hasStaticShape()) {
+      results.push_back(result);
+      continue;
+    }
+    SmallVector<OpFoldResult> offsets(tensorType.getRank(),
+                                      builder.getIndexAttr(0));
+    SmallVector<OpFoldResult> strides(tensorType.getRank(),
+                                      builder.getIndexAttr(1));
+    SmallVector<OpFoldResult> sizes;
+    for (int64_t dimSize : tensorType.getShape()) {
+      sizes.push_back(ShapedType::isDynamic(dimSize)
+                          ? OpFoldResult(size)
+                          : builder.getIndexAttr(dimSize));
+    }
+    results.push_back(builder.create<tensor::ExtractSliceOp>(
+        loc, tensorType, result, offsets, sizes, strides));
+  }
+  return results;
+}
+
+// Emit a chain of scf.if selecting the smallest bucket that fits `size`,
+// falling back to the dynamic kernel.
+static SmallVector<Value> buildDispatch(OpBuilder &builder, Location loc,
+                                        ArrayRef<func::FuncOp> versions,
+                                        ArrayRef<int64_t> buckets,
+                                        func::FuncOp fallback, ValueRange args,
+                                        Value size, TypeRange resultTypes) {
+  if (versions.empty()) {
+    auto callOp = builder.create<func::CallOp>(loc, fallback, args);
+    return llvm::to_vector(callOp.getResults());
+  }
+  Value bucket = builder.create<arith::ConstantIndexOp>(loc, buckets.front());
+  Value fits = builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::ule,
+                                             size, bucket);
+  auto ifOp = builder.create<scf::IfOp>(
+      loc, resultTypes, fits,
+      [&](OpBuilder &b, Location loc) {
+        b.create<scf::YieldOp>(
+            loc, callBucketVersion(b, loc, versions.front(), buckets.front(),
+                                   args, size, resultTypes));
+      },
+      [&](OpBuilder &b, Location loc) {
+        b.create<scf::YieldOp>(
+            loc, buildDispatch(b, loc, versions.drop_front(),
+                               buckets.drop_front(), fallback, args, size,
+                               resultTypes));
+      });
+  return llvm::to_vector(ifOp.getResults());
+}
+
+// Turn `func` into a dispatcher over static versions, one for each bucket.
+static LogicalResult multiVersionKernel(RewriterBase &rewriter,
+                                        func::FuncOp func,
+                                        ArrayRef<int64_t> buckets) {
+  std::optional<DynamicSizePos> sizePos = getDynamicSizePos(func);
+  if (!sizePos)
+    return failure();
+
+  SmallVector<func::FuncOp> versions;
+  for (int64_t bucket : buckets) {
+    FailureOr<func::FuncOp> version =
+        tpp::createShapeBucketVersion(rewriter, func, bucket);
+    if (failed(version))
+      return failure();
+    versions.push_back(*version);
+  }
+
+  // Keep the original kernel for the sizes larger than the biggest bucket.
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPointAfter(func);
+  auto fallback = cast<func::FuncOp>(rewriter.clone(*func));
+  fallback.setSymName((func.getSymName() + "_dynamic").str());
+  fallback->removeAttr(linalgx::utils::kShapeBuckets);
+  func->removeAttr(linalgx::utils::kShapeBuckets);
+
+  // Replace the body with the dispatcher.
+  Location loc = func.getLoc();
+  Block &entry = func.getBody().front();
+  SmallVector<Operation *> toErase;
+  for (Operation &op : llvm::reverse(entry))
+    toErase.push_back(&op);
+  for (Operation *op : toErase)
+    rewriter.eraseOp(op);
+
+  rewriter.setInsertionPointToStart(&entry);
+  ValueRange args = entry.getArguments();
+  Value size = rewriter.create<tensor::DimOp>(loc, args[sizePos->argNumber],
+                                              sizePos->dim);
+  SmallVector<Value> results =
+      buildDispatch(rewriter, loc, versions, buckets, fallback, args, size,
+                    func.getResultTypes());
+  rewriter.create<func::ReturnOp>(loc, results);
+  LLVM_DEBUG(llvm::dbgs() << "Multi-versioned: " << func.getSymName() << "\n");
+  return success();
+}
+
+namespace {
+
+struct ShapeBucketing : public tpp::impl::ShapeBucketingBase<ShapeBucketing> {
+  using ShapeBucketingBase::ShapeBucketingBase;
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    SmallVector<int64_t> defaultBuckets = llvm::to_vector(buckets);
+    if (defaultBuckets.empty())
+      defaultBuckets = {1, 8, 32, 128, 256};
+
+    SmallVector<func::FuncOp> funcs;
+    for (auto func : module.getOps<func::FuncOp>()) {
+      if (func->hasAttr(linalgx::utils::kShapeBuckets))
+        funcs.push_back(func);
+    }
+
+    IRRewriter rewriter(&getContext());
+    for (func::FuncOp func : funcs) {
+      SmallVector<int64_t> funcBuckets = defaultBuckets;
+      if (auto attr = func->getAttrOfType<DenseI64ArrayAttr>(
+              linalgx::utils::kShapeBuckets)) {
+        funcBuckets = llvm::to_vector(attr.asArrayRef());
+      }
+      // Smallest bucket first.
+      llvm::sort(funcBuckets);
+      funcBuckets.erase(std::unique(funcBuckets.begin(), funcBuckets.end()),
+                        funcBuckets.end());
+      if (llvm::any_of(funcBuckets,
+                       [](int64_t bucket) { return bucket <= 0; })) {
+        func.emitError("expect positive shape buckets");
+        return signalPassFailure();
+      }
+      if (getDynamicSizePos(func) && !hasTiedDynamicDims(func)) {
+        func.emitError("expect all the dynamic dimensions to have the same "
+                       "size");
+        return signalPassFailure();
+      }
+      if (failed(multiVersionKernel(rewriter, func, funcBuckets))) {
+        func.emitError("expect tensor arguments with a dynamic dimension "
+                       "and a single block body");
+        return signalPassFailure();
+      }
+    }
+  }
+};
+
+} // namespace
@@ -0,0 +1,145 @@
+//===- ThreadLocalScratch.cpp ------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements hoisting of per-iteration scratch buffers out of
+// OpenMP worksharing loops into the enclosing parallel region.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Passes.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/OpenMP/OpenMPDialect.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/Support/Debug.h"
+
+using namespace mlir;
+
+#define DEBUG_TYPE "thread-local-scratch"
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_THREADLOCALSCRATCH
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+namespace {
+
+// Return the op, directly nested in the body of `parallelOp`, that contains
+// `loopNest`. Only loop wrappers and alloca scopes are allowed in between, as
+// they execute exactly once per thread. Return nullptr otherwise.
+static Operation *getThreadLevelAncestor(omp::ParallelOp parallelOp,
+                                         omp::LoopNestOp loopNest) {
+  Operation *current = loopNest->getParentOp();
+  while (current && current->getParentOp() != parallelOp.getOperation()) {
+    if (!isa<omp::WsloopOp, memref::AllocaScopeOp>(current))
+      return nullptr;
+    current = current->getParentOp();
+  }
+  if (!current || !isa<omp::WsloopOp, memref::AllocaScopeOp>(current))
+    return nullptr;
+  return current;
+}
+
+// An allocation is a scratch buffer if it has a static shape and it is
+// released in the same block it is allocated. The buffer must not be
+// deallocated anywhere else, otherwise hoisting would change its lifetime.
+static bool isScratchBuffer(memref::AllocOp alloc,
+                            SmallVectorImpl<memref::DeallocOp> &deallocs) {
+  if (!alloc.getType().hasStaticShape() || !alloc.getSymbolOperands().empty())
+    return false;
+  for (Operation *user : alloc->getUsers()) {
+    auto dealloc = dyn_cast<memref::DeallocOp>(user);
+    if (!dealloc)
+      continue;
+    if (dealloc->getBlock() != alloc->getBlock())
+      return false;
+    deallocs.push_back(dealloc);
+  }
+  return !deallocs.empty();
+}
+
+// Give each thread a private scratch buffer for the tiles allocated inside
+// a worksharing loop. The loop body of `omp.loop_nest` runs once per
+// iteration, while the body of `omp.parallel` runs once per thread. Moving
+// the allocation into the parallel region, right before the worksharing loop,
+// allocates the buffer once per thread instead of once per iteration.
+//
+// Before:
+//   omp.parallel {
+//     omp.wsloop {
+//       omp.loop_nest (%i) : index = (%lb) to (%ub) step (%step) {
+//         memref.alloca_scope {
+//           %tile = memref.alloc() : memref<32x32xf32>
+//           ...
+//           memref.dealloc %tile : memref<32x32xf32>
+//         }
+//         omp.yield
+//       }
+//     }
+//     omp.terminator
+//   }
+//
+// After:
+//   omp.parallel {
+//     %tile = memref.alloc() : memref<32x32xf32>
+//     omp.wsloop {
+//       omp.loop_nest (%i) : index = (%lb) to (%ub) step (%step) {
+//         memref.alloca_scope {
+//           ...
+//         }
+//         omp.yield
+//       }
+//     }
+//     memref.dealloc %tile : memref<32x32xf32>
+//     omp.terminator
+//   }
+static void hoistScratchBuffers(omp::LoopNestOp loopNest) {
+  auto parallelOp = loopNest->getParentOfType<omp::ParallelOp>();
+  if (!parallelOp)
+    return;
+  Operation *threadLevelOp = getThreadLevelAncestor(parallelOp, loopNest);
+  if (!threadLevelOp)
+    return;
+
+  // Only consider allocations executed once per iteration, i.e., directly
+  // nested in the loop body or in its alloca scope. Allocations in nested
+  // sequential loops are left to regular hoisting.
+  SmallVector<memref::AllocOp> allocs;
+  loopNest->walk([&](memref::AllocOp alloc) {
+    Operation *parent = alloc->getParentOp();
+    while (parent != loopNest.getOperation() &&
+           isa<memref::AllocaScopeOp>(parent))
+      parent = parent->getParentOp();
+    if (parent == loopNest.getOperation())
+      allocs.push_back(alloc);
+  });
+
+  for (memref::AllocOp alloc : allocs) {
+    SmallVector<memref::DeallocOp> deallocs;
+    if (!isScratchBuffer(alloc, deallocs))
+      continue;
+
+    LLVM_DEBUG(llvm::dbgs() << "Hoisting scratch buffer: " << alloc << "\n");
+    alloc->moveBefore(threadLevelOp);
+    deallocs.front()->moveAfter(threadLevelOp);
+    for (memref::DeallocOp dealloc : llvm::drop_begin(deallocs))
+      dealloc->erase();
+  }
+}
+
+struct ThreadLocalScratch
+    : public tpp::impl::ThreadLocalScratchBase<ThreadLocalScratch> {
+  void runOnOperation() override {
+    getOperation()->walk(
+        [](omp::LoopNestOp loopNest) { hoistScratchBuffers(loopNest); });
+  }
+};
+
+} // namespace
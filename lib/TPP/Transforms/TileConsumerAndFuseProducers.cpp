@@ -9,13 +9,19 @@
 #include "TPP/Passes.h"
 #include "TPP/Transforms/Transforms.h"
 #include "TPP/Transforms/Utils/TransformUtils.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/Utils/Utils.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Transforms/TilingInterfaceImpl.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
+#include "mlir/Dialect/SCF/Transforms/Transforms.h"
+#include "mlir/Dialect/SCF/Utils/AffineCanonicalizationUtils.h"
 #include "mlir/Dialect/Tensor/Transforms/Transforms.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/IRMapping.h"
 #include "mlir/Interfaces/DestinationStyleOpInterface.h"
 #include "mlir/Interfaces/TilingInterface.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -316,6 +322,22 @@ bool hasAllUsersInWorklist(Operation *op,
   return true;
 }
 
+// Return true if `producer` is a pack that can be fused into the tiled loops
+// through `operand`. The pack is recomputed per tile, so only packs feeding an
+// input of a contraction are considered, and only if they do not pad: a padded
+// pack cannot be sliced along the outer dimensions.
+static bool isFusablePack(OpOperand &operand, Operation *producer) {
+  auto packOp = dyn_cast_or_null<tensor::PackOp>(producer);
+  if (!packOp || packOp.getPaddingValue())
+    return false;
+  auto linalgOp = dyn_cast<linalg::LinalgOp>(operand.getOwner());
+  if (!linalgOp || !linalgOp.isDpsInput(&operand) ||
+      failed(linalgx::utils::isContraction(linalgOp))) {
+    return false;
+  }
+  return packOp->getResult(0).hasOneUse();
+}
+
 void incDepthAndSwap(std::queue<Operation *> &frontier,
                      std::queue<Operation *> &nextFrontier, int64_t &depth) {
   if (frontier.empty() && !nextFrontier.empty()) {
@@ -329,7 +351,8 @@ void incDepthAndSwap(std::queue<Operation *> &frontier,
 static llvm::SmallDenseSet<Operation *> collectFusableProducers(
     TilingInterface rootConsumer,
     llvm::DenseMap<Operation *, SmallVector<OpFoldResult>> &tileSizes,
-    const llvm::SmallDenseSet<Operation *> &alreadyFusedOps, int64_t maxDepth) {
+    const llvm::SmallDenseSet<Operation *> &alreadyFusedOps, int64_t maxDepth,
+    bool fusePacks) {
   if (alreadyFusedOps.count(rootConsumer.getOperation()))
     return {};
 
@@ -360,6 +383,15 @@ static llvm::SmallDenseSet<Operation *> collectFusableProducers(
         worklist.insert(producer);
         continue;
       }
+      // Packs are fused as leaves: their producers are not part of the
+      // fusion domain.
+      if (fusePacks && !worklist.count(producer) &&
+          isFusablePack(operand, producer)) {
+        LLVM_DEBUG(llvm::dbgs()
+                   << "WORKLIST INSERT PACK: " << producer << "\n");
+        worklist.insert(producer);
+        continue;
+      }
       if (producer && isa<TilingInterface>(producer) &&
           !worklist.count(producer) && producer->getNumResults() == 1 &&
           !alreadyFusedOps.count(producer) &&
@@ -384,7 +416,7 @@ static FailureOr<scf::SCFTileAndFuseResult> fuseWithEltwise(
     RewriterBase &rewriter, TilingInterface consumer,
     llvm::DenseMap<Operation *, SmallVector<OpFoldResult>> &tileSizes,
     llvm::SmallDenseSet<Operation *> &alreadyFusedOps, int64_t maxDepth,
-    int64_t minTileFactor) {
+    int64_t minTileFactor, bool fusePacks) {
   // Step 0. Early exit if tileSizes are empty.
   if (tileSizes.empty() || !tileSizes.count(consumer)) {
     LLVM_DEBUG(llvm::dbgs() << "EMPTY TILE SIZES\n");
@@ -408,7 +440,8 @@ static FailureOr<scf::SCFTileAndFuseResult> fuseWithEltwise(
 
   // Step 3. Collect the operations that can be tiled and fused.
   llvm::SmallDenseSet<Operation *> worklist =
-      collectFusableProducers(consumer, tileSizes, alreadyFusedOps, maxDepth);
+      collectFusableProducers(consumer, tileSizes, alreadyFusedOps, maxDepth,
+                              fusePacks);
   LLVM_DEBUG(llvm::dbgs() << "#WORKLIST: " << worklist.size() << "\n");
   if (worklist.size() < 1)
     return failure();
@@ -617,10 +650,123 @@ static Operation *getLastFusableEltWiseConsumer(
   return currentConsumer;
 }
 
+// Simplify the affine.min/max ops computing the tile sizes of `loopOp` once
+// the dimension with induction variable `iv` is peeled at `ub`.
+static void simplifyPeeledMinMaxOps(RewriterBase &rewriter, Operation *loopOp,
+                                    Value iv, Value ub, Value step,
+                                    bool insideLoop) {
+  SmallVector<Operation *> minMaxOps;
+  loopOp->walk([&](Operation *op) {
+    if (isa<affine::AffineMinOp, affine::AffineMaxOp>(op))
+      minMaxOps.push_back(op);
+  });
+  for (Operation *op : minMaxOps)
+    (void)scf::rewritePeeledMinMaxOp(rewriter, op, iv, ub, step, insideLoop);
+}
+
+// Split the dimension `dim` of `forallOp` into a loop over the full tiles
+// followed by a loop over the last partial tile. The remainder loop carries
+// the results of the main one.
+static LogicalResult peelForallDim(RewriterBase &rewriter,
+                                   scf::ForallOp forallOp, unsigned dim,
+                                   scf::ForallOp &mainLoop,
+                                   scf::ForallOp &remainderLoop) {
+  SmallVector<OpFoldResult> lbs = forallOp.getMixedLowerBound();
+  SmallVector<OpFoldResult> ubs = forallOp.getMixedUpperBound();
+  SmallVector<OpFoldResult> steps = forallOp.getMixedStep();
+  std::optional<int64_t> step = getConstantIntValue(steps[dim]);
+  if (getConstantIntValue(ubs[dim]) || !step)
+    return failure();
+
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(forallOp);
+  Location loc = forallOp.getLoc();
+  AffineExpr lb, ub;
+  bindSymbols(rewriter.getContext(), lb, ub);
+  OpFoldResult splitBound = affine::makeComposedFoldedAffineApply(
+      rewriter, loc, (ub - lb).floorDiv(*step) * *step + lb,
+      {lbs[dim], ubs[dim]});
+  Value ubValue = getValueOrCreateConstantIndexOp(rewriter, loc, ubs[dim]);
+  Value stepValue = getValueOrCreateConstantIndexOp(rewriter, loc, steps[dim]);
+
+  SmallVector<OpFoldResult> mainUbs = ubs;
+  mainUbs[dim] = splitBound;
+  mainLoop = rewriter.create<scf::ForallOp>(loc, lbs, mainUbs, steps,
+                                            forallOp.getOutputs(),
+                                            forallOp.getMapping());
+  rewriter.eraseOp(mainLoop.getTerminator());
+  IRMapping mapping;
+  mapping.map(forallOp.getBody()->getArguments(),
+              mainLoop.getBody()->getArguments());
+  rewriter.setInsertionPointToEnd(mainLoop.getBody());
+  for (Operation &op : forallOp.getBody()->getOperations())
+    rewriter.clone(op, mapping);
+
+  SmallVector<OpFoldResult> remainderLbs = lbs;
+  remainderLbs[dim] = splitBound;
+  rewriter.setInsertionPoint(forallOp);
+  remainderLoop = rewriter.create<scf::ForallOp>(
+      loc, remainderLbs, ubs, steps, mainLoop.getResults(),
+      forallOp.getMapping());
+  rewriter.eraseOp(remainderLoop.getTerminator());
+  rewriter.mergeBlocks(forallOp.getBody(), remainderLoop.getBody(),
+                       remainderLoop.getBody()->getArguments());
+  rewriter.replaceOp(forallOp, remainderLoop.getResults());
+
+  simplifyPeeledMinMaxOps(rewriter, mainLoop, mainLoop.getInductionVar(dim),
+                          ubValue, stepValue, /*insideLoop=*/true);
+  simplifyPeeledMinMaxOps(rewriter, remainderLoop,
+                          remainderLoop.getInductionVar(dim), ubValue,
+                          stepValue, /*insideLoop=*/false);
+  return success();
+}
+
+// Peel the dynamic dimensions of `forallOp` starting from `dim`. Each peeled
+// dimension doubles the number of loops, one per combination of full and
+// partial tiles.
+static void peelDynamicForall(RewriterBase &rewriter, scf::ForallOp forallOp,
+                              unsigned dim) {
+  for (; dim < forallOp.getRank(); dim++) {
+    scf::ForallOp mainLoop, remainderLoop;
+    if (failed(peelForallDim(rewriter, forallOp, dim, mainLoop,
+                             remainderLoop))) {
+      continue;
+    }
+    LLVM_DEBUG(llvm::dbgs() << "PEELED DYNAMIC FORALL: " << mainLoop << "\n");
+    peelDynamicForall(rewriter, mainLoop, dim + 1);
+    peelDynamicForall(rewriter, remainderLoop, dim + 1);
+    return;
+  }
+}
+
+// Peel the last partial tile of the loops with a dynamic trip count. The
+// main loop then only works on full tiles of static shape, which take a
+// static dispatch hoisted out of the loops, while the remainder is left with
+// a dynamic one. Both scf.for and scf.forall tile loops are handled.
+static void peelDynamicLoops(RewriterBase &rewriter,
+                             ArrayRef<Operation *> loops) {
+  for (Operation *loop : loops) {
+    if (auto forallOp = dyn_cast<scf::ForallOp>(loop)) {
+      peelDynamicForall(rewriter, forallOp, /*dim=*/0);
+      continue;
+    }
+    auto forOp = dyn_cast<scf::ForOp>(loop);
+    if (!forOp || getConstantIntValue(forOp.getUpperBound()) ||
+        !getConstantIntValue(forOp.getStep())) {
+      continue;
+    }
+    scf::ForOp partialIteration;
+    if (succeeded(scf::peelForLoopAndSimplifyBounds(rewriter, forOp,
+                                                    partialIteration))) {
+      LLVM_DEBUG(llvm::dbgs() << "PEELED DYNAMIC LOOP: " << forOp << "\n");
+    }
+  }
+}
+
 // Run `fuseWithEltwise` on contraction-like operations.
 static void doFusion(RewriterBase &rewriter, func::FuncOp func,
                      ArrayRef<int64_t> tileSizes, int64_t maxDepth,
-                     int64_t minTileFactor) {
+                     int64_t minTileFactor, bool fusePacks) {
   // Set to keep track of fused ops.
   llvm::SmallDenseSet<Operation *> fusedOps;
 
@@ -677,12 +823,14 @@ static void doFusion(RewriterBase &rewriter, func::FuncOp func,
       LLVM_DEBUG(llvm::dbgs() << "\n\n");
       FailureOr<scf::SCFTileAndFuseResult> fuseAndTileResult =
           fuseWithEltwise(rewriter, cast<TilingInterface>(linalgOp),
-                          defaultTiles, fusedOps, maxDepth, minTileFactor);
+                          defaultTiles, fusedOps, maxDepth, minTileFactor,
+                          fusePacks);
       LLVM_DEBUG(llvm::dbgs() << "\n\n");
       if (succeeded(fuseAndTileResult)) {
         rewriter.replaceOp(
             linalgOp,
             (*fuseAndTileResult).replacements[linalgOp->getResults()[0]]);
+        peelDynamicLoops(rewriter, fuseAndTileResult->loops);
       }
     }
   }
@@ -708,7 +856,7 @@ struct TileConsumerAndFuseProducers
       func::FuncOp func = getOperation();
       IRRewriter rewriter(&getContext());
       doFusion(rewriter, func, this->tileSizes, this->maxDepth,
-               this->minTileFactor);
+               this->minTileFactor, this->fusePacks);
 
       {
         RewritePatternSet patterns(&ctx);
@@ -232,6 +232,13 @@ packConvolutions(RewriterBase &rewriter, OpTy convOp,
     strides[0] = strideValues[0];
     strides[1] = strideValues[1];
   }
+  SmallVector<int64_t, 2> dilations = {1, 1};
+  if (DenseIntElementsAttr dilationsAttr = convOp.getDilations()) {
+    auto dilationValues = dilationsAttr.getValues<int64_t>();
+    assert(dilationValues.size() == 2 && "expect two dilation values");
+    dilations[0] = dilationValues[0];
+    dilations[1] = dilationValues[1];
+  }
 
   // Swap convolution with generic.
   //         N   K   P   Q   k   C   R   S   c
@@ -241,7 +248,9 @@ packConvolutions(RewriterBase &rewriter, OpTy convOp,
       AffineMap::get(/*dims=*/9, /*symbols=*/0, {p1, p2, p3, p4, p5}, ctx);
   AffineMap mapImg = AffineMap::get(
       /*dims=*/9, /*symbols=*/0,
-      {p1, r1, p3 * strides[0] + r2, p4 * strides[1] + r3, r4}, ctx);
+      {p1, r1, p3 * strides[0] + r2 * dilations[0],
+       p4 * strides[1] + r3 * dilations[1], r4},
+      ctx);
   AffineMap mapFil =
       AffineMap::get(/*dims=*/9, /*symbols=*/0, {p2, r1, r2, r3, r4, p5}, ctx);
   linalg::GenericOp replacementOp = rewriter.create<linalg::GenericOp>(
@@ -484,6 +493,10 @@ struct PackMatmul : public tpp::impl::PackMatmulBase<PackMatmul> {
         return std::nullopt;
       }
 
+      // Blocking does not pay off on small per-batch products.
+      if (linalgx::utils::isSmallBatchMatmul(linalgOp, smallGemmSize))
+        return std::nullopt;
+
       // Enforce user defined blocking factors or use defaults.
       if (!blockingFactors.empty()) {
         SmallVector<int64_t, 3> blockFactors{*blockingFactors};
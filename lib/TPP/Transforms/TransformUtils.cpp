@@ -93,9 +93,28 @@ getInvolvedLocalDimsForOperand(OpBuilder &builder, Location loc,
           affine::makeComposedAffineApply(builder, loc, resMap,
                                           getAsOpFoldResult(touchedIvs))
               .getResult());
-    } else
-      // single dimension touched just return it.
-      ivsResult.push_back(touchedIvs[0]);
+    } else {
+      // single dimension touched, possibly with a multiplicative factor
+      // (i.e., dilation) or combined with non-local dimensions (i.e., the
+      // strided window). The non-local dimensions start at zero.
+      SmallVector<AffineExpr> dimReplacements;
+      for (unsigned pos = 0, e = mapOperand.getNumDims(); pos < e; pos++) {
+        dimReplacements.push_back(pos < localIvs.size()
+                                      ? builder.getAffineDimExpr(pos)
+                                      : builder.getAffineConstantExpr(0));
+      }
+      AffineExpr localExpr = results[idx].replaceDims(dimReplacements);
+      if (auto dimExpr = dyn_cast<AffineDimExpr>(localExpr)) {
+        ivsResult.push_back(localIvs[dimExpr.getPosition()]);
+        continue;
+      }
+      AffineMap localMap =
+          AffineMap::get(localIvs.size(), /*symbolCount=*/0, localExpr);
+      ivsResult.push_back(
+          affine::makeComposedAffineApply(builder, loc, localMap,
+                                          getAsOpFoldResult(localIvs))
+              .getResult());
+    }
   }
   return ivsResult;
 }
@@ -346,6 +365,18 @@ bool validateFullTilesOnDims(TilingInterface tileOp,
   return true;
 }
 
+bool isSmallBatchMatmul(linalg::LinalgOp linalgOp, int64_t maxSize) {
+  if (maxSize <= 0 || !isa<linalg::BatchMatmulOp>(linalgOp))
+    return false;
+  // Loops are (b, m, n, k), the batch size does not matter.
+  SmallVector<int64_t> loopRanges = linalgOp.getStaticLoopRanges();
+  return llvm::all_of(ArrayRef<int64_t>(loopRanges).drop_front(),
+                      [&](int64_t range) {
+                        return !ShapedType::isDynamic(range) &&
+                               range <= maxSize;
+                      });
+}
+
 namespace {
 
 // Convert scf.for to scf.forall after fusion.
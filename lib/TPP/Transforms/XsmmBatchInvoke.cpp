@@ -0,0 +1,221 @@
+//===- XsmmBatchInvoke.cpp ---------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the batching of the XSMM gemm and brgemm invocations
+// issued by the iterations of a loop into a single runtime call.
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Dialect/Xsmm/XsmmOps.h"
+#include "TPP/Passes.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_XSMMBATCHINVOKE
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+using namespace mlir;
+
+namespace {
+
+// Return true if `value` is the same for all the iterations of `forOp`.
+static bool isLoopInvariant(scf::ForOp forOp, Value value) {
+  return forOp.isDefinedOutsideOfLoop(value) ||
+         matchPattern(value, m_Constant());
+}
+
+// Return true if `value` is a linear function of the induction variable of
+// `forOp`.
+static bool isLinearInIv(scf::ForOp forOp, Value value) {
+  if (isLoopInvariant(forOp, value) || value == forOp.getInductionVar())
+    return true;
+  Operation *op = value.getDefiningOp();
+  if (!op)
+    return false;
+
+  if (isa<arith::AddIOp, arith::SubIOp>(op)) {
+    return llvm::all_of(op->getOperands(), [&](Value operand) {
+      return isLinearInIv(forOp, operand);
+    });
+  }
+  if (isa<arith::MulIOp>(op)) {
+    Value lhs = op->getOperand(0);
+    Value rhs = op->getOperand(1);
+    return (isLoopInvariant(forOp, lhs) && isLinearInIv(forOp, rhs)) ||
+           (isLoopInvariant(forOp, rhs) && isLinearInIv(forOp, lhs));
+  }
+  if (auto applyOp = dyn_cast<affine::AffineApplyOp>(op)) {
+    AffineMap map = applyOp.getAffineMap();
+    bool isLinear = true;
+    map.getResult(0).walk([&](AffineExpr expr) {
+      if (expr.getKind() == AffineExprKind::Mod ||
+          expr.getKind() == AffineExprKind::FloorDiv ||
+          expr.getKind() == AffineExprKind::CeilDiv)
+        isLinear = false;
+    });
+    if (!isLinear)
+      return false;
+    // Symbols can multiply dimensions, they must be invariant.
+    for (auto [idx, operand] : llvm::enumerate(applyOp.getMapOperands())) {
+      if (idx < map.getNumDims() ? !isLinearInIv(forOp, operand)
+                                 : !isLoopInvariant(forOp, operand))
+        return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+// Return true if `memref` is a buffer defined outside of `forOp` or a view of
+// it whose offset is a linear function of the induction variable.
+static bool isLinearView(scf::ForOp forOp, Value memref) {
+  if (forOp.isDefinedOutsideOfLoop(memref))
+    return true;
+  auto subview = memref.getDefiningOp<memref::SubViewOp>();
+  if (!subview || !isLinearView(forOp, subview.getSource()))
+    return false;
+  auto isInvariant = [&](Value value) {
+    return isLoopInvariant(forOp, value);
+  };
+  auto isLinear = [&](Value value) { return isLinearInIv(forOp, value); };
+  return llvm::all_of(subview.getOffsets(), isLinear) &&
+         llvm::all_of(subview.getSizes(), isInvariant) &&
+         llvm::all_of(subview.getStrides(), isInvariant);
+}
+
+// Return the gemm or brgemm invocation of `forOp` if the loop can be replaced
+// by a batched invocation, nullptr otherwise.
+static Operation *getBatchableInvoke(scf::ForOp forOp) {
+  if (forOp.getNumResults() != 0 ||
+      !forOp.getInductionVar().getType().isIndex())
+    return nullptr;
+
+  // A single trip does not need a batch.
+  std::optional<int64_t> lb = getConstantIntValue(forOp.getLowerBound());
+  std::optional<int64_t> ub = getConstantIntValue(forOp.getUpperBound());
+  std::optional<int64_t> step = getConstantIntValue(forOp.getStep());
+  if (lb && ub && step && *ub - *lb <= *step)
+    return nullptr;
+
+  // The body must only compute the operands of the invocation.
+  Operation *invoke = nullptr;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    if (isa<xsmm::GemmOp, xsmm::BrgemmOp>(op)) {
+      if (invoke)
+        return nullptr;
+      invoke = &op;
+      continue;
+    }
+    if (op.getNumRegions() != 0 || !isMemoryEffectFree(&op))
+      return nullptr;
+  }
+  if (!invoke)
+    return nullptr;
+
+  // The kernel must be the same for all the iterations and the operands must
+  // move by a constant stride.
+  if (!forOp.isDefinedOutsideOfLoop(invoke->getOperand(0)))
+    return nullptr;
+  if (auto brgemmOp = dyn_cast<xsmm::BrgemmOp>(invoke);
+      brgemmOp && !isLoopInvariant(forOp, brgemmOp.getBatch()))
+    return nullptr;
+  for (Value operand : invoke->getOperands().slice(1, 3)) {
+    if (!isLinearView(forOp, operand))
+      return nullptr;
+  }
+  return invoke;
+}
+
+// Replace `forOp` by a single batched invocation of `invoke`.
+static void batchInvokes(scf::ForOp forOp, Operation *invoke) {
+  OpBuilder builder(forOp);
+  Location loc = forOp.getLoc();
+  Value lb = forOp.getLowerBound();
+  Value step = forOp.getStep();
+
+  // Materialize the operands of the first two iterations before the loop.
+  auto cloneBodyAt = [&](Value iv) {
+    IRMapping mapping;
+    mapping.map(forOp.getInductionVar(), iv);
+    for (Operation &op : forOp.getBody()->without_terminator()) {
+      if (&op != invoke)
+        builder.clone(op, mapping);
+    }
+    return mapping;
+  };
+  IRMapping first = cloneBodyAt(lb);
+  IRMapping second =
+      cloneBodyAt(builder.create<arith::AddIOp>(loc, lb, step));
+
+  Type i64Type = builder.getI64Type();
+  auto toI64 = [&](Value value) -> Value {
+    return builder.create<arith::IndexCastOp>(loc, i64Type, value);
+  };
+
+  // The stride of each operand is the distance between the first two
+  // iterations, in elements.
+  SmallVector<Value> inputs{invoke->getOperand(0)};
+  SmallVector<Value> strides;
+  for (Value operand : invoke->getOperands().slice(1, 3)) {
+    Value firstView = first.lookupOrDefault(operand);
+    Value secondView = second.lookupOrDefault(operand);
+    auto firstMeta =
+        builder.create<memref::ExtractStridedMetadataOp>(loc, firstView);
+    auto secondMeta =
+        builder.create<memref::ExtractStridedMetadataOp>(loc, secondView);
+    inputs.push_back(firstView);
+    strides.push_back(toI64(builder.create<arith::SubIOp>(
+        loc, secondMeta.getOffset(), firstMeta.getOffset())));
+  }
+  Value tripCount = builder.create<arith::CeilDivSIOp>(
+      loc, builder.create<arith::SubIOp>(loc, forOp.getUpperBound(), lb),
+      step);
+  inputs.push_back(toI64(tripCount));
+  inputs.append(strides);
+
+  xsmm::DataTypeAttr dataType;
+  if (auto brgemmOp = dyn_cast<xsmm::BrgemmOp>(invoke)) {
+    inputs.push_back(first.lookupOrDefault(brgemmOp.getBatch()));
+    dataType = brgemmOp.getDataTypeAttr();
+  } else {
+    dataType = cast<xsmm::GemmOp>(invoke).getDataTypeAttr();
+  }
+  builder.create<xsmm::GemmBatchOp>(loc, dataType, inputs);
+  forOp.erase();
+}
+
+struct XsmmBatchInvoke
+    : public tpp::impl::XsmmBatchInvokeBase<XsmmBatchInvoke> {
+  using XsmmBatchInvokeBase::XsmmBatchInvokeBase;
+
+  void runOnOperation() override {
+    // Only the innermost loop of a nest is batched, the batched invocation
+    // prevents the enclosing loops from being batched in turn.
+    SmallVector<std::pair<scf::ForOp, Operation *>> candidates;
+    getOperation()->walk([&](scf::ForOp forOp) {
+      if (Operation *invoke = getBatchableInvoke(forOp))
+        candidates.emplace_back(forOp, invoke);
+    });
+    for (auto [forOp, invoke] : candidates)
+      batchInvokes(forOp, invoke);
+    numBatched += candidates.size();
+  }
+};
+
+} // namespace
@@ -0,0 +1,121 @@
+//===- XsmmGlobalDispatch.cpp ------------------------------------*- C++-*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "TPP/Dialect/Xsmm/XsmmOps.h"
+#include "TPP/Passes.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/SymbolTable.h"
+#include "llvm/ADT/MapVector.h"
+
+namespace mlir {
+namespace tpp {
+#define GEN_PASS_DEF_XSMMGLOBALDISPATCH
+#include "TPP/Passes.h.inc"
+} // namespace tpp
+} // namespace mlir
+
+using namespace mlir;
+
+namespace {
+
+// Return true if the operation dispatches an XSMM kernel which is fully
+// described by its attributes.
+static bool isStaticDispatch(Operation *op) {
+  return isa<xsmm::GemmDispatchOp, xsmm::BrgemmDispatchOp,
+             xsmm::FusedBrgemmDispatchOp, xsmm::BrgemmOffsDispatchOp,
+             xsmm::BrgemmAddrDispatchOp, xsmm::UnaryDispatchOp,
+             xsmm::BinaryDispatchOp, xsmm::NormDispatchOp,
+             xsmm::IntelAMXTileConfigDispatchOp>(op) &&
+         op->getNumOperands() == 0;
+}
+
+struct XsmmGlobalDispatch
+    : public tpp::impl::XsmmGlobalDispatchBase<XsmmGlobalDispatch> {
+  using XsmmGlobalDispatchBase::XsmmGlobalDispatchBase;
+
+  void runOnOperation() override {
+    ModuleOp module = getOperation();
+    MLIRContext *ctx = &getContext();
+
+    // Group the dispatches by kernel. The operation name and its attributes
+    // uniquely identify the kernel.
+    using KernelKey = std::pair<OperationName, DictionaryAttr>;
+    llvm::MapVector<KernelKey, SmallVector<Operation *>> kernels;
+    for (auto funcOp : module.getOps<func::FuncOp>()) {
+      funcOp.walk([&](Operation *op) {
+        if (!isStaticDispatch(op))
+          return;
+        // The handle cannot be passed into isolated regions.
+        if (op->getParentWithTrait<OpTrait::IsIsolatedFromAbove>() != funcOp)
+          return;
+        kernels[{op->getName(), op->getAttrDictionary()}].push_back(op);
+      });
+    }
+    numKernels = kernels.size();
+    if (kernels.empty())
+      return;
+
+    SymbolTable symbolTable(module);
+    OpBuilder builder(ctx);
+    Location loc = module.getLoc();
+    Type i64Type = builder.getI64Type();
+
+    // Create a module constructor which dispatches all the kernels once.
+    builder.setInsertionPointToEnd(module.getBody());
+    auto initFunc = builder.create<LLVM::LLVMFuncOp>(
+        loc, "__xsmm_dispatch_kernels",
+        LLVM::LLVMFunctionType::get(LLVM::LLVMVoidType::get(ctx), {}),
+        LLVM::Linkage::Internal);
+    symbolTable.insert(initFunc);
+    Block *initBlock = builder.createBlock(&initFunc.getBody());
+
+    for (auto [idx, kernel] : llvm::enumerate(kernels)) {
+      ArrayRef<Operation *> dispatches = kernel.second;
+
+      builder.setInsertionPoint(initFunc);
+      auto handleGlobal = builder.create<LLVM::GlobalOp>(
+          loc, i64Type, /*isConstant=*/false, LLVM::Linkage::Internal,
+          "__xsmm_kernel_" + std::to_string(idx),
+          builder.getI64IntegerAttr(0));
+      symbolTable.insert(handleGlobal);
+
+      builder.setInsertionPointToEnd(initBlock);
+      Operation *dispatch = builder.clone(*dispatches.front());
+      Value globalPtr = builder.create<LLVM::AddressOfOp>(loc, handleGlobal);
+      builder.create<LLVM::StoreOp>(loc, dispatch->getResult(0), globalPtr);
+
+      // Load the handle once at the entry of each function using the kernel.
+      DenseMap<Operation *, Value> funcHandles;
+      for (Operation *op : dispatches) {
+        auto funcOp = op->getParentOfType<func::FuncOp>();
+        Value &handle = funcHandles[funcOp];
+        if (!handle) {
+          builder.setInsertionPointToStart(&funcOp.getBody().front());
+          Value ptr = builder.create<LLVM::AddressOfOp>(loc, handleGlobal);
+          handle = builder.create<LLVM::LoadOp>(loc, i64Type, ptr);
+        }
+        op->getResult(0).replaceAllUsesWith(handle);
+        op->erase();
+        ++numDispatches;
+      }
+    }
+
+    builder.setInsertionPointToEnd(initBlock);
+    builder.create<LLVM::ReturnOp>(loc, ValueRange{});
+
+    // Run the dispatches when the module is loaded.
+    builder.setInsertionPointToEnd(module.getBody());
+    builder.create<LLVM::GlobalCtorsOp>(
+        loc, builder.getArrayAttr({FlatSymbolRefAttr::get(initFunc)}),
+        builder.getI32ArrayAttr({65535}));
+  }
+};
+
+} // namespace
@@ -10,8 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <mutex>
 
 #include "PerfRunnerUtils.h"
 
@@ -33,3 +40,172 @@ double perf_stop_timer(int64_t startTimestamp) {
   return std::chrono::duration_cast<std::chrono::duration<double>>(stop - start)
       .count();
 }
+
+//===----------------------------------------------------------------------===//
+// Timeline
+//===----------------------------------------------------------------------===//
+
+std::atomic<bool> perfTimelineEnabled(false);
+
+namespace {
+
+struct TimelineEvent {
+  const char *name;
+  const char *category;
+  const char *argName;
+  int64_t arg;
+  int64_t begin;
+  int64_t end;
+};
+
+// Events kept per thread, the oldest are overwritten past this count.
+const uint64_t timelineCapacity = 1 << 15;
+
+// Ring buffer of the events of one thread. Only the owning thread writes to
+// it, the buffers are read once at exit.
+struct TimelineBuffer {
+  TimelineEvent events[timelineCapacity];
+  std::atomic<uint64_t> head;
+  int64_t tid;
+  TimelineBuffer *next;
+};
+
+// Lock-free list of the thread buffers.
+std::atomic<TimelineBuffer *> timelineBuffers(nullptr);
+std::atomic<int64_t> timelineThreads(0);
+
+TimelineBuffer *getTimelineBuffer() {
+  static thread_local TimelineBuffer *buffer = nullptr;
+  if (buffer)
+    return buffer;
+
+  // Never freed, the buffers are written out by an exit handler.
+  buffer = new TimelineBuffer;
+  buffer->head.store(0, std::memory_order_relaxed);
+  buffer->tid = timelineThreads.fetch_add(1, std::memory_order_relaxed);
+  buffer->next = timelineBuffers.load(std::memory_order_relaxed);
+  while (!timelineBuffers.compare_exchange_weak(buffer->next, buffer,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed))
+    ;
+  return buffer;
+}
+
+const char *getTimelinePath() {
+  const char *path = getenv("TPP_TIMELINE");
+  return path && *path ? path : "timeline.json";
+}
+
+void writeTimeline() {
+  TimelineBuffer *buffers = timelineBuffers.load(std::memory_order_acquire);
+
+  // Timestamps are relative to the first recorded event.
+  int64_t origin = INT64_MAX;
+  for (TimelineBuffer *buffer = buffers; buffer; buffer = buffer->next) {
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t count = std::min(head, timelineCapacity);
+    for (uint64_t i = head - count; i < head; i++)
+      origin = std::min(origin, buffer->events[i % timelineCapacity].begin);
+  }
+
+  const char *path = getTimelinePath();
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    fprintf(stderr, "Cannot write the timeline to %s\n", path);
+    return;
+  }
+  fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+  const char *separator = "\n";
+  for (TimelineBuffer *buffer = buffers; buffer; buffer = buffer->next) {
+    fprintf(file,
+            "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, "
+            "\"tid\": %lld, \"args\": {\"name\": \"thread %lld\"}}",
+            separator, static_cast<long long>(buffer->tid),
+            static_cast<long long>(buffer->tid));
+    separator = ",\n";
+
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t count = std::min(head, timelineCapacity);
+    if (count < head)
+      fprintf(stderr, "Timeline of thread %lld dropped %llu events\n",
+              static_cast<long long>(buffer->tid),
+              static_cast<unsigned long long>(head - count));
+    for (uint64_t i = head - count; i < head; i++) {
+      const TimelineEvent &event = buffer->events[i % timelineCapacity];
+      fprintf(file,
+              "%s{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", "
+              "\"pid\": 0, \"tid\": %lld, \"ts\": %.3f, \"dur\": %.3f",
+              separator, event.name, event.category,
+              static_cast<long long>(buffer->tid),
+              (event.begin - origin) * 1e-3, (event.end - event.begin) * 1e-3);
+      if (event.argName)
+        fprintf(file, ", \"args\": {\"%s\": %lld}", event.argName,
+                static_cast<long long>(event.arg));
+      fprintf(file, "}");
+    }
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+}
+
+// TPP_TIMELINE enables the recording without recompiling, the XSMM
+// invocations are then recorded.
+const bool timelineFromEnv = [] {
+  if (!getenv("TPP_TIMELINE"))
+    return false;
+  perf_timeline_enable();
+  return true;
+}();
+
+} // namespace
+
+int64_t getPerfTimelineTimestamp() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void recordPerfTimelineEvent(const char *name, const char *category,
+                             const char *argName, int64_t arg, int64_t begin,
+                             int64_t end) {
+  TimelineBuffer *buffer = getTimelineBuffer();
+  uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  TimelineEvent &event = buffer->events[head % timelineCapacity];
+  event.name = name;
+  event.category = category;
+  event.argName = argName;
+  event.arg = arg;
+  event.begin = begin;
+  event.end = end;
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void perf_timeline_enable() {
+  static std::once_flag registered;
+  std::call_once(registered, [] { atexit(writeTimeline); });
+  perfTimelineEnabled.store(true, std::memory_order_relaxed);
+}
+
+// The instrumented code enables the recording on its first event.
+int64_t perf_timeline_begin() {
+  if (!isPerfTimelineEnabled())
+    perf_timeline_enable();
+  return getPerfTimelineTimestamp();
+}
+
+void perf_timeline_end(int64_t begin, int64_t kind, int64_t arg) {
+  int64_t end = getPerfTimelineTimestamp();
+  // Kinds of perf::TimelineEndOp.
+  switch (kind) {
+  case 0:
+    recordPerfTimelineEvent("bench_iteration", "perf", nullptr, 0, begin, end);
+    break;
+  case 1:
+    recordPerfTimelineEvent("parallel_iteration", "perf", "index", arg, begin,
+                            end);
+    break;
+  default:
+    recordPerfTimelineEvent("event", "perf", "arg", arg, begin, end);
+    break;
+  }
+}
@@ -15,6 +15,8 @@
 
 #include "mlir/ExecutionEngine/RunnerUtils.h"
 
+#include <atomic>
+
 //===----------------------------------------------------------------------===//
 // Perf dialect utils
 //===----------------------------------------------------------------------===//
@@ -23,4 +25,36 @@ extern "C" MLIR_RUNNERUTILS_EXPORT int64_t perf_start_timer();
 
 extern "C" MLIR_RUNNERUTILS_EXPORT double perf_stop_timer(int64_t);
 
+//===----------------------------------------------------------------------===//
+// Timeline
+//===----------------------------------------------------------------------===//
+
+// Start recording the timeline. The events are written to a Chrome trace file
+// at exit, named by TPP_TIMELINE or `timeline.json` by default.
+extern "C" MLIR_RUNNERUTILS_EXPORT void perf_timeline_enable();
+
+// Return the timestamp at which a timeline event begins.
+extern "C" MLIR_RUNNERUTILS_EXPORT int64_t perf_timeline_begin();
+
+// Record an event of `kind` from `begin` until now.
+extern "C" MLIR_RUNNERUTILS_EXPORT void perf_timeline_end(int64_t begin,
+                                                          int64_t kind,
+                                                          int64_t arg);
+
+// Timeline hooks for the other runtime utils.
+extern std::atomic<bool> perfTimelineEnabled;
+
+inline bool isPerfTimelineEnabled() {
+  return perfTimelineEnabled.load(std::memory_order_relaxed);
+}
+
+// Return the current timestamp of the timeline, in nanoseconds.
+int64_t getPerfTimelineTimestamp();
+
+// Record an event from `begin` to `end` on the timeline of the calling thread.
+// The strings must outlive the runtime and `argName` may be null.
+void recordPerfTimelineEvent(const char *name, const char *category,
+                             const char *argName, int64_t arg, int64_t begin,
+                             int64_t end);
+
 #endif // TPP_EXECUTIONENGINE_PERFRUNNERUTILS_H
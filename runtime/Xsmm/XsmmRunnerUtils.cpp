@@ -13,9 +13,23 @@
 //===----------------------------------------------------------------------===//
 
 #include "XsmmRunnerUtils.h"
+#include "../PerfRunnerUtils.h"
 #include "libxsmm.h" // NOLINT [build/include_subdir]
 #include "libxsmm_utils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
 // Helper function prototypes.
 static void printXsmmStruct(const libxsmm_gemm_shape &gemmShape,
                             FILE *outfile = stderr);
@@ -58,6 +72,28 @@ static bool hasImplicitComputeDtypeUnary(const libxsmm_meltw_unary_type dtype) {
   }
 }
 
+// The direct call lowering in ConvertXsmmToFunc builds the kernel parameters
+// in place, assuming argument structs of four pointers laid out back to back.
+static_assert(sizeof(libxsmm_matrix_arg) == 4 * sizeof(void *) &&
+                  sizeof(libxsmm_matrix_op_arg) == 4 * sizeof(void *) &&
+                  offsetof(libxsmm_matrix_op_arg, tertiary) ==
+                      2 * sizeof(void *),
+              "Unexpected libxsmm argument layout");
+static_assert(offsetof(libxsmm_gemm_param, a) == 4 * sizeof(void *) &&
+                  offsetof(libxsmm_gemm_param, b) == 8 * sizeof(void *) &&
+                  offsetof(libxsmm_gemm_param, c) == 12 * sizeof(void *),
+              "Unexpected libxsmm_gemm_param layout");
+static_assert(offsetof(libxsmm_meltw_unary_param, in) == 4 * sizeof(void *) &&
+                  offsetof(libxsmm_meltw_unary_param, out) ==
+                      8 * sizeof(void *),
+              "Unexpected libxsmm_meltw_unary_param layout");
+static_assert(offsetof(libxsmm_meltw_binary_param, in0) == 4 * sizeof(void *) &&
+                  offsetof(libxsmm_meltw_binary_param, in1) ==
+                      8 * sizeof(void *) &&
+                  offsetof(libxsmm_meltw_binary_param, out) ==
+                      12 * sizeof(void *),
+              "Unexpected libxsmm_meltw_binary_param layout");
+
 namespace {
 
 void *get_base_ptr(const libxsmm_datatype dType, void *alignedPtr,
@@ -74,12 +110,347 @@ void *get_base_ptr(const libxsmm_datatype dType, void *alignedPtr,
   return nullptr;
 }
 
+// Row-wise normalization kernel, see xsmm_norm_dispatch.
+enum NormKind : int64_t { LAYERNORM = 1, RMSNORM = 2 };
+
+struct NormKernel {
+  int64_t kind;
+  libxsmm_datatype dtype;
+  int64_t m;
+  int64_t n;
+  int64_t ldi;
+  int64_t ldo;
+  float epsilon;
+};
+
+float bf16ToFloat(uint16_t value) {
+  uint32_t bits = static_cast<uint32_t>(value) << 16;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+// Round to nearest even, keep NaNs quiet.
+uint16_t floatToBF16(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if ((bits & 0x7fffffff) > 0x7f800000)
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  uint32_t rounding = 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>((bits + rounding) >> 16);
+}
+
+// Sums of (row[j] - shift) and of its square, gathered in a single read of
+// the row. The partial sums are kept in independent lanes so the compiler
+// vectorizes the loop without having to reassociate the additions.
+void rowSums(const float *row, int64_t n, float shift, float &sum,
+             float &sumSq) {
+  constexpr int64_t kLanes = 16;
+  float lanes[kLanes] = {0.0f};
+  float lanesSq[kLanes] = {0.0f};
+  int64_t j = 0;
+  for (; j + kLanes <= n; j += kLanes) {
+    for (int64_t l = 0; l < kLanes; l++) {
+      float value = row[j + l] - shift;
+      lanes[l] += value;
+      lanesSq[l] += value * value;
+    }
+  }
+  sum = 0.0f;
+  sumSq = 0.0f;
+  for (; j < n; j++) {
+    float value = row[j] - shift;
+    sum += value;
+    sumSq += value * value;
+  }
+  for (int64_t l = 0; l < kLanes; l++) {
+    sum += lanes[l];
+    sumSq += lanesSq[l];
+  }
+}
+
+// Normalize one row. Layernorm centers the row on its mean before scaling by
+// the inverse standard deviation, rmsnorm scales by the inverse root mean
+// square. The statistics take one pass over the row and the normalization a
+// second one. Layernorm shifts the row by its first element so the variance,
+// taken as E[x^2] - E[x]^2, does not cancel out on rows with a large mean.
+// `out` may alias `row`.
+void normRow(const NormKernel &kernel, const float *row, const float *gamma,
+             const float *beta, float *out) {
+  int64_t n = kernel.n;
+  float shift = (kernel.kind == LAYERNORM && n > 0) ? row[0] : 0.0f;
+  float sum, sumSq;
+  rowSums(row, n, shift, sum, sumSq);
+  float mean = 0.0f;
+  float var = sumSq / n;
+  if (kernel.kind == LAYERNORM) {
+    float shiftedMean = sum / n;
+    mean = shift + shiftedMean;
+    var = std::max(var - shiftedMean * shiftedMean, 0.0f);
+  }
+  float rstd = 1.0f / std::sqrt(var + kernel.epsilon);
+  if (beta) {
+    for (int64_t j = 0; j < n; j++)
+      out[j] = (row[j] - mean) * rstd * gamma[j] + beta[j];
+  } else {
+    for (int64_t j = 0; j < n; j++)
+      out[j] = (row[j] - mean) * rstd * gamma[j];
+  }
+}
+
+void normInvoke(const libxsmm_datatype dType, int64_t addr, void *in,
+                void *gamma, void *beta, void *out) {
+  const NormKernel &kernel = *reinterpret_cast<const NormKernel *>(addr);
+  if (dType == LIBXSMM_DATATYPE_F32) {
+    for (int64_t i = 0; i < kernel.m; i++) {
+      normRow(kernel, static_cast<const float *>(in) + i * kernel.ldi,
+              static_cast<const float *>(gamma),
+              static_cast<const float *>(beta),
+              static_cast<float *>(out) + i * kernel.ldo);
+    }
+    return;
+  }
+
+  // bf16 rows are widened to f32 in a scratch row, normalized in place and
+  // rounded back.
+  int64_t n = kernel.n;
+  thread_local std::vector<float> scratch;
+  scratch.resize(3 * n);
+  float *row = scratch.data();
+  float *gammaF32 = row + n;
+  float *betaF32 = beta ? row + 2 * n : nullptr;
+  for (int64_t j = 0; j < n; j++) {
+    gammaF32[j] = bf16ToFloat(static_cast<const uint16_t *>(gamma)[j]);
+    if (betaF32)
+      betaF32[j] = bf16ToFloat(static_cast<const uint16_t *>(beta)[j]);
+  }
+  for (int64_t i = 0; i < kernel.m; i++) {
+    const uint16_t *inRow = static_cast<const uint16_t *>(in) + i * kernel.ldi;
+    uint16_t *outRow = static_cast<uint16_t *>(out) + i * kernel.ldo;
+    for (int64_t j = 0; j < n; j++)
+      row[j] = bf16ToFloat(inRow[j]);
+    normRow(kernel, row, gammaF32, betaF32, row);
+    for (int64_t j = 0; j < n; j++)
+      outRow[j] = floatToBF16(row[j]);
+  }
+}
+
 } // namespace
 
+//===----------------------------------------------------------------------===//
+// Invoke tracing
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+// Dispatch parameters of a traced kernel, printed as its label.
+struct TraceKernel {
+  enum Kind { GEMM, UNARY, BINARY };
+  Kind kind;
+  const char *name;
+  // Flops of one GEMM of the batch, or of one element-wise call.
+  double flops;
+  bool hasBrgemmConfig;
+  libxsmm_gemm_shape gemmShape;
+  libxsmm_gemm_batch_reduce_config brgemmConfig;
+  libxsmm_meltw_unary_shape unaryShape;
+  libxsmm_meltw_binary_shape binaryShape;
+};
+
+struct TraceCounter {
+  int64_t calls = 0;
+  // GEMMs for gemm-like kernels, calls otherwise.
+  int64_t units = 0;
+  int64_t nanoseconds = 0;
+};
+
+typedef std::unordered_map<int64_t, TraceCounter> TraceBuffer;
+
+struct TraceState {
+  std::mutex mutex;
+  std::map<int64_t, TraceKernel> kernels;
+  std::vector<TraceBuffer *> buffers;
+};
+
+std::atomic<bool> traceEnabled(false);
+
+// Never destroyed, the trace is dumped by an exit handler.
+TraceState &getTraceState() {
+  static TraceState *state = new TraceState();
+  return *state;
+}
+
+void registerTraceKernel(int64_t kernel, const TraceKernel &info) {
+  if (!traceEnabled.load(std::memory_order_relaxed))
+    return;
+  TraceState &state = getTraceState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.kernels.insert(std::make_pair(kernel, info));
+}
+
+void traceGemmKernel(int64_t kernel, const char *name,
+                     const libxsmm_gemm_shape &shape,
+                     const libxsmm_gemm_batch_reduce_config *config = nullptr) {
+  TraceKernel info;
+  memset(&info, 0, sizeof(TraceKernel));
+  info.kind = TraceKernel::GEMM;
+  info.name = name;
+  info.flops = 2.0 * shape.m * shape.n * shape.k;
+  info.gemmShape = shape;
+  if (config) {
+    info.hasBrgemmConfig = true;
+    info.brgemmConfig = *config;
+  }
+  registerTraceKernel(kernel, info);
+}
+
+void traceUnaryKernel(int64_t kernel, const libxsmm_meltw_unary_shape &shape) {
+  TraceKernel info;
+  memset(&info, 0, sizeof(TraceKernel));
+  info.kind = TraceKernel::UNARY;
+  info.name = "unary";
+  info.flops = static_cast<double>(shape.m) * shape.n;
+  info.unaryShape = shape;
+  registerTraceKernel(kernel, info);
+}
+
+void traceBinaryKernel(int64_t kernel,
+                       const libxsmm_meltw_binary_shape &shape) {
+  TraceKernel info;
+  memset(&info, 0, sizeof(TraceKernel));
+  info.kind = TraceKernel::BINARY;
+  info.name = "binary";
+  info.flops = static_cast<double>(shape.m) * shape.n;
+  info.binaryShape = shape;
+  registerTraceKernel(kernel, info);
+}
+
+// Accumulate in a per-thread buffer, the buffers are merged at exit.
+void recordInvoke(int64_t kernel, int64_t units, int64_t nanoseconds) {
+  static thread_local TraceBuffer *buffer = nullptr;
+  if (!buffer) {
+    buffer = new TraceBuffer();
+    TraceState &state = getTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.buffers.push_back(buffer);
+  }
+  TraceCounter &counter = (*buffer)[kernel];
+  counter.calls++;
+  counter.units += units;
+  counter.nanoseconds += nanoseconds;
+}
+
+// Time the enclosing invocation of `kernel` if tracing is enabled, and record
+// it on the perf timeline if enabled. When neither is, the cost is two relaxed
+// loads and a branch.
+class TraceScope {
+public:
+  TraceScope(const char *name, int64_t kernel, int64_t units = 1)
+      : name(name), kernel(kernel), units(units),
+        active(traceEnabled.load(std::memory_order_relaxed)),
+        timeline(isPerfTimelineEnabled()), start(0) {
+    if (active || timeline)
+      start = getPerfTimelineTimestamp();
+  }
+
+  ~TraceScope() {
+    if (!active && !timeline)
+      return;
+    int64_t end = getPerfTimelineTimestamp();
+    if (active)
+      recordInvoke(kernel, units, end - start);
+    if (timeline)
+      recordPerfTimelineEvent(name, "xsmm", "count", units, start, end);
+  }
+
+private:
+  const char *name;
+  int64_t kernel;
+  int64_t units;
+  bool active;
+  bool timeline;
+  int64_t start;
+};
+
+void dumpTrace() {
+  TraceState &state = getTraceState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  std::map<int64_t, TraceCounter> totals;
+  for (TraceBuffer *buffer : state.buffers) {
+    for (const auto &entry : *buffer) {
+      TraceCounter &total = totals[entry.first];
+      total.calls += entry.second.calls;
+      total.units += entry.second.units;
+      total.nanoseconds += entry.second.nanoseconds;
+    }
+  }
+  std::vector<std::pair<int64_t, TraceCounter>> rows(totals.begin(),
+                                                     totals.end());
+  std::sort(rows.begin(), rows.end(),
+            [](const std::pair<int64_t, TraceCounter> &lhs,
+               const std::pair<int64_t, TraceCounter> &rhs) {
+              return lhs.second.nanoseconds > rhs.second.nanoseconds;
+            });
+
+  fprintf(stderr, "XSMM invoke trace, %zu kernels:\n", rows.size());
+  fprintf(stderr, "%-12s %12s %14s %12s %10s\n", "kernel", "calls",
+          "total (ms)", "avg (us)", "GFLOP/s");
+  for (const auto &row : rows) {
+    const TraceCounter &counter = row.second;
+    double totalMs = counter.nanoseconds * 1e-6;
+    double avgUs = counter.nanoseconds * 1e-3 / counter.calls;
+    auto kernel = state.kernels.find(row.first);
+    if (kernel == state.kernels.end()) {
+      // Dispatched before the tracing was enabled.
+      fprintf(stderr, "%-12s %12lld %14.3f %12.3f %10s\n", "unknown",
+              static_cast<long long>(counter.calls), totalMs, avgUs, "-");
+      continue;
+    }
+    const TraceKernel &info = kernel->second;
+    double gflops = counter.nanoseconds
+                        ? info.flops * counter.units / counter.nanoseconds
+                        : 0.0;
+    fprintf(stderr, "%-12s %12lld %14.3f %12.3f %10.2f\n", info.name,
+            static_cast<long long>(counter.calls), totalMs, avgUs, gflops);
+    switch (info.kind) {
+    case TraceKernel::GEMM:
+      printXsmmStruct(info.gemmShape);
+      if (info.hasBrgemmConfig)
+        printXsmmStruct(info.brgemmConfig);
+      break;
+    case TraceKernel::UNARY:
+      printXsmmStruct(info.unaryShape);
+      break;
+    case TraceKernel::BINARY:
+      printXsmmStruct(info.binaryShape);
+      break;
+    }
+  }
+}
+
+} // namespace
+
+extern "C" void xsmm_trace_enable() {
+  static std::once_flag registered;
+  std::call_once(registered, [] { atexit(dumpTrace); });
+  traceEnabled.store(true, std::memory_order_relaxed);
+}
+
+// TPP_XSMM_TRACE enables the tracing without recompiling. It must be on
+// before the kernels are dispatched to label them.
+static const bool traceFromEnv = [] {
+  const char *env = getenv("TPP_XSMM_TRACE");
+  if (!env || !strcmp(env, "0"))
+    return false;
+  xsmm_trace_enable();
+  return true;
+}();
+
 extern "C" void xsmm_gemm_invoke(const libxsmm_datatype dType, int64_t addr,
                                  void *alignedPtrA, int64_t offsetA,
                                  void *alignedPtrB, int64_t offsetB,
                                  void *alignedPtrC, int64_t offsetC) {
+  TraceScope trace("gemm", addr);
   libxsmm_xmmfunction sgemm;
   libxsmm_gemm_param gemm_param;
 
@@ -136,6 +507,7 @@ extern "C" int64_t xsmm_gemm_dispatch(const libxsmm_datatype dtype, int64_t m,
     exit(-1);
   }
 
+  traceGemmKernel(reinterpret_cast<int64_t>(sgemm), "gemm", l_shape);
   return reinterpret_cast<int64_t>(sgemm);
 }
 
@@ -175,6 +547,7 @@ xsmm_unary_dispatch(const libxsmm_meltw_unary_type op_type,
     exit(-1);
   }
 
+  traceUnaryKernel(reinterpret_cast<int64_t>(kernel), unary_shape);
   return reinterpret_cast<int64_t>(kernel);
 }
 
@@ -207,6 +580,7 @@ xsmm_binary_dispatch(const libxsmm_meltw_binary_type op_type,
     exit(-1);
   }
 
+  traceBinaryKernel(reinterpret_cast<int64_t>(kernel), binary_shape);
   return reinterpret_cast<int64_t>(kernel);
 }
 
@@ -248,6 +622,7 @@ extern "C" int64_t xsmm_intel_amx_tile_config_dispatch(
 extern "C" void xsmm_unary_invoke(const libxsmm_datatype dType, int64_t addr,
                                   void *alignedPtrIn, int64_t offsetIn,
                                   void *alignedPtrOut, int64_t offsetOut) {
+  TraceScope trace("unary", addr);
   libxsmm_meltw_unary_param param;
 
   param.in.primary = get_base_ptr(dType, alignedPtrIn, offsetIn);
@@ -262,6 +637,7 @@ extern "C" void xsmm_binary_invoke(const libxsmm_datatype dType, int64_t addr,
                                    void *alignedPtrLhs, int64_t offsetLhs,
                                    void *alignedPtrRhs, int64_t offsetRhs,
                                    void *alignedPtrOut, int64_t offsetOut) {
+  TraceScope trace("binary", addr);
   libxsmm_meltw_binary_param param;
 
   param.in0.primary = get_base_ptr(dType, alignedPtrLhs, offsetLhs);
@@ -276,6 +652,7 @@ extern "C" void xsmm_binary_invoke(const libxsmm_datatype dType, int64_t addr,
 extern "C" void xsmm_unary_scalar_invoke(const libxsmm_datatype dType,
                                          int64_t addr, float input,
                                          void *alignedOut, int64_t offsetOut) {
+  TraceScope trace("unary", addr);
   libxsmm_meltwfunction_unary kernel =
       reinterpret_cast<libxsmm_meltwfunction_unary>(addr);
   libxsmm_meltw_unary_param param;
@@ -290,6 +667,7 @@ extern "C" void xsmm_brgemm_invoke(const libxsmm_datatype dType, int64_t addr,
                                    void *alignedPtrB, int64_t offsetB,
                                    void *alignedPtrC, int64_t offsetC,
                                    int64_t numBatches) {
+  TraceScope trace("brgemm", addr, numBatches);
   libxsmm_xmmfunction sgemm;
   libxsmm_gemm_param gemm_param;
 
@@ -305,6 +683,56 @@ extern "C" void xsmm_brgemm_invoke(const libxsmm_datatype dType, int64_t addr,
   sgemm.gemm(&gemm_param);
 }
 
+extern "C" void xsmm_gemm_batch_invoke(const libxsmm_datatype dType,
+                                       int64_t addr, void *alignedPtrA,
+                                       int64_t offsetA, void *alignedPtrB,
+                                       int64_t offsetB, void *alignedPtrC,
+                                       int64_t offsetC, int64_t count,
+                                       int64_t strideA, int64_t strideB,
+                                       int64_t strideC) {
+  TraceScope trace("gemm_batch", addr, count);
+  libxsmm_xmmfunction sgemm;
+  libxsmm_gemm_param gemm_param;
+  sgemm.gemm = reinterpret_cast<libxsmm_gemmfunction>(addr);
+
+  for (int64_t i = 0; i < count; i++) {
+    // LIBXSMM col-major change A with B.
+    gemm_param.a.primary =
+        get_base_ptr(dType, alignedPtrB, offsetB + i * strideB);
+    gemm_param.b.primary =
+        get_base_ptr(dType, alignedPtrA, offsetA + i * strideA);
+    gemm_param.c.primary =
+        get_base_ptr(dType, alignedPtrC, offsetC + i * strideC);
+    sgemm.gemm(&gemm_param);
+  }
+}
+
+extern "C" void
+xsmm_brgemm_batch_invoke(const libxsmm_datatype dType, int64_t addr,
+                         void *alignedPtrA, int64_t offsetA, void *alignedPtrB,
+                         int64_t offsetB, void *alignedPtrC, int64_t offsetC,
+                         int64_t count, int64_t strideA, int64_t strideB,
+                         int64_t strideC, int64_t numBatches) {
+  TraceScope trace("brgemm_batch", addr, count * numBatches);
+  libxsmm_xmmfunction sgemm;
+  libxsmm_gemm_param gemm_param;
+  sgemm.gemm = reinterpret_cast<libxsmm_gemmfunction>(addr);
+
+  unsigned long long numBatchesVar = numBatches;
+  gemm_param.op.tertiary = (void *)&numBatchesVar;
+
+  for (int64_t i = 0; i < count; i++) {
+    // LIBXSMM col-major change A with B.
+    gemm_param.a.primary =
+        get_base_ptr(dType, alignedPtrB, offsetB + i * strideB);
+    gemm_param.b.primary =
+        get_base_ptr(dType, alignedPtrA, offsetA + i * strideA);
+    gemm_param.c.primary =
+        get_base_ptr(dType, alignedPtrC, offsetC + i * strideC);
+    sgemm.gemm(&gemm_param);
+  }
+}
+
 extern "C" int64_t xsmm_brgemm_dispatch(const libxsmm_datatype dtype, int64_t m,
                                         int64_t n, int64_t k, int64_t lda,
                                         int64_t ldb, int64_t ldc,
@@ -357,15 +785,134 @@ extern "C" int64_t xsmm_brgemm_dispatch(const libxsmm_datatype dtype, int64_t m,
     exit(-1);
   }
 
+  traceGemmKernel(reinterpret_cast<int64_t>(sgemm), "brgemm", l_shape,
+                  &l_brconfig);
   return reinterpret_cast<int64_t>(sgemm);
 }
 
+// Dispatch a brgemm kernel locating its batch elements with `brType`, either
+// a list of offsets or a list of addresses.
+static int64_t
+dispatchBrgemmList(const libxsmm_datatype dtype, int64_t m, int64_t n,
+                   int64_t k, int64_t lda, int64_t ldb, int64_t ldc,
+                   const libxsmm_gemm_flags flags,
+                   const libxsmm_gemm_batch_reduce_type brType) {
+  // LIBXSMM col-major change A with B.
+  libxsmm_gemm_shape l_shape;
+  l_shape.m = n;
+  l_shape.n = m;
+  l_shape.k = k;
+  l_shape.lda = ldb;
+  l_shape.ldb = lda;
+  l_shape.ldc = ldc;
+  l_shape.a_in_type = dtype;
+  l_shape.b_in_type = dtype;
+  l_shape.out_type = dtype;
+  l_shape.comp_type =
+      dtype == LIBXSMM_DATATYPE_BF16 ? LIBXSMM_DATATYPE_F32 : dtype;
+
+  libxsmm_gemm_batch_reduce_config l_brconfig;
+  l_brconfig.br_type = brType;
+  l_brconfig.br_stride_a_hint = 0;
+  l_brconfig.br_stride_b_hint = 0;
+  l_brconfig.br_unroll_hint = 0;
+
+  libxsmm_bitfield l_flags = flags;
+  libxsmm_bitfield l_prefetch_flags = 0;
+  auto sgemm =
+      libxsmm_dispatch_brgemm(l_shape, l_flags, l_prefetch_flags, l_brconfig);
+  if (!sgemm) {
+    fprintf(stderr, "failed to generate brgemm func\n");
+    fprintf(stderr, "dtype: %u\n", dtype);
+    printXsmmStruct(l_shape);
+    printXsmmStruct(l_brconfig);
+    exit(-1);
+  }
+  traceGemmKernel(reinterpret_cast<int64_t>(sgemm),
+                  brType == LIBXSMM_GEMM_BATCH_REDUCE_OFFSET ? "brgemm_offs"
+                                                             : "brgemm_addr",
+                  l_shape, &l_brconfig);
+  return reinterpret_cast<int64_t>(sgemm);
+}
+
+extern "C" int64_t xsmm_brgemm_offs_dispatch(const libxsmm_datatype dtype,
+                                             int64_t m, int64_t n, int64_t k,
+                                             int64_t lda, int64_t ldb,
+                                             int64_t ldc,
+                                             const libxsmm_gemm_flags flags) {
+  return dispatchBrgemmList(dtype, m, n, k, lda, ldb, ldc, flags,
+                            LIBXSMM_GEMM_BATCH_REDUCE_OFFSET);
+}
+
+extern "C" int64_t xsmm_brgemm_addr_dispatch(const libxsmm_datatype dtype,
+                                             int64_t m, int64_t n, int64_t k,
+                                             int64_t lda, int64_t ldb,
+                                             int64_t ldc,
+                                             const libxsmm_gemm_flags flags) {
+  return dispatchBrgemmList(dtype, m, n, k, lda, ldb, ldc, flags,
+                            LIBXSMM_GEMM_BATCH_REDUCE_ADDRESS);
+}
+
+extern "C" void
+xsmm_brgemm_offs_invoke(const libxsmm_datatype dType, int64_t addr,
+                        void *alignedPtrA, int64_t offsetA, void *alignedPtrB,
+                        int64_t offsetB, void *alignedPtrC, int64_t offsetC,
+                        void *alignedPtrOffsA, int64_t offsetOffsA,
+                        void *alignedPtrOffsB, int64_t offsetOffsB,
+                        int64_t numBatches) {
+  TraceScope trace("brgemm_offs", addr, numBatches);
+  libxsmm_xmmfunction sgemm;
+  libxsmm_gemm_param gemm_param;
+
+  unsigned long long numBatchesVar = numBatches;
+  gemm_param.op.tertiary = (void *)&numBatchesVar;
+
+  // LIBXSMM col-major change A with B. The offsets are in bytes.
+  gemm_param.a.primary = get_base_ptr(dType, alignedPtrB, offsetB);
+  gemm_param.a.secondary =
+      (void *)(static_cast<unsigned long long *>(alignedPtrOffsB) +
+               offsetOffsB);
+  gemm_param.b.primary = get_base_ptr(dType, alignedPtrA, offsetA);
+  gemm_param.b.secondary =
+      (void *)(static_cast<unsigned long long *>(alignedPtrOffsA) +
+               offsetOffsA);
+  gemm_param.c.primary = get_base_ptr(dType, alignedPtrC, offsetC);
+
+  sgemm.gemm = reinterpret_cast<libxsmm_gemmfunction>(addr);
+  sgemm.gemm(&gemm_param);
+}
+
+extern "C" void
+xsmm_brgemm_addr_invoke(const libxsmm_datatype dType, int64_t addr,
+                        void *alignedPtrAddrA, int64_t offsetAddrA,
+                        void *alignedPtrAddrB, int64_t offsetAddrB,
+                        void *alignedPtrC, int64_t offsetC,
+                        int64_t numBatches) {
+  TraceScope trace("brgemm_addr", addr, numBatches);
+  libxsmm_xmmfunction sgemm;
+  libxsmm_gemm_param gemm_param;
+
+  unsigned long long numBatchesVar = numBatches;
+  gemm_param.op.tertiary = (void *)&numBatchesVar;
+
+  // LIBXSMM col-major change A with B.
+  gemm_param.a.primary =
+      (void *)(static_cast<int64_t *>(alignedPtrAddrB) + offsetAddrB);
+  gemm_param.b.primary =
+      (void *)(static_cast<int64_t *>(alignedPtrAddrA) + offsetAddrA);
+  gemm_param.c.primary = get_base_ptr(dType, alignedPtrC, offsetC);
+
+  sgemm.gemm = reinterpret_cast<libxsmm_gemmfunction>(addr);
+  sgemm.gemm(&gemm_param);
+}
+
 extern "C" void xsmm_fused_brgemm_invoke(const libxsmm_datatype dType,
                                          int64_t addr, void *alignedPtrA,
                                          int64_t offsetA, void *alignedPtrB,
                                          int64_t offsetB, void *alignedPtrC,
                                          int64_t offsetC, void *alignedPtrD,
                                          int64_t offsetD, int64_t numBatches) {
+  TraceScope trace("fused_brgemm", addr, numBatches);
   libxsmm_xmmfunction sgemm;
   libxsmm_gemm_ext_param gemm_param;
 
@@ -453,9 +1000,56 @@ xsmm_fused_brgemm_dispatch(const libxsmm_datatype data_type, int64_t m,
     exit(-1);
   }
 
+  traceGemmKernel(reinterpret_cast<int64_t>(sgemm), "fused_brgemm", l_shape,
+                  &l_brconfig);
   return reinterpret_cast<int64_t>(sgemm);
 }
 
+extern "C" int64_t xsmm_norm_dispatch(int64_t kind,
+                                      const libxsmm_datatype dtype, int64_t m,
+                                      int64_t n, int64_t ldi, int64_t ldo,
+                                      float epsilon) {
+  if ((kind != LAYERNORM && kind != RMSNORM) ||
+      (dtype != LIBXSMM_DATATYPE_F32 && dtype != LIBXSMM_DATATYPE_BF16)) {
+    fprintf(stderr, "failed to generate norm func\n");
+    fprintf(stderr, "kind: %ld\n", static_cast<long>(kind));
+    fprintf(stderr, "dtype: %u\n", dtype);
+    exit(-1);
+  }
+
+  // The descriptors live as long as the program, like the libxsmm kernels.
+  typedef std::tuple<int64_t, int, int64_t, int64_t, int64_t, int64_t, float>
+      NormKey;
+  static std::mutex mutex;
+  static std::map<NormKey, std::unique_ptr<NormKernel>> kernels;
+  NormKey key(kind, static_cast<int>(dtype), m, n, ldi, ldo, epsilon);
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<NormKernel> &kernel = kernels[key];
+  if (!kernel)
+    kernel.reset(new NormKernel{kind, dtype, m, n, ldi, ldo, epsilon});
+  return reinterpret_cast<int64_t>(kernel.get());
+}
+
+extern "C" void xsmm_layernorm_invoke(
+    const libxsmm_datatype dType, int64_t addr, void *alignedPtrIn,
+    int64_t offsetIn, void *alignedPtrGamma, int64_t offsetGamma,
+    void *alignedPtrBeta, int64_t offsetBeta, void *alignedPtrOut,
+    int64_t offsetOut) {
+  normInvoke(dType, addr, get_base_ptr(dType, alignedPtrIn, offsetIn),
+             get_base_ptr(dType, alignedPtrGamma, offsetGamma),
+             get_base_ptr(dType, alignedPtrBeta, offsetBeta),
+             get_base_ptr(dType, alignedPtrOut, offsetOut));
+}
+
+extern "C" void xsmm_rmsnorm_invoke(const libxsmm_datatype dType, int64_t addr,
+                                    void *alignedPtrIn, int64_t offsetIn,
+                                    void *alignedPtrGamma, int64_t offsetGamma,
+                                    void *alignedPtrOut, int64_t offsetOut) {
+  normInvoke(dType, addr, get_base_ptr(dType, alignedPtrIn, offsetIn),
+             get_base_ptr(dType, alignedPtrGamma, offsetGamma),
+             /*beta=*/nullptr, get_base_ptr(dType, alignedPtrOut, offsetOut));
+}
+
 extern "C" MLIR_RUNNERUTILS_EXPORT void
 xsmm_intel_amx_tile_config_invoke(const libxsmm_datatype dType, int64_t addr,
                                   void *tileState, int64_t offset) {
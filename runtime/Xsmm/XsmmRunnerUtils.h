@@ -19,6 +19,11 @@
 #include "mlir/ExecutionEngine/Float16bits.h"
 #include "mlir/ExecutionEngine/RunnerUtils.h"
 
+// Time the XSMM invocations per kernel and print a summary at exit. Only the
+// kernels dispatched after enabling are labeled with their parameters. Also
+// enabled by setting TPP_XSMM_TRACE in the environment.
+extern "C" MLIR_RUNNERUTILS_EXPORT void xsmm_trace_enable();
+
 extern "C" MLIR_RUNNERUTILS_EXPORT int64_t
 xsmm_gemm_dispatch(const libxsmm_datatype, int64_t, int64_t, int64_t, int64_t,
                    int64_t, int64_t, const libxsmm_gemm_flags);
@@ -35,6 +40,16 @@ extern "C" MLIR_RUNNERUTILS_EXPORT int64_t xsmm_brgemm_dispatch(
     const libxsmm_datatype, int64_t, int64_t, int64_t, int64_t, int64_t,
     int64_t, int64_t, int64_t, const libxsmm_gemm_flags);
 
+// Dispatch a brgemm kernel whose batch elements are located by a list of byte
+// offsets (offs) or by a list of addresses (addr).
+extern "C" MLIR_RUNNERUTILS_EXPORT int64_t
+xsmm_brgemm_offs_dispatch(const libxsmm_datatype, int64_t, int64_t, int64_t,
+                          int64_t, int64_t, int64_t, const libxsmm_gemm_flags);
+
+extern "C" MLIR_RUNNERUTILS_EXPORT int64_t
+xsmm_brgemm_addr_dispatch(const libxsmm_datatype, int64_t, int64_t, int64_t,
+                          int64_t, int64_t, int64_t, const libxsmm_gemm_flags);
+
 extern "C" MLIR_RUNNERUTILS_EXPORT int64_t xsmm_fused_brgemm_dispatch(
     const libxsmm_datatype data_type, int64_t m, int64_t n, int64_t k,
     int64_t lda, int64_t ldb, int64_t ldc, int64_t stride_a, int64_t stride_b,
@@ -48,6 +63,12 @@ extern "C" MLIR_RUNNERUTILS_EXPORT int64_t xsmm_intel_amx_tile_config_dispatch(
     const libxsmm_datatype, int64_t, int64_t, int64_t, int64_t, int64_t,
     int64_t, int64_t, int64_t, const libxsmm_gemm_flags);
 
+// Row-wise normalization, not provided by libxsmm. `kind` is 1 for layernorm
+// and 2 for rmsnorm, the returned value is an opaque kernel descriptor.
+extern "C" MLIR_RUNNERUTILS_EXPORT int64_t
+xsmm_norm_dispatch(int64_t kind, const libxsmm_datatype, int64_t m, int64_t n,
+                   int64_t ldi, int64_t ldo, float epsilon);
+
 extern "C" MLIR_RUNNERUTILS_EXPORT void
 xsmm_gemm_invoke(const libxsmm_datatype dType, int64_t addr, void *alignedPtrA,
                  int64_t offsetA, void *alignedPtrB, int64_t offsetB,
@@ -73,11 +94,48 @@ xsmm_brgemm_invoke(const libxsmm_datatype dType, int64_t addr,
                    int64_t offsetB, void *alignedPtrC, int64_t offsetC,
                    int64_t numBatches);
 
+// Invoke the gemm (brgemm) kernel `count` times. Invocation `i` uses the
+// operands offset by `i` times their stride, in elements.
+extern "C" MLIR_RUNNERUTILS_EXPORT void xsmm_gemm_batch_invoke(
+    const libxsmm_datatype dType, int64_t addr, void *alignedPtrA,
+    int64_t offsetA, void *alignedPtrB, int64_t offsetB, void *alignedPtrC,
+    int64_t offsetC, int64_t count, int64_t strideA, int64_t strideB,
+    int64_t strideC);
+
+extern "C" MLIR_RUNNERUTILS_EXPORT void xsmm_brgemm_batch_invoke(
+    const libxsmm_datatype dType, int64_t addr, void *alignedPtrA,
+    int64_t offsetA, void *alignedPtrB, int64_t offsetB, void *alignedPtrC,
+    int64_t offsetC, int64_t count, int64_t strideA, int64_t strideB,
+    int64_t strideC, int64_t numBatches);
+
+extern "C" MLIR_RUNNERUTILS_EXPORT void xsmm_brgemm_offs_invoke(
+    const libxsmm_datatype dType, int64_t addr, void *alignedPtrA,
+    int64_t offsetA, void *alignedPtrB, int64_t offsetB, void *alignedPtrC,
+    int64_t offsetC, void *alignedPtrOffsA, int64_t offsetOffsA,
+    void *alignedPtrOffsB, int64_t offsetOffsB, int64_t numBatches);
+
+extern "C" MLIR_RUNNERUTILS_EXPORT void xsmm_brgemm_addr_invoke(
+    const libxsmm_datatype dType, int64_t addr, void *alignedPtrAddrA,
+    int64_t offsetAddrA, void *alignedPtrAddrB, int64_t offsetAddrB,
+    void *alignedPtrC, int64_t offsetC, int64_t numBatches);
+
 extern "C" MLIR_RUNNERUTILS_EXPORT void xsmm_fused_brgemm_invoke(
     const libxsmm_datatype dType, int64_t addr, void *alignedPtrA,
     int64_t offsetA, void *alignedPtrB, int64_t offsetB, void *alignedPtrC,
     int64_t offsetC, void *alignedPtrD, int64_t offsetD, int64_t numBatches);
 
+extern "C" MLIR_RUNNERUTILS_EXPORT void
+xsmm_layernorm_invoke(const libxsmm_datatype dType, int64_t addr,
+                      void *alignedPtrIn, int64_t offsetIn,
+                      void *alignedPtrGamma, int64_t offsetGamma,
+                      void *alignedPtrBeta, int64_t offsetBeta,
+                      void *alignedPtrOut, int64_t offsetOut);
+
+extern "C" MLIR_RUNNERUTILS_EXPORT void
+xsmm_rmsnorm_invoke(const libxsmm_datatype dType, int64_t addr,
+                    void *alignedPtrIn, int64_t offsetIn, void *alignedPtrGamma,
+                    int64_t offsetGamma, void *alignedPtrOut, int64_t offsetOut);
+
 extern "C" MLIR_RUNNERUTILS_EXPORT void
 xsmm_intel_amx_tile_config_invoke(const libxsmm_datatype dType, int64_t addr,
                                   void *alignedPtrA, int64_t offset);
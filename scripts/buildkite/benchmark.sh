@@ -98,6 +98,8 @@ if [ "$BENCH_BASE" ]; then
   benchmark base/base.json "Base Benchmarks"
   benchmark base/pack.json "Pack Benchmarks"
   benchmark base/mha.json "MHA Benchmarks"
+  benchmark base/conv.json "Conv Benchmarks"
+  benchmark base/epilogue.json "Epilogue Benchmarks"
 fi
 
 # PyTorch model benchmarks
@@ -0,0 +1,74 @@
+// RUN: tpp-opt %s -convert-linalg-to-xsmm -split-input-file | FileCheck %s
+
+func.func @batch_matmul(%arg0: memref<8x32x64xf32>, %arg1: memref<8x64x32xf32>,
+                        %arg2: memref<8x32x32xf32>) {
+  linalg.batch_matmul ins(%arg0, %arg1 : memref<8x32x64xf32>, memref<8x64x32xf32>)
+                      outs(%arg2 : memref<8x32x32xf32>)
+  return
+}
+
+// CHECK-LABEL: batch_matmul
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x32x64xf32>, %[[ARG1:.+]]: memref<8x64x32xf32>, %[[ARG2:.+]]: memref<8x32x32xf32>
+// CHECK-DAG: %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG: %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG: %[[C8:.+]] = arith.constant 8 : index
+// CHECK-DAG: %[[DIS:.+]] = xsmm.gemm.dispatch [32, 32, 64, 64, 32, 32] flags = (none) data_type = f32
+// CHECK: scf.parallel (%[[IV:.+]]) = (%[[C0]]) to (%[[C8]]) step (%[[C1]])
+// CHECK: %[[SUB:.+]] = memref.subview %[[ARG0]][%[[IV]], 0, 0] [1, 32, 64] [1, 1, 1]
+// CHECK-SAME:  : memref<8x32x64xf32> to memref<32x64xf32, strided<[64, 1], offset: ?>>
+// CHECK: %[[SUB_0:.+]] = memref.subview %[[ARG1]][%[[IV]], 0, 0] [1, 64, 32] [1, 1, 1]
+// CHECK-SAME:  : memref<8x64x32xf32> to memref<64x32xf32, strided<[32, 1], offset: ?>>
+// CHECK: %[[SUB_1:.+]] = memref.subview %[[ARG2]][%[[IV]], 0, 0] [1, 32, 32] [1, 1, 1]
+// CHECK-SAME:  : memref<8x32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+// CHECK: xsmm.gemm(data_type = f32, %[[DIS]], %[[SUB]], %[[SUB_0]], %[[SUB_1]])
+// CHECK-NOT: linalg.batch_matmul
+
+// -----
+
+#map = affine_map<(d0, d1, d2, d3) -> (d0, d1, d3)>
+#map1 = affine_map<(d0, d1, d2, d3) -> (d0, d3, d2)>
+#map2 = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2)>
+
+func.func @batch_matmul_single(
+    %arg0: memref<1x32x64xf32, strided<[2048, 64, 1], offset: ?>>,
+    %arg1: memref<1x64x32xf32, strided<[2048, 32, 1], offset: ?>>,
+    %arg2: memref<1x32x32xf32, strided<[1024, 32, 1], offset: ?>>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "parallel", "reduction"]}
+    ins(%arg0, %arg1 : memref<1x32x64xf32, strided<[2048, 64, 1], offset: ?>>,
+                       memref<1x64x32xf32, strided<[2048, 32, 1], offset: ?>>)
+    outs(%arg2 : memref<1x32x32xf32, strided<[1024, 32, 1], offset: ?>>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %0 = arith.mulf %in, %in_0 : f32
+      %1 = arith.addf %out, %0 : f32
+      linalg.yield %1 : f32
+  }
+  return
+}
+
+// A single GEMM is invoked directly.
+// CHECK-LABEL: batch_matmul_single
+// CHECK-SAME: %[[ARG0:[^:]+]]: memref<1x32x64xf32, strided<[2048, 64, 1], offset: ?>>
+// CHECK-SAME: %[[ARG1:[^:]+]]: memref<1x64x32xf32, strided<[2048, 32, 1], offset: ?>>
+// CHECK-SAME: %[[ARG2:[^:]+]]: memref<1x32x32xf32, strided<[1024, 32, 1], offset: ?>>
+// CHECK-NOT: scf.parallel
+// CHECK: %[[DIS:.+]] = xsmm.gemm.dispatch [32, 32, 64, 64, 32, 32] flags = (none) data_type = f32
+// CHECK: %[[SUB:.+]] = memref.subview %[[ARG0]][0, 0, 0] [1, 32, 64] [1, 1, 1]
+// CHECK: %[[SUB_0:.+]] = memref.subview %[[ARG1]][0, 0, 0] [1, 64, 32] [1, 1, 1]
+// CHECK: %[[SUB_1:.+]] = memref.subview %[[ARG2]][0, 0, 0] [1, 32, 32] [1, 1, 1]
+// CHECK: xsmm.gemm(data_type = f32, %[[DIS]], %[[SUB]], %[[SUB_0]], %[[SUB_1]])
+// CHECK-NOT: linalg.generic
+
+// -----
+
+func.func @batch_matmul_dynamic(%arg0: memref<?x32x64xf32>, %arg1: memref<?x64x32xf32>,
+                                %arg2: memref<?x32x32xf32>) {
+  linalg.batch_matmul ins(%arg0, %arg1 : memref<?x32x64xf32>, memref<?x64x32xf32>)
+                      outs(%arg2 : memref<?x32x32xf32>)
+  return
+}
+
+// CHECK-LABEL: batch_matmul_dynamic
+// CHECK-NOT: xsmm.gemm
+// CHECK: linalg.batch_matmul
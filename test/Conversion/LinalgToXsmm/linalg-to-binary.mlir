@@ -719,3 +719,115 @@ func.func @mul_bcast_row_in1(%arg0: memref<10xf32>, %arg1: memref<10x10xf32>) {
 // CHECK: %[[EXP:.+]] = memref.expand_shape %[[ARG0]] {{\[}}[0, 1]] output_shape [10, 1] : memref<10xf32> into memref<10x1xf32>
 // CHECK: %[[DIS:.+]] = xsmm.binary.dispatch mul [10, 10, 10, 1, 10] flags = (bcast_row_in1) data_type = f32
 // CHECK: xsmm.binary mul(data_type = f32, %[[DIS]], %[[ARG1]], %[[EXP]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0, 0)>
+
+func.func @div_bcast_row_in1(%arg0: memref<256x1024xf32>, %arg1: memref<256x1xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%arg0, %arg1 : memref<256x1024xf32>, memref<256x1xf32>)
+    outs(%arg0 : memref<256x1024xf32>) {
+    ^bb0(%in: f32, %in_6: f32, %out: f32):
+      %6 = arith.divf %in, %in_6 : f32
+      linalg.yield %6 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @div_bcast_row_in1(
+// CHECK-SAME: %[[ARG0:.+]]: memref<256x1024xf32>, %[[ARG1:.+]]: memref<256x1xf32>
+// CHECK: %[[DIS:.+]] = xsmm.binary.dispatch div [256, 1024, 1024, 1, 1024]
+// CHECK-SAME:  flags = (bcast_row_in1) data_type = f32
+// CHECK: xsmm.binary div(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]], %[[ARG0]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+
+// Softmax numerator: exp(x - max) becomes a broadcast sub and an in-place exp.
+func.func @sub_exp(%arg0: memref<64x128xf32>, %arg1: memref<64xf32>,
+                   %arg2: memref<64x128xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%arg0, %arg1 : memref<64x128xf32>, memref<64xf32>)
+    outs(%arg2 : memref<64x128xf32>) {
+    ^bb0(%in: f32, %in_6: f32, %out: f32):
+      %0 = arith.subf %in, %in_6 : f32
+      %1 = math.exp %0 : f32
+      linalg.yield %1 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @sub_exp(
+// CHECK-SAME: %[[ARG0:.+]]: memref<64x128xf32>, %[[ARG1:.+]]: memref<64xf32>, %[[ARG2:.+]]: memref<64x128xf32>
+// CHECK: %[[EXP:.+]] = memref.expand_shape %[[ARG1]] {{\[}}[0, 1]] output_shape [64, 1] : memref<64xf32> into memref<64x1xf32>
+// CHECK: %[[DIS:.+]] = xsmm.binary.dispatch sub [64, 128, 128, 1, 128] flags = (bcast_row_in1) data_type = f32
+// CHECK: xsmm.binary sub(data_type = f32, %[[DIS]], %[[ARG0]], %[[EXP]], %[[ARG2]])
+// CHECK: %[[DIS1:.+]] = xsmm.unary.dispatch exp [64, 128, 128, 128] flags = (none) data_type = f32
+// CHECK: xsmm.unary exp(data_type = f32, %[[DIS1]], %[[ARG2]], %[[ARG2]])
+// CHECK-NOT: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @silu_in_place(%arg0: memref<64x128xf32, strided<[256, 1], offset: ?>>) {
+  %one = arith.constant 1.0 : f32
+  linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : memref<64x128xf32, strided<[256, 1], offset: ?>>) {
+    ^bb0(%out: f32):
+      %0 = arith.negf %out : f32
+      %1 = math.exp %0 : f32
+      %2 = arith.addf %one, %1 : f32
+      %3 = arith.divf %out, %2 : f32
+      linalg.yield %3 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @silu_in_place(
+// CHECK-SAME: %[[ARG0:.+]]: memref<64x128xf32, strided<[256, 1], offset: ?>>
+// CHECK: %[[SCRATCH:.+]] = memref.alloc() : memref<64x128xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch sigmoid [64, 128, 256, 128] flags = (none) data_type = f32
+// CHECK: xsmm.unary sigmoid(data_type = f32, %[[DIS]], %[[ARG0]], %[[SCRATCH]])
+// CHECK: %[[DIS1:.+]] = xsmm.binary.dispatch mul [64, 128, 256, 128, 256] flags = (none) data_type = f32
+// CHECK: xsmm.binary mul(data_type = f32, %[[DIS1]], %[[ARG0]], %[[SCRATCH]], %[[ARG0]])
+// CHECK: memref.dealloc %[[SCRATCH]]
+// CHECK-NOT: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @silu_mul_sigmoid(%arg0: memref<8x16xf32>, %arg1: memref<8x16xf32>) {
+  %one = arith.constant 1.0 : f32
+  linalg.generic {
+    indexing_maps = [#map, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<8x16xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = arith.negf %in : f32
+      %1 = math.exp %0 : f32
+      %2 = arith.addf %1, %one : f32
+      %3 = arith.divf %one, %2 : f32
+      %4 = arith.mulf %in, %3 : f32
+      linalg.yield %4 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @silu_mul_sigmoid(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>, %[[ARG1:.+]]: memref<8x16xf32>
+// CHECK: %[[SCRATCH:.+]] = memref.alloc() : memref<8x16xf32>
+// CHECK: xsmm.unary sigmoid(data_type = f32, %{{.+}}, %[[ARG0]], %[[SCRATCH]])
+// CHECK: xsmm.binary mul(data_type = f32, %{{.+}}, %[[ARG0]], %[[SCRATCH]], %[[ARG1]])
+// CHECK: memref.dealloc %[[SCRATCH]]
@@ -0,0 +1,108 @@
+// RUN: tpp-opt %s -convert-linalg-to-xsmm -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d0 * 2 + d4, d5)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d4, d5, d1)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1)>
+
+func.func @conv_row(%arg0: memref<2x3x9x4xf32>, %arg1: memref<2x3x3x4x4xf32>,
+                    %arg2: memref<4x4xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "reduction", "reduction", "reduction", "reduction"]}
+    ins(%arg0, %arg1 : memref<2x3x9x4xf32>, memref<2x3x3x4x4xf32>)
+    outs(%arg2 : memref<4x4xf32>) {
+  ^bb0(%in: f32, %in_1: f32, %out: f32):
+    %0 = arith.mulf %in, %in_1 : f32
+    %1 = arith.addf %out, %0 : f32
+    linalg.yield %1 : f32
+  }
+  return
+}
+
+// The blocks of the image are enumerated over (C', R, S), the stride on W is
+// the leading dimension of A.
+// CHECK-LABEL: conv_row
+// CHECK-SAME: %[[ARG0:.+]]: memref<2x3x9x4xf32>, %[[ARG1:.+]]: memref<2x3x3x4x4xf32>, %[[ARG2:.+]]: memref<4x4xf32>
+// CHECK: %[[DIS:.+]] = xsmm.brgemm_offs.dispatch [4, 4, 4, 8, 4, 4] flags = (none) data_type = f32
+// CHECK: xsmm.brgemm_offs(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]], %[[ARG2]])
+// CHECK-SAME: offsets_a = [0, 4, 8, 36, 40, 44, 72, 76, 80, 108, 112, 116, 144, 148, 152, 180, 184, 188]
+// CHECK-SAME: offsets_b = [0, 16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256, 272]
+// CHECK-NOT: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d0 * 2 + d4, d5)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d4, d5, d1)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1)>
+
+func.func @conv_row_bf16(%arg0: memref<2x3x9x4xbf16>, %arg1: memref<2x3x3x4x4xbf16>,
+                         %arg2: memref<4x4xbf16>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "reduction", "reduction", "reduction", "reduction"]}
+    ins(%arg0, %arg1 : memref<2x3x9x4xbf16>, memref<2x3x3x4x4xbf16>)
+    outs(%arg2 : memref<4x4xbf16>) {
+  ^bb0(%in: bf16, %in_1: bf16, %out: bf16):
+    %0 = arith.mulf %in, %in_1 : bf16
+    %1 = arith.addf %out, %0 : bf16
+    linalg.yield %1 : bf16
+  }
+  return
+}
+
+// The blocks of B are not VNNI packed.
+// CHECK-LABEL: conv_row_bf16
+// CHECK-NOT: xsmm.brgemm_offs
+// CHECK: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d5, d0 * 2 + d4)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d4, d5, d1)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1)>
+
+func.func @conv_row_transposed(%arg0: memref<2x3x4x9xf32>, %arg1: memref<2x3x3x4x4xf32>,
+                               %arg2: memref<4x4xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "reduction", "reduction", "reduction", "reduction"]}
+    ins(%arg0, %arg1 : memref<2x3x4x9xf32>, memref<2x3x3x4x4xf32>)
+    outs(%arg2 : memref<4x4xf32>) {
+  ^bb0(%in: f32, %in_1: f32, %out: f32):
+    %0 = arith.mulf %in, %in_1 : f32
+    %1 = arith.addf %out, %0 : f32
+    linalg.yield %1 : f32
+  }
+  return
+}
+
+// The reduction is not the minor dimension of A.
+// CHECK-LABEL: conv_row_transposed
+// CHECK-NOT: xsmm.brgemm_offs
+// CHECK: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d0 * 2 + d4, d5)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d4, d5, d1)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1)>
+
+func.func @conv_row_many_blocks(%arg0: memref<64x17x9x4xf32>, %arg1: memref<64x17x3x4x4xf32>,
+                                %arg2: memref<4x4xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "reduction", "reduction", "reduction", "reduction"]}
+    ins(%arg0, %arg1 : memref<64x17x9x4xf32>, memref<64x17x3x4x4xf32>)
+    outs(%arg2 : memref<4x4xf32>) {
+  ^bb0(%in: f32, %in_1: f32, %out: f32):
+    %0 = arith.mulf %in, %in_1 : f32
+    %1 = arith.addf %out, %0 : f32
+    linalg.yield %1 : f32
+  }
+  return
+}
+
+// 64 x 17 x 3 blocks, too many to enumerate the offsets.
+// CHECK-LABEL: conv_row_many_blocks
+// CHECK-NOT: xsmm.brgemm_offs
+// CHECK: linalg.generic
@@ -362,3 +362,39 @@ func.func @non_square_vnni_gemm_1(%arg0: memref<4x16xbf16, strided<[64, 1], offs
 // CHECK-SAME:  %[[ARG2:.+]]: memref<4x64xbf16, strided<[64, 1], offset: ?>>
 // CHECK: %[[DIS:.+]] = xsmm.gemm.dispatch [4, 64, 16, 64, 64, 64] flags = (vnni_b) data_type = bf16
 // CHECK: xsmm.gemm(data_type = bf16, %[[DIS]], %[[ARG0]], %[[ARG1]], %[[ARG2]])
+
+// -----
+
+func.func @gemm_dynamic_m(%arg0: memref<?x64xf32, strided<[64, 1], offset: ?>>,
+                          %arg1: memref<64x32xf32, strided<[32, 1], offset: ?>>,
+                          %arg2: memref<?x32xf32, strided<[32, 1], offset: ?>>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<?x64xf32, strided<[64, 1], offset: ?>>,
+                                   memref<64x32xf32, strided<[32, 1], offset: ?>>)
+                outs(%arg2 : memref<?x32xf32, strided<[32, 1], offset: ?>>)
+  return
+}
+
+// The m dimension is passed at runtime to the dispatch.
+// CHECK-LABEL: gemm_dynamic_m
+// CHECK-SAME: %[[ARG0:.+]]: memref<?x64xf32, strided<[64, 1], offset: ?>>,
+// CHECK-SAME: %[[ARG1:.+]]: memref<64x32xf32, strided<[32, 1], offset: ?>>,
+// CHECK-SAME: %[[ARG2:.+]]: memref<?x32xf32, strided<[32, 1], offset: ?>>
+// CHECK: %[[C0:.+]] = arith.constant 0 : index
+// CHECK: %[[DIM:.+]] = memref.dim %[[ARG2]], %[[C0]]
+// CHECK: %[[M:.+]] = arith.index_cast %[[DIM]] : index to i64
+// CHECK: %[[DIS:.+]] = xsmm.gemm.dispatch [0, 32, 64, 64, 32, 32] dynamic_m = %[[M]] flags = (none) data_type = f32
+// CHECK: xsmm.gemm(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]], %[[ARG2]])
+
+// -----
+
+func.func @gemm_dynamic_n(%arg0: memref<32x64xf32>, %arg1: memref<64x?xf32>,
+                          %arg2: memref<32x?xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<32x64xf32>, memref<64x?xf32>)
+                outs(%arg2 : memref<32x?xf32>)
+  return
+}
+
+// Only m can be dynamic.
+// CHECK-LABEL: gemm_dynamic_n
+// CHECK-NOT: xsmm.gemm
+// CHECK: linalg.matmul
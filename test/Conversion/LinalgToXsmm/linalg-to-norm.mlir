@@ -0,0 +1,352 @@
+// RUN: tpp-opt %s -convert-linalg-to-xsmm -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0, 0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+func.func @layernorm(%x: memref<8x16xf32>, %gamma: memref<16xf32>,
+                     %beta: memref<16xf32>, %out: memref<8x16xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %invN = arith.constant 0.0625 : f32
+  %eps = arith.constant 1.0e-05 : f32
+  %mean = memref.alloc() : memref<8x1xf32>
+  linalg.fill ins(%zero : f32) outs(%mean : memref<8x1xf32>)
+  linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : memref<8x16xf32>) outs(%mean : memref<8x1xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %invN : f32
+      %1 = arith.addf %0, %acc : f32
+      linalg.yield %1 : f32
+  }
+  %var = memref.alloc() : memref<8x1xf32>
+  linalg.fill ins(%zero : f32) outs(%var : memref<8x1xf32>)
+  linalg.generic {
+    indexing_maps = [#map, #row, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x, %mean : memref<8x16xf32>, memref<8x1xf32>) outs(%var : memref<8x1xf32>) {
+    ^bb0(%in: f32, %m: f32, %acc: f32):
+      %0 = arith.subf %in, %m : f32
+      %1 = arith.mulf %0, %0 : f32
+      %2 = arith.mulf %1, %invN : f32
+      %3 = arith.addf %2, %acc : f32
+      linalg.yield %3 : f32
+  }
+  linalg.generic {
+    indexing_maps = [#map, #row, #row, #col, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %mean, %var, %gamma, %beta
+      : memref<8x16xf32>, memref<8x1xf32>, memref<8x1xf32>, memref<16xf32>, memref<16xf32>)
+    outs(%out : memref<8x16xf32>) {
+    ^bb0(%in: f32, %m: f32, %v: f32, %g: f32, %b: f32, %o: f32):
+      %0 = arith.subf %in, %m : f32
+      %1 = arith.addf %v, %eps : f32
+      %2 = math.rsqrt %1 : f32
+      %3 = arith.mulf %0, %2 : f32
+      %4 = arith.mulf %3, %g : f32
+      %5 = arith.addf %4, %b : f32
+      linalg.yield %5 : f32
+  }
+  memref.dealloc %mean : memref<8x1xf32>
+  memref.dealloc %var : memref<8x1xf32>
+  return
+}
+
+// The statistics are computed by the kernel, their buffers are gone.
+// CHECK-LABEL: func.func @layernorm(
+// CHECK-SAME: %[[X:.+]]: memref<8x16xf32>, %[[GAMMA:.+]]: memref<16xf32>, %[[BETA:.+]]: memref<16xf32>, %[[OUT:.+]]: memref<8x16xf32>
+// CHECK-NOT: memref.alloc
+// CHECK-NOT: linalg.generic
+// CHECK: %[[DIS:.+]] = xsmm.norm.dispatch layernorm [8, 16, 16, 16] epsilon = {{.+}} data_type = f32
+// CHECK: xsmm.norm layernorm(data_type = f32, %[[DIS]], %[[X]], %[[GAMMA]], %[[BETA]], %[[OUT]])
+// CHECK-NOT: linalg.generic
+// CHECK-NOT: memref.dealloc
+// CHECK: return
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+func.func @rmsnorm(%x: memref<8x16xf32>, %gamma: memref<16xf32>,
+                   %out: memref<8x16xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %n = arith.constant 16.0 : f32
+  %eps = arith.constant 1.0e-06 : f32
+  %ms = memref.alloc() : memref<8xf32>
+  linalg.fill ins(%zero : f32) outs(%ms : memref<8xf32>)
+  linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : memref<8x16xf32>) outs(%ms : memref<8xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %in : f32
+      %1 = arith.divf %0, %n : f32
+      %2 = arith.addf %acc, %1 : f32
+      linalg.yield %2 : f32
+  }
+  linalg.generic {
+    indexing_maps = [#col, #row, #map, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%gamma, %ms, %x : memref<16xf32>, memref<8xf32>, memref<8x16xf32>)
+    outs(%out : memref<8x16xf32>) {
+    ^bb0(%g: f32, %s: f32, %in: f32, %o: f32):
+      %0 = arith.addf %eps, %s : f32
+      %1 = math.rsqrt %0 : f32
+      %2 = arith.mulf %g, %in : f32
+      %3 = arith.mulf %2, %1 : f32
+      linalg.yield %3 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @rmsnorm(
+// CHECK-SAME: %[[X:.+]]: memref<8x16xf32>, %[[GAMMA:.+]]: memref<16xf32>, %[[OUT:.+]]: memref<8x16xf32>
+// CHECK-NOT: memref.alloc
+// CHECK: %[[DIS:.+]] = xsmm.norm.dispatch rmsnorm [8, 16, 16, 16] epsilon = {{.+}} data_type = f32
+// CHECK: xsmm.norm rmsnorm(data_type = f32, %[[DIS]], %[[X]], %[[GAMMA]], %[[OUT]])
+// CHECK-NOT: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+// Bufferization shares the zero-filled init of the statistics through a copy.
+func.func @layernorm_copied_init(%x: memref<8x16xf32, strided<[32, 1]>>,
+                                 %gamma: memref<16xf32>, %beta: memref<16xf32>,
+                                 %out: memref<8x16xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %n = arith.constant 16.0 : f32
+  %eps = arith.constant 1.0e-05 : f32
+  %mean = memref.alloc() : memref<8xf32>
+  linalg.fill ins(%zero : f32) outs(%mean : memref<8xf32>)
+  %var = memref.alloc() : memref<8xf32>
+  linalg.copy ins(%mean : memref<8xf32>) outs(%var : memref<8xf32>)
+  linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : memref<8x16xf32, strided<[32, 1]>>) outs(%mean : memref<8xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.divf %in, %n : f32
+      %1 = arith.addf %0, %acc : f32
+      linalg.yield %1 : f32
+  }
+  linalg.generic {
+    indexing_maps = [#map, #row, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x, %mean : memref<8x16xf32, strided<[32, 1]>>, memref<8xf32>)
+    outs(%var : memref<8xf32>) {
+    ^bb0(%in: f32, %m: f32, %acc: f32):
+      %0 = arith.subf %in, %m : f32
+      %1 = arith.mulf %0, %0 : f32
+      %2 = arith.divf %1, %n : f32
+      %3 = arith.addf %2, %acc : f32
+      linalg.yield %3 : f32
+  }
+  linalg.generic {
+    indexing_maps = [#map, #row, #row, #col, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %mean, %var, %gamma, %beta
+      : memref<8x16xf32, strided<[32, 1]>>, memref<8xf32>, memref<8xf32>,
+        memref<16xf32>, memref<16xf32>)
+    outs(%out : memref<8x16xf32>) {
+    ^bb0(%in: f32, %m: f32, %v: f32, %g: f32, %b: f32, %o: f32):
+      %0 = arith.subf %in, %m : f32
+      %1 = arith.addf %v, %eps : f32
+      %2 = math.sqrt %1 : f32
+      %3 = arith.divf %0, %2 : f32
+      %4 = arith.mulf %g, %3 : f32
+      %5 = arith.addf %b, %4 : f32
+      linalg.yield %5 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @layernorm_copied_init(
+// CHECK-SAME: %[[X:.+]]: memref<8x16xf32, strided<[32, 1]>>, %[[GAMMA:.+]]: memref<16xf32>, %[[BETA:.+]]: memref<16xf32>, %[[OUT:.+]]: memref<8x16xf32>
+// CHECK-NOT: memref.alloc
+// CHECK-NOT: linalg.copy
+// CHECK: %[[DIS:.+]] = xsmm.norm.dispatch layernorm [8, 16, 32, 16] epsilon = {{.+}} data_type = f32
+// CHECK: xsmm.norm layernorm(data_type = f32, %[[DIS]], %[[X]], %[[GAMMA]], %[[BETA]], %[[OUT]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+// The mean square is needed after the normalization, nothing to fuse.
+func.func @rmsnorm_stat_escapes(%x: memref<8x16xf32>, %gamma: memref<16xf32>,
+                                %out: memref<8x16xf32>, %ms: memref<8xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %invN = arith.constant 0.0625 : f32
+  %eps = arith.constant 1.0e-06 : f32
+  linalg.fill ins(%zero : f32) outs(%ms : memref<8xf32>)
+  linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : memref<8x16xf32>) outs(%ms : memref<8xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %in : f32
+      %1 = arith.mulf %0, %invN : f32
+      %2 = arith.addf %acc, %1 : f32
+      linalg.yield %2 : f32
+  }
+  linalg.generic {
+    indexing_maps = [#map, #row, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %ms, %gamma : memref<8x16xf32>, memref<8xf32>, memref<16xf32>)
+    outs(%out : memref<8x16xf32>) {
+    ^bb0(%in: f32, %s: f32, %g: f32, %o: f32):
+      %0 = arith.addf %s, %eps : f32
+      %1 = math.rsqrt %0 : f32
+      %2 = arith.mulf %in, %1 : f32
+      %3 = arith.mulf %2, %g : f32
+      linalg.yield %3 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @rmsnorm_stat_escapes(
+// CHECK-NOT: xsmm.norm
+// CHECK: linalg.generic
+// CHECK: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+// The accumulator of the mean is not zero.
+func.func @rmsnorm_not_zero_init(%x: memref<8x16xf32>, %gamma: memref<16xf32>,
+                                 %out: memref<8x16xf32>) {
+  %one = arith.constant 1.0 : f32
+  %invN = arith.constant 0.0625 : f32
+  %eps = arith.constant 1.0e-06 : f32
+  %ms = memref.alloc() : memref<8xf32>
+  linalg.fill ins(%one : f32) outs(%ms : memref<8xf32>)
+  linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : memref<8x16xf32>) outs(%ms : memref<8xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %in : f32
+      %1 = arith.mulf %0, %invN : f32
+      %2 = arith.addf %acc, %1 : f32
+      linalg.yield %2 : f32
+  }
+  linalg.generic {
+    indexing_maps = [#map, #row, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %ms, %gamma : memref<8x16xf32>, memref<8xf32>, memref<16xf32>)
+    outs(%out : memref<8x16xf32>) {
+    ^bb0(%in: f32, %s: f32, %g: f32, %o: f32):
+      %0 = arith.addf %s, %eps : f32
+      %1 = math.rsqrt %0 : f32
+      %2 = arith.mulf %in, %1 : f32
+      %3 = arith.mulf %2, %g : f32
+      linalg.yield %3 : f32
+  }
+  memref.dealloc %ms : memref<8xf32>
+  return
+}
+
+// CHECK-LABEL: func.func @rmsnorm_not_zero_init(
+// CHECK-NOT: xsmm.norm
+// CHECK: linalg.generic
+// CHECK: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+// The mean is not divided by the row size.
+func.func @rmsnorm_wrong_scale(%x: memref<8x16xf32>, %gamma: memref<16xf32>,
+                               %out: memref<8x16xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %scale = arith.constant 0.125 : f32
+  %eps = arith.constant 1.0e-06 : f32
+  %ms = memref.alloc() : memref<8xf32>
+  linalg.fill ins(%zero : f32) outs(%ms : memref<8xf32>)
+  linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : memref<8x16xf32>) outs(%ms : memref<8xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %in : f32
+      %1 = arith.mulf %0, %scale : f32
+      %2 = arith.addf %acc, %1 : f32
+      linalg.yield %2 : f32
+  }
+  linalg.generic {
+    indexing_maps = [#map, #row, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %ms, %gamma : memref<8x16xf32>, memref<8xf32>, memref<16xf32>)
+    outs(%out : memref<8x16xf32>) {
+    ^bb0(%in: f32, %s: f32, %g: f32, %o: f32):
+      %0 = arith.addf %s, %eps : f32
+      %1 = math.rsqrt %0 : f32
+      %2 = arith.mulf %in, %1 : f32
+      %3 = arith.mulf %2, %g : f32
+      linalg.yield %3 : f32
+  }
+  memref.dealloc %ms : memref<8xf32>
+  return
+}
+
+// CHECK-LABEL: func.func @rmsnorm_wrong_scale(
+// CHECK-NOT: xsmm.norm
+// CHECK: linalg.generic
+// CHECK: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+// The mean is divided by a size close to but different from the row size.
+func.func @rmsnorm_near_size(%x: memref<8x768xf32>, %gamma: memref<768xf32>,
+                             %out: memref<8x768xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %n = arith.constant 770.0 : f32
+  %eps = arith.constant 1.0e-06 : f32
+  %ms = memref.alloc() : memref<8xf32>
+  linalg.fill ins(%zero : f32) outs(%ms : memref<8xf32>)
+  linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : memref<8x768xf32>) outs(%ms : memref<8xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %in : f32
+      %1 = arith.divf %0, %n : f32
+      %2 = arith.addf %acc, %1 : f32
+      linalg.yield %2 : f32
+  }
+  linalg.generic {
+    indexing_maps = [#col, #row, #map, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%gamma, %ms, %x : memref<768xf32>, memref<8xf32>, memref<8x768xf32>)
+    outs(%out : memref<8x768xf32>) {
+    ^bb0(%g: f32, %s: f32, %in: f32, %o: f32):
+      %0 = arith.addf %eps, %s : f32
+      %1 = math.rsqrt %0 : f32
+      %2 = arith.mulf %g, %in : f32
+      %3 = arith.mulf %2, %1 : f32
+      linalg.yield %3 : f32
+  }
+  memref.dealloc %ms : memref<8xf32>
+  return
+}
+
+// CHECK-LABEL: func.func @rmsnorm_near_size(
+// CHECK-NOT: xsmm.norm
+// CHECK: linalg.generic
+// CHECK: linalg.generic
@@ -518,3 +518,289 @@ func.func @linalg_copy(%arg0: memref<2x2xf32>, %arg1: memref<2x2xf32>) {
 // CHECK-SAME: %[[ARG0:.+]]: memref<2x2xf32>, %[[ARG1:.+]]: memref<2x2xf32>
 // CHECK: %[[DIS:.+]] = xsmm.unary.dispatch identity [2, 2, 2, 2] flags = (none) data_type = f32
 // CHECK: xsmm.unary identity(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @exp(%arg0: memref<8x16xf32>, %arg1: memref<8x16xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<8x16xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = math.exp %in : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @exp(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>, %[[ARG1:.+]]: memref<8x16xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch exp [8, 16, 16, 16] flags = (none) data_type = f32
+// CHECK: xsmm.unary exp(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0)>
+#map1 = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @exp_bcast_row(%arg0: memref<8xf32>, %arg1: memref<8x16xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%arg0 : memref<8xf32>) outs(%arg1 : memref<8x16xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = math.exp %in : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @exp_bcast_row(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8xf32>, %[[ARG1:.+]]: memref<8x16xf32>
+// CHECK: %[[EXP:.+]] = memref.expand_shape %[[ARG0]] {{\[}}[0, 1]] output_shape [8, 1] : memref<8xf32> into memref<8x1xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch exp [8, 16, 1, 16] flags = (bcast_row) data_type = f32
+// CHECK: xsmm.unary exp(data_type = f32, %[[DIS]], %[[EXP]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// The exponential must be applied on the input, not on the output.
+func.func @exp_of_output(%arg0: memref<8x16xf32>, %arg1: memref<8x16xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<8x16xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = math.exp %out : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @exp_of_output(
+// CHECK-NOT: xsmm.unary
+// CHECK: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+
+func.func @reduce_add_rows(%arg0: memref<8x16xf32>, %arg1: memref<8xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<8xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = arith.addf %in, %out : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @reduce_add_rows(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>, %[[ARG1:.+]]: memref<8xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch reduce_add [8, 16, 16, 8]
+// CHECK-SAME:  flags = (reduce_rows, reduce_init_acc) data_type = f32
+// CHECK: xsmm.unary reduce_add(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0, 0)>
+
+func.func @reduce_max_rows(%arg0: memref<8x16xf32>, %arg1: memref<8x1xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<8x1xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = arith.maximumf %out, %in : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @reduce_max_rows(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>, %[[ARG1:.+]]: memref<8x1xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch reduce_max [8, 16, 16, 8]
+// CHECK-SAME:  flags = (reduce_rows, reduce_init_acc) data_type = f32
+// CHECK: xsmm.unary reduce_max(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1)>
+
+func.func @reduce_add_cols(%arg0: memref<8x16xf32>, %arg1: memref<16xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1],
+    iterator_types = ["reduction", "parallel"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<16xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = arith.addf %in, %out : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @reduce_add_cols(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>, %[[ARG1:.+]]: memref<16xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch reduce_add [8, 16, 16, 16]
+// CHECK-SAME:  flags = (reduce_cols, reduce_init_acc) data_type = f32
+// CHECK: xsmm.unary reduce_add(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+
+// Reduced values must be contiguous.
+func.func @reduce_add_strided(%arg0: memref<8x16xf32>,
+                              %arg1: memref<8xf32, strided<[2], offset: ?>>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<8xf32, strided<[2], offset: ?>>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = arith.addf %in, %out : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @reduce_add_strided(
+// CHECK-NOT: xsmm.unary
+// CHECK: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @tanh(%arg0: memref<8x16xf32>, %arg1: memref<8x16xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<8x16xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = math.tanh %in : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @tanh(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>, %[[ARG1:.+]]: memref<8x16xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch tanh [8, 16, 16, 16] flags = (none) data_type = f32
+// CHECK: xsmm.unary tanh(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @sigmoid_in_place(%arg0: memref<8x16xf32>) {
+  %one = arith.constant 1.0 : f32
+  linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : memref<8x16xf32>) {
+    ^bb0(%out: f32):
+      %0 = arith.negf %out : f32
+      %1 = math.exp %0 : f32
+      %2 = arith.addf %1, %one : f32
+      %3 = arith.divf %one, %2 : f32
+      linalg.yield %3 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @sigmoid_in_place(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch sigmoid [8, 16, 16, 16] flags = (none) data_type = f32
+// CHECK: xsmm.unary sigmoid(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG0]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @gelu_in_place(%arg0: memref<8x16xf32>) {
+  %half = arith.constant 0.5 : f32
+  %one = arith.constant 1.0 : f32
+  %rsqrt2 = arith.constant 0.707106769 : f32
+  linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : memref<8x16xf32>) {
+    ^bb0(%out: f32):
+      %0 = arith.mulf %out, %rsqrt2 : f32
+      %1 = math.erf %0 : f32
+      %2 = arith.addf %1, %one : f32
+      %3 = arith.mulf %out, %2 : f32
+      %4 = arith.mulf %3, %half : f32
+      linalg.yield %4 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @gelu_in_place(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch gelu [8, 16, 16, 16] flags = (none) data_type = f32
+// CHECK: xsmm.unary gelu(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG0]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @gelu_div(%arg0: memref<8x16xf32>, %arg1: memref<8x16xf32>) {
+  %half = arith.constant 0.5 : f32
+  %one = arith.constant 1.0 : f32
+  %sqrt2 = arith.constant 1.41421354 : f32
+  linalg.generic {
+    indexing_maps = [#map, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%arg0 : memref<8x16xf32>) outs(%arg1 : memref<8x16xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = arith.mulf %half, %in : f32
+      %1 = arith.divf %in, %sqrt2 : f32
+      %2 = math.erf %1 : f32
+      %3 = arith.addf %one, %2 : f32
+      %4 = arith.mulf %0, %3 : f32
+      linalg.yield %4 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @gelu_div(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x16xf32>, %[[ARG1:.+]]: memref<8x16xf32>
+// CHECK: %[[DIS:.+]] = xsmm.unary.dispatch gelu [8, 16, 16, 16] flags = (none) data_type = f32
+// CHECK: xsmm.unary gelu(data_type = f32, %[[DIS]], %[[ARG0]], %[[ARG1]])
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @gelu_wrong_constant(%arg0: memref<8x16xf32>) {
+  %half = arith.constant 0.5 : f32
+  %one = arith.constant 1.0 : f32
+  %c = arith.constant 0.8 : f32
+  linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : memref<8x16xf32>) {
+    ^bb0(%out: f32):
+      %0 = arith.mulf %out, %c : f32
+      %1 = math.erf %0 : f32
+      %2 = arith.addf %1, %one : f32
+      %3 = arith.mulf %out, %2 : f32
+      %4 = arith.mulf %3, %half : f32
+      linalg.yield %4 : f32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @gelu_wrong_constant(
+// CHECK-NOT: xsmm.unary
+// CHECK: linalg.generic
@@ -92,3 +92,17 @@ func.func @perf_example(%A: tensor<4x8xf32>,
   // CHECK: return %[[stats]], %[[res]]
   return %stats, %res : f64, i64
 }
+
+// -----
+
+// CHECK-DAG: func.func private @perf_timeline_begin() -> i64
+// CHECK-DAG: func.func private @perf_timeline_end(i64, i64, i64)
+// CHECK-LABEL: @func_timeline
+func.func @func_timeline(%arg0: i64) {
+  // CHECK-DAG: %[[kind:.*]] = arith.constant 1 : i64
+  // CHECK: %[[begin:.*]] = call @perf_timeline_begin()
+  %begin = perf.timeline_begin : i64
+  // CHECK: call @perf_timeline_end(%[[begin]], %[[kind]], %arg0)
+  perf.timeline_end(%begin, %arg0) kind = 1
+  return
+}
@@ -0,0 +1,115 @@
+// RUN: tpp-opt %s -convert-xsmm-to-func="direct-call=1" -split-input-file | FileCheck %s
+
+func.func @gemm(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>, %arg2: memref<32x32xf32>) {
+  %0 = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (none) data_type = f32
+  xsmm.gemm(data_type = f32, %0, %arg0, %arg1, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  return
+}
+
+// CHECK-LABEL: func.func @gemm(
+// CHECK:         %[[param:.+]] = llvm.alloca %{{.+}} x !llvm.array<17 x ptr> : (i64) -> !llvm.ptr
+// CHECK:         %[[kernel:.+]] = call @xsmm_gemm_dispatch(
+// CHECK:         %[[A:.+]] = llvm.getelementptr %{{.+}}[%{{.+}}] : (!llvm.ptr, i64) -> !llvm.ptr, f32
+// CHECK:         %[[B:.+]] = llvm.getelementptr %{{.+}}[%{{.+}}] : (!llvm.ptr, i64) -> !llvm.ptr, f32
+// CHECK:         %[[C:.+]] = llvm.getelementptr %{{.+}}[%{{.+}}] : (!llvm.ptr, i64) -> !llvm.ptr, f32
+// CHECK:         %[[slotA:.+]] = llvm.getelementptr %[[param]][0, 4]
+// CHECK:         llvm.store %[[B]], %[[slotA]] : !llvm.ptr, !llvm.ptr
+// CHECK:         %[[slotB:.+]] = llvm.getelementptr %[[param]][0, 8]
+// CHECK:         llvm.store %[[A]], %[[slotB]] : !llvm.ptr, !llvm.ptr
+// CHECK:         %[[slotC:.+]] = llvm.getelementptr %[[param]][0, 12]
+// CHECK:         llvm.store %[[C]], %[[slotC]] : !llvm.ptr, !llvm.ptr
+// CHECK:         %[[fn:.+]] = llvm.inttoptr %[[kernel]] : i64 to !llvm.ptr
+// CHECK:         llvm.call %[[fn]](%[[param]]) : !llvm.ptr, (!llvm.ptr) -> ()
+// CHECK-NOT:     xsmm_gemm_invoke
+
+// -----
+
+func.func @brgemm(%arg0: memref<4x32x32xbf16>, %arg1: memref<4x16x32x2xbf16>, %arg2: memref<32x32xbf16>) {
+  %c4 = arith.constant 4 : i64
+  %0 = xsmm.brgemm.dispatch [32, 32, 32, 32, 32, 32, 1024, 1024] flags = (vnni_b) data_type = bf16
+  xsmm.brgemm(data_type = bf16, %0, %arg0, %arg1, %arg2, %c4) : (i64, memref<4x32x32xbf16>, memref<4x16x32x2xbf16>, memref<32x32xbf16>, i64) -> ()
+  return
+}
+
+// CHECK-LABEL: func.func @brgemm(
+// CHECK:         %[[param:.+]] = llvm.alloca %{{.+}} x !llvm.array<17 x ptr>
+// CHECK:         llvm.getelementptr %{{.+}}[%{{.+}}] : (!llvm.ptr, i64) -> !llvm.ptr, bf16
+// CHECK:         %[[batch:.+]] = llvm.getelementptr %[[param]][0, 16]
+// CHECK:         llvm.store %{{.+}}, %[[batch]] : i64, !llvm.ptr
+// CHECK:         %[[tertiary:.+]] = llvm.getelementptr %[[param]][0, 2]
+// CHECK:         llvm.store %[[batch]], %[[tertiary]] : !llvm.ptr, !llvm.ptr
+// CHECK:         llvm.call %{{.+}}(%[[param]]) : !llvm.ptr, (!llvm.ptr) -> ()
+// CHECK-NOT:     xsmm_brgemm_invoke
+
+// -----
+
+func.func @eltwise(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>, %arg2: memref<32x32xf32>) {
+  %0 = xsmm.binary.dispatch add [32, 32, 32, 32, 32] flags = (none) data_type = f32
+  xsmm.binary add(data_type = f32, %0, %arg0, %arg1, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  %1 = xsmm.unary.dispatch relu [32, 32, 32, 32] flags = (none) data_type = f32
+  xsmm.unary relu(data_type = f32, %1, %arg2, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  %cst = arith.constant 0.0 : f32
+  %2 = xsmm.unary.dispatch identity [32, 32, 1, 32] flags = (bcast_scalar) data_type = f32
+  xsmm.unary identity(data_type = f32, %2, %cst, %arg2) : (i64, f32, memref<32x32xf32>) -> ()
+  return
+}
+
+// One parameter buffer is shared within the function. Scalar inputs still go
+// through the runtime.
+// CHECK-LABEL: func.func @eltwise(
+// CHECK:         %[[param:.+]] = llvm.alloca %{{.+}} x !llvm.array<17 x ptr>
+// CHECK-NOT:     llvm.alloca
+// CHECK:         llvm.getelementptr %[[param]][0, 4]
+// CHECK:         llvm.getelementptr %[[param]][0, 8]
+// CHECK:         llvm.getelementptr %[[param]][0, 12]
+// CHECK:         llvm.call %{{.+}}(%[[param]])
+// CHECK:         llvm.getelementptr %[[param]][0, 4]
+// CHECK:         llvm.getelementptr %[[param]][0, 8]
+// CHECK:         llvm.call %{{.+}}(%[[param]])
+// CHECK:         call @xsmm_unary_scalar_invoke(
+
+// -----
+
+func.func @binary_scalar(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>) {
+  %cst = arith.constant 2.0 : f32
+  %0 = xsmm.binary.dispatch mul [32, 32, 1, 32, 32] flags = (bcast_scalar_in0) data_type = f32
+  xsmm.binary mul(data_type = f32, %0, %cst, %arg0, %arg1) : (i64, f32, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  %1 = xsmm.binary.dispatch add [32, 32, 32, 1, 32] flags = (bcast_scalar_in1) data_type = f32
+  xsmm.binary add(data_type = f32, %1, %arg0, %cst, %arg1) : (i64, memref<32x32xf32>, f32, memref<32x32xf32>) -> ()
+  return
+}
+
+// Binary ops with a scalar operand go through the runtime.
+// CHECK-LABEL: func.func @binary_scalar(
+// CHECK-NOT:     llvm.call
+// CHECK:         call @xsmm_binary_invoke(
+// CHECK-NOT:     llvm.call
+// CHECK:         call @xsmm_binary_invoke(
+// CHECK-NOT:     llvm.call
+// CHECK:         return
+
+// -----
+
+func.func @parallel(%arg0: memref<8x32x32xf32>, %arg1: memref<32x32xf32>, %arg2: memref<8x32x32xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %0 = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (none) data_type = f32
+  scf.parallel (%i) = (%c0) to (%c8) step (%c1) {
+    %a = memref.subview %arg0[%i, 0, 0] [1, 32, 32] [1, 1, 1] : memref<8x32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+    %c = memref.subview %arg2[%i, 0, 0] [1, 32, 32] [1, 1, 1] : memref<8x32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+    xsmm.gemm(data_type = f32, %0, %a, %arg1, %c) : (i64, memref<32x32xf32, strided<[32, 1], offset: ?>>, memref<32x32xf32>, memref<32x32xf32, strided<[32, 1], offset: ?>>) -> ()
+    scf.reduce
+  }
+  return
+}
+
+// Concurrent iterations use their own parameter buffer.
+// CHECK-LABEL: func.func @parallel(
+// CHECK-NOT:     llvm.alloca
+// CHECK:         scf.parallel
+// CHECK:           %[[stack:.+]] = llvm.intr.stacksave : !llvm.ptr
+// CHECK:           %[[param:.+]] = llvm.alloca %{{.+}} x !llvm.array<17 x ptr>
+// CHECK:           llvm.call %{{.+}}(%[[param]])
+// CHECK:           llvm.intr.stackrestore %[[stack]] : !llvm.ptr
+// CHECK:           scf.reduce
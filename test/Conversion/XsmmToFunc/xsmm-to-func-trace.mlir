@@ -0,0 +1,27 @@
+// RUN: tpp-opt %s -convert-xsmm-to-func="trace=1" -split-input-file | FileCheck %s
+// RUN: tpp-opt %s -convert-xsmm-to-func="direct-call=1 trace=1" -split-input-file | FileCheck %s
+
+func.func @gemm(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>, %arg2: memref<32x32xf32>) {
+  %0 = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (none) data_type = f32
+  xsmm.gemm(data_type = f32, %0, %arg0, %arg1, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  return
+}
+
+// Tracing is enabled before the kernels are dispatched and the invocations
+// go through the runtime.
+// CHECK-LABEL: func.func @gemm(
+// CHECK-NOT:     xsmm_gemm_dispatch
+// CHECK:         call @xsmm_trace_enable() : () -> ()
+// CHECK:         call @xsmm_gemm_dispatch(
+// CHECK-NOT:     llvm.call
+// CHECK:         call @xsmm_gemm_invoke(
+// CHECK:       func.func private @xsmm_trace_enable()
+
+// -----
+
+func.func @no_kernels(%arg0: memref<32x32xf32>) {
+  return
+}
+
+// CHECK-LABEL: func.func @no_kernels(
+// CHECK-NOT:     xsmm_trace_enable
@@ -145,6 +145,28 @@ func.func @invoke_brgemm(%arg0: memref<2x5x4xf32>, %arg1: memref<2x4x5xf32>,
 
 // -----
 
+func.func @invoke_gemm_batch(%arg0: memref<4x4xf32>, %arg1: memref<4x4xf32>,
+                             %arg2: memref<4x4xf32>, %count: i64, %stride: i64) {
+  %0 = xsmm.gemm.dispatch [4, 4, 4, 4, 4, 4] flags = (none) data_type = f32
+  xsmm.gemm_batch(data_type = f32, %0, %arg0, %arg1, %arg2, %count, %stride, %stride, %stride)
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>, i64, i64, i64, i64) -> ()
+  %1 = xsmm.brgemm.dispatch [4, 4, 4, 4, 4, 4, 16, 16] flags = (none) data_type = f32
+  xsmm.gemm_batch(data_type = f32, %1, %arg0, %arg1, %arg2, %count, %stride, %stride, %stride, %count)
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>, i64, i64, i64, i64, i64) -> ()
+  return
+}
+
+// CHECK-LABEL: invoke_gemm_batch
+// CHECK-SAME: %{{.+}}: memref<4x4xf32>, %{{.+}}: memref<4x4xf32>, %{{.+}}: memref<4x4xf32>, %[[COUNT:.+]]: i64, %[[STRIDE:.+]]: i64
+// CHECK: %[[GEMM:.+]] = call @xsmm_gemm_dispatch
+// CHECK: call @xsmm_gemm_batch_invoke(%{{.+}}, %[[GEMM]], %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %[[COUNT]], %[[STRIDE]], %[[STRIDE]], %[[STRIDE]])
+// CHECK: %[[BRGEMM:.+]] = call @xsmm_brgemm_dispatch
+// CHECK: call @xsmm_brgemm_batch_invoke(%{{.+}}, %[[BRGEMM]], %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %[[COUNT]], %[[STRIDE]], %[[STRIDE]], %[[STRIDE]], %[[COUNT]])
+// CHECK-DAG: func.func private @xsmm_gemm_batch_invoke(i64, i64, !llvm.ptr, index, !llvm.ptr, index, !llvm.ptr, index, i64, i64, i64, i64)
+// CHECK-DAG: func.func private @xsmm_brgemm_batch_invoke(i64, i64, !llvm.ptr, index, !llvm.ptr, index, !llvm.ptr, index, i64, i64, i64, i64, i64)
+
+// -----
+
 func.func @invoke_unary(%arg0: memref<512xbf16>, %arg1: memref<128x512xbf16>) {
   %0 = xsmm.unary.dispatch identity [128, 512, 512, 512]  flags = (bcast_col) data_type = bf16
   xsmm.unary identity(data_type = bf16, %0, %arg0, %arg1) : (i64, memref<512xbf16>, memref<128x512xbf16>) -> ()
@@ -430,3 +452,105 @@ func.func @dispatch_binary() -> i64 {
 // CHECK-DAG: %[[C32:.+]] = arith.constant 32 : i64
 // CHECK: %{{.+}} = call @xsmm_binary_dispatch(%[[C1]], %[[C1]], %[[C5]], %[[C6]], %[[C5]], %[[C6]], %[[C5]], %[[C32]])
 
+
+// -----
+
+// CHECK-LABEL: dispatch_gemm_dynamic_m
+// CHECK-SAME: %[[M:.+]]: i64
+func.func @dispatch_gemm_dynamic_m(%m: i64) -> i64 {
+  %0 = xsmm.gemm.dispatch [0, 2, 3, 4, 5, 6] dynamic_m = %m flags = (none) data_type = f32
+  return %0 : i64
+}
+
+// The runtime m replaces the static one.
+// CHECK-DAG: %[[C1:.+]] = arith.constant 1 : i64
+// CHECK-DAG: %[[C2:.+]] = arith.constant 2 : i64
+// CHECK-DAG: %[[C3:.+]] = arith.constant 3 : i64
+// CHECK-DAG: %[[C4:.+]] = arith.constant 4 : i64
+// CHECK-DAG: %[[C5:.+]] = arith.constant 5 : i64
+// CHECK-DAG: %[[C6:.+]] = arith.constant 6 : i64
+// CHECK-DAG: %[[C0:.+]] = arith.constant 0 : i64
+// CHECK: call @xsmm_gemm_dispatch(%[[C1]], %[[M]], %[[C2]], %[[C3]], %[[C4]], %[[C5]], %[[C6]], %[[C0]])
+
+// -----
+
+// CHECK-LABEL: dispatch_norm
+func.func @dispatch_norm() -> i64 {
+  %0 = xsmm.norm.dispatch layernorm [4, 8, 16, 8] epsilon = 5.0e-01 data_type = f32
+  return %0 : i64
+}
+
+// CHECK-DAG: %[[C1:.+]] = arith.constant 1 : i64
+// CHECK-DAG: %[[C4:.+]] = arith.constant 4 : i64
+// CHECK-DAG: %[[C8:.+]] = arith.constant 8 : i64
+// CHECK-DAG: %[[C16:.+]] = arith.constant 16 : i64
+// CHECK-DAG: %[[EPS:.+]] = arith.constant 5.000000e-01 : f32
+// CHECK: call @xsmm_norm_dispatch(%[[C1]], %[[C1]], %[[C4]], %[[C8]], %[[C16]], %[[C8]], %[[EPS]])
+// CHECK: func.func private @xsmm_norm_dispatch(i64, i64, i64, i64, i64, i64, f32) -> i64
+
+// -----
+
+func.func @invoke_norm(%arg0: memref<4x8xbf16>, %arg1: memref<8xbf16>,
+                       %arg2: memref<8xbf16>, %arg3: memref<4x8xbf16>) {
+  %0 = xsmm.norm.dispatch layernorm [4, 8, 8, 8] epsilon = 1.0e-05 data_type = bf16
+  xsmm.norm layernorm(data_type = bf16, %0, %arg0, %arg1, %arg2, %arg3)
+    : (i64, memref<4x8xbf16>, memref<8xbf16>, memref<8xbf16>, memref<4x8xbf16>) -> ()
+  %1 = xsmm.norm.dispatch rmsnorm [4, 8, 8, 8] epsilon = 1.0e-05 data_type = bf16
+  xsmm.norm rmsnorm(data_type = bf16, %1, %arg0, %arg1, %arg3)
+    : (i64, memref<4x8xbf16>, memref<8xbf16>, memref<4x8xbf16>) -> ()
+  return
+}
+
+// CHECK-LABEL: invoke_norm
+// CHECK-DAG: %[[C2:.+]] = arith.constant 2 : i64
+// CHECK: %[[LN:.+]] = call @xsmm_norm_dispatch
+// CHECK: call @xsmm_layernorm_invoke(%[[C2]], %[[LN]], %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}})
+// CHECK: %[[RMS:.+]] = call @xsmm_norm_dispatch
+// CHECK: call @xsmm_rmsnorm_invoke(%[[C2]], %[[RMS]], %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}})
+
+// -----
+
+func.func @invoke_brgemm_offs(%arg0: memref<2x4x8xf32>, %arg1: memref<3x8x4xf32>,
+                              %arg2: memref<4x4xf32>, %arg3: memref<4x4xf32>) {
+  %0 = xsmm.brgemm_offs.dispatch [4, 4, 8, 8, 4, 4] flags = (none) data_type = f32
+  xsmm.brgemm_offs(data_type = f32, %0, %arg0, %arg1, %arg2)
+    offsets_a = [0, 8, 32] offsets_b = [0, 32, 64]
+    : (i64, memref<2x4x8xf32>, memref<3x8x4xf32>, memref<4x4xf32>) -> ()
+  xsmm.brgemm_offs(data_type = f32, %0, %arg0, %arg1, %arg3)
+    offsets_a = [0, 8, 32] offsets_b = [0, 32, 64]
+    : (i64, memref<2x4x8xf32>, memref<3x8x4xf32>, memref<4x4xf32>) -> ()
+  return
+}
+
+// The offsets are converted to bytes and shared between the invocations.
+// CHECK-DAG: memref.global "private" constant @__xsmm_brgemm_offsets_0 : memref<3xi64> = dense<[0, 32, 128]>
+// CHECK-DAG: memref.global "private" constant @__xsmm_brgemm_offsets_1 : memref<3xi64> = dense<[0, 128, 256]>
+// CHECK-NOT: memref.global
+// CHECK-LABEL: invoke_brgemm_offs
+// CHECK: %[[ADDR:.+]] = call @xsmm_brgemm_offs_dispatch
+// CHECK: %[[OFFS_A:.+]] = memref.get_global @__xsmm_brgemm_offsets_0 : memref<3xi64>
+// CHECK: %[[OFFS_B:.+]] = memref.get_global @__xsmm_brgemm_offsets_1 : memref<3xi64>
+// CHECK: call @xsmm_brgemm_offs_invoke(%{{.+}}, %[[ADDR]], {{.+}}, %{{.+}}) : (i64, i64, !llvm.ptr, index, !llvm.ptr, index, !llvm.ptr, index, !llvm.ptr, index, !llvm.ptr, index, i64) -> ()
+// CHECK: memref.get_global @__xsmm_brgemm_offsets_0 : memref<3xi64>
+// CHECK: memref.get_global @__xsmm_brgemm_offsets_1 : memref<3xi64>
+// CHECK: call @xsmm_brgemm_offs_invoke(
+// CHECK: func.func private @xsmm_brgemm_offs_invoke(i64, i64, !llvm.ptr, index, !llvm.ptr, index, !llvm.ptr, index, !llvm.ptr, index, !llvm.ptr, index, i64)
+
+// -----
+
+func.func @invoke_brgemm_addr(%arg0: memref<3xi64>, %arg1: memref<3xi64>,
+                              %arg2: memref<4x4xf32>, %batch: i64) {
+  %0 = xsmm.brgemm_addr.dispatch [4, 4, 8, 8, 4, 4] flags = (none) data_type = f32
+  xsmm.brgemm_addr(data_type = f32, %0, %arg0, %arg1, %arg2, %batch)
+    : (i64, memref<3xi64>, memref<3xi64>, memref<4x4xf32>, i64) -> ()
+  return
+}
+
+// CHECK-LABEL: invoke_brgemm_addr
+// CHECK-SAME: %{{.+}}: memref<3xi64>, %{{.+}}: memref<3xi64>, %{{.+}}: memref<4x4xf32>, %[[BATCH:.+]]: i64
+// CHECK-DAG: %[[C1:.+]] = arith.constant 1 : i64
+// CHECK-DAG: %[[C4:.+]] = arith.constant 4 : i64
+// CHECK-DAG: %[[C8:.+]] = arith.constant 8 : i64
+// CHECK-DAG: %[[C0:.+]] = arith.constant 0 : i64
+// CHECK: %[[ADDR:.+]] = call @xsmm_brgemm_addr_dispatch(%[[C1]], %[[C4]], %[[C4]], %[[C8]], %[[C8]], %[[C4]], %[[C4]], %[[C0]])
+// CHECK: call @xsmm_brgemm_addr_invoke(%[[C1]], %[[ADDR]], {{.+}}, %[[BATCH]])
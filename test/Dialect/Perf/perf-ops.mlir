@@ -12,6 +12,17 @@ func.func @perf_timer(%a: i32, %b: i32, %n: i64) -> f64 {
 
 // -----
 
+// CHECK-LABEL: @perf_timeline
+func.func @perf_timeline(%arg: i64) {
+  // CHECK: %[[begin:.+]] = perf.timeline_begin : i64
+  %begin = perf.timeline_begin : i64
+  // CHECK: perf.timeline_end(%[[begin]], %{{.+}}) kind = 1
+  perf.timeline_end(%begin, %arg) kind = 1
+  return
+}
+
+// -----
+
 /// CHECK-LABEL: @perf_matmul_bench
 func.func @perf_matmul_bench(%A: tensor<4x8xf32>,
           %B: tensor<8x4xf32>, %C: tensor<4x4xf32>, %n: i64) -> f64 {
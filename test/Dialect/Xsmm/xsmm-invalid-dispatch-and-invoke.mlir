@@ -242,3 +242,43 @@ func.func @binary(%arg0: memref<3x3xf32>, %arg1: memref<3x3xf32>) {
     (i64, memref<3x3xf32>, memref<3x3xf32>, memref<3x3xf32>) -> ()
   return
 }
+
+// -----
+
+func.func @unary(%arg0: memref<3x3xf32>, %arg1: memref<3x3xf32>) {
+  %0 = xsmm.unary.dispatch exp [3, 3, 3, 3] flags = (reduce_rows) data_type = f32
+  // expected-error@+1 {{invalid reduce flag for element-wise operation}}
+  xsmm.unary exp(data_type = f32, %0, %arg0, %arg1) :
+    (i64, memref<3x3xf32>, memref<3x3xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @unary(%arg0: memref<3x3xf32>, %arg1: memref<3xf32>) {
+  %0 = xsmm.unary.dispatch reduce_add [3, 3, 3, 3] flags = (reduce_init_acc) data_type = f32
+  // expected-error@+1 {{expect exactly one of 'reduce_rows' or 'reduce_cols' flags}}
+  xsmm.unary reduce_add(data_type = f32, %0, %arg0, %arg1) :
+    (i64, memref<3x3xf32>, memref<3xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @unary(%arg0: memref<3x3xf32>, %arg1: memref<3xf32>) {
+  %0 = xsmm.unary.dispatch reduce_max [3, 3, 3, 3] flags = (reduce_rows, bcast_row) data_type = f32
+  // expected-error@+1 {{invalid broadcast flag for reduce operation}}
+  xsmm.unary reduce_max(data_type = f32, %0, %arg0, %arg1) :
+    (i64, memref<3x3xf32>, memref<3xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @norm(%arg0: memref<4x8xf32>, %arg1: memref<8xf32>) {
+  %0 = xsmm.norm.dispatch rmsnorm [2, 8, 8, 8] epsilon = 1.0e-05 data_type = f32
+  // expected-error@+1 {{inconsistent sizes with dispatch operation}}
+  xsmm.norm rmsnorm(data_type = f32, %0, %arg0, %arg1, %arg0)
+    : (i64, memref<4x8xf32>, memref<8xf32>, memref<4x8xf32>) -> ()
+  return
+}
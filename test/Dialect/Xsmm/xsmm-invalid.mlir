@@ -424,3 +424,112 @@ func.func @binary_invoke(%arg0: i64, %arg1: memref<3x3xf32>) {
     : (i64, memref<3x3xf32>, memref<3x3xf32>, memref<3x3xf32>, memref<3x3xf32>) -> ()
   return
 }
+
+// -----
+
+func.func @gemm_dispatch_dynamic_m(%m: i64) -> i64 {
+  // expected-error@+1 {{expect dimension m to be 0 with a dynamic m}}
+  %0 = xsmm.gemm.dispatch [1, 2, 3, 3, 5, 6] dynamic_m = %m flags = (none) data_type = f32
+  return %0 : i64
+}
+
+// -----
+
+func.func @norm_dispatch() -> i64 {
+  // expected-error@+1 {{expect ldi and ldo to be >= of dimension n}}
+  %0 = xsmm.norm.dispatch layernorm [4, 8, 4, 8] epsilon = 1.0e-05 data_type = f32
+  return %0 : i64
+}
+
+// -----
+
+func.func @norm_invoke(%arg0: i64, %arg1: memref<4x8xf32>, %arg2: memref<8xf32>) {
+  // expected-error@+1 {{expect 5 inputs but got 4}}
+  xsmm.norm layernorm(data_type = f32, %arg0, %arg1, %arg2, %arg1)
+    : (i64, memref<4x8xf32>, memref<8xf32>, memref<4x8xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @norm_invoke(%arg0: i64, %arg1: memref<4x8xf32>, %arg2: memref<4xf32>) {
+  // expected-error@+1 {{expect a 1d memref matching the row size for operand at index: 2}}
+  xsmm.norm rmsnorm(data_type = f32, %arg0, %arg1, %arg2, %arg1)
+    : (i64, memref<4x8xf32>, memref<4xf32>, memref<4x8xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @gemm_batch(%arg0: i64, %arg1: memref<4x4xf32>) {
+  // expected-error@+1 {{expect 8 or 9 inputs but got 5}}
+  xsmm.gemm_batch(data_type = f32, %arg0, %arg1, %arg1, %arg1, %arg0)
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>, i64) -> ()
+  return
+}
+
+// -----
+
+func.func @gemm_batch(%arg0: i64, %arg1: memref<4x4xf32>) {
+  // expected-error@+1 {{expect an i64 but got 'memref<4x4xf32>' for operand at index: 7}}
+  xsmm.gemm_batch(data_type = f32, %arg0, %arg1, %arg1, %arg1, %arg0, %arg0, %arg0, %arg1)
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>, i64, i64, i64, memref<4x4xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @gemm_batch(%arg0: i64, %arg1: memref<4x4xf32>) {
+  // expected-error@+1 {{expect bf16 but got: 'f32' for operand at index: 1}}
+  xsmm.gemm_batch(data_type = bf16, %arg0, %arg1, %arg1, %arg1, %arg0, %arg0, %arg0, %arg0)
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>, i64, i64, i64, i64) -> ()
+  return
+}
+
+// -----
+
+func.func @brgemm_offs(%arg0: i64, %arg1: memref<4x4xf32>) {
+  // expected-error@+1 {{expect the same non-zero number of offsets for A and B}}
+  xsmm.brgemm_offs(data_type = f32, %arg0, %arg1, %arg1, %arg1)
+    offsets_a = [0, 4] offsets_b = [0]
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @brgemm_offs(%arg0: i64, %arg1: memref<4x4xf32>) {
+  // expected-error@+1 {{expect non-negative offsets}}
+  xsmm.brgemm_offs(data_type = f32, %arg0, %arg1, %arg1, %arg1)
+    offsets_a = [0, -4] offsets_b = [0, 4]
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @brgemm_offs(%arg0: i64, %arg1: memref<4x4xf32>) {
+  // expected-error@+1 {{expect bf16 but got: 'f32' for operand at index: 1}}
+  xsmm.brgemm_offs(data_type = bf16, %arg0, %arg1, %arg1, %arg1)
+    offsets_a = [0] offsets_b = [0]
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>) -> ()
+  return
+}
+
+// -----
+
+func.func @brgemm_addr(%arg0: i64, %arg1: memref<4x4xf32>, %arg2: memref<2xi64>) {
+  // expected-error@+1 {{expect a 1d memref of i64 addresses for operand at index: 2}}
+  xsmm.brgemm_addr(data_type = f32, %arg0, %arg2, %arg1, %arg1, %arg0)
+    : (i64, memref<2xi64>, memref<4x4xf32>, memref<4x4xf32>, i64) -> ()
+  return
+}
+
+// -----
+
+func.func @brgemm_addr(%arg0: i64, %arg1: memref<4x4xf32>, %arg2: memref<2xi64>) {
+  // expected-error@+1 {{expect 5 inputs but got 4}}
+  xsmm.brgemm_addr(data_type = f32, %arg0, %arg2, %arg2, %arg1)
+    : (i64, memref<2xi64>, memref<2xi64>, memref<4x4xf32>) -> ()
+  return
+}
@@ -74,3 +74,64 @@ func.func @xsmm_dialect(%arg0: memref<2x2xf32>,
 
   return
 }
+
+// CHECK-LABEL: @xsmm_dynamic_m
+func.func @xsmm_dynamic_m(%arg0: memref<?x4xf32>, %arg1: memref<4x4xf32>,
+                          %arg2: memref<?x4xf32>, %m: i64) {
+  // CHECK: xsmm.gemm.dispatch [0, 4, 4, 4, 4, 4] dynamic_m = %{{.+}} flags = (none) data_type = f32
+  %0 = xsmm.gemm.dispatch [0, 4, 4, 4, 4, 4] dynamic_m = %m flags = (none) data_type = f32
+  // CHECK: xsmm.gemm(data_type = f32
+  xsmm.gemm(data_type = f32, %0, %arg0, %arg1, %arg2)
+    : (i64, memref<?x4xf32>, memref<4x4xf32>, memref<?x4xf32>) -> ()
+  // CHECK: xsmm.brgemm.dispatch [0, 4, 4, 4, 4, 4, 1, 1] dynamic_m = %{{.+}} flags = (beta_0) data_type = f32
+  %1 = xsmm.brgemm.dispatch [0, 4, 4, 4, 4, 4, 1, 1] dynamic_m = %m flags = (beta_0) data_type = f32
+  return
+}
+
+// CHECK-LABEL: @xsmm_norm
+func.func @xsmm_norm(%arg0: memref<4x8xf32>, %arg1: memref<8xf32>,
+                     %arg2: memref<8xf32>, %arg3: memref<4x8xf32>) {
+  // CHECK: xsmm.norm.dispatch layernorm [4, 8, 8, 8] epsilon = {{.+}} data_type = f32
+  %0 = xsmm.norm.dispatch layernorm [4, 8, 8, 8] epsilon = 1.0e-05 data_type = f32
+  // CHECK: xsmm.norm layernorm(data_type = f32
+  xsmm.norm layernorm(data_type = f32, %0, %arg0, %arg1, %arg2, %arg3)
+    : (i64, memref<4x8xf32>, memref<8xf32>, memref<8xf32>, memref<4x8xf32>) -> ()
+  // CHECK: xsmm.norm.dispatch rmsnorm [4, 8, 8, 8] epsilon = 5.000000e-01 data_type = f32
+  %1 = xsmm.norm.dispatch rmsnorm [4, 8, 8, 8] epsilon = 0.5 data_type = f32
+  // CHECK: xsmm.norm rmsnorm(data_type = f32
+  xsmm.norm rmsnorm(data_type = f32, %1, %arg0, %arg1, %arg3)
+    : (i64, memref<4x8xf32>, memref<8xf32>, memref<4x8xf32>) -> ()
+  return
+}
+
+// CHECK-LABEL: @xsmm_gemm_batch
+func.func @xsmm_gemm_batch(%arg0: memref<4x4xf32>, %arg1: memref<2x4x4xf32>,
+                           %arg2: memref<4x4xf32>, %count: i64, %stride: i64) {
+  %0 = xsmm.gemm.dispatch [4, 4, 4, 4, 4, 4] flags = (none) data_type = f32
+  // CHECK: xsmm.gemm_batch(data_type = f32
+  xsmm.gemm_batch(data_type = f32, %0, %arg0, %arg0, %arg2, %count, %stride, %stride, %stride)
+    : (i64, memref<4x4xf32>, memref<4x4xf32>, memref<4x4xf32>, i64, i64, i64, i64) -> ()
+  %1 = xsmm.brgemm.dispatch [4, 4, 4, 4, 4, 4, 16, 16] flags = (none) data_type = f32
+  // CHECK: xsmm.gemm_batch(data_type = f32
+  xsmm.gemm_batch(data_type = f32, %1, %arg1, %arg1, %arg2, %count, %stride, %stride, %stride, %count)
+    : (i64, memref<2x4x4xf32>, memref<2x4x4xf32>, memref<4x4xf32>, i64, i64, i64, i64, i64) -> ()
+  return
+}
+
+// CHECK-LABEL: @xsmm_brgemm_lists
+func.func @xsmm_brgemm_lists(%arg0: memref<2x4x8xf32>, %arg1: memref<3x8x4xf32>,
+                             %arg2: memref<4x4xf32>, %arg3: memref<3xi64>,
+                             %batch: i64) {
+  // CHECK: xsmm.brgemm_offs.dispatch [4, 4, 8, 8, 4, 4] flags = (none) data_type = f32
+  %0 = xsmm.brgemm_offs.dispatch [4, 4, 8, 8, 4, 4] flags = (none) data_type = f32
+  // CHECK: xsmm.brgemm_offs(data_type = f32, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}) offsets_a = [0, 8, 32] offsets_b = [0, 32, 64]
+  xsmm.brgemm_offs(data_type = f32, %0, %arg0, %arg1, %arg2)
+    offsets_a = [0, 8, 32] offsets_b = [0, 32, 64]
+    : (i64, memref<2x4x8xf32>, memref<3x8x4xf32>, memref<4x4xf32>) -> ()
+  // CHECK: xsmm.brgemm_addr.dispatch [4, 4, 8, 8, 4, 4] flags = (beta_0) data_type = f32
+  %1 = xsmm.brgemm_addr.dispatch [4, 4, 8, 8, 4, 4] flags = (beta_0) data_type = f32
+  // CHECK: xsmm.brgemm_addr(data_type = f32
+  xsmm.brgemm_addr(data_type = f32, %1, %arg3, %arg3, %arg2, %batch)
+    : (i64, memref<3xi64>, memref<3xi64>, memref<4x4xf32>, i64) -> ()
+  return
+}
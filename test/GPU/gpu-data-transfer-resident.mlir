@@ -0,0 +1,218 @@
+// RUN: tpp-opt %s -gpu-data-transfer -split-input-file | \
+// RUN: FileCheck %s
+
+module attributes {gpu.container_module} {
+  memref.global "private" constant @__weights : memref<8x8xf32> = dense<1.0>
+  func.func @launch_chain(%arg0: memref<8x8xf32>) {
+    %c1 = arith.constant 1 : index
+
+    %w = memref.get_global @__weights : memref<8x8xf32>
+    %0 = memref.alloc() : memref<8x8xf32>
+    gpu.launch_func  @kernels::@first blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%arg0 : memref<8x8xf32>, %w : memref<8x8xf32>, %0 : memref<8x8xf32>)
+    gpu.launch_func  @kernels::@second blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%0 : memref<8x8xf32>)
+    gpu.launch_func  @kernels::@third blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%0 : memref<8x8xf32>, %arg0 : memref<8x8xf32>)
+    memref.dealloc %0 : memref<8x8xf32>
+
+    return
+  }
+  gpu.module @kernels {
+    gpu.func @first(%arg0: memref<8x8xf32>, %arg1: memref<8x8xf32>, %arg2: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+    gpu.func @second(%arg0: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+    gpu.func @third(%arg0: memref<8x8xf32>, %arg1: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+  }
+}
+
+// The intermediate buffer lives only on the device, the constant weights are
+// copied once.
+// CHECK-LABEL: @launch_chain(
+// CHECK-SAME: %[[ARG0:.+]]: memref<8x8xf32>
+// CHECK-COUNT-2: gpu.alloc
+// CHECK-NOT: gpu.alloc
+// CHECK: %[[W:.+]] = memref.get_global @__weights
+// CHECK: gpu.memcpy  %{{.+}}, %[[W]]
+// CHECK-NOT: gpu.memcpy
+// CHECK: gpu.launch_func  @kernels::@first{{.*}}args(%[[ARG0]] : memref<8x8xf32>, %{{.+}} : memref<8x8xf32>, %[[GPU:.+]] : memref<8x8xf32>)
+// CHECK-NOT: gpu.memcpy
+// CHECK: gpu.launch_func  @kernels::@second{{.*}}args(%[[GPU]] : memref<8x8xf32>)
+// CHECK-NOT: gpu.memcpy
+// CHECK: gpu.launch_func  @kernels::@third{{.*}}args(%[[GPU]] : memref<8x8xf32>, %[[ARG0]] : memref<8x8xf32>)
+// CHECK-NOT: gpu.memcpy
+// CHECK: memref.dealloc
+// CHECK-COUNT-2: gpu.dealloc
+
+// -----
+
+module attributes {gpu.container_module} {
+  func.func @host_read_between_launches() -> f32 {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+
+    %0 = memref.alloc() : memref<8x8xf32>
+    gpu.launch_func  @kernels::@first blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%0 : memref<8x8xf32>)
+    %v = memref.load %0[%c0, %c0] : memref<8x8xf32>
+    gpu.launch_func  @kernels::@second blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%0 : memref<8x8xf32>)
+    memref.dealloc %0 : memref<8x8xf32>
+
+    return %v : f32
+  }
+  gpu.module @kernels {
+    gpu.func @first(%arg0: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+    gpu.func @second(%arg0: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+  }
+}
+
+// The host only reads the data, the device copy stays valid.
+// CHECK-LABEL: @host_read_between_launches(
+// CHECK-DAG: %[[HOST:.+]] = memref.alloc
+// CHECK-DAG: %[[GPU:.+]] = gpu.alloc
+// CHECK-NOT: gpu.memcpy
+// CHECK: gpu.launch_func  @kernels::@first
+// CHECK: gpu.memcpy  %[[HOST]], %[[GPU]]
+// CHECK: memref.load %[[HOST]]
+// CHECK-NOT: gpu.memcpy
+// CHECK: gpu.launch_func  @kernels::@second
+// CHECK-NOT: gpu.memcpy
+// CHECK: memref.dealloc
+
+// -----
+
+module attributes {gpu.container_module} {
+  func.func @host_write_between_launches() {
+    %c1 = arith.constant 1 : index
+    %cst = arith.constant 5.0 : f32
+
+    %0 = memref.alloc() : memref<8x8xf32>
+    gpu.launch_func  @kernels::@first blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%0 : memref<8x8xf32>)
+    linalg.fill ins(%cst : f32) outs(%0 : memref<8x8xf32>)
+    gpu.launch_func  @kernels::@second blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%0 : memref<8x8xf32>)
+    memref.dealloc %0 : memref<8x8xf32>
+
+    return
+  }
+  gpu.module @kernels {
+    gpu.func @first(%arg0: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+    gpu.func @second(%arg0: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+  }
+}
+
+// The host writes the data, it has to be copied again to the device.
+// CHECK-LABEL: @host_write_between_launches(
+// CHECK-DAG: %[[HOST:.+]] = memref.alloc
+// CHECK-DAG: %[[GPU:.+]] = gpu.alloc
+// CHECK-NOT: gpu.memcpy
+// CHECK: gpu.launch_func  @kernels::@first
+// CHECK: gpu.memcpy  %[[HOST]], %[[GPU]]
+// CHECK: linalg.fill{{.*}}outs(%[[HOST]]
+// CHECK: gpu.memcpy  %[[GPU]], %[[HOST]]
+// CHECK: gpu.launch_func  @kernels::@second
+// CHECK-NOT: gpu.memcpy
+// CHECK: memref.dealloc
+
+// -----
+
+module attributes {gpu.container_module} {
+  memref.global "private" @__global : memref<8x8xf32> = dense<1.0>
+  func.func @global_launch_chain() {
+    %c1 = arith.constant 1 : index
+
+    %0 = memref.get_global @__global : memref<8x8xf32>
+    gpu.launch_func  @kernels::@first blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%0 : memref<8x8xf32>)
+    gpu.launch_func  @kernels::@second blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+        args(%0 : memref<8x8xf32>)
+
+    return
+  }
+  gpu.module @kernels {
+    gpu.func @first(%arg0: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+    gpu.func @second(%arg0: memref<8x8xf32>) kernel {
+      gpu.return
+    }
+  }
+}
+
+// The global data is copied in before the first launch and out after the
+// last one.
+// CHECK-LABEL: @global_launch_chain(
+// CHECK-DAG: %[[GPU:.+]] = gpu.alloc
+// CHECK-DAG: %[[GLOBAL:.+]] = memref.get_global @__global
+// CHECK: gpu.memcpy  %[[GPU]], %[[GLOBAL]]
+// CHECK: gpu.launch_func  @kernels::@first{{.*}}args(%[[GPU]]
+// CHECK-NOT: gpu.memcpy
+// CHECK: gpu.launch_func  @kernels::@second{{.*}}args(%[[GPU]]
+// CHECK: gpu.memcpy  %[[GLOBAL]], %[[GPU]]
+// CHECK-NOT: gpu.memcpy
+// CHECK: gpu.dealloc
+
+// -----
+
+module attributes {gpu.container_module} {
+  func.func @launch_chain_in_loop() {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+
+    %0 = memref.alloc() : memref<32x32xf32>
+    scf.for %iter = %c0 to %c4 step %c1 {
+      %subview = memref.subview %0[%iter, 0] [8, 8] [1, 1] : memref<32x32xf32> to memref<8x8xf32, strided<[32, 1], offset: ?>>
+      gpu.launch_func  @kernels::@first blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+          args(%subview : memref<8x8xf32, strided<[32, 1], offset: ?>>)
+      gpu.launch_func  @kernels::@second blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+          args(%subview : memref<8x8xf32, strided<[32, 1], offset: ?>>)
+    }
+    %cast = memref.cast %0 : memref<32x32xf32> to memref<?x?xf32>
+    call @use(%cast) : (memref<?x?xf32>) -> ()
+    memref.dealloc %0 : memref<32x32xf32>
+
+    return
+  }
+  func.func private @use(memref<?x?xf32>)
+  gpu.module @kernels {
+    gpu.func @first(%arg0: memref<8x8xf32, strided<[32, 1], offset: ?>>) kernel {
+      gpu.return
+    }
+    gpu.func @second(%arg0: memref<8x8xf32, strided<[32, 1], offset: ?>>) kernel {
+      gpu.return
+    }
+  }
+}
+
+// Overlapping views are synchronized once per iteration.
+// CHECK-LABEL: @launch_chain_in_loop(
+// CHECK-DAG: %[[HOST:.+]] = memref.alloc
+// CHECK-DAG: %[[GPU:.+]] = gpu.alloc
+// CHECK:     scf.for
+// CHECK:       gpu.memcpy
+// CHECK-NOT:   gpu.memcpy
+// CHECK:       gpu.launch_func  @kernels::@first
+// CHECK-NOT:   gpu.memcpy
+// CHECK:       gpu.launch_func  @kernels::@second
+// CHECK:       gpu.memcpy
+// CHECK-NOT:   gpu.memcpy
+// CHECK:     }
+// CHECK:     call @use
+// CHECK-NOT: gpu.memcpy
+// CHECK:     gpu.dealloc
@@ -1,4 +1,4 @@
-// RUN: tpp-opt %s -gpu-data-transfer -split-input-file | \
+// RUN: tpp-opt %s -gpu-data-transfer="device-resident=false" -split-input-file | \
 // RUN: FileCheck %s
 
 module attributes {gpu.container_module} {
@@ -0,0 +1,160 @@
+// RUN: tpp-opt %s -gpu-double-buffering -split-input-file | FileCheck %s
+
+// RUN: tpp-opt %s -gpu-double-buffering -gpu-async-region -split-input-file | \
+// RUN: FileCheck %s -check-prefix=ASYNC
+
+module attributes {gpu.container_module} {
+  func.func @pipelined_slices() {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c8 = arith.constant 8 : index
+    %c32 = arith.constant 32 : index
+
+    %gpu = gpu.alloc () : memref<32x16xf32>
+    %host = memref.alloc() : memref<32x16xf32>
+    scf.for %iv = %c0 to %c32 step %c8 {
+      %hs = memref.subview %host[%iv, 0] [8, 16] [1, 1] : memref<32x16xf32> to memref<8x16xf32, strided<[16, 1], offset: ?>>
+      %ds = memref.subview %gpu[%iv, 0] [8, 16] [1, 1] : memref<32x16xf32> to memref<8x16xf32, strided<[16, 1], offset: ?>>
+      gpu.memcpy %ds, %hs : memref<8x16xf32, strided<[16, 1], offset: ?>>, memref<8x16xf32, strided<[16, 1], offset: ?>>
+      gpu.launch_func  @kernels::@kernel blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+          args(%ds : memref<8x16xf32, strided<[16, 1], offset: ?>>)
+      gpu.memcpy %hs, %ds : memref<8x16xf32, strided<[16, 1], offset: ?>>, memref<8x16xf32, strided<[16, 1], offset: ?>>
+    }
+    memref.dealloc %host : memref<32x16xf32>
+    gpu.dealloc %gpu : memref<32x16xf32>
+
+    return
+  }
+  gpu.module @kernels {
+    gpu.func @kernel(%arg0: memref<8x16xf32, strided<[16, 1], offset: ?>>) kernel {
+      gpu.return
+    }
+  }
+}
+
+// CHECK-LABEL: @pipelined_slices(
+// CHECK-DAG: %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG: %[[C8:.+]] = arith.constant 8 : index
+// CHECK: %[[GPU:.+]] = gpu.alloc
+// CHECK: %[[HOST:.+]] = memref.alloc
+// First slice is copied before the loop.
+// CHECK: %[[HS0:.+]] = memref.subview %[[HOST]][%[[C0]], 0]
+// CHECK: %[[DS0:.+]] = memref.subview %[[GPU]][%[[C0]], 0]
+// CHECK: gpu.memcpy  %[[DS0]], %[[HS0]]
+// CHECK: %[[LAST:.+]] = arith.constant 24 : index
+// CHECK: scf.for %[[IV:.+]] = %[[C0]] to %[[LAST]] step %[[C8]] {
+// CHECK:   %[[HS:.+]] = memref.subview %[[HOST]][%[[IV]], 0]
+// CHECK:   %[[DS:.+]] = memref.subview %[[GPU]][%[[IV]], 0]
+// CHECK:   %[[NEXT:.+]] = arith.addi %[[IV]], %[[C8]]
+// CHECK:   %[[PREFETCH:.+]] = async.execute {
+// CHECK:     %[[NHS:.+]] = memref.subview %[[HOST]][%[[NEXT]], 0]
+// CHECK:     %[[NDS:.+]] = memref.subview %[[GPU]][%[[NEXT]], 0]
+// CHECK:     gpu.memcpy  %[[NDS]], %[[NHS]]
+// CHECK-NEXT: async.yield
+// CHECK:   }
+// CHECK:   %[[COMPUTE:.+]] = async.execute {
+// CHECK-NOT: gpu.memcpy  %[[DS]], %[[HS]]
+// CHECK:     gpu.launch_func  @kernels::@kernel{{.*}}args(%[[DS]]
+// CHECK:     gpu.memcpy  %[[HS]], %[[DS]]
+// CHECK-NEXT: async.yield
+// CHECK:   }
+// CHECK:   async.await %[[PREFETCH]] : !async.token
+// CHECK:   async.await %[[COMPUTE]] : !async.token
+// CHECK: }
+// The last slice has nothing to prefetch.
+// CHECK: %[[LHS:.+]] = memref.subview %[[HOST]][%[[LAST]], 0]
+// CHECK: %[[LDS:.+]] = memref.subview %[[GPU]][%[[LAST]], 0]
+// CHECK-NOT: gpu.memcpy  %[[LDS]], %[[LHS]]
+// CHECK: gpu.launch_func  @kernels::@kernel{{.*}}args(%[[LDS]]
+// CHECK: gpu.memcpy  %[[LHS]], %[[LDS]]
+// CHECK: memref.dealloc
+
+// Each async region runs its own chain of GPU operations.
+// ASYNC-LABEL: @pipelined_slices(
+// ASYNC: gpu.memcpy async
+// ASYNC: scf.for
+// ASYNC: async.execute
+// ASYNC: gpu.memcpy async
+// ASYNC: async.execute
+// ASYNC: gpu.launch_func async
+// ASYNC: gpu.memcpy async
+
+// -----
+
+module attributes {gpu.container_module} {
+  func.func @overlapping_slices() {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c4 = arith.constant 4 : index
+
+    %gpu = gpu.alloc () : memref<32x16xf32>
+    %host = memref.alloc() : memref<32x16xf32>
+    scf.for %iv = %c0 to %c4 step %c1 {
+      %hs = memref.subview %host[%iv, 0] [8, 16] [1, 1] : memref<32x16xf32> to memref<8x16xf32, strided<[16, 1], offset: ?>>
+      %ds = memref.subview %gpu[%iv, 0] [8, 16] [1, 1] : memref<32x16xf32> to memref<8x16xf32, strided<[16, 1], offset: ?>>
+      gpu.memcpy %ds, %hs : memref<8x16xf32, strided<[16, 1], offset: ?>>, memref<8x16xf32, strided<[16, 1], offset: ?>>
+      gpu.launch_func  @kernels::@kernel blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+          args(%ds : memref<8x16xf32, strided<[16, 1], offset: ?>>)
+      gpu.memcpy %hs, %ds : memref<8x16xf32, strided<[16, 1], offset: ?>>, memref<8x16xf32, strided<[16, 1], offset: ?>>
+    }
+    memref.dealloc %host : memref<32x16xf32>
+    gpu.dealloc %gpu : memref<32x16xf32>
+
+    return
+  }
+  gpu.module @kernels {
+    gpu.func @kernel(%arg0: memref<8x16xf32, strided<[16, 1], offset: ?>>) kernel {
+      gpu.return
+    }
+  }
+}
+
+// Consecutive iterations access the same data, the next copy has to wait.
+// CHECK-LABEL: @overlapping_slices(
+// CHECK-NOT: async.execute
+// CHECK: scf.for
+// CHECK: gpu.memcpy
+// CHECK: gpu.launch_func
+// CHECK: gpu.memcpy
+// CHECK-NOT: async.execute
+
+// -----
+
+module attributes {gpu.container_module} {
+  func.func @host_access_in_loop() {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c8 = arith.constant 8 : index
+    %c32 = arith.constant 32 : index
+    %cst = arith.constant 1.0 : f32
+
+    %gpu = gpu.alloc () : memref<32x16xf32>
+    %host = memref.alloc() : memref<32x16xf32>
+    scf.for %iv = %c0 to %c32 step %c8 {
+      %hs = memref.subview %host[%iv, 0] [8, 16] [1, 1] : memref<32x16xf32> to memref<8x16xf32, strided<[16, 1], offset: ?>>
+      %ds = memref.subview %gpu[%iv, 0] [8, 16] [1, 1] : memref<32x16xf32> to memref<8x16xf32, strided<[16, 1], offset: ?>>
+      gpu.memcpy %ds, %hs : memref<8x16xf32, strided<[16, 1], offset: ?>>, memref<8x16xf32, strided<[16, 1], offset: ?>>
+      gpu.launch_func  @kernels::@kernel blocks in (%c1, %c1, %c1) threads in (%c1, %c1, %c1)
+          args(%ds : memref<8x16xf32, strided<[16, 1], offset: ?>>)
+      gpu.memcpy %hs, %ds : memref<8x16xf32, strided<[16, 1], offset: ?>>, memref<8x16xf32, strided<[16, 1], offset: ?>>
+      memref.store %cst, %host[%c0, %c0] : memref<32x16xf32>
+    }
+    memref.dealloc %host : memref<32x16xf32>
+    gpu.dealloc %gpu : memref<32x16xf32>
+
+    return
+  }
+  gpu.module @kernels {
+    gpu.func @kernel(%arg0: memref<8x16xf32, strided<[16, 1], offset: ?>>) kernel {
+      gpu.return
+    }
+  }
+}
+
+// The host touches the data within the loop.
+// CHECK-LABEL: @host_access_in_loop(
+// CHECK-NOT: async.execute
+// CHECK: scf.for
+// CHECK: gpu.launch_func
+// CHECK: memref.store
+// CHECK-NOT: async.execute
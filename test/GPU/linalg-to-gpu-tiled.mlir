@@ -0,0 +1,172 @@
+// RUN: tpp-opt %s -linalg-to-gpu="register-tile=2,4 shared-memory=1 k-tile=16" -split-input-file | FileCheck %s
+// RUN: tpp-opt %s -linalg-to-gpu="register-tile=2,2" -split-input-file | FileCheck %s --check-prefix=REG
+// RUN: tpp-opt %s -gpu-conversion="register-tile=2,4 shared-memory=1 k-tile=16" -split-input-file | FileCheck %s --check-prefix=GPU
+
+func.func @matmul(%arg0: memref<32x64xf32>,
+                 %arg1: memref<64x32xf32>,
+                 %arg2: memref<32x32xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<32x64xf32>, memref<64x32xf32>)
+                outs(%arg2 : memref<32x32xf32>)
+  return
+}
+
+// CHECK-LABEL: func.func @matmul(
+// CHECK-SAME:  %[[A:.+]]: memref<32x64xf32>, %[[B:.+]]: memref<64x32xf32>, %[[C:.+]]: memref<32x32xf32>
+// CHECK-DAG:     %[[c1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[c8:.+]] = arith.constant 8 : index
+// CHECK-DAG:     %[[c16:.+]] = arith.constant 16 : index
+// CHECK-DAG:     %[[c64:.+]] = arith.constant 64 : index
+// CHECK-DAG:     %[[c128:.+]] = arith.constant 128 : index
+// CHECK-DAG:     %[[c512:.+]] = arith.constant 512 : index
+// CHECK:         scf.parallel {{.*}}to (%[[c1]], %[[c1]])
+// CHECK:           scf.parallel (%[[tm:.+]], %[[tn:.+]]) ={{.*}}to (%[[c16]], %[[c8]])
+// CHECK:             %[[tid:.+]] = arith.addi %{{.+}}, %[[tn]] : index
+// CHECK:             %[[sharedA:.+]] = memref.alloc() : memref<32x16xf32, #gpu.address_space<workgroup>>
+// CHECK:             %[[sharedB:.+]] = memref.alloc() : memref<16x32xf32, #gpu.address_space<workgroup>>
+// CHECK-COUNT-8:     memref.load %[[C]]
+// CHECK:             scf.for %[[kTile:.+]] = {{.*}}to %[[c64]] step %[[c16]] iter_args(
+// CHECK:               scf.for {{.*}} = %[[tid]] to %[[c512]] step %[[c128]]
+// CHECK:                 memref.load %[[A]]
+// CHECK:                 memref.store {{.*}}, %[[sharedA]]
+// CHECK:               scf.for {{.*}} = %[[tid]] to %[[c512]] step %[[c128]]
+// CHECK:                 memref.load %[[B]]
+// CHECK:                 memref.store {{.*}}, %[[sharedB]]
+// CHECK:               gpu.barrier
+// CHECK:               scf.for {{.*}}to %[[c16]] step %[[c1]] iter_args(
+// CHECK-COUNT-2:         memref.load %[[sharedA]]
+// CHECK-COUNT-4:         memref.load %[[sharedB]]
+// CHECK:                 arith.mulf
+// CHECK-COUNT-8:         arith.addf
+// CHECK:                 scf.yield
+// CHECK:               gpu.barrier
+// CHECK:               scf.yield
+// CHECK-COUNT-8:     memref.store {{.*}}, %[[C]]
+// CHECK:             scf.reduce
+// CHECK:           scf.reduce
+
+// REG-LABEL: func.func @matmul(
+// REG-SAME:  %[[A:.+]]: memref<32x64xf32>, %[[B:.+]]: memref<64x32xf32>, %[[C:.+]]: memref<32x32xf32>
+// REG-DAG:     %[[c16:.+]] = arith.constant 16 : index
+// REG-DAG:     %[[c64:.+]] = arith.constant 64 : index
+// REG:         scf.parallel (%[[tm:.+]], %[[tn:.+]]) ={{.*}}to (%[[c16]], %[[c16]])
+// REG-NOT:       scf.parallel
+// REG-NOT:       memref.alloc
+// REG-COUNT-4:   memref.load %[[C]]
+// REG:           scf.for {{.*}}to %[[c64]] {{.*}}iter_args(
+// REG-COUNT-2:     memref.load %[[A]]
+// REG-COUNT-2:     memref.load %[[B]]
+// REG:             arith.mulf
+// REG-COUNT-4:     arith.addf
+// REG:             scf.yield
+// REG-NOT:       gpu.barrier
+// REG-COUNT-4:   memref.store {{.*}}, %[[C]]
+// REG:           scf.reduce
+
+// GPU-LABEL: gpu.module @matmul_kernel
+// GPU:         gpu.func @matmul_kernel
+// GPU-SAME:      workgroup(%{{.+}} : memref<32x16xf32, #gpu.address_space<workgroup>>, %{{.+}} : memref<16x32xf32, #gpu.address_space<workgroup>>)
+// GPU-SAME:      kernel
+// GPU-NOT:       memref.alloc
+// GPU:           gpu.barrier
+// GPU:           gpu.barrier
+// GPU:           gpu.return
+
+// -----
+
+func.func @brgemm(%arg0: memref<4x32x64xf32>,
+                 %arg1: memref<4x64x32xf32>,
+                 %arg2: memref<32x32xf32>) {
+  linalg.batch_reduce_matmul ins(%arg0, %arg1 : memref<4x32x64xf32>, memref<4x64x32xf32>)
+                             outs(%arg2 : memref<32x32xf32>)
+  return
+}
+
+// CHECK-LABEL: func.func @brgemm(
+// CHECK-SAME:  %[[A:.+]]: memref<4x32x64xf32>, %[[B:.+]]: memref<4x64x32xf32>, %[[C:.+]]: memref<32x32xf32>
+// CHECK-DAG:     %[[c4:.+]] = arith.constant 4 : index
+// CHECK-DAG:     %[[c64:.+]] = arith.constant 64 : index
+// CHECK-DAG:     %[[c16:.+]] = arith.constant 16 : index
+// CHECK:         scf.parallel
+// CHECK:           scf.parallel
+// CHECK:             memref.alloc() : memref<32x16xf32, #gpu.address_space<workgroup>>
+// CHECK:             memref.alloc() : memref<16x32xf32, #gpu.address_space<workgroup>>
+// CHECK:             scf.for %[[batch:.+]] = {{.*}}to %[[c4]] {{.*}}iter_args(
+// CHECK:               scf.for %[[kTile:.+]] = {{.*}}to %[[c64]] step %[[c16]] iter_args(
+// CHECK:                 scf.for
+// CHECK:                   memref.load %[[A]]{{\[}}%[[batch]],
+// CHECK:                 scf.for
+// CHECK:                   memref.load %[[B]]{{\[}}%[[batch]],
+// CHECK:                 gpu.barrier
+// CHECK-COUNT-8:     memref.store {{.*}}, %[[C]]
+
+// REG-LABEL: func.func @brgemm(
+// REG-SAME:  %[[A:.+]]: memref<4x32x64xf32>, %[[B:.+]]: memref<4x64x32xf32>, %[[C:.+]]: memref<32x32xf32>
+// REG:         scf.parallel
+// REG:           scf.for %[[batch:.+]] = {{.*}}iter_args(
+// REG:             scf.for %[[k:.+]] = {{.*}}iter_args(
+// REG:               memref.load %[[A]]{{\[}}%[[batch]], %{{.+}}, %[[k]]{{\]}}
+// REG:               memref.load %[[B]]{{\[}}%[[batch]], %[[k]], %{{.+}}{{\]}}
+// REG-COUNT-4:   memref.store {{.*}}, %[[C]]
+
+// GPU-LABEL: gpu.module @brgemm_kernel
+// GPU:         gpu.func @brgemm_kernel
+// GPU-SAME:      workgroup(
+// GPU:           gpu.barrier
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @matmul_add_relu(%arg0: memref<32x64xf32>, %arg1: memref<64x32xf32>,
+                           %arg2: memref<32x32xf32>, %arg3: memref<32x32xf32>) {
+  %cst = arith.constant 0.000000e+00 : f32
+  linalg.matmul ins(%arg0, %arg1 : memref<32x64xf32>, memref<64x32xf32>)
+                outs(%arg3 : memref<32x32xf32>)
+  linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg2 : memref<32x32xf32>) outs(%arg3 : memref<32x32xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.addf %in, %out : f32
+    linalg.yield %0 : f32
+  }
+  linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]} outs(%arg3 : memref<32x32xf32>) {
+  ^bb0(%out: f32):
+    %0 = arith.maximumf %out, %cst : f32
+    linalg.yield %0 : f32
+  }
+  return
+}
+
+// Element-wise consumers are fused into each store of the micro-tile.
+// REG-LABEL: func.func @matmul_add_relu(
+// REG-SAME:  %[[A:.+]]: memref<32x64xf32>, %[[B:.+]]: memref<64x32xf32>, %[[BIAS:.+]]: memref<32x32xf32>, %[[C:.+]]: memref<32x32xf32>
+// REG:         scf.parallel
+// REG:           scf.for
+// REG:             scf.yield
+// REG-NOT:       linalg.generic
+// REG:           memref.load %[[BIAS]]
+// REG:           arith.addf
+// REG:           arith.maximumf
+// REG-COUNT-4:   memref.store {{.*}}, %[[C]]
+// REG:           scf.reduce
+// REG-NOT:     linalg.generic
+
+// -----
+
+func.func @matmul_odd(%arg0: memref<30x64xf32>,
+                      %arg1: memref<64x30xf32>,
+                      %arg2: memref<30x30xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<30x64xf32>, memref<64x30xf32>)
+                outs(%arg2 : memref<30x30xf32>)
+  return
+}
+
+// Shapes not divisible by the register tile fall back to one output element
+// per thread.
+// CHECK-LABEL: func.func @matmul_odd(
+// CHECK-DAG:     %[[c30:.+]] = arith.constant 30 : index
+// CHECK:         scf.parallel {{.*}}to (%[[c30]], %[[c30]])
+// CHECK-NOT:       memref.alloc
+// CHECK-NOT:       gpu.barrier
+// CHECK:           scf.for
+// CHECK-COUNT-1:     arith.addf
+// CHECK:           memref.store
+// CHECK:           scf.reduce
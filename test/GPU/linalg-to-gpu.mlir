@@ -135,7 +135,7 @@ func.func @matmul_add_relu(%arg0: memref<256x1024xf32>, %arg1: memref<1024x1024x
 // CHECK:             }
 // CHECK-NOT:         linalg.generic
 // CHECK:             %[[elemBias:.+]] = memref.load
-// CHECK:             %[[biasAdd:.+]] = arith.addf %[[sum]], %[[elemBias]]
+// CHECK:             %[[biasAdd:.+]] = arith.addf %[[elemBias]], %[[sum]]
 // CHECK:             %[[reluRes:.+]] = arith.maximumf %[[biasAdd]], %[[zero]]
 // CHECK:             memref.store %[[reluRes]], %[[outTile]]
 // CHECK:             scf.reduce
@@ -160,3 +160,94 @@ func.func private @eltwiseFunc(memref<256x256xf32>, memref<256x256xf32>, memref<
 // CHECK-NOT: linalg.matmul
 // CHECK: call @eltwiseFunc
 // CHECK: linalg.add
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1)>
+#map2 = affine_map<(d0, d1) -> ()>
+
+func.func @matmul_bias_scale_gelu(%arg0: memref<64x64xf32>, %arg1: memref<64x64xf32>,
+    %arg2: memref<64xf32>, %arg3: f32, %arg4: memref<64x64xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<64x64xf32>, memref<64x64xf32>)
+                outs(%arg4 : memref<64x64xf32>)
+  linalg.generic {indexing_maps = [#map1, #map], iterator_types = ["parallel", "parallel"]} ins(%arg2 : memref<64xf32>) outs(%arg4 : memref<64x64xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.addf %out, %in : f32
+    linalg.yield %0 : f32
+  }
+  linalg.generic {indexing_maps = [#map2, #map], iterator_types = ["parallel", "parallel"]} ins(%arg3 : f32) outs(%arg4 : memref<64x64xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.mulf %out, %in : f32
+    linalg.yield %0 : f32
+  }
+  linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]} outs(%arg4 : memref<64x64xf32>) {
+  ^bb0(%out: f32):
+    %half = arith.constant 5.000000e-01 : f32
+    %one = arith.constant 1.000000e+00 : f32
+    %rsqrt2 = arith.constant 0.707106769 : f32
+    %0 = arith.mulf %out, %rsqrt2 : f32
+    %1 = math.erf %0 : f32
+    %2 = arith.addf %1, %one : f32
+    %3 = arith.mulf %out, %half : f32
+    %4 = arith.mulf %3, %2 : f32
+    linalg.yield %4 : f32
+  }
+  return
+}
+
+// Arbitrary element-wise epilogues, including broadcasts and scalars, are
+// inlined at the store.
+// CHECK-LABEL: func.func @matmul_bias_scale_gelu(
+// CHECK-SAME:  %[[A:.+]]: memref<64x64xf32>, %[[B:.+]]: memref<64x64xf32>, %[[BIAS:.+]]: memref<64xf32>, %[[SCALE:.+]]: f32, %[[C:.+]]: memref<64x64xf32>
+// CHECK:         scf.parallel (%[[i:.+]], %[[j:.+]]) =
+// CHECK:           %[[sum:.+]] = scf.for
+// CHECK:           }
+// CHECK-NOT:       linalg.generic
+// CHECK:           %[[elemBias:.+]] = memref.load %[[BIAS]]{{\[}}%[[j]]{{\]}} : memref<64xf32>
+// CHECK:           %[[biasAdd:.+]] = arith.addf %[[sum]], %[[elemBias]]
+// CHECK:           %[[scaled:.+]] = arith.mulf %[[biasAdd]], %[[SCALE]]
+// CHECK:           arith.mulf %[[scaled]]
+// CHECK:           math.erf
+// CHECK:           arith.addf
+// CHECK:           arith.mulf %[[scaled]]
+// CHECK:           %[[gelu:.+]] = arith.mulf
+// CHECK:           memref.store %[[gelu]], %[[C]]{{\[}}%[[i]], %[[j]]{{\]}}
+// CHECK:           scf.reduce
+// CHECK-NOT:     linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1, d0)>
+
+func.func @matmul_transposed_epilogue(%arg0: memref<64x64xf32>, %arg1: memref<64x64xf32>,
+    %arg2: memref<64x64xf32>, %arg3: memref<64x64xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<64x64xf32>, memref<64x64xf32>)
+                outs(%arg3 : memref<64x64xf32>)
+  linalg.generic {indexing_maps = [#map1, #map], iterator_types = ["parallel", "parallel"]} ins(%arg2 : memref<64x64xf32>) outs(%arg3 : memref<64x64xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.addf %out, %in : f32
+    linalg.yield %0 : f32
+  }
+  linalg.generic {indexing_maps = [#map1, #map], iterator_types = ["parallel", "parallel"]} ins(%arg3 : memref<64x64xf32>) outs(%arg3 : memref<64x64xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.addf %out, %in : f32
+    linalg.yield %0 : f32
+  }
+  return
+}
+
+// Operands can be permuted but the output can only be read at the stored
+// element.
+// CHECK-LABEL: func.func @matmul_transposed_epilogue(
+// CHECK-SAME:  %[[A:.+]]: memref<64x64xf32>, %[[B:.+]]: memref<64x64xf32>, %[[D:.+]]: memref<64x64xf32>, %[[C:.+]]: memref<64x64xf32>
+// CHECK:         scf.parallel (%[[i:.+]], %[[j:.+]]) =
+// CHECK:           %[[sum:.+]] = scf.for
+// CHECK:           }
+// CHECK:           %[[elemD:.+]] = memref.load %[[D]]{{\[}}%[[j]], %[[i]]{{\]}}
+// CHECK:           %[[res:.+]] = arith.addf %[[sum]], %[[elemD]]
+// CHECK:           memref.store %[[res]], %[[C]]
+// CHECK:           scf.reduce
+// CHECK:         linalg.generic
+// CHECK-SAME:      ins(%[[C]] : memref<64x64xf32>) outs(%[[C]] : memref<64x64xf32>)
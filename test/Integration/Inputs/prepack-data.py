@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Helper of tpp-prepack-data.mlir.
+
+Write the raw data of a 64x64 f32 weight matrix, or wrap raw weights, plain or
+packed by tpp-prepack, into a kernel multiplying a 32x64 input by them.
+"""
+
+import argparse
+import struct
+import sys
+
+ROWS = 64
+COLS = 64
+PACKED_SHAPE = "2x2x32x32"
+UNPACK = "outer_dims_perm = [1, 0] inner_dims_pos = [0, 1] inner_tiles = [32, 32]"
+
+
+def nest(values, shape):
+    if len(shape) == 1:
+        return "[" + ", ".join(str(v) for v in values) + "]"
+    step = len(values) // shape[0]
+    return (
+        "["
+        + ", ".join(
+            nest(values[i : i + step], shape[1:]) for i in range(0, len(values), step)
+        )
+        + "]"
+    )
+
+
+def gen(args):
+    values = [float((i * COLS + j) % 17) for i in range(ROWS) for j in range(COLS)]
+    with open(args.output, "wb") as f:
+        f.write(struct.pack(f"<{len(values)}f", *values))
+
+
+def kernel(args):
+    with open(args.data, "rb") as f:
+        data = f.read()
+    values = struct.unpack(f"<{ROWS * COLS}f", data)
+    shape = PACKED_SHAPE if args.packed else f"{ROWS}x{COLS}"
+    dense = nest(values, [int(dim) for dim in shape.split("x")])
+
+    out = sys.stdout
+    out.write(
+        f"func.func @entry(%arg0: tensor<32x{ROWS}xf32>, "
+        f"%arg1: tensor<32x{COLS}xf32>) -> tensor<32x{COLS}xf32> {{\n"
+    )
+    out.write(f"  %w = arith.constant dense<{dense}> : tensor<{shape}xf32>\n")
+    weights = "%w"
+    if args.packed:
+        out.write(f"  %e = tensor.empty() : tensor<{ROWS}x{COLS}xf32>\n")
+        out.write(
+            f"  %u = tensor.unpack %w {UNPACK} into %e : "
+            f"tensor<{shape}xf32> -> tensor<{ROWS}x{COLS}xf32>\n"
+        )
+        weights = "%u"
+    out.write(
+        f"  %0 = linalg.matmul ins(%arg0, {weights} : tensor<32x{ROWS}xf32>, "
+        f"tensor<{ROWS}x{COLS}xf32>) outs(%arg1 : tensor<32x{COLS}xf32>) "
+        f"-> tensor<32x{COLS}xf32>\n"
+    )
+    out.write(f"  return %0 : tensor<32x{COLS}xf32>\n")
+    out.write("}\n")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    sub = parser.add_subparsers(dest="command", required=True)
+    gen_parser = sub.add_parser("gen")
+    gen_parser.add_argument("output")
+    gen_parser.set_defaults(func=gen)
+    kernel_parser = sub.add_parser("kernel")
+    kernel_parser.add_argument("data")
+    kernel_parser.add_argument("--packed", action="store_true")
+    kernel_parser.set_defaults(func=kernel)
+    args = parser.parse_args()
+    args.func(args)
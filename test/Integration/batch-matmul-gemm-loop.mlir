@@ -0,0 +1,62 @@
+// RUN: tpp-run %s -e entry -entry-point-result=void | FileCheck %s
+
+// RUN: tpp-run %s -linalg-to-loops -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+// RUN: tpp-opt %s -default-tpp-passes | \
+// RUN: FileCheck %s -check-prefix=IR
+
+#map = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+
+// Small per-batch products are not blocked, one GEMM dispatch is shared by
+// the whole batch.
+// IR-LABEL: @batch_matmul(
+// IR-NOT: xsmm_brgemm_invoke
+// IR: call @xsmm_gemm_dispatch
+// IR: scf.parallel
+// IR: call @xsmm_gemm_invoke
+// IR-NOT: xsmm_brgemm_invoke
+func.func @batch_matmul(%A: tensor<4x8x16xf32>,
+                        %B: tensor<4x16x8xf32>) -> tensor<4x8x8xf32> {
+  %zero = arith.constant 0.0 : f32
+  %0 = tensor.empty() : tensor<4x8x8xf32>
+  %1 = linalg.fill ins(%zero : f32) outs(%0 : tensor<4x8x8xf32>) -> tensor<4x8x8xf32>
+  %2 = linalg.batch_matmul ins(%A, %B : tensor<4x8x16xf32>, tensor<4x16x8xf32>)
+                           outs(%1 : tensor<4x8x8xf32>) -> tensor<4x8x8xf32>
+  return %2 : tensor<4x8x8xf32>
+}
+
+func.func @entry() {
+  %c0 = arith.constant 0 : index
+  %c3 = arith.constant 3 : index
+  %c7 = arith.constant 7 : index
+  %d1 = arith.constant -1.0 : f32
+  %A = arith.constant dense<1.0> : tensor<4x8x16xf32>
+
+  // B[b] = b + 1, every output of batch b is 16 * (b + 1).
+  %empty = tensor.empty() : tensor<4x16x8xf32>
+  %B = linalg.generic {indexing_maps = [#map],
+                       iterator_types = ["parallel", "parallel", "parallel"]}
+    outs(%empty : tensor<4x16x8xf32>) {
+      ^bb0(%out: f32):
+        %b = linalg.index 0 : index
+        %bi = arith.index_cast %b : index to i32
+        %bf = arith.sitofp %bi : i32 to f32
+        %one = arith.constant 1.0 : f32
+        %v = arith.addf %bf, %one : f32
+        linalg.yield %v : f32
+  } -> tensor<4x16x8xf32>
+
+  %0 = call @batch_matmul(%A, %B)
+    : (tensor<4x8x16xf32>, tensor<4x16x8xf32>) -> tensor<4x8x8xf32>
+
+  // CHECK: ( 16, 16, 16, 16, 16, 16, 16, 16 )
+  %v0 = vector.transfer_read %0[%c0, %c0, %c0], %d1 : tensor<4x8x8xf32>, vector<8xf32>
+  vector.print %v0 : vector<8xf32>
+
+  // CHECK: ( 64, 64, 64, 64, 64, 64, 64, 64 )
+  %v1 = vector.transfer_read %0[%c3, %c7, %c0], %d1 : tensor<4x8x8xf32>, vector<8xf32>
+  vector.print %v1 : vector<8xf32>
+
+  return
+}
@@ -0,0 +1,83 @@
+// RUN: tpp-opt %s -pack-conv2DNchwFchw="block-factors=2,2" \
+// RUN:  -rewrite-conv-to-matmul-or-brgemm="enable-brgemm=true" | \
+// RUN: FileCheck %s -check-prefix=IR
+
+// RUN: tpp-run %s -linalg-to-loops -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+// RUN: tpp-opt %s -pack-conv2DNchwFchw="block-factors=2,2" \
+// RUN:  -rewrite-conv-to-matmul-or-brgemm="enable-brgemm=true" | \
+// RUN: tpp-run -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+func.func private @generate_1D_source(%init_source : tensor<7xf32>) -> tensor<7xf32> {
+  %source = linalg.generic {
+      indexing_maps = [affine_map<(d0) -> (d0)>],
+      iterator_types = ["parallel"]}
+      outs(%init_source : tensor<7xf32>) {
+    ^bb0(%b0 : f32):
+      %inner = linalg.index 0 : index
+      %inner_val_i32 = arith.index_cast %inner : index to i32
+      %inner_val = arith.sitofp %inner_val_i32 : i32 to f32
+      linalg.yield %inner_val :  f32
+  } -> tensor<7xf32>
+  return %source : tensor<7xf32>
+}
+
+// Strided conv, the image W is accessed with stride 2.
+func.func @conv_with_stride(%img: tensor<1x4x7x7xf32>, %filter: tensor<4x4x3x3xf32>, %out: tensor<1x4x3x3xf32>) -> tensor<1x4x3x3xf32> {
+  // IR: linalg.batch_reduce_matmul
+  %0 = linalg.conv_2d_nchw_fchw {dilations = dense<1> : tensor<2xi64>, strides = dense<2> : tensor<2xi64>}
+    ins(%img, %filter: tensor<1x4x7x7xf32>, tensor<4x4x3x3xf32>) outs(%out: tensor<1x4x3x3xf32>) -> tensor<1x4x3x3xf32>
+  return %0: tensor<1x4x3x3xf32>
+}
+
+// Dilated conv, the filter taps are 2 elements apart.
+func.func @conv_with_dilation(%img: tensor<1x4x7x7xf32>, %filter: tensor<4x4x3x3xf32>, %out: tensor<1x4x3x3xf32>) -> tensor<1x4x3x3xf32> {
+  // IR: linalg.batch_reduce_matmul
+  %0 = linalg.conv_2d_nchw_fchw {dilations = dense<2> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+    ins(%img, %filter: tensor<1x4x7x7xf32>, tensor<4x4x3x3xf32>) outs(%out: tensor<1x4x3x3xf32>) -> tensor<1x4x3x3xf32>
+  return %0: tensor<1x4x3x3xf32>
+}
+
+func.func @entry() {
+  // The image holds the W index, the filter is all ones. Each output element
+  // is C * R * sum_s(q * stride + s * dilation).
+  %init_source = tensor.empty() : tensor<7xf32>
+  %seed = call @generate_1D_source(%init_source) : (tensor<7xf32>) -> (tensor<7xf32>)
+  %img_shape = tensor.empty() : tensor<1x4x7x7xf32>
+  %img = linalg.broadcast ins(%seed: tensor<7xf32>)
+                          outs(%img_shape: tensor<1x4x7x7xf32>)
+                          dimensions = [0, 1, 2]
+  %filter = arith.constant dense<1.0> : tensor<4x4x3x3xf32>
+  %out = arith.constant dense<0.0> : tensor<1x4x3x3xf32>
+
+  %c0 = arith.constant 0 : index
+  %d1 = arith.constant -1.0 : f32
+
+  %result0 = call @conv_with_stride(%img, %filter, %out)
+    : (tensor<1x4x7x7xf32>, tensor<4x4x3x3xf32>, tensor<1x4x3x3xf32>) -> tensor<1x4x3x3xf32>
+  %v0 = vector.transfer_read %result0[%c0, %c0, %c0, %c0], %d1 : tensor<1x4x3x3xf32>, vector<1x4x3x3xf32>
+  //
+  // CHECK:      ( ( ( ( 36, 108, 180 ), ( 36, 108, 180 ), ( 36, 108, 180 ) ),
+  // CHECK-SAME:     ( ( 36, 108, 180 ), ( 36, 108, 180 ), ( 36, 108, 180 ) ),
+  // CHECK-SAME:     ( ( 36, 108, 180 ), ( 36, 108, 180 ), ( 36, 108, 180 ) ),
+  // CHECK-SAME:     ( ( 36, 108, 180 ), ( 36, 108, 180 ), ( 36, 108, 180 ) ) ) )
+  //
+  vector.print %v0 : vector<1x4x3x3xf32>
+
+  %result1 = call @conv_with_dilation(%img, %filter, %out)
+    : (tensor<1x4x7x7xf32>, tensor<4x4x3x3xf32>, tensor<1x4x3x3xf32>) -> tensor<1x4x3x3xf32>
+  %v1 = vector.transfer_read %result1[%c0, %c0, %c0, %c0], %d1 : tensor<1x4x3x3xf32>, vector<1x4x3x3xf32>
+  //
+  // CHECK:      ( ( ( ( 72, 108, 144 ), ( 72, 108, 144 ), ( 72, 108, 144 ) ),
+  // CHECK-SAME:     ( ( 72, 108, 144 ), ( 72, 108, 144 ), ( 72, 108, 144 ) ),
+  // CHECK-SAME:     ( ( 72, 108, 144 ), ( 72, 108, 144 ), ( 72, 108, 144 ) ),
+  // CHECK-SAME:     ( ( 72, 108, 144 ), ( 72, 108, 144 ), ( 72, 108, 144 ) ) ) )
+  //
+  vector.print %v1 : vector<1x4x3x3xf32>
+
+  return
+}
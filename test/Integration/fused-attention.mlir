@@ -0,0 +1,65 @@
+// RUN: tpp-run %s -e entry -entry-point-result=void | FileCheck %s
+
+// RUN: tpp-opt %s -default-tpp-passes | \
+// RUN: FileCheck %s -check-prefix=IR
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// IR-LABEL: @attention(
+// IR-NOT: memref.alloc() {{.*}} : memref<64x64xf32>
+// IR: scf.parallel
+// IR: scf.for
+// IR: xsmm_gemm_invoke
+// IR: xsmm_gemm_invoke
+func.func @attention(%Q: tensor<64x4xf32>, %K: tensor<64x4xf32>,
+                     %V: tensor<64x4xf32>) -> tensor<64x4xf32> {
+  %zero = arith.constant 0.0 : f32
+  %0 = tensor.empty() : tensor<64x64xf32>
+  %1 = linalg.fill ins(%zero : f32) outs(%0 : tensor<64x64xf32>) -> tensor<64x64xf32>
+  %2 = linalg.matmul_transpose_b ins(%Q, %K : tensor<64x4xf32>, tensor<64x4xf32>)
+                                 outs(%1 : tensor<64x64xf32>) -> tensor<64x64xf32>
+  %3 = tensor.empty() : tensor<64x64xf32>
+  %4 = linalg.softmax dimension(1)
+    ins(%2 : tensor<64x64xf32>) outs(%3 : tensor<64x64xf32>) -> tensor<64x64xf32>
+  %5 = tensor.empty() : tensor<64x4xf32>
+  %6 = linalg.fill ins(%zero : f32) outs(%5 : tensor<64x4xf32>) -> tensor<64x4xf32>
+  %7 = linalg.matmul ins(%4, %V : tensor<64x64xf32>, tensor<64x4xf32>)
+                     outs(%6 : tensor<64x4xf32>) -> tensor<64x4xf32>
+  return %7 : tensor<64x4xf32>
+}
+
+func.func @entry() {
+  %c0 = arith.constant 0 : index
+  %c63 = arith.constant 63 : index
+  %d1 = arith.constant -1.0 : f32
+  %Q = arith.constant dense<1.0> : tensor<64x4xf32>
+
+  // K[j] = j / 64 and V[j] = j: the scores grow along the keys, so the
+  // running max changes with every key block.
+  %empty = tensor.empty() : tensor<64x4xf32>
+  %K, %V = linalg.generic {indexing_maps = [#map, #map],
+                           iterator_types = ["parallel", "parallel"]}
+    outs(%empty, %empty : tensor<64x4xf32>, tensor<64x4xf32>) {
+      ^bb0(%out: f32, %out_0: f32):
+        %i = linalg.index 0 : index
+        %ii = arith.index_cast %i : index to i32
+        %j = arith.sitofp %ii : i32 to f32
+        %c64 = arith.constant 64.0 : f32
+        %k = arith.divf %j, %c64 : f32
+        linalg.yield %k, %j : f32, f32
+  } -> (tensor<64x4xf32>, tensor<64x4xf32>)
+
+  %0 = call @attention(%Q, %K, %V)
+    : (tensor<64x4xf32>, tensor<64x4xf32>, tensor<64x4xf32>) -> tensor<64x4xf32>
+
+  // sum_j(exp(j / 16) * j) / sum_j(exp(j / 16)) = 48.6889
+  // CHECK: ( 48.68{{[0-9]+}}, 48.68{{[0-9]+}}, 48.68{{[0-9]+}}, 48.68{{[0-9]+}} )
+  %v0 = vector.transfer_read %0[%c0, %c0], %d1 : tensor<64x4xf32>, vector<4xf32>
+  vector.print %v0 : vector<4xf32>
+
+  // CHECK: ( 48.68{{[0-9]+}}, 48.68{{[0-9]+}}, 48.68{{[0-9]+}}, 48.68{{[0-9]+}} )
+  %v1 = vector.transfer_read %0[%c63, %c0], %d1 : tensor<64x4xf32>, vector<4xf32>
+  vector.print %v1 : vector<4xf32>
+
+  return
+}
@@ -6,6 +6,13 @@
 // RUN: mlir-gen --kernel=args --seed=0 --float-type=f32 --batch=8 --layers=4,16 2>&1 | FileCheck %s --check-prefix=MATMUL-SMALL
 // RUN: mlir-gen --kernel=args --bias --relu --seed=0 --float-type=f32 --batch=8 --layers=4,16 2>&1 | FileCheck %s --check-prefix=FC-SMALL
 // RUN: mlir-gen --kernel=const --bias --relu --seed=0 --float-type=f32 --batch=8 --layers=4,8,16 2>&1 | FileCheck %s --check-prefix=MLP-SMALL
+// RUN: mlir-gen --kernel=args --bias --gelu --seed=0 --float-type=f32 --batch=8 --layers=4,16 2>&1 | FileCheck %s --check-prefix=GELU-SMALL
+// RUN: mlir-gen --kernel=args --bias --silu --seed=0 --float-type=f32 --batch=8 --layers=4,16 2>&1 | FileCheck %s --check-prefix=SILU-SMALL
+// RUN: mlir-gen --kernel=args --bias --tanh --seed=0 --float-type=f32 --batch=8 --layers=4,16 2>&1 | FileCheck %s --check-prefix=FC-SMALL
+// Attention models
+// RUN: mlir-gen --kernel=args --model=mha --seed=0 --float-type=f32 --batch=2 --seq-len=4 --heads=2 --hidden-size=8 2>&1 | FileCheck %s --check-prefix=MHA-SMALL
+// RUN: mlir-gen --kernel=const --model=mha --bias --seed=0 --float-type=f32 --batch=2 --seq-len=4 --heads=2 --hidden-size=8 2>&1 | FileCheck %s --check-prefix=MHA-BIAS-SMALL
+// RUN: mlir-gen --kernel=args --model=transformer --seed=0 --float-type=f32 --batch=2 --seq-len=4 --heads=2 --hidden-size=8 2>&1 | FileCheck %s --check-prefix=TRANSFORMER-SMALL
 // Large sizes + no tiling
 // RUN: mlir-gen --kernel=args --seed=0 --float-type=f32 --batch=128 --layers=1024,4096 2>&1 | FileCheck %s --check-prefix=MATMUL-LARGE
 // RUN: mlir-gen --kernel=args --bias --relu --seed=0 --float-type=f32 --batch=128 --layers=1024,4096 2>&1 | FileCheck %s --check-prefix=FC-LARGE
@@ -23,6 +30,12 @@
 // MATMUL-SMALL: // BENCH_TOTAL_FLOPS: 1024
 // FC-SMALL: // BENCH_TOTAL_FLOPS: 1280
 // MLP-SMALL: // BENCH_TOTAL_FLOPS: 2944
+// GELU-SMALL: // BENCH_TOTAL_FLOPS: 1792
+// SILU-SMALL: // BENCH_TOTAL_FLOPS: 1664
+
+// MHA-SMALL: // BENCH_TOTAL_FLOPS: 5440
+// MHA-BIAS-SMALL: // BENCH_TOTAL_FLOPS: 5696
+// TRANSFORMER-SMALL: // BENCH_TOTAL_FLOPS: 16576
 
 // MATMUL-LARGE: // BENCH_TOTAL_FLOPS: 1073741824
 // FC-LARGE: // BENCH_TOTAL_FLOPS: 1074790400
@@ -10,6 +10,21 @@
 // Constant values
 // RUN: mlir-gen --kernel=const --bias --relu --batch=10 --layers=10,10 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=CONSTANT
 
+// Activations
+// RUN: mlir-gen --kernel=const --bias --gelu --batch=10 --layers=10,10 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=CONSTANT
+// RUN: mlir-gen --kernel=const --bias --silu --batch=10 --layers=10,10 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=SILU
+// RUN: mlir-gen --kernel=const --bias --tanh --batch=10 --layers=10,10 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=TANH
+
+// Attention models
+// RUN: mlir-gen --kernel=const --model=mha --bias --batch=2 --seq-len=16 --heads=2 --hidden-size=32 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=MHA-BIAS
+// RUN: mlir-gen --kernel=args --model=mha --batch=2 --seq-len=16 --heads=2 --hidden-size=32 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=MHA
+// RUN: mlir-gen --kernel=const --model=transformer --bias --batch=2 --seq-len=16 --heads=2 --hidden-size=32 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=TRANSFORMER
+// RUN: mlir-gen --kernel=args --model=transformer --bias --silu --batch=2 --seq-len=16 --heads=2 --hidden-size=32 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=TRANSFORMER
+
+// Invalid attention arguments
+// RUN: not mlir-gen --model=mha --batch=2 --seq-len=16 --heads=3 --hidden-size=32 2>&1 | FileCheck %s --check-prefix=HEADS
+// RUN: not mlir-gen --model=transformer --batch=2 --seq-len=0 --heads=2 --hidden-size=32 2>&1 | FileCheck %s --check-prefix=SEQLEN
+
 // Kernel - matmul
 // RUN: mlir-gen --kernel=args --seed=123 --float-type=f32 --batch=10 --layers=10,10 | tpp-run -e entry -entry-point-result=void -print | FileCheck %s --check-prefix=GEN-MATMUL
 
@@ -22,6 +37,20 @@
 
 // CONSTANT:( 11, 11, 11, 11, 11, 11, 11, 11, 11, 11 )
 
+// SILU:( 10.999{{[0-9]+}}, 10.999{{[0-9]+}}, 10.999{{[0-9]+}}, 10.999{{[0-9]+}}, 10.999{{[0-9]+}}, 10.999{{[0-9]+}}, 10.999{{[0-9]+}}, 10.999{{[0-9]+}}, 10.999{{[0-9]+}}, 10.999{{[0-9]+}} )
+
+// TANH:( 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 )
+
+// With uniform weights all the scores are equal, the attention returns V.
+// MHA-BIAS-COUNT-32: ( 1057,{{( 1057,)+}} 1057 )
+// MHA-COUNT-32: ( 1024,{{( 1024,)+}} 1024 )
+
+// The rows are constant, the layernorm returns its shift.
+// TRANSFORMER-COUNT-32: ( 1,{{( 1,)+}} 1 )
+
+// HEADS: error: Hidden size must be a multiple of the number of heads
+// SEQLEN: error: Sequence length cannot be zero
+
 // GEN-MATMUL: ( 11, 11, 11, 11, 11, 11, 11, 11, 11, 11 )
 
 // GEN-FC: ( 12, 12, 12, 12, 12, 12, 12, 12, 12, 12 )
@@ -0,0 +1,50 @@
+// RUN: tpp-run %s -e entry -entry-point-result=void | FileCheck %s
+
+// A single bucket can be benchmarked on its own.
+// RUN: tpp-run %s -e matmul -entry-point-result=void -shape-bucket=32 -n 10 | \
+// RUN: FileCheck %s -check-prefix=BENCH
+
+// RUN: tpp-opt %s -default-tpp-passes | \
+// RUN: FileCheck %s -check-prefix=IR
+
+// 40 rows are padded to the bucket of 64.
+func.func @matmul(%A: tensor<?x64xf32>, %B: tensor<64x64xf32>,
+                  %C: tensor<?x64xf32>) -> tensor<?x64xf32>
+    attributes {tpp.shape_buckets = array<i64: 16, 64>} {
+  %0 = linalg.matmul ins(%A, %B : tensor<?x64xf32>, tensor<64x64xf32>)
+                     outs(%C : tensor<?x64xf32>) -> tensor<?x64xf32>
+  return %0 : tensor<?x64xf32>
+}
+
+// IR-LABEL: @matmul_b64(
+// IR: xsmm_gemm_dispatch
+// IR: xsmm_gemm_invoke
+// IR-LABEL: @matmul_b16(
+// IR: xsmm_gemm_dispatch
+// IR: xsmm_gemm_invoke
+
+func.func @entry() {
+  %c0 = arith.constant 0 : index
+  %c39 = arith.constant 39 : index
+  %d1 = arith.constant -1.0 : f32
+  %A = arith.constant dense<1.0> : tensor<40x64xf32>
+  %B = arith.constant dense<2.0> : tensor<64x64xf32>
+  %C = arith.constant dense<1.0> : tensor<40x64xf32>
+  %dynA = tensor.cast %A : tensor<40x64xf32> to tensor<?x64xf32>
+  %dynC = tensor.cast %C : tensor<40x64xf32> to tensor<?x64xf32>
+  %0 = call @matmul(%dynA, %B, %dynC)
+    : (tensor<?x64xf32>, tensor<64x64xf32>, tensor<?x64xf32>) -> tensor<?x64xf32>
+  %1 = tensor.cast %0 : tensor<?x64xf32> to tensor<40x64xf32>
+
+  // CHECK: ( 129, 129, 129, 129, 129, 129, 129, 129
+  %v0 = vector.transfer_read %1[%c0, %c0], %d1 : tensor<40x64xf32>, vector<8xf32>
+  vector.print %v0 : vector<8xf32>
+
+  // CHECK: ( 129, 129, 129, 129, 129, 129, 129, 129
+  %v1 = vector.transfer_read %1[%c39, %c0], %d1 : tensor<40x64xf32>, vector<8xf32>
+  vector.print %v1 : vector<8xf32>
+
+  return
+}
+
+// BENCH: {{[0-9]+}}{{.?}}{{[0-9e-]+}}
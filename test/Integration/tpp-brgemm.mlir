@@ -2,6 +2,10 @@
 // RUN:  -e entry -entry-point-result=void | \
 // RUN: FileCheck %s
 
+// RUN: tpp-run %s -print -xsmm-direct-call \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
 // RUN: tpp-run %s -linalg-to-loops -print \
 // RUN:  -e entry -entry-point-result=void | \
 // RUN: FileCheck %s
@@ -0,0 +1,23 @@
+// RUN: %python %S/Inputs/prepack-data.py gen %t.bin
+// RUN: tpp-prepack %s -e entry --arg=1 --data=%t.bin -o %t.packed | \
+// RUN: FileCheck %s
+
+// The kernel computes the same result from the packed weights as from the
+// plain ones.
+// RUN: %python %S/Inputs/prepack-data.py kernel %t.bin > %t.plain.mlir
+// RUN: %python %S/Inputs/prepack-data.py kernel %t.packed --packed > %t.packed.mlir
+// RUN: tpp-run %t.plain.mlir -seed=123 -print \
+// RUN:  -e entry -entry-point-result=void > %t.plain.out
+// RUN: tpp-run %t.packed.mlir -seed=123 -print \
+// RUN:  -e entry -entry-point-result=void > %t.packed.out
+// RUN: diff %t.plain.out %t.packed.out
+
+func.func @entry(%arg0: tensor<32x64xf32>, %arg1: tensor<64x64xf32>,
+                 %arg2: tensor<32x64xf32>) -> tensor<32x64xf32> {
+  %0 = linalg.matmul ins(%arg0, %arg1 : tensor<32x64xf32>, tensor<64x64xf32>)
+                     outs(%arg2 : tensor<32x64xf32>) -> tensor<32x64xf32>
+  return %0 : tensor<32x64xf32>
+}
+
+// CHECK: @entry argument 1: tensor<64x64xf32> -> tensor<2x2x32x32xf32>
+// CHECK-NEXT: pack inner_dims_pos = [0, 1] inner_tiles = [32, 32] outer_dims_perm = [1, 0]
@@ -0,0 +1,22 @@
+// RUN: mlir-gen --kernel=args --batch=128 --layers=256,512 --seed=123 | \
+// RUN: tpp-prepack -e entry --arg=1 | \
+// RUN: FileCheck %s
+
+// RUN: mlir-gen --kernel=args --batch=128 --layers=256,512 --seed=123 --float-type=bf16 | \
+// RUN: tpp-prepack -e entry --arg=1 | \
+// RUN: FileCheck %s --check-prefix=BF16
+
+// RUN: mlir-gen --kernel=args --batch=128 --layers=256,512 --seed=123 --prepacked-weights | \
+// RUN: tpp-opt -default-tpp-passes | \
+// RUN: FileCheck %s --check-prefix=IR
+
+// CHECK: @entry argument 1: tensor<256x512xf32> -> tensor<16x8x32x32xf32>
+// CHECK-NEXT: pack inner_dims_pos = [0, 1] inner_tiles = [32, 32] outer_dims_perm = [1, 0]
+
+// BF16: @entry argument 1: tensor<256x512xbf16> -> tensor<16x8x16x32x2xbf16>
+// BF16-NEXT: pack inner_dims_pos = [0, 1] inner_tiles = [32, 32] outer_dims_perm = [1, 0]
+// BF16-NEXT: pack inner_dims_pos = [2] inner_tiles = [2] outer_dims_perm = []
+
+// The prepacked weights are passed directly to the kernel.
+// IR-LABEL: func.func @entry(
+// IR-SAME:  memref<16x8x32x32xf32> {tpp.blocked_layout = {{.+}}, tpp.prepacked}
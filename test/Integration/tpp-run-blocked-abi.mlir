@@ -0,0 +1,19 @@
+// RUN: tpp-run %s -blocked-abi \
+// RUN:  -e entry -entry-point-result=void -print | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s -blocked-abi \
+// RUN:  -e entry -entry-point-result=void -n 10 | \
+// RUN: FileCheck %s --check-prefix=BENCH
+
+func.func @entry(%A: tensor<64x64xf32>,
+          %B: tensor<64x64xf32>, %C: tensor<64x64xf32>) -> tensor<64x64xf32> {
+  %D = linalg.matmul ins(%A, %B: tensor<64x64xf32>, tensor<64x64xf32>) outs(%C: tensor<64x64xf32>) -> tensor<64x64xf32>
+  return %D : tensor<64x64xf32>
+}
+
+// The kernel takes and returns blocked tensors, the result is unpacked back
+// before printing.
+// CHECK-COUNT-64: ( 65,{{( 65,)+}} 65 )
+
+// BENCH: {{[0-9]+}}{{.?}}{{[0-9e-]+}}
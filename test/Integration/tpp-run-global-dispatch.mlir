@@ -0,0 +1,23 @@
+// RUN: tpp-run %s -global-dispatch \
+// RUN:  -e entry -entry-point-result=void -print | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s -global-dispatch -xsmm-direct-call \
+// RUN:  -e entry -entry-point-result=void -print | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s -global-dispatch \
+// RUN:  -e entry -entry-point-result=void -n 10 | \
+// RUN: FileCheck %s --check-prefix=BENCH
+
+// Both gemms share the same kernel handle, dispatched once per module.
+func.func @entry(%A: tensor<4x8xf32>,
+          %B: tensor<8x4xf32>, %C: tensor<4x4xf32>) -> tensor<4x4xf32> {
+  %D = linalg.matmul ins(%A, %B: tensor<4x8xf32>, tensor<8x4xf32>) outs(%C: tensor<4x4xf32>) -> tensor<4x4xf32>
+  %E = linalg.matmul ins(%A, %B: tensor<4x8xf32>, tensor<8x4xf32>) outs(%D: tensor<4x4xf32>) -> tensor<4x4xf32>
+  return %E : tensor<4x4xf32>
+}
+
+// CHECK-COUNT-4: ( 17, 17, 17, 17 )
+
+// BENCH: {{[0-9]+}}{{.?}}{{[0-9e-]+}}
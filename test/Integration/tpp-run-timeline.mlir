@@ -0,0 +1,16 @@
+// RUN: rm -f %t.json
+// RUN: env TPP_TIMELINE=%t.json tpp-run %s -e entry -entry-point-result=void -n 10 -timeline
+// RUN: FileCheck %s --input-file=%t.json
+
+func.func @entry(%A: tensor<128x128xf32>, %B: tensor<128x128xf32>,
+                 %C: tensor<128x128xf32>) -> tensor<128x128xf32> {
+  %D = linalg.matmul ins(%A, %B: tensor<128x128xf32>, tensor<128x128xf32>)
+                     outs(%C: tensor<128x128xf32>) -> tensor<128x128xf32>
+  return %D : tensor<128x128xf32>
+}
+
+// CHECK: "traceEvents"
+// CHECK-DAG: "name": "thread_name", "ph": "M", "pid": 0, "tid": 0
+// CHECK-DAG: "name": "bench_iteration", "cat": "perf", "ph": "X"
+// CHECK-DAG: "name": "parallel_iteration", "cat": "perf", "ph": "X", {{.*}} "args": {"index": {{[0-9]+}}}
+// CHECK-DAG: "cat": "xsmm", "ph": "X", {{.*}} "args": {"count": {{[0-9]+}}}
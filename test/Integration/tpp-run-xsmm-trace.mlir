@@ -0,0 +1,26 @@
+// RUN: env TPP_XSMM_TRACE=1 tpp-run %s \
+// RUN:  -e entry -entry-point-result=void 2>&1 | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s -xsmm-trace \
+// RUN:  -e entry -entry-point-result=void 2>&1 | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s \
+// RUN:  -e entry -entry-point-result=void 2>&1 | \
+// RUN: FileCheck %s --check-prefix=NOTRACE --allow-empty
+
+func.func @entry(%A: tensor<4x8xf32>,
+          %B: tensor<8x4xf32>, %C: tensor<4x4xf32>) -> tensor<4x4xf32> {
+  %D = linalg.matmul ins(%A, %B: tensor<4x8xf32>, tensor<8x4xf32>) outs(%C: tensor<4x4xf32>) -> tensor<4x4xf32>
+  return %D : tensor<4x4xf32>
+}
+
+// CHECK: XSMM invoke trace, {{[0-9]+}} kernels:
+// CHECK-NEXT: kernel {{ +}}calls {{ +}}total (ms) {{ +}}avg (us) {{ +}}GFLOP/s
+// CHECK: {{^}}gemm {{ +}}{{[0-9]+}} {{ +}}{{[0-9.]+}} {{ +}}{{[0-9.]+}} {{ +}}{{[0-9.]+}}
+// CHECK-NEXT: M: 4
+// CHECK-NEXT: N: 4
+// CHECK-NEXT: K: 8
+
+// NOTRACE-NOT: XSMM invoke trace
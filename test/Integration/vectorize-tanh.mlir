@@ -0,0 +1,50 @@
+// RUN: tpp-opt %s -default-tpp-passes="vector-width=128" | FileCheck -check-prefix=IR %s
+
+// RUN: tpp-run %s -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s -vectorize -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// IR-LABEL: tanh
+// IR: vector.transfer_read {{.+}} vector<4xf32>
+// IR-NOT: math.tanh
+func.func @tanh(%A: tensor<2x8xf32>) -> tensor<2x8xf32> {
+  %O = linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%A : tensor<2x8xf32>) {
+      ^bb0(%a: f32):
+        %0 = math.tanh %a : f32
+        linalg.yield %0 : f32
+  } -> tensor<2x8xf32>
+  return %O : tensor<2x8xf32>
+}
+
+func.func @entry() {
+  %c0 = arith.constant 0 : index
+  %d1 = arith.constant -1.0 : f32
+
+  %da = arith.constant dense<[
+        [ 0.0, 0.5, 1.0, 2.0, -0.5, -1.0, -2.0, 0.0 ],
+        [ 2.0, 1.0, 0.5, 0.0, -2.0, -1.0, -0.5, 0.0 ]
+  ]> : tensor<2x8xf32>
+
+  %0 = call @tanh(%da) : (tensor<2x8xf32>) -> tensor<2x8xf32>
+
+  //
+  // CHECK:       ( ( {{-?}}0, 0.4621{{[0-9]+}}, 0.7615{{[0-9]+}}, 0.9640{{[0-9]+}},
+  // CHECK-SAME:      -0.4621{{[0-9]+}}, -0.7615{{[0-9]+}}, -0.9640{{[0-9]+}}, {{-?}}0 ),
+  // CHECK-SAME:    ( 0.9640{{[0-9]+}}, 0.7615{{[0-9]+}}, 0.4621{{[0-9]+}}, {{-?}}0,
+  // CHECK-SAME:      -0.9640{{[0-9]+}}, -0.7615{{[0-9]+}}, -0.4621{{[0-9]+}}, {{-?}}0 ) )
+  //
+
+  %v0 = vector.transfer_read %0[%c0, %c0], %d1 : tensor<2x8xf32>, vector<2x8xf32>
+  vector.print %v0 : vector<2x8xf32>
+
+  return
+}
@@ -0,0 +1,50 @@
+// RUN: tpp-run %s -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+memref.global "private" constant @__constant_a : memref<32x16xf32> = dense<2.0> {alignment = 64 : i64}
+memref.global "private" constant @__constant_b0 : memref<16x64xf32> = dense<3.0> {alignment = 64 : i64}
+memref.global "private" constant @__constant_b1 : memref<16x64xf32> = dense<5.0> {alignment = 64 : i64}
+
+func.func private @address(%arg0: memref<?x?xf32>) -> i64 {
+  %0 = memref.extract_aligned_pointer_as_index %arg0 : memref<?x?xf32> -> index
+  %1 = arith.index_cast %0 : index to i64
+  return %1 : i64
+}
+
+// The blocks of the batch live in different buffers and are gathered through
+// their addresses: C += A0 x B0 + A1 x B1, with A0 = %arg0.
+func.func @entry(%arg0: memref<32x16xf32>, %arg1: memref<32x64xf32>) -> memref<32x64xf32> {
+  %a = memref.get_global @__constant_a : memref<32x16xf32>
+  %b0 = memref.get_global @__constant_b0 : memref<16x64xf32>
+  %b1 = memref.get_global @__constant_b1 : memref<16x64xf32>
+  %a0_dyn = memref.cast %arg0 : memref<32x16xf32> to memref<?x?xf32>
+  %a1_dyn = memref.cast %a : memref<32x16xf32> to memref<?x?xf32>
+  %b0_dyn = memref.cast %b0 : memref<16x64xf32> to memref<?x?xf32>
+  %b1_dyn = memref.cast %b1 : memref<16x64xf32> to memref<?x?xf32>
+  %addr_a0 = call @address(%a0_dyn) : (memref<?x?xf32>) -> i64
+  %addr_a1 = call @address(%a1_dyn) : (memref<?x?xf32>) -> i64
+  %addr_b0 = call @address(%b0_dyn) : (memref<?x?xf32>) -> i64
+  %addr_b1 = call @address(%b1_dyn) : (memref<?x?xf32>) -> i64
+
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %addrs_a = memref.alloca() : memref<2xi64>
+  %addrs_b = memref.alloca() : memref<2xi64>
+  memref.store %addr_a0, %addrs_a[%c0] : memref<2xi64>
+  memref.store %addr_a1, %addrs_a[%c1] : memref<2xi64>
+  memref.store %addr_b0, %addrs_b[%c0] : memref<2xi64>
+  memref.store %addr_b1, %addrs_b[%c1] : memref<2xi64>
+
+  // [32x16] * [16x64] -> [32x64]
+  // m = 32, n = 64, k = 16
+  // lda = 16, ldb = 64, ldc = 64
+  %0 = xsmm.brgemm_addr.dispatch [32, 64, 16, 16, 64, 64] flags = (none) data_type = f32
+  %c2 = arith.constant 2 : i64
+  xsmm.brgemm_addr(data_type = f32, %0, %addrs_a, %addrs_b, %arg1, %c2)
+    : (i64, memref<2xi64>, memref<2xi64>, memref<32x64xf32>, i64) -> ()
+  return %arg1 : memref<32x64xf32>
+}
+
+// 1 + 16 * (1 * 3) + 16 * (2 * 5)
+// CHECK-COUNT-32: ( 209,{{( 209,)+}} 209 )
@@ -2,6 +2,10 @@
 // RUN:  -e entry -entry-point-result=void | \
 // RUN: FileCheck %s
 
+// RUN: tpp-run %s -print -xsmm-direct-call \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
 memref.global "private" constant @__constant_bias : memref<2x16x64xf32> = dense<1.0> {alignment = 64 : i64}
 
 func.func @entry(%arg0: memref<2x32x16xf32>, %arg1: memref<64x32xf32>) -> memref<64x32xf32> {
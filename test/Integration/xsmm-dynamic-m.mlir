@@ -0,0 +1,50 @@
+// RUN: tpp-run %s -e entry -entry-point-result=void | FileCheck %s
+
+// RUN: tpp-opt %s -default-tpp-passes | \
+// RUN: FileCheck %s -check-prefix=IR
+
+// The m dimension is only known at runtime, 40 rows are a full tile of 32 and
+// a remainder of 8.
+// The full tiles use a static kernel dispatched once, out of the parallel
+// loop. Only the remainder dispatches on its runtime m.
+// IR-LABEL: func.func @matmul_dynamic_m(
+// IR: %[[STATIC:.+]] = call @xsmm_gemm_dispatch(
+// IR: scf.parallel
+// IR-NOT: call @xsmm_gemm_dispatch(
+// IR: call @xsmm_gemm_invoke(%{{.+}}, %[[STATIC]],
+// IR: %[[M:.+]] = arith.index_cast %{{.+}} : index to i64
+// IR: %[[DYN:.+]] = call @xsmm_gemm_dispatch(%{{.+}}, %[[M]],
+// IR: call @xsmm_gemm_invoke(%{{.+}}, %[[DYN]],
+// IR-LABEL: func.func @entry(
+func.func @matmul_dynamic_m(%A: tensor<?x64xf32>, %B: tensor<64x64xf32>,
+                            %C: tensor<?x64xf32>) -> tensor<?x64xf32> {
+  %0 = linalg.matmul ins(%A, %B : tensor<?x64xf32>, tensor<64x64xf32>)
+                     outs(%C : tensor<?x64xf32>) -> tensor<?x64xf32>
+  return %0 : tensor<?x64xf32>
+}
+
+func.func @entry() {
+  %c0 = arith.constant 0 : index
+  %c39 = arith.constant 39 : index
+  %d1 = arith.constant -1.0 : f32
+  %A = arith.constant dense<1.0> : tensor<40x64xf32>
+  %B = arith.constant dense<2.0> : tensor<64x64xf32>
+  %C = arith.constant dense<1.0> : tensor<40x64xf32>
+  %dynA = tensor.cast %A : tensor<40x64xf32> to tensor<?x64xf32>
+  %dynC = tensor.cast %C : tensor<40x64xf32> to tensor<?x64xf32>
+  %0 = call @matmul_dynamic_m(%dynA, %B, %dynC)
+    : (tensor<?x64xf32>, tensor<64x64xf32>, tensor<?x64xf32>) -> tensor<?x64xf32>
+  %1 = tensor.cast %0 : tensor<?x64xf32> to tensor<40x64xf32>
+
+  // First row, computed by the main loop.
+  // CHECK: ( 129, 129, 129, 129, 129, 129, 129, 129
+  %v0 = vector.transfer_read %1[%c0, %c0], %d1 : tensor<40x64xf32>, vector<8xf32>
+  vector.print %v0 : vector<8xf32>
+
+  // Last row, computed by the remainder loop.
+  // CHECK: ( 129, 129, 129, 129, 129, 129, 129, 129
+  %v1 = vector.transfer_read %1[%c39, %c0], %d1 : tensor<40x64xf32>, vector<8xf32>
+  vector.print %v1 : vector<8xf32>
+
+  return
+}
@@ -0,0 +1,39 @@
+// RUN: tpp-run %s -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s -print -xsmm-batch-invoke \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+// RUN: tpp-opt %s -xsmm-batch-invoke | FileCheck %s -check-prefix=IR
+
+memref.global "private" constant @__constant_b : memref<16x64xf32> = dense<2.0> {alignment = 64 : i64}
+
+#map = affine_map<(d0) -> (d0 * 16)>
+
+// IR-LABEL: entry
+func.func @entry(%arg0: memref<16x16xf32>, %arg1: memref<16x64xf32>) -> memref<16x64xf32> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %0 = memref.get_global @__constant_b : memref<16x64xf32>
+  // m = 16, n = 16, k = 16
+  // lda = 16, ldb = 64, ldc = 64
+  %1 = xsmm.gemm.dispatch [16, 16, 16, 16, 64, 64] flags = (none) data_type = f32
+  // IR-NOT: scf.for
+  // IR: xsmm.gemm_batch
+  scf.for %i = %c0 to %c4 step %c1 {
+    %col = affine.apply #map(%i)
+    %b = memref.subview %0[0, %col] [16, 16] [1, 1]
+      : memref<16x64xf32> to memref<16x16xf32, strided<[64, 1], offset: ?>>
+    %c = memref.subview %arg1[0, %col] [16, 16] [1, 1]
+      : memref<16x64xf32> to memref<16x16xf32, strided<[64, 1], offset: ?>>
+    xsmm.gemm(data_type = f32, %1, %arg0, %b, %c)
+      : (i64, memref<16x16xf32>, memref<16x16xf32, strided<[64, 1], offset: ?>>,
+         memref<16x16xf32, strided<[64, 1], offset: ?>>) -> ()
+  }
+  return %arg1 : memref<16x64xf32>
+}
+
+// CHECK-COUNT-16: ( 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33 )
@@ -0,0 +1,139 @@
+// RUN: tpp-opt %s -default-tpp-passes | FileCheck -check-prefix=IR %s
+
+// RUN: tpp-run %s -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s -linalg-to-loops -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#row = affine_map<(d0, d1) -> (d0)>
+#col = affine_map<(d0, d1) -> (d1)>
+
+// The statistics and the normalization run in a single fused kernel.
+// IR-LABEL: layernorm
+// IR-NOT: linalg.generic
+// IR: xsmm_layernorm_invoke
+// IR-NOT: linalg.generic
+func.func @layernorm(%x: tensor<4x4xf32>, %gamma: tensor<4xf32>,
+                     %beta: tensor<4xf32>) -> tensor<4x4xf32> {
+  %zero = arith.constant 0.0 : f32
+  %invN = arith.constant 0.25 : f32
+  %eps = arith.constant 1.0e-05 : f32
+  %empty = tensor.empty() : tensor<4xf32>
+  %init = linalg.fill ins(%zero : f32) outs(%empty : tensor<4xf32>) -> tensor<4xf32>
+  %mean = linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : tensor<4x4xf32>) outs(%init : tensor<4xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %invN : f32
+      %1 = arith.addf %0, %acc : f32
+      linalg.yield %1 : f32
+  } -> tensor<4xf32>
+  %var = linalg.generic {
+    indexing_maps = [#map, #row, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x, %mean : tensor<4x4xf32>, tensor<4xf32>) outs(%init : tensor<4xf32>) {
+    ^bb0(%in: f32, %m: f32, %acc: f32):
+      %0 = arith.subf %in, %m : f32
+      %1 = arith.mulf %0, %0 : f32
+      %2 = arith.mulf %1, %invN : f32
+      %3 = arith.addf %2, %acc : f32
+      linalg.yield %3 : f32
+  } -> tensor<4xf32>
+  %out = tensor.empty() : tensor<4x4xf32>
+  %res = linalg.generic {
+    indexing_maps = [#map, #row, #row, #col, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %mean, %var, %gamma, %beta
+      : tensor<4x4xf32>, tensor<4xf32>, tensor<4xf32>, tensor<4xf32>, tensor<4xf32>)
+    outs(%out : tensor<4x4xf32>) {
+    ^bb0(%in: f32, %m: f32, %v: f32, %g: f32, %b: f32, %o: f32):
+      %0 = arith.subf %in, %m : f32
+      %1 = arith.addf %v, %eps : f32
+      %2 = math.rsqrt %1 : f32
+      %3 = arith.mulf %0, %2 : f32
+      %4 = arith.mulf %3, %g : f32
+      %5 = arith.addf %4, %b : f32
+      linalg.yield %5 : f32
+  } -> tensor<4x4xf32>
+  return %res : tensor<4x4xf32>
+}
+
+// IR-LABEL: rmsnorm
+// IR-NOT: linalg.generic
+// IR: xsmm_rmsnorm_invoke
+// IR-NOT: linalg.generic
+func.func @rmsnorm(%x: tensor<4x4xf32>, %gamma: tensor<4xf32>) -> tensor<4x4xf32> {
+  %zero = arith.constant 0.0 : f32
+  %invN = arith.constant 0.25 : f32
+  %eps = arith.constant 1.0e-05 : f32
+  %empty = tensor.empty() : tensor<4xf32>
+  %init = linalg.fill ins(%zero : f32) outs(%empty : tensor<4xf32>) -> tensor<4xf32>
+  %ms = linalg.generic {
+    indexing_maps = [#map, #row],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%x : tensor<4x4xf32>) outs(%init : tensor<4xf32>) {
+    ^bb0(%in: f32, %acc: f32):
+      %0 = arith.mulf %in, %in : f32
+      %1 = arith.mulf %0, %invN : f32
+      %2 = arith.addf %1, %acc : f32
+      linalg.yield %2 : f32
+  } -> tensor<4xf32>
+  %out = tensor.empty() : tensor<4x4xf32>
+  %res = linalg.generic {
+    indexing_maps = [#map, #row, #col, #map],
+    iterator_types = ["parallel", "parallel"]}
+    ins(%x, %ms, %gamma : tensor<4x4xf32>, tensor<4xf32>, tensor<4xf32>)
+    outs(%out : tensor<4x4xf32>) {
+    ^bb0(%in: f32, %s: f32, %g: f32, %o: f32):
+      %0 = arith.addf %s, %eps : f32
+      %1 = math.rsqrt %0 : f32
+      %2 = arith.mulf %in, %1 : f32
+      %3 = arith.mulf %2, %g : f32
+      linalg.yield %3 : f32
+  } -> tensor<4x4xf32>
+  return %res : tensor<4x4xf32>
+}
+
+func.func @entry() {
+  %x = arith.constant dense<[
+        [ 1.0, 2.0, 3.0, 4.0 ],
+        [ 4.0, 4.0, 4.0, 4.0 ],
+        [ 0.0, 0.0, 0.0, 8.0 ],
+        [ -2.0, -1.0, 1.0, 2.0 ]
+  ]> : tensor<4x4xf32>
+  %gamma = arith.constant dense<2.0> : tensor<4xf32>
+  %beta = arith.constant dense<1.0> : tensor<4xf32>
+  %c0 = arith.constant 0 : index
+  %d1 = arith.constant -1.0 : f32
+
+  %0 = call @layernorm(%x, %gamma, %beta)
+    : (tensor<4x4xf32>, tensor<4xf32>, tensor<4xf32>) -> tensor<4x4xf32>
+
+  //
+  // CHECK:       ( ( -1.6832{{[0-9]*}}, 0.1055{{[0-9]*}}, 1.8944{{[0-9]*}}, 3.6832{{[0-9]*}} ),
+  // CHECK-SAME:    ( 1, 1, 1, 1 ),
+  // CHECK-SAME:    ( -0.1547{{[0-9]*}}, -0.1547{{[0-9]*}}, -0.1547{{[0-9]*}}, 4.4641{{[0-9]*}} ),
+  // CHECK-SAME:    ( -1.5298{{[0-9]*}}, -0.2649{{[0-9]*}}, 2.2649{{[0-9]*}}, 3.5298{{[0-9]*}} ) )
+  //
+  %v0 = vector.transfer_read %0[%c0, %c0], %d1 : tensor<4x4xf32>, vector<4x4xf32>
+  vector.print %v0 : vector<4x4xf32>
+
+  %1 = call @rmsnorm(%x, %gamma)
+    : (tensor<4x4xf32>, tensor<4xf32>) -> tensor<4x4xf32>
+
+  //
+  // CHECK:       ( ( 0.7302{{[0-9]*}}, 1.4605{{[0-9]*}}, 2.1908{{[0-9]*}}, 2.9211{{[0-9]*}} ),
+  // CHECK-SAME:    ( 1.9999{{[0-9]*}}, 1.9999{{[0-9]*}}, 1.9999{{[0-9]*}}, 1.9999{{[0-9]*}} ),
+  // CHECK-SAME:    ( 0, 0, 0, 3.9999{{[0-9]*}} ),
+  // CHECK-SAME:    ( -2.5298{{[0-9]*}}, -1.2649{{[0-9]*}}, 1.2649{{[0-9]*}}, 2.5298{{[0-9]*}} ) )
+  //
+  %v1 = vector.transfer_read %1[%c0, %c0], %d1 : tensor<4x4xf32>, vector<4x4xf32>
+  vector.print %v1 : vector<4x4xf32>
+
+  return
+}
@@ -0,0 +1,49 @@
+// RUN: tpp-opt %s -default-tpp-passes | FileCheck -check-prefix=IR %s
+
+// RUN: tpp-run %s -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+// RUN: tpp-run %s -linalg-to-loops -print \
+// RUN:  -e entry -entry-point-result=void | \
+// RUN: FileCheck %s
+
+// The decomposed softmax runs on XSMM reduce, sub, exp and div kernels.
+// IR-LABEL: softmax
+// IR-NOT: math.exp
+// IR: xsmm_unary_invoke
+// IR: xsmm_binary_invoke
+// IR: xsmm_unary_invoke
+// IR: xsmm_binary_invoke
+// IR-NOT: math.exp
+func.func @softmax(%A: tensor<4x4xf32>) -> tensor<4x4xf32> {
+  %0 = tensor.empty() : tensor<4x4xf32>
+  %1 = linalg.softmax dimension(1)
+    ins(%A : tensor<4x4xf32>) outs(%0 : tensor<4x4xf32>) -> tensor<4x4xf32>
+  return %1 : tensor<4x4xf32>
+}
+
+func.func @entry() {
+  %da = arith.constant dense<[
+        [ 1.0, 2.0, 3.0, 4.0 ],
+        [ 4.0, 3.0, 2.0, 1.0 ],
+        [ 0.0, 0.0, 0.0, 0.0 ],
+        [ 1.0, 2.0, 3.0, 4.0 ]
+  ]> : tensor<4x4xf32>
+
+  %0 = call @softmax(%da) : (tensor<4x4xf32>) -> tensor<4x4xf32>
+
+  //
+  // CHECK:       ( ( 0.0320{{[0-9]+}}, 0.0871{{[0-9]+}}, 0.2368{{[0-9]+}}, 0.6439{{[0-9]+}} ),
+  // CHECK-SAME:    ( 0.6439{{[0-9]+}}, 0.2368{{[0-9]+}}, 0.0871{{[0-9]+}}, 0.0320{{[0-9]+}} ),
+  // CHECK-SAME:    ( 0.25, 0.25, 0.25, 0.25 ),
+  // CHECK-SAME:    ( 0.0320{{[0-9]+}}, 0.0871{{[0-9]+}}, 0.2368{{[0-9]+}}, 0.6439{{[0-9]+}} ) )
+  //
+
+  %c0 = arith.constant 0 : index
+  %d1 = arith.constant -1.0 : f32
+  %v0 = vector.transfer_read %0[%c0, %c0], %d1 : tensor<4x4xf32>, vector<4x4xf32>
+  vector.print %v0 : vector<4x4xf32>
+
+  return
+}
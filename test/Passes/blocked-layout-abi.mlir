@@ -0,0 +1,148 @@
+// RUN: tpp-opt %s -blocked-layout-abi -split-input-file -allow-unregistered-dialect | FileCheck %s
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d2, d3, d5)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d1, d2, d5, d4)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d3, d4)>
+
+func.func @kernel(%arg0: tensor<128x256xf32>, %arg1: tensor<16x8x32x32xf32>,
+                  %arg2: tensor<128x512xf32>) -> tensor<128x512xf32>
+    attributes {tpp.blocked_abi} {
+  %0 = tensor.empty() : tensor<4x8x32x32xf32>
+  %pack = tensor.pack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+    into %0 : tensor<128x256xf32> -> tensor<4x8x32x32xf32>
+  %1 = tensor.empty() : tensor<4x16x32x32xf32>
+  %pack_0 = tensor.pack %arg2 inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+    into %1 : tensor<128x512xf32> -> tensor<4x16x32x32xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map1, #map2], iterator_types = ["parallel", "parallel", "reduction", "parallel", "parallel", "reduction"]} ins(%pack, %arg1 : tensor<4x8x32x32xf32>, tensor<16x8x32x32xf32>) outs(%pack_0 : tensor<4x16x32x32xf32>) {
+    ^bb0(%in: f32, %in_1: f32, %out: f32):
+      %3 = arith.mulf %in, %in_1 : f32
+      %4 = arith.addf %out, %3 : f32
+      linalg.yield %4 : f32
+  } -> tensor<4x16x32x32xf32>
+  %unpack = tensor.unpack %2 inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+    into %arg2 : tensor<4x16x32x32xf32> -> tensor<128x512xf32>
+  return %unpack : tensor<128x512xf32>
+}
+
+func.func @caller(%arg0: tensor<128x256xf32>, %arg1: tensor<16x8x32x32xf32>,
+                  %arg2: tensor<128x512xf32>, %n: index) -> tensor<128x512xf32> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %0 = scf.for %i = %c0 to %n step %c1 iter_args(%acc = %arg2) -> (tensor<128x512xf32>) {
+    %1 = func.call @kernel(%arg0, %arg1, %arg2) : (tensor<128x256xf32>, tensor<16x8x32x32xf32>, tensor<128x512xf32>) -> tensor<128x512xf32>
+    scf.yield %1 : tensor<128x512xf32>
+  }
+  return %0 : tensor<128x512xf32>
+}
+
+// CHECK-LABEL: func.func @kernel(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<4x8x32x32xf32> {tpp.blocked_layout = {inner_dims_pos = array<i64: 0, 1>, inner_tiles = array<i64: 32, 32>, outer_dims_perm = array<i64>}},
+// CHECK-SAME:  %[[ARG1:.+]]: tensor<16x8x32x32xf32>,
+// CHECK-SAME:  %[[ARG2:.+]]: tensor<4x16x32x32xf32> {tpp.blocked_layout = {{.+}}})
+// CHECK-SAME:  -> (tensor<4x16x32x32xf32> {tpp.blocked_layout = {{.+}}})
+// CHECK-NOT: tensor.pack
+// CHECK: %[[GEMM:.+]] = linalg.generic
+// CHECK-SAME:  ins(%[[ARG0]], %[[ARG1]] :
+// CHECK-SAME:  outs(%[[ARG2]] :
+// CHECK-NOT: tensor.unpack
+// CHECK: return %[[GEMM]] : tensor<4x16x32x32xf32>
+
+func.func @unused_result(%arg0: tensor<128x256xf32>, %arg1: tensor<16x8x32x32xf32>,
+                         %arg2: tensor<128x512xf32>, %n: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  scf.for %i = %c0 to %n step %c1 {
+    %1 = func.call @kernel(%arg0, %arg1, %arg2) : (tensor<128x256xf32>, tensor<16x8x32x32xf32>, tensor<128x512xf32>) -> tensor<128x512xf32>
+  }
+  return
+}
+
+// The operands are packed once, before the loop, and the result carried by
+// the loop is unpacked once, after it.
+// CHECK-LABEL: func.func @caller(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<128x256xf32>, %[[ARG1:.+]]: tensor<16x8x32x32xf32>, %[[ARG2:.+]]: tensor<128x512xf32>
+// CHECK-DAG: %[[PACK0:.+]] = tensor.pack %[[ARG0]] inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+// CHECK-DAG: %[[PACK2:.+]] = tensor.pack %[[ARG2]] inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+// CHECK: %[[INIT:.+]] = tensor.pack %[[ARG2]] inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+// CHECK: %[[LOOP:.+]] = scf.for {{.+}} iter_args(%{{.+}} = %[[INIT]]) -> (tensor<4x16x32x32xf32>)
+// CHECK-NOT: tensor.pack
+// CHECK: %[[CALL:.+]] = call @kernel(%[[PACK0]], %[[ARG1]], %[[PACK2]])
+// CHECK-SAME:  -> tensor<4x16x32x32xf32>
+// CHECK-NOT: tensor.unpack
+// CHECK: scf.yield %[[CALL]]
+// CHECK: %[[EMPTY:.+]] = tensor.empty() : tensor<128x512xf32>
+// CHECK: %[[UNPACK:.+]] = tensor.unpack %[[LOOP]] inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+// CHECK-SAME:  into %[[EMPTY]] : tensor<4x16x32x32xf32> -> tensor<128x512xf32>
+// CHECK: return %[[UNPACK]]
+
+// Unused results, e.g., in a benchmarking loop, are not unpacked.
+// CHECK-LABEL: func.func @unused_result(
+// CHECK: scf.for
+// CHECK: call @kernel(
+// CHECK-NOT: tensor.unpack
+// CHECK: return
+
+// -----
+
+func.func @not_marked(%arg0: tensor<128x256xf32>) -> tensor<4x8x32x32xf32> {
+  %0 = tensor.empty() : tensor<4x8x32x32xf32>
+  %pack = tensor.pack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+    into %0 : tensor<128x256xf32> -> tensor<4x8x32x32xf32>
+  return %pack : tensor<4x8x32x32xf32>
+}
+
+// Only functions that opt into the blocked ABI are converted.
+// CHECK-LABEL: func.func @not_marked(
+// CHECK-SAME:  %{{.+}}: tensor<128x256xf32>)
+// CHECK: tensor.pack
+
+// -----
+
+func.func @multi_use(%arg0: tensor<128x256xf32>) -> (tensor<4x8x32x32xf32>, tensor<128x256xf32>)
+    attributes {tpp.blocked_abi} {
+  %0 = tensor.empty() : tensor<4x8x32x32xf32>
+  %pack = tensor.pack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+    into %0 : tensor<128x256xf32> -> tensor<4x8x32x32xf32>
+  return %pack, %arg0 : tensor<4x8x32x32xf32>, tensor<128x256xf32>
+}
+
+// Arguments also used in the plain layout keep their type.
+// CHECK-LABEL: func.func @multi_use(
+// CHECK-SAME:  %{{.+}}: tensor<128x256xf32>)
+// CHECK-NOT: tpp.blocked_layout
+// CHECK: tensor.pack
+
+// -----
+
+func.func @prepacked(%arg0: tensor<128x256xbf16>, %arg1: tensor<256x512xbf16> {tpp.prepacked},
+                     %arg2: tensor<128x512xbf16>) -> tensor<128x512xbf16> {
+  %0 = tensor.empty() : tensor<16x8x32x32xbf16>
+  %pack = tensor.pack %arg1 outer_dims_perm = [1, 0] inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+    into %0 : tensor<256x512xbf16> -> tensor<16x8x32x32xbf16>
+  %1 = tensor.empty() : tensor<16x8x16x32x2xbf16>
+  %pack_0 = tensor.pack %pack inner_dims_pos = [2] inner_tiles = [2]
+    into %1 : tensor<16x8x32x32xbf16> -> tensor<16x8x16x32x2xbf16>
+  %2 = "test.op"(%arg0, %pack_0, %arg2) : (tensor<128x256xbf16>, tensor<16x8x16x32x2xbf16>, tensor<128x512xbf16>) -> tensor<128x512xbf16>
+  return %2 : tensor<128x512xbf16>
+}
+
+func.func @prepacked_caller(%arg0: tensor<128x256xbf16>, %arg1: tensor<256x512xbf16>,
+                            %arg2: tensor<128x512xbf16>) -> tensor<128x512xbf16> {
+  %0 = func.call @prepacked(%arg0, %arg1, %arg2) : (tensor<128x256xbf16>, tensor<256x512xbf16>, tensor<128x512xbf16>) -> tensor<128x512xbf16>
+  return %0 : tensor<128x512xbf16>
+}
+
+// Prepacked arguments skip the whole chain of packs, blocking and VNNI.
+// CHECK-LABEL: func.func @prepacked(
+// CHECK-SAME:  %{{.+}}: tensor<128x256xbf16>,
+// CHECK-SAME:  %[[ARG1:.+]]: tensor<16x8x16x32x2xbf16> {tpp.blocked_layout = [{inner_dims_pos = array<i64: 0, 1>, inner_tiles = array<i64: 32, 32>, outer_dims_perm = array<i64: 1, 0>}, {inner_dims_pos = array<i64: 2>, inner_tiles = array<i64: 2>, outer_dims_perm = array<i64>}], tpp.prepacked},
+// CHECK-SAME:  %{{.+}}: tensor<128x512xbf16>) -> tensor<128x512xbf16>
+// CHECK-NOT: tensor.pack
+// CHECK: "test.op"(%{{.+}}, %[[ARG1]], %{{.+}})
+
+// CHECK-LABEL: func.func @prepacked_caller(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<128x256xbf16>, %[[ARG1:.+]]: tensor<256x512xbf16>, %[[ARG2:.+]]: tensor<128x512xbf16>
+// CHECK: %[[PACK:.+]] = tensor.pack %[[ARG1]] outer_dims_perm = [1, 0] inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+// CHECK: %[[VNNI:.+]] = tensor.pack %[[PACK]] inner_dims_pos = [2] inner_tiles = [2]
+// CHECK: call @prepacked(%[[ARG0]], %[[VNNI]], %[[ARG2]])
+// CHECK-NOT: tensor.unpack
@@ -0,0 +1,117 @@
+// RUN: tpp-opt %s -fuse-attention -split-input-file | FileCheck %s
+
+func.func @mha(%Q: tensor<8x128x64xf32>, %K: tensor<8x256x64xf32>,
+               %V: tensor<8x256x32xf32>) -> tensor<8x128x32xf32> {
+  %zero = arith.constant 0.0 : f32
+  %0 = tensor.empty() : tensor<8x128x256xf32>
+  %1 = linalg.fill ins(%zero : f32) outs(%0 : tensor<8x128x256xf32>) -> tensor<8x128x256xf32>
+  %2 = linalg.batch_matmul_transpose_b ins(%Q, %K : tensor<8x128x64xf32>, tensor<8x256x64xf32>)
+                                       outs(%1 : tensor<8x128x256xf32>) -> tensor<8x128x256xf32>
+  %3 = tensor.empty() : tensor<8x128x256xf32>
+  %4 = linalg.softmax dimension(2)
+    ins(%2 : tensor<8x128x256xf32>) outs(%3 : tensor<8x128x256xf32>) -> tensor<8x128x256xf32>
+  %5 = tensor.empty() : tensor<8x128x32xf32>
+  %6 = linalg.fill ins(%zero : f32) outs(%5 : tensor<8x128x32xf32>) -> tensor<8x128x32xf32>
+  %7 = linalg.batch_matmul ins(%4, %V : tensor<8x128x256xf32>, tensor<8x256x32xf32>)
+                           outs(%6 : tensor<8x128x32xf32>) -> tensor<8x128x32xf32>
+  return %7 : tensor<8x128x32xf32>
+}
+
+// CHECK-DAG: #[[ID:.+]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG: #[[ROW:.+]] = affine_map<(d0, d1) -> (d0)>
+// CHECK-DAG: #[[VEC:.+]] = affine_map<(d0) -> (d0)>
+
+// CHECK-LABEL: func.func @mha(
+// CHECK-SAME:  %[[Q:.+]]: tensor<8x128x64xf32>, %[[K:.+]]: tensor<8x256x64xf32>, %[[V:.+]]: tensor<8x256x32xf32>
+// CHECK-NOT: linalg.softmax
+// CHECK-NOT: linalg.batch_matmul
+// CHECK: %[[FILL:.+]] = linalg.fill {{.+}} -> tensor<8x128x32xf32>
+// CHECK: %[[KT:.+]] = linalg.transpose ins(%[[K]] : tensor<8x256x64xf32>) outs(%{{.+}} : tensor<8x64x256xf32>) permutation = [0, 2, 1]
+// CHECK: %[[RES:.+]] = scf.forall (%[[B:.+]], %[[I:.+]]) = (0, 0) to (8, 128) step (1, 32)
+// CHECK-SAME:  shared_outs(%[[OUT:.+]] = %[[FILL]])
+// CHECK: %[[QB:.+]] = tensor.extract_slice %[[Q]][%[[B]], %[[I]], 0] [1, 32, 64] [1, 1, 1]
+// CHECK-SAME:  : tensor<8x128x64xf32> to tensor<32x64xf32>
+// CHECK: %[[MINF:.+]] = arith.constant 0xFF800000 : f32
+// CHECK: %[[INITMAX:.+]] = linalg.fill ins(%[[MINF]] : f32) {{.+}} -> tensor<32xf32>
+// CHECK: %[[LOOP:.+]]:3 = scf.for %[[J:.+]] = %{{.+}} to %{{.+}} step %{{.+}} iter_args(
+// CHECK-SAME:  %[[ACC:.+]] = %{{.+}}, %[[MAX:.+]] = %[[INITMAX]], %[[SUM:.+]] = %{{.+}})
+// CHECK-SAME:  -> (tensor<32x32xf32>, tensor<32xf32>, tensor<32xf32>)
+// CHECK: %[[KB:.+]] = tensor.extract_slice %[[KT]][%[[B]], 0, %[[J]]] [1, 64, 32] [1, 1, 1]
+// CHECK-SAME:  : tensor<8x64x256xf32> to tensor<64x32xf32>
+// CHECK: %[[VB:.+]] = tensor.extract_slice %[[V]][%[[B]], %[[J]], 0] [1, 32, 32] [1, 1, 1]
+// CHECK-SAME:  : tensor<8x256x32xf32> to tensor<32x32xf32>
+// CHECK-NOT: linalg.transpose
+// CHECK: %[[S:.+]] = linalg.matmul ins(%[[QB]], %[[KB]] : tensor<32x64xf32>, tensor<64x32xf32>)
+// CHECK: %[[NEWMAX:.+]] = linalg.generic {indexing_maps = [#[[ID]], #[[ROW]]], iterator_types = ["parallel", "reduction"]}
+// CHECK-SAME:  ins(%[[S]] : tensor<32x32xf32>) outs(%[[MAX]] : tensor<32xf32>)
+// CHECK: arith.maximumf
+// CHECK: %[[P:.+]] = linalg.generic {{.+}} ins(%[[S]], %[[NEWMAX]] :
+// CHECK: arith.subf
+// CHECK: math.exp
+// CHECK: %[[ALPHA:.+]] = linalg.generic {{.+}} ins(%[[MAX]], %[[NEWMAX]] :
+// CHECK: arith.subf
+// CHECK: math.exp
+// CHECK: %[[SCALEDSUM:.+]] = linalg.generic {{.+}} ins(%[[ALPHA]] : tensor<32xf32>) outs(%[[SUM]] : tensor<32xf32>)
+// CHECK: %[[NEWSUM:.+]] = linalg.generic {{.+}} ins(%[[P]] : tensor<32x32xf32>) outs(%[[SCALEDSUM]] : tensor<32xf32>)
+// CHECK: arith.addf
+// CHECK: %[[SCALEDACC:.+]] = linalg.generic {{.+}} ins(%[[ALPHA]] : tensor<32xf32>) outs(%[[ACC]] : tensor<32x32xf32>)
+// CHECK: %[[NEWACC:.+]] = linalg.matmul ins(%[[P]], %[[VB]] : tensor<32x32xf32>, tensor<32x32xf32>)
+// CHECK-SAME:  outs(%[[SCALEDACC]] : tensor<32x32xf32>)
+// CHECK: scf.yield %[[NEWACC]], %[[NEWMAX]], %[[NEWSUM]]
+// CHECK: %[[NORM:.+]] = linalg.generic {{.+}} ins(%[[LOOP]]#2 : tensor<32xf32>) outs(%[[LOOP]]#0 : tensor<32x32xf32>)
+// CHECK: arith.divf
+// CHECK: scf.forall.in_parallel
+// CHECK: tensor.parallel_insert_slice %[[NORM]] into %[[OUT]][%[[B]], %[[I]], 0] [1, 32, 32] [1, 1, 1]
+// CHECK: return %[[RES]]
+
+// -----
+
+func.func @attention_small(%Q: tensor<16x8xf32>, %K: tensor<64x8xf32>,
+                           %V: tensor<64x8xf32>) -> tensor<16x8xf32> {
+  %zero = arith.constant 0.0 : f32
+  %0 = tensor.empty() : tensor<16x64xf32>
+  %1 = linalg.fill ins(%zero : f32) outs(%0 : tensor<16x64xf32>) -> tensor<16x64xf32>
+  %2 = linalg.matmul_transpose_b ins(%Q, %K : tensor<16x8xf32>, tensor<64x8xf32>)
+                                 outs(%1 : tensor<16x64xf32>) -> tensor<16x64xf32>
+  %3 = tensor.empty() : tensor<16x64xf32>
+  %4 = linalg.softmax dimension(1)
+    ins(%2 : tensor<16x64xf32>) outs(%3 : tensor<16x64xf32>) -> tensor<16x64xf32>
+  %5 = tensor.empty() : tensor<16x8xf32>
+  %6 = linalg.fill ins(%zero : f32) outs(%5 : tensor<16x8xf32>) -> tensor<16x8xf32>
+  %7 = linalg.matmul ins(%4, %V : tensor<16x64xf32>, tensor<64x8xf32>)
+                     outs(%6 : tensor<16x8xf32>) -> tensor<16x8xf32>
+  return %7 : tensor<16x8xf32>
+}
+
+// Query blocks are clamped to the sequence length.
+// CHECK-LABEL: func.func @attention_small(
+// CHECK: scf.forall (%{{.+}}) = (0) to (16) step (16)
+// CHECK: tensor.extract_slice {{.+}} [16, 8] [1, 1] : tensor<16x8xf32> to tensor<16x8xf32>
+// CHECK: scf.for
+// CHECK: tensor.extract_slice {{.+}} [8, 32] [1, 1] : tensor<8x64xf32> to tensor<8x32xf32>
+// CHECK: tensor.extract_slice {{.+}} [32, 8] [1, 1] : tensor<64x8xf32> to tensor<32x8xf32>
+// CHECK: linalg.matmul {{.+}} -> tensor<16x32xf32>
+// CHECK-NOT: linalg.softmax
+
+// -----
+
+func.func @softmax_reused(%Q: tensor<64x64xf32>, %K: tensor<64x64xf32>,
+                          %V: tensor<64x64xf32>) -> (tensor<64x64xf32>, tensor<64x64xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %0 = tensor.empty() : tensor<64x64xf32>
+  %1 = linalg.fill ins(%zero : f32) outs(%0 : tensor<64x64xf32>) -> tensor<64x64xf32>
+  %2 = linalg.matmul_transpose_b ins(%Q, %K : tensor<64x64xf32>, tensor<64x64xf32>)
+                                 outs(%1 : tensor<64x64xf32>) -> tensor<64x64xf32>
+  %4 = linalg.softmax dimension(1)
+    ins(%2 : tensor<64x64xf32>) outs(%0 : tensor<64x64xf32>) -> tensor<64x64xf32>
+  %7 = linalg.matmul ins(%4, %V : tensor<64x64xf32>, tensor<64x64xf32>)
+                     outs(%1 : tensor<64x64xf32>) -> tensor<64x64xf32>
+  return %7, %4 : tensor<64x64xf32>, tensor<64x64xf32>
+}
+
+// The probabilities are needed as a whole, nothing to fuse.
+// CHECK-LABEL: func.func @softmax_reused(
+// CHECK-NOT: scf.forall
+// CHECK: linalg.matmul_transpose_b
+// CHECK: linalg.softmax
+// CHECK: linalg.matmul
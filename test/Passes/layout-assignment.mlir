@@ -0,0 +1,173 @@
+// RUN: tpp-opt %s -layout-assignment -split-input-file | FileCheck %s
+// RUN: tpp-opt %s -layout-assignment="print-summary=true" -split-input-file -o /dev/null 2>&1 | \
+// RUN: FileCheck %s -check-prefix=SUMMARY
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d2, d3, d5)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d1, d2, d5, d4)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d3, d4)>
+#map3 = affine_map<(d0, d1) -> (d0, d1)>
+#map4 = affine_map<(d0, d1) -> (d1)>
+
+func.func @two_layers(%arg0: tensor<4x4x32x32xf32>, %arg1: tensor<4x4x32x32xf32>,
+                      %bias: tensor<128xf32>, %arg2: tensor<4x4x32x32xf32>,
+                      %arg3: tensor<4x4x32x32xf32>) -> tensor<4x4x32x32xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = linalg.generic {indexing_maps = [#map, #map1, #map2], iterator_types = ["parallel", "parallel", "reduction", "parallel", "parallel", "reduction"]} ins(%arg0, %arg1 : tensor<4x4x32x32xf32>, tensor<4x4x32x32xf32>) outs(%arg2 : tensor<4x4x32x32xf32>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %6 = arith.mulf %in, %in_0 : f32
+      %7 = arith.addf %out, %6 : f32
+      linalg.yield %7 : f32
+  } -> tensor<4x4x32x32xf32>
+  %1 = tensor.empty() : tensor<128x128xf32>
+  %unpack = tensor.unpack %0 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %1 : tensor<4x4x32x32xf32> -> tensor<128x128xf32>
+  %2 = linalg.generic {indexing_maps = [#map3, #map4, #map3], iterator_types = ["parallel", "parallel"]} ins(%unpack, %bias : tensor<128x128xf32>, tensor<128xf32>) outs(%1 : tensor<128x128xf32>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %6 = arith.addf %in, %in_0 : f32
+      linalg.yield %6 : f32
+  } -> tensor<128x128xf32>
+  %3 = linalg.generic {indexing_maps = [#map3], iterator_types = ["parallel", "parallel"]} outs(%2 : tensor<128x128xf32>) {
+    ^bb0(%out: f32):
+      %6 = arith.maximumf %out, %cst : f32
+      linalg.yield %6 : f32
+  } -> tensor<128x128xf32>
+  %4 = tensor.empty() : tensor<4x4x32x32xf32>
+  %pack = tensor.pack %3 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %4 : tensor<128x128xf32> -> tensor<4x4x32x32xf32>
+  %5 = linalg.generic {indexing_maps = [#map, #map1, #map2], iterator_types = ["parallel", "parallel", "reduction", "parallel", "parallel", "reduction"]} ins(%pack, %arg1 : tensor<4x4x32x32xf32>, tensor<4x4x32x32xf32>) outs(%arg3 : tensor<4x4x32x32xf32>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %6 = arith.mulf %in, %in_0 : f32
+      %7 = arith.addf %out, %6 : f32
+      linalg.yield %7 : f32
+  } -> tensor<4x4x32x32xf32>
+  return %5 : tensor<4x4x32x32xf32>
+}
+
+// The pack of the bias is the only conversion left.
+// SUMMARY: layout-assignment: @two_layers: 1 blocked group(s), packs 1 -> 1, unpacks 1 -> 0
+// CHECK-LABEL: func.func @two_layers(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<4x4x32x32xf32>, %[[ARG1:.+]]: tensor<4x4x32x32xf32>,
+// CHECK-SAME:  %[[BIAS:.+]]: tensor<128xf32>
+// CHECK-NOT: tensor.unpack
+// CHECK: %[[GEMM0:.+]] = linalg.generic
+// CHECK-SAME:  ins(%[[ARG0]], %[[ARG1]]
+// CHECK: %[[PACKED_BIAS:.+]] = tensor.pack %[[BIAS]]
+// CHECK-SAME:  inner_dims_pos = [0] inner_tiles = [32]
+// CHECK-SAME:  tensor<128xf32> -> tensor<4x32xf32>
+// CHECK: %[[ADD:.+]] = linalg.generic
+// CHECK-SAME:  ins(%[[GEMM0]], %[[PACKED_BIAS]] : tensor<4x4x32x32xf32>, tensor<4x32xf32>)
+// CHECK: %[[RELU:.+]] = linalg.generic
+// CHECK-SAME:  outs(%[[ADD]] : tensor<4x4x32x32xf32>)
+// CHECK-NOT: tensor.unpack
+// CHECK: %[[GEMM1:.+]] = linalg.generic
+// CHECK-SAME:  ins(%[[RELU]], %[[ARG1]]
+// CHECK: return %[[GEMM1]]
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// The unpacked value escapes the function: moving the conversion to the
+// result does not remove any.
+func.func @boundary(%arg0: tensor<4x4x32x32xf32>) -> tensor<128x128xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<128x128xf32>
+  %unpack = tensor.unpack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %0 : tensor<4x4x32x32xf32> -> tensor<128x128xf32>
+  %1 = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]} outs(%unpack : tensor<128x128xf32>) {
+    ^bb0(%out: f32):
+      %2 = arith.maximumf %out, %cst : f32
+      linalg.yield %2 : f32
+  } -> tensor<128x128xf32>
+  return %1 : tensor<128x128xf32>
+}
+
+// SUMMARY: layout-assignment: @boundary: 0 blocked group(s), packs 0 -> 0, unpacks 1 -> 1
+// CHECK-LABEL: func.func @boundary(
+// CHECK: tensor.unpack
+// CHECK: linalg.generic
+// CHECK: return
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @escaping_result(%arg0: tensor<4x4x32x32xf32>) -> (tensor<4x4x32x32xf32>, tensor<128x128xf32>) {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<128x128xf32>
+  %unpack = tensor.unpack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %0 : tensor<4x4x32x32xf32> -> tensor<128x128xf32>
+  %1 = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]} outs(%unpack : tensor<128x128xf32>) {
+    ^bb0(%out: f32):
+      %2 = arith.maximumf %out, %cst : f32
+      linalg.yield %2 : f32
+  } -> tensor<128x128xf32>
+  %3 = tensor.empty() : tensor<4x4x32x32xf32>
+  %pack = tensor.pack %1 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %3 : tensor<128x128xf32> -> tensor<4x4x32x32xf32>
+  return %pack, %1 : tensor<4x4x32x32xf32>, tensor<128x128xf32>
+}
+
+// The value also returned in the plain layout is unpacked once, at the
+// function boundary.
+// SUMMARY: layout-assignment: @escaping_result: 1 blocked group(s), packs 1 -> 0, unpacks 1 -> 1
+// CHECK-LABEL: func.func @escaping_result(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<4x4x32x32xf32>
+// CHECK-NOT: tensor.unpack
+// CHECK: %[[RELU:.+]] = linalg.generic
+// CHECK-SAME:  outs(%[[ARG0]] : tensor<4x4x32x32xf32>)
+// CHECK: %[[EMPTY:.+]] = tensor.empty() : tensor<128x128xf32>
+// CHECK: %[[UNPACK:.+]] = tensor.unpack %[[RELU]] inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+// CHECK-SAME:  into %[[EMPTY]]
+// CHECK-NOT: tensor.pack
+// CHECK: return %[[RELU]], %[[UNPACK]]
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @conflicting(%arg0: tensor<4x4x32x32xf32>) -> tensor<8x8x16x16xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<128x128xf32>
+  %unpack = tensor.unpack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %0 : tensor<4x4x32x32xf32> -> tensor<128x128xf32>
+  %1 = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]} outs(%unpack : tensor<128x128xf32>) {
+    ^bb0(%out: f32):
+      %2 = arith.maximumf %out, %cst : f32
+      linalg.yield %2 : f32
+  } -> tensor<128x128xf32>
+  %3 = tensor.empty() : tensor<8x8x16x16xf32>
+  %pack = tensor.pack %1 inner_dims_pos = [0, 1] inner_tiles = [16, 16] into %3 : tensor<128x128xf32> -> tensor<8x8x16x16xf32>
+  return %pack : tensor<8x8x16x16xf32>
+}
+
+// Either blocked layout trades one conversion for another: keep the plain
+// layout.
+// SUMMARY: layout-assignment: @conflicting: 0 blocked group(s), packs 1 -> 1, unpacks 1 -> 1
+// CHECK-LABEL: func.func @conflicting(
+// CHECK: tensor.unpack
+// CHECK: linalg.generic
+// CHECK: tensor.pack
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @multi_block(%arg0: tensor<4x4x32x32xf32>, %cond: i1) -> tensor<4x4x32x32xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<128x128xf32>
+  %unpack = tensor.unpack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %0 : tensor<4x4x32x32xf32> -> tensor<128x128xf32>
+  cf.cond_br %cond, ^bb1, ^bb2(%unpack : tensor<128x128xf32>)
+^bb1:
+  %1 = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]} outs(%unpack : tensor<128x128xf32>) {
+    ^bb0(%out: f32):
+      %2 = arith.maximumf %out, %cst : f32
+      linalg.yield %2 : f32
+  } -> tensor<128x128xf32>
+  cf.br ^bb2(%1 : tensor<128x128xf32>)
+^bb2(%3: tensor<128x128xf32>):
+  %4 = tensor.empty() : tensor<4x4x32x32xf32>
+  %pack = tensor.pack %3 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %4 : tensor<128x128xf32> -> tensor<4x4x32x32xf32>
+  return %pack : tensor<4x4x32x32xf32>
+}
+
+// Only straight-line functions are rewritten, the others are still reported.
+// SUMMARY: layout-assignment: @multi_block: 0 blocked group(s) (skipped: multi-block), packs 1 -> 1, unpacks 1 -> 1
+// CHECK-LABEL: func.func @multi_block(
+// CHECK: tensor.unpack
+// CHECK: linalg.generic
+// CHECK: tensor.pack
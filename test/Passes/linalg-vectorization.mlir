@@ -0,0 +1,179 @@
+// RUN: tpp-opt %s -linalg-vectorization="vector-width=256" -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+
+func.func @tanh_blocked(%arg0: memref<2x4x32x32xf32>, %arg1: memref<2x4x32x32xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map],
+    iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+    ins(%arg0 : memref<2x4x32x32xf32>) outs(%arg1 : memref<2x4x32x32xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %0 = math.tanh %in : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// Outer loops are tiled by one, the innermost by the vector length.
+// CHECK-LABEL: func.func @tanh_blocked(
+// CHECK-DAG: %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG: %[[C8:.+]] = arith.constant 8 : index
+// CHECK: scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C1]]
+// CHECK: scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C1]]
+// CHECK: scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C1]]
+// CHECK: scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C8]]
+// CHECK: vector.transfer_read {{.+}} vector<8xf32>
+// CHECK: math.exp {{.+}} : vector<8xf32>
+// CHECK: vector.transfer_write {{.+}} : vector<8xf32>
+// CHECK-NOT: linalg.generic
+// CHECK-NOT: math.tanh
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+
+func.func @row_sum(%arg0: memref<64x64xbf16>, %arg1: memref<64xbf16>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1],
+    iterator_types = ["parallel", "reduction"]}
+    ins(%arg0 : memref<64x64xbf16>) outs(%arg1 : memref<64xbf16>) {
+    ^bb0(%in: bf16, %out: bf16):
+      %0 = arith.addf %in, %out : bf16
+      linalg.yield %0 : bf16
+  }
+  return
+}
+
+// Narrower types get longer vectors.
+// CHECK-LABEL: func.func @row_sum(
+// CHECK-DAG: %[[C16:.+]] = arith.constant 16 : index
+// CHECK: scf.for
+// CHECK: scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C16]]
+// CHECK: vector.transfer_read {{.+}} vector<16xbf16>
+// CHECK: vector.reduction <add>, {{.+}} : vector<16xbf16> into bf16
+// CHECK-NOT: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @not_divisible(%arg0: memref<4x12xf32>) {
+  linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : memref<4x12xf32>) {
+    ^bb0(%out: f32):
+      %0 = math.exp %out : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// The full vectors of the innermost dimension are split from the remainder,
+// which is left to scalar code.
+// CHECK-LABEL: func.func @not_divisible(
+// CHECK-SAME:  %[[ARG0:.+]]: memref<4x12xf32>
+// CHECK: scf.for
+// CHECK-NOT: scf.for
+// CHECK: math.exp {{.+}} : vector<8xf32>
+// CHECK-NOT: vector<12xf32>
+// CHECK: %[[TAIL:.+]] = memref.subview %[[ARG0]][0, 8] [4, 4] [1, 1]
+// CHECK: linalg.generic
+// CHECK-SAME:  outs(%[[TAIL]] : memref<4x4xf32, strided<[12, 1], offset: 8>>)
+// CHECK: math.exp {{.+}} : f32
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @wide_row(%arg0: memref<2x1000xf32>) {
+  linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : memref<2x1000xf32>) {
+    ^bb0(%out: f32):
+      %0 = math.exp %out : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// A wide row is vectorized by the register width, never as a whole.
+// CHECK-LABEL: func.func @wide_row(
+// CHECK-SAME:  %[[ARG0:.+]]: memref<2x1000xf32>
+// CHECK-DAG: %[[C8:.+]] = arith.constant 8 : index
+// CHECK: scf.for
+// CHECK: scf.for %{{.+}} = %{{.+}} to %{{.+}} step %[[C8]]
+// CHECK: math.exp {{.+}} : vector<8xf32>
+// CHECK-NOT: vector<1000xf32>
+// CHECK-NOT: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @shorter_than_vector(%arg0: memref<4x6xf32>) {
+  linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : memref<4x6xf32>) {
+    ^bb0(%out: f32):
+      %0 = math.exp %out : f32
+      linalg.yield %0 : f32
+  }
+  return
+}
+
+// An innermost dimension shorter than a vector is kept whole.
+// CHECK-LABEL: func.func @shorter_than_vector(
+// CHECK: scf.for
+// CHECK-NOT: scf.for
+// CHECK: math.exp {{.+}} : vector<6xf32>
+// CHECK-NOT: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d2, d1)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d1)>
+
+func.func @contraction(%arg0: memref<8x8xf32>, %arg1: memref<8x8xf32>,
+                       %arg2: memref<8x8xf32>) {
+  linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "reduction"]}
+    ins(%arg0, %arg1 : memref<8x8xf32>, memref<8x8xf32>)
+    outs(%arg2 : memref<8x8xf32>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %0 = arith.mulf %in, %in_0 : f32
+      %1 = arith.addf %out, %0 : f32
+      linalg.yield %1 : f32
+  }
+  return
+}
+
+// Contractions are not element-wise leftovers.
+// CHECK-LABEL: func.func @contraction(
+// CHECK-NOT: vector.transfer_read
+// CHECK: linalg.generic
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @tensor_semantics(%arg0: tensor<8x8xf32>) -> tensor<8x8xf32> {
+  %0 = linalg.generic {
+    indexing_maps = [#map],
+    iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : tensor<8x8xf32>) {
+    ^bb0(%out: f32):
+      %1 = math.exp %out : f32
+      linalg.yield %1 : f32
+  } -> tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
+
+// CHECK-LABEL: func.func @tensor_semantics(
+// CHECK-NOT: vector.transfer_read
+// CHECK: linalg.generic
@@ -1,4 +1,6 @@
 // RUN: tpp-opt -rewrite-batch-matmul-to-matmul -split-input-file %s | FileCheck %s
+// RUN: tpp-opt -rewrite-batch-matmul-to-matmul="small-gemm-size=64" -split-input-file %s | \
+// RUN: FileCheck %s -check-prefix=SMALL
 
 func.func @batch_matmul_rewrite(%arg0: tensor<512x32x64xf32>, %arg1: tensor<512x64x32xf32>) -> tensor<512x32x32xf32> {
   %0 = tensor.empty() : tensor<512x32x32xf32>
@@ -87,3 +89,23 @@ func.func @batch_matmul_rewrite(%arg0: tensor<?x?x?xf32>,
 // CHECK-SAME:  : tensor<?x?x?xf32> to tensor<?x?x?xf32>
 // CHECK: %{{.+}} = linalg.batch_matmul ins(%[[SLICE]], %[[SLICE1]] : tensor<?x?x?xf32>, tensor<?x?x?xf32>)
 // CHECK-SAME:  outs(%[[SLICE2]] : tensor<?x?x?xf32>) -> tensor<?x?x?xf32>
+
+// -----
+
+func.func @small_batch_matmul(%arg0: tensor<512x32x32xf32>, %arg1: tensor<512x32x64xf32>,
+                              %arg2: tensor<512x64x128xf32>) -> (tensor<512x32x64xf32>, tensor<512x32x128xf32>) {
+  %0 = tensor.empty() : tensor<512x32x64xf32>
+  %1 = linalg.batch_matmul ins(%arg0, %arg1 : tensor<512x32x32xf32>, tensor<512x32x64xf32>)
+                           outs(%0 : tensor<512x32x64xf32>) -> tensor<512x32x64xf32>
+  %2 = tensor.empty() : tensor<512x32x128xf32>
+  %3 = linalg.batch_matmul ins(%1, %arg2 : tensor<512x32x64xf32>, tensor<512x64x128xf32>)
+                           outs(%2 : tensor<512x32x128xf32>) -> tensor<512x32x128xf32>
+  return %1, %3 : tensor<512x32x64xf32>, tensor<512x32x128xf32>
+}
+
+// Small per-batch products are kept whole, the others are still rewritten.
+// SMALL-LABEL: small_batch_matmul
+// SMALL: %[[BMM:.+]] = linalg.batch_matmul
+// SMALL-SAME:  -> tensor<512x32x64xf32>
+// SMALL: scf.forall
+// SMALL: linalg.matmul ins(%{{.+}}, %{{.+}} : tensor<32x64xf32>, tensor<64x128xf32>)
@@ -89,3 +89,26 @@ func.func @conv_2d_blocked(%arg0: tensor<1x2x113x113x32xf32>, %arg1: tensor<8x2x
 // CHECK: {{.+}} = tensor.insert_slice %[[MUL]]
 // CHECK-SAME:  into %{{.+}}[0, %[[ARG3]], %[[ARG5]], 0, 0] [1, 1, 1, 111, 32] [1, 1, 1, 1, 1]
 // CHECK-SAME:  : tensor<111x32xf32> into tensor<1x8x111x111x32xf32>
+
+// -----
+
+func.func @conv2d_nhwc_hwcf_dilated(%arg0: tensor<1x60x60x64xf32>, %arg1: tensor<3x3x64x256xf32>, %arg2: tensor<1x56x56x256xf32>) -> tensor<1x56x56x256xf32> {
+  %1 = linalg.conv_2d_nhwc_hwcf {dilations = dense<2> : tensor<2xi64>,
+                                 strides = dense<1> : tensor<2xi64>}
+    ins(%arg0, %arg1 : tensor<1x60x60x64xf32>, tensor<3x3x64x256xf32>)
+    outs(%arg2: tensor<1x56x56x256xf32>) -> tensor<1x56x56x256xf32>
+  return %1 : tensor<1x56x56x256xf32>
+}
+
+// CHECK-DAG: #[[MAP0:.+]] = affine_map<(d0, d1) -> (d0 + d1 * 2)>
+// CHECK-DAG: #[[MAP1:.+]] = affine_map<(d0) -> (d0 * 2)>
+// CHECK: func.func @conv2d_nhwc_hwcf_dilated
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<1x60x60x64xf32>,
+// CHECK: scf.for %[[P:.+]] =
+// CHECK: scf.for %[[R:.+]] =
+// CHECK: scf.for %[[S:.+]] =
+// CHECK-DAG: %[[H:.+]] = affine.apply #[[MAP0]](%[[P]], %[[R]])
+// CHECK-DAG: %[[W:.+]] = affine.apply #[[MAP1]](%[[S]])
+// CHECK: tensor.extract_slice %[[ARG0]][0, %[[H]], %[[W]], 0] [1, 1, 56, 64] [1, 1, 1, 1]
+// CHECK-SAME:  : tensor<1x60x60x64xf32> to tensor<56x64xf32>
+// CHECK: linalg.matmul
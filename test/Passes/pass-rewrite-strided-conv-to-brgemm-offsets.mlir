@@ -0,0 +1,50 @@
+// RUN: tpp-opt %s -rewrite-conv-to-matmul-or-brgemm="enable-brgemm=true brgemm-offsets=true" -canonicalize -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d0, d5, d2 * 2 + d6, d3 * 2 + d7, d8)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d1, d5, d6, d7, d8, d4)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d0, d1, d2, d3, d4)>
+
+func.func @conv_2d_blocked_strided(%arg0: tensor<1x2x9x9x32xf32>, %arg1: tensor<8x2x3x3x32x32xf32>,
+                                   %arg2: tensor<1x8x4x4x32xf32>) -> tensor<1x8x4x4x32xf32> {
+  %0 = linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "parallel", "parallel", "parallel",
+                      "reduction", "reduction", "reduction", "reduction"]}
+    ins(%arg0, %arg1 : tensor<1x2x9x9x32xf32>, tensor<8x2x3x3x32x32xf32>)
+    outs(%arg2 : tensor<1x8x4x4x32xf32>) {
+  ^bb0(%in: f32, %in_1: f32, %out: f32):
+    %1 = arith.mulf %in, %in_1 : f32
+    %2 = arith.addf %out, %1 : f32
+    linalg.yield %2 : f32
+  } -> tensor<1x8x4x4x32xf32>
+  return %0 : tensor<1x8x4x4x32xf32>
+}
+
+// The filter window joins C' in the reduction, only the output rows are
+// materialized as loops.
+// CHECK-DAG: #[[MAP:.+]] = affine_map<(d0) -> (d0 * 2)>
+// CHECK-DAG: #[[IMG_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d0 * 2 + d4, d5)>
+// CHECK-DAG: #[[FLT_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d2, d3, d4, d5, d1)>
+// CHECK-DAG: #[[OUT_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1)>
+// CHECK-LABEL: func.func @conv_2d_blocked_strided(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<1x2x9x9x32xf32>, %[[ARG1:.+]]: tensor<8x2x3x3x32x32xf32>,
+// CHECK-SAME:  %[[ARG2:.+]]: tensor<1x8x4x4x32xf32>
+// CHECK: scf.for %[[K:.+]] =
+// CHECK: scf.for %[[P:.+]] =
+// CHECK-SAME:  iter_args(%[[ACC:.+]] = %{{.+}})
+// CHECK-NOT: scf.for
+// CHECK: %[[H:.+]] = affine.apply #[[MAP]](%[[P]])
+// CHECK: %[[IMG:.+]] = tensor.extract_slice %[[ARG0]][0, 0, %[[H]], 0, 0] [1, 2, 3, 9, 32] [1, 1, 1, 1, 1]
+// CHECK-SAME:  : tensor<1x2x9x9x32xf32> to tensor<2x3x9x32xf32>
+// CHECK: %[[FLT:.+]] = tensor.extract_slice %[[ARG1]][%[[K]], 0, 0, 0, 0, 0] [1, 2, 3, 3, 32, 32] [1, 1, 1, 1, 1, 1]
+// CHECK-SAME:  : tensor<8x2x3x3x32x32xf32> to tensor<2x3x3x32x32xf32>
+// CHECK: %[[OUT:.+]] = tensor.extract_slice %[[ACC]][0, %[[K]], %[[P]], 0, 0] [1, 1, 1, 4, 32] [1, 1, 1, 1, 1]
+// CHECK-SAME:  : tensor<1x8x4x4x32xf32> to tensor<4x32xf32>
+// CHECK: %[[BRGEMM:.+]] = linalg.generic
+// CHECK-SAME:  indexing_maps = [#[[IMG_MAP]], #[[FLT_MAP]], #[[OUT_MAP]]]
+// CHECK-SAME:  iterator_types = ["parallel", "parallel", "reduction", "reduction", "reduction", "reduction"]
+// CHECK-SAME:  ins(%[[IMG]], %[[FLT]] : tensor<2x3x9x32xf32>, tensor<2x3x3x32x32xf32>)
+// CHECK-SAME:  outs(%[[OUT]] : tensor<4x32xf32>)
+// CHECK: arith.mulf
+// CHECK: arith.addf
+// CHECK: tensor.insert_slice %[[BRGEMM]] into %[[ACC]][0, %[[K]], %[[P]], 0, 0] [1, 1, 1, 4, 32] [1, 1, 1, 1, 1]
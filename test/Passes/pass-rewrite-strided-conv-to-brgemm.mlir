@@ -0,0 +1,112 @@
+// RUN: tpp-opt %s -rewrite-conv-to-matmul-or-brgemm="enable-brgemm=true" -canonicalize -split-input-file | FileCheck %s
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d0, d5, d2 * 2 + d6, d3 * 2 + d7, d8)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d1, d5, d6, d7, d8, d4)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d0, d1, d2, d3, d4)>
+
+func.func @conv_2d_blocked_strided(%arg0: tensor<1x2x9x9x32xf32>, %arg1: tensor<8x2x3x3x32x32xf32>,
+                                   %arg2: tensor<1x8x4x4x32xf32>) -> tensor<1x8x4x4x32xf32> {
+  %0 = linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "parallel", "parallel", "parallel",
+                      "reduction", "reduction", "reduction", "reduction"]}
+    ins(%arg0, %arg1 : tensor<1x2x9x9x32xf32>, tensor<8x2x3x3x32x32xf32>)
+    outs(%arg2 : tensor<1x8x4x4x32xf32>) {
+  ^bb0(%in: f32, %in_1: f32, %out: f32):
+    %1 = arith.mulf %in, %in_1 : f32
+    %2 = arith.addf %out, %1 : f32
+    linalg.yield %2 : f32
+  } -> tensor<1x8x4x4x32xf32>
+  return %0 : tensor<1x8x4x4x32xf32>
+}
+
+// The strided W becomes the leading dimension of the image and C' the
+// batch-reduce dimension.
+// CHECK-DAG: #[[MAP:.+]] = affine_map<(d0, d1) -> (d0 * 2 + d1)>
+// CHECK-LABEL: func.func @conv_2d_blocked_strided(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<1x2x9x9x32xf32>, %[[ARG1:.+]]: tensor<8x2x3x3x32x32xf32>,
+// CHECK-SAME:  %[[ARG2:.+]]: tensor<1x8x4x4x32xf32>
+// CHECK-DAG: %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG: %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG: %[[C3:.+]] = arith.constant 3 : index
+// CHECK-DAG: %[[C4:.+]] = arith.constant 4 : index
+// CHECK-DAG: %[[C8:.+]] = arith.constant 8 : index
+// CHECK: scf.for %[[K:.+]] = %[[C0]] to %[[C8]] step %[[C1]]
+// CHECK: scf.for %[[P:.+]] = %[[C0]] to %[[C4]] step %[[C1]]
+// CHECK: scf.for %[[R:.+]] = %[[C0]] to %[[C3]] step %[[C1]]
+// CHECK: scf.for %[[S:.+]] = %[[C0]] to %[[C3]] step %[[C1]]
+// CHECK-SAME:  iter_args(%[[ACC:.+]] = %{{.+}})
+// CHECK: %[[H:.+]] = affine.apply #[[MAP]](%[[P]], %[[R]])
+// CHECK: %[[IMG:.+]] = tensor.extract_slice %[[ARG0]][0, 0, %[[H]], %[[S]], 0] [1, 2, 1, 4, 32] [1, 1, 1, 2, 1]
+// CHECK-SAME:  : tensor<1x2x9x9x32xf32> to tensor<2x4x32xf32>
+// CHECK: %[[FLT:.+]] = tensor.extract_slice %[[ARG1]][%[[K]], 0, %[[R]], %[[S]], 0, 0] [1, 2, 1, 1, 32, 32] [1, 1, 1, 1, 1, 1]
+// CHECK-SAME:  : tensor<8x2x3x3x32x32xf32> to tensor<2x32x32xf32>
+// CHECK: %[[OUT:.+]] = tensor.extract_slice %[[ACC]][0, %[[K]], %[[P]], 0, 0] [1, 1, 1, 4, 32] [1, 1, 1, 1, 1]
+// CHECK-SAME:  : tensor<1x8x4x4x32xf32> to tensor<4x32xf32>
+// CHECK: %[[BRGEMM:.+]] = linalg.batch_reduce_matmul ins(%[[IMG]], %[[FLT]] : tensor<2x4x32xf32>, tensor<2x32x32xf32>)
+// CHECK-SAME:  outs(%[[OUT]] : tensor<4x32xf32>) -> tensor<4x32xf32>
+// CHECK: tensor.insert_slice %[[BRGEMM]] into %[[ACC]][0, %[[K]], %[[P]], 0, 0] [1, 1, 1, 4, 32] [1, 1, 1, 1, 1]
+
+// -----
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d0, d5, d2 + d6 * 2, d3 + d7 * 2, d8)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d1, d5, d6, d7, d8, d4)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d0, d1, d2, d3, d4)>
+
+func.func @conv_2d_blocked_dilated(%arg0: tensor<1x2x8x8x32xf32>, %arg1: tensor<8x2x3x3x32x32xf32>,
+                                   %arg2: tensor<1x8x4x4x32xf32>) -> tensor<1x8x4x4x32xf32> {
+  %0 = linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "parallel", "parallel", "parallel",
+                      "reduction", "reduction", "reduction", "reduction"]}
+    ins(%arg0, %arg1 : tensor<1x2x8x8x32xf32>, tensor<8x2x3x3x32x32xf32>)
+    outs(%arg2 : tensor<1x8x4x4x32xf32>) {
+  ^bb0(%in: f32, %in_1: f32, %out: f32):
+    %1 = arith.mulf %in, %in_1 : f32
+    %2 = arith.addf %out, %1 : f32
+    linalg.yield %2 : f32
+  } -> tensor<1x8x4x4x32xf32>
+  return %0 : tensor<1x8x4x4x32xf32>
+}
+
+// The dilation only moves the offsets of the image slice.
+// CHECK-DAG: #[[MAP0:.+]] = affine_map<(d0, d1) -> (d0 + d1 * 2)>
+// CHECK-DAG: #[[MAP1:.+]] = affine_map<(d0) -> (d0 * 2)>
+// CHECK-LABEL: func.func @conv_2d_blocked_dilated(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<1x2x8x8x32xf32>
+// CHECK: scf.for %[[K:.+]] =
+// CHECK: scf.for %[[P:.+]] =
+// CHECK: scf.for %[[R:.+]] =
+// CHECK: scf.for %[[S:.+]] =
+// CHECK-DAG: %[[H:.+]] = affine.apply #[[MAP0]](%[[P]], %[[R]])
+// CHECK-DAG: %[[W:.+]] = affine.apply #[[MAP1]](%[[S]])
+// CHECK: tensor.extract_slice %[[ARG0]][0, 0, %[[H]], %[[W]], 0] [1, 2, 1, 4, 32] [1, 1, 1, 1, 1]
+// CHECK-SAME:  : tensor<1x2x8x8x32xf32> to tensor<2x4x32xf32>
+// CHECK: linalg.batch_reduce_matmul
+
+// -----
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d0, d5, d2 + d6, d3 + d7, d8)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d1, d5, d6, d7, d8, d4)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5, d6, d7, d8) -> (d0, d1, d2, d3, d4)>
+
+func.func @conv_2d_blocked_1x1(%arg0: tensor<1x2x4x4x32xf32>, %arg1: tensor<8x2x1x1x32x32xf32>,
+                               %arg2: tensor<1x8x4x4x32xf32>) -> tensor<1x8x4x4x32xf32> {
+  %0 = linalg.generic {
+    indexing_maps = [#map, #map1, #map2],
+    iterator_types = ["parallel", "parallel", "parallel", "parallel", "parallel",
+                      "reduction", "reduction", "reduction", "reduction"]}
+    ins(%arg0, %arg1 : tensor<1x2x4x4x32xf32>, tensor<8x2x1x1x32x32xf32>)
+    outs(%arg2 : tensor<1x8x4x4x32xf32>) {
+  ^bb0(%in: f32, %in_1: f32, %out: f32):
+    %1 = arith.mulf %in, %in_1 : f32
+    %2 = arith.addf %out, %1 : f32
+    linalg.yield %2 : f32
+  } -> tensor<1x8x4x4x32xf32>
+  return %0 : tensor<1x8x4x4x32xf32>
+}
+
+// Unit strides with R = S = 1 are left to the collapsing patterns.
+// CHECK-LABEL: func.func @conv_2d_blocked_1x1(
+// CHECK-NOT: linalg.batch_reduce_matmul
+// CHECK: linalg.generic
@@ -0,0 +1,63 @@
+// RUN: tpp-opt %s -perf-timeline -split-input-file | FileCheck %s
+
+func.func @bench(%arg0: memref<32x32xf32>, %n: i64) -> f64 {
+  %stat = perf.bench (%n : i64) -> f64 {
+    perf.sink(%arg0) : memref<32x32xf32>
+    perf.yield
+  }
+  return %stat : f64
+}
+
+// CHECK-LABEL: func.func @bench(
+// CHECK:         perf.bench
+// CHECK-NEXT:      %[[begin:.+]] = perf.timeline_begin : i64
+// CHECK-NEXT:      perf.sink
+// CHECK-NEXT:      %[[arg:.+]] = arith.constant 0 : i64
+// CHECK-NEXT:      perf.timeline_end(%[[begin]], %[[arg]]) kind = 0
+// CHECK-NEXT:      perf.yield
+
+// -----
+
+func.func @parallel(%arg0: memref<8x4x32x32xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c2 = arith.constant 2 : index
+  %c4 = arith.constant 4 : index
+  %c8 = arith.constant 8 : index
+  %cst = arith.constant 0.0 : f32
+  scf.parallel (%i, %j) = (%c0, %c0) to (%c8, %c4) step (%c2, %c1) {
+    scf.parallel (%k) = (%c0) to (%c4) step (%c1) {
+      memref.store %cst, %arg0[%i, %j, %k, %k] : memref<8x4x32x32xf32>
+      scf.reduce
+    }
+    scf.reduce
+  }
+  return
+}
+
+// Only the outermost parallel loop is recorded, its iterations are numbered
+// in row-major order.
+// CHECK-LABEL: func.func @parallel(
+// CHECK-SAME:  %[[arg0:.+]]: memref<8x4x32x32xf32>
+// CHECK-DAG:     %[[c0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[c1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[c2:.+]] = arith.constant 2 : index
+// CHECK-DAG:     %[[c4:.+]] = arith.constant 4 : index
+// CHECK:         scf.parallel (%[[i:.+]], %[[j:.+]]) =
+// CHECK-NEXT:      %[[begin:.+]] = perf.timeline_begin : i64
+// CHECK-NOT:       perf.timeline_begin
+// CHECK:           scf.parallel
+// CHECK-NOT:         perf.timeline
+// CHECK:             memref.store
+// CHECK:           scf.reduce
+// CHECK:           %[[offI:.+]] = arith.subi %[[i]], %[[c0]] : index
+// CHECK:           %[[posI:.+]] = arith.divsi %[[offI]], %[[c2]] : index
+// CHECK:           %[[offJ:.+]] = arith.subi %[[j]], %[[c0]] : index
+// CHECK:           %[[posJ:.+]] = arith.divsi %[[offJ]], %[[c1]] : index
+// CHECK:           %[[spanJ:.+]] = arith.subi %[[c4]], %[[c0]] : index
+// CHECK:           %[[tripsJ:.+]] = arith.ceildivsi %[[spanJ]], %[[c1]] : index
+// CHECK:           %[[rowOff:.+]] = arith.muli %[[posI]], %[[tripsJ]] : index
+// CHECK:           %[[index:.+]] = arith.addi %[[rowOff]], %[[posJ]] : index
+// CHECK:           %[[arg:.+]] = arith.index_cast %[[index]] : index to i64
+// CHECK:           perf.timeline_end(%[[begin]], %[[arg]]) kind = 1
+// CHECK-NEXT:      scf.reduce
@@ -0,0 +1,117 @@
+// RUN: tpp-opt %s -shape-bucketing -split-input-file -verify-diagnostics | FileCheck %s
+
+func.func @matmul(%arg0: tensor<?x64xf32>, %arg1: tensor<64x64xf32>,
+                  %arg2: tensor<?x64xf32>) -> tensor<?x64xf32>
+    attributes {tpp.shape_buckets = array<i64: 32, 8>} {
+  %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x64xf32>, tensor<64x64xf32>)
+                     outs(%arg2 : tensor<?x64xf32>) -> tensor<?x64xf32>
+  return %0 : tensor<?x64xf32>
+}
+
+// The dispatcher picks the smallest bucket that fits, and falls back to the
+// dynamic kernel.
+// CHECK-LABEL: func.func @matmul(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<?x64xf32>, %[[ARG1:.+]]: tensor<64x64xf32>, %[[ARG2:.+]]: tensor<?x64xf32>)
+// CHECK-NOT: tpp.shape_buckets
+// CHECK: %[[C0:.+]] = arith.constant 0 : index
+// CHECK: %[[SIZE:.+]] = tensor.dim %[[ARG0]], %[[C0]]
+// CHECK: %[[C8:.+]] = arith.constant 8 : index
+// CHECK: %[[FITS:.+]] = arith.cmpi ule, %[[SIZE]], %[[C8]]
+// CHECK: %[[IF:.+]] = scf.if %[[FITS]] -> (tensor<?x64xf32>)
+// CHECK: %[[PAD0:.+]] = tensor.pad %[[ARG0]]
+// CHECK: } : tensor<?x64xf32> to tensor<8x64xf32>
+// CHECK: %[[PAD2:.+]] = tensor.pad %[[ARG2]]
+// CHECK: } : tensor<?x64xf32> to tensor<8x64xf32>
+// CHECK: %[[CALL:.+]] = call @matmul_b8(%[[PAD0]], %[[ARG1]], %[[PAD2]])
+// CHECK: %[[SLICE:.+]] = tensor.extract_slice %[[CALL]][0, 0] [%[[SIZE]], 64] [1, 1]
+// CHECK-SAME:  : tensor<8x64xf32> to tensor<?x64xf32>
+// CHECK: scf.yield %[[SLICE]]
+// CHECK: } else {
+// CHECK: arith.cmpi ule, %[[SIZE]], %{{.+}}
+// CHECK: scf.if
+// CHECK: call @matmul_b32(
+// CHECK: } else {
+// CHECK: call @matmul_dynamic(%[[ARG0]], %[[ARG1]], %[[ARG2]])
+// CHECK: return %[[IF]]
+
+// CHECK-LABEL: func.func @matmul_dynamic(
+// CHECK-SAME:  %{{.+}}: tensor<?x64xf32>, %{{.+}}: tensor<64x64xf32>, %{{.+}}: tensor<?x64xf32>)
+// CHECK: linalg.matmul
+
+// CHECK-LABEL: func.func @matmul_b32(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<32x64xf32>, %[[ARG1:.+]]: tensor<64x64xf32>, %[[ARG2:.+]]: tensor<32x64xf32>)
+// CHECK-SAME:  -> tensor<32x64xf32>
+// CHECK-NOT: tensor.cast
+// CHECK: %[[MUL:.+]] = linalg.matmul ins(%[[ARG0]], %[[ARG1]] : tensor<32x64xf32>, tensor<64x64xf32>)
+// CHECK-SAME:  outs(%[[ARG2]] : tensor<32x64xf32>)
+// CHECK: return %[[MUL]] : tensor<32x64xf32>
+
+// CHECK-LABEL: func.func @matmul_b8(
+// CHECK-SAME:  %{{.+}}: tensor<8x64xf32>, %{{.+}}: tensor<64x64xf32>, %{{.+}}: tensor<8x64xf32>)
+// CHECK-SAME:  -> tensor<8x64xf32>
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @relu(%arg0: tensor<?x16xf32>) -> tensor<?x16xf32>
+    attributes {tpp.shape_buckets} {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.0 : f32
+  %dim = tensor.dim %arg0, %c0 : tensor<?x16xf32>
+  %0 = tensor.empty(%dim) : tensor<?x16xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+    ins(%arg0 : tensor<?x16xf32>) outs(%0 : tensor<?x16xf32>) {
+      ^bb0(%in: f32, %out: f32):
+        %2 = arith.maximumf %in, %cst : f32
+        linalg.yield %2 : f32
+  } -> tensor<?x16xf32>
+  return %1 : tensor<?x16xf32>
+}
+
+// A unit attribute uses the default buckets.
+// CHECK-LABEL: func.func @relu(
+// CHECK: call @relu_b1(
+// CHECK: call @relu_b8(
+// CHECK: call @relu_b32(
+// CHECK: call @relu_b128(
+// CHECK: call @relu_b256(
+// CHECK: call @relu_dynamic(
+
+// The shapes inside the body are static as well.
+// CHECK-LABEL: func.func @relu_b256(
+// CHECK-SAME:  %{{.+}}: tensor<256x16xf32>) -> tensor<256x16xf32>
+// CHECK: tensor.empty() : tensor<256x16xf32>
+// CHECK: linalg.generic
+// CHECK-SAME:  outs(%{{.+}} : tensor<256x16xf32>)
+
+// -----
+
+// expected-error @below {{expect tensor arguments with a dynamic dimension and a single block body}}
+func.func @static(%arg0: tensor<8x16xf32>) -> tensor<8x16xf32>
+    attributes {tpp.shape_buckets} {
+  return %arg0 : tensor<8x16xf32>
+}
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+// expected-error @below {{expect all the dynamic dimensions to have the same size}}
+func.func @untied(%arg0: tensor<?x16xf32>, %arg1: tensor<?x16xf32>)
+    -> (tensor<?x16xf32>, tensor<?x16xf32>) attributes {tpp.shape_buckets} {
+  %cst = arith.constant 0.0 : f32
+  %0 = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]}
+    outs(%arg0 : tensor<?x16xf32>) {
+      ^bb0(%out: f32):
+        %2 = arith.maximumf %out, %cst : f32
+        linalg.yield %2 : f32
+  } -> tensor<?x16xf32>
+  %1 = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]}
+    outs(%arg1 : tensor<?x16xf32>) {
+      ^bb0(%out: f32):
+        %2 = arith.maximumf %out, %cst : f32
+        linalg.yield %2 : f32
+  } -> tensor<?x16xf32>
+  return %0, %1 : tensor<?x16xf32>, tensor<?x16xf32>
+}
@@ -0,0 +1,86 @@
+// RUN: tpp-opt %s -convert-scf-to-openmp -thread-local-scratch -split-input-file | FileCheck %s
+
+func.func @pack_tile_scratch(%arg0: memref<128x256xf32>, %arg1: memref<4x8x32x32xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %c8 = arith.constant 8 : index
+  %c32 = arith.constant 32 : index
+  scf.parallel (%i, %j) = (%c0, %c0) to (%c4, %c8) step (%c1, %c1) {
+    %0 = arith.muli %i, %c32 : index
+    %1 = arith.muli %j, %c32 : index
+    %tile = memref.alloc() {alignment = 64 : i64} : memref<32x32xf32>
+    %subview = memref.subview %arg0[%0, %1] [32, 32] [1, 1]
+      : memref<128x256xf32> to memref<32x32xf32, strided<[256, 1], offset: ?>>
+    memref.copy %subview, %tile
+      : memref<32x32xf32, strided<[256, 1], offset: ?>> to memref<32x32xf32>
+    %out = memref.subview %arg1[%i, %j, 0, 0] [1, 1, 32, 32] [1, 1, 1, 1]
+      : memref<4x8x32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+    memref.copy %tile, %out
+      : memref<32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+    memref.dealloc %tile : memref<32x32xf32>
+    scf.reduce
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @pack_tile_scratch
+// CHECK: omp.parallel {
+// CHECK-NEXT: %[[TILE:.+]] = memref.alloc() {alignment = 64 : i64} : memref<32x32xf32>
+// CHECK-NEXT: omp.wsloop {
+// CHECK: omp.loop_nest
+// CHECK-NOT: memref.alloc
+// CHECK-NOT: memref.dealloc
+// CHECK: memref.copy %{{.+}}, %[[TILE]]
+// CHECK: memref.copy %[[TILE]], %{{.+}}
+// CHECK-NOT: memref.dealloc
+// CHECK: omp.yield
+// CHECK: memref.dealloc %[[TILE]] : memref<32x32xf32>
+// CHECK-NEXT: omp.terminator
+
+// -----
+
+func.func @dynamic_scratch(%arg0: memref<?x32xf32>, %n: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  scf.parallel (%i) = (%c0) to (%c4) step (%c1) {
+    %tile = memref.alloc(%n) : memref<?x32xf32>
+    memref.copy %arg0, %tile : memref<?x32xf32> to memref<?x32xf32>
+    memref.dealloc %tile : memref<?x32xf32>
+    scf.reduce
+  }
+  return
+}
+
+// Dynamically shaped buffers are not hoisted.
+// CHECK-LABEL: func.func @dynamic_scratch
+// CHECK: omp.parallel {
+// CHECK-NEXT: omp.wsloop {
+// CHECK: omp.loop_nest
+// CHECK: memref.alloc
+// CHECK: memref.dealloc
+// CHECK: omp.yield
+
+// -----
+
+func.func @escaping_scratch(%arg0: memref<32x32xf32>, %arg1: memref<4xmemref<32x32xf32>>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  scf.parallel (%i) = (%c0) to (%c4) step (%c1) {
+    %tile = memref.alloc() : memref<32x32xf32>
+    memref.copy %arg0, %tile : memref<32x32xf32> to memref<32x32xf32>
+    memref.store %tile, %arg1[%i] : memref<4xmemref<32x32xf32>>
+    scf.reduce
+  }
+  return
+}
+
+// Buffers without a matching release in the loop body are not hoisted.
+// CHECK-LABEL: func.func @escaping_scratch
+// CHECK: omp.parallel {
+// CHECK-NEXT: omp.wsloop {
+// CHECK: omp.loop_nest
+// CHECK: memref.alloc
+// CHECK: omp.yield
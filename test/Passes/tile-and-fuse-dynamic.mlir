@@ -0,0 +1,62 @@
+// RUN: tpp-opt %s -tile-consumer-and-fuse-producers="use-for-all=false" -canonicalize -cse | FileCheck %s
+// RUN: tpp-opt %s -tile-consumer-and-fuse-producers -canonicalize -cse | FileCheck %s -check-prefix=FORALL
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @matmul_eletwise_dynamic_m(%arg0: tensor<?x64xf32>, %arg1: tensor<64x64xf32>,
+    %arg2: tensor<?x64xf32>) -> tensor<?x64xf32> {
+  %c0 = arith.constant 0.0 : f32
+  %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x64xf32>, tensor<64x64xf32>)
+    outs(%arg2 : tensor<?x64xf32>) -> tensor<?x64xf32>
+  %1 = linalg.generic {indexing_maps = [#map],
+                       iterator_types = ["parallel", "parallel"]}
+    outs(%0: tensor<?x64xf32>) {
+      ^bb0(%out: f32):
+        %2 = arith.maximumf %out, %c0 : f32
+        linalg.yield %2 : f32
+    } -> tensor<?x64xf32>
+  return %1 : tensor<?x64xf32>
+}
+
+// The dynamic m loop is peeled: full tiles of static shape, then a remainder.
+// CHECK-LABEL: func.func @matmul_eletwise_dynamic_m(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<?x64xf32>, %[[ARG1:.+]]: tensor<64x64xf32>, %[[ARG2:.+]]: tensor<?x64xf32>
+// CHECK-DAG: %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG: %[[C32:.+]] = arith.constant 32 : index
+// CHECK: %[[M:.+]] = tensor.dim %{{.+}}, %[[C0]]
+// CHECK: %[[UB:.+]] = affine.apply #{{.+}}()[%[[M]]]
+// CHECK: %[[MAIN:.+]] = scf.for %{{.+}} = %[[C0]] to %[[UB]] step %[[C32]]
+// CHECK-SAME:  iter_args(%{{.+}} = %[[ARG2]])
+// CHECK: scf.for
+// CHECK: linalg.matmul ins(%{{.+}}, %{{.+}} : tensor<32x64xf32>, tensor<64x32xf32>)
+// CHECK-SAME:  outs(%{{.+}} : tensor<32x32xf32>)
+// CHECK: linalg.generic
+// CHECK-SAME:  outs(%{{.+}} : tensor<32x32xf32>)
+// CHECK: %[[REM:.+]] = scf.for %{{.+}} = %[[UB]] to %[[M]] step %[[C32]]
+// CHECK-SAME:  iter_args(%{{.+}} = %[[MAIN]])
+// CHECK: scf.for
+// CHECK: linalg.matmul ins(%{{.+}}, %{{.+}} : tensor<?x64xf32>, tensor<64x32xf32>)
+// CHECK-SAME:  outs(%{{.+}} : tensor<?x32xf32>)
+// CHECK: linalg.generic
+// CHECK-SAME:  outs(%{{.+}} : tensor<?x32xf32>)
+// CHECK: return %[[REM]]
+
+// The full tiles become a parallel loop of static shape, the partial tile is
+// left to the remainder loop.
+// FORALL-LABEL: func.func @matmul_eletwise_dynamic_m(
+// FORALL-SAME:  %[[ARG0:.+]]: tensor<?x64xf32>, %[[ARG1:.+]]: tensor<64x64xf32>, %[[ARG2:.+]]: tensor<?x64xf32>
+// FORALL: %[[M:.+]] = tensor.dim %{{.+}}, %{{.+}}
+// FORALL: %[[UB:.+]] = affine.apply #{{.+}}()[%[[M]]]
+// FORALL: %[[MAIN:.+]] = scf.forall (%{{.+}}, %{{.+}}) = (0, 0) to (%[[UB]], 64) step (32, 32)
+// FORALL-SAME:  shared_outs(%{{.+}} = %[[ARG2]])
+// FORALL-NOT: affine.min
+// FORALL: linalg.matmul ins(%{{.+}}, %{{.+}} : tensor<32x64xf32>, tensor<64x32xf32>)
+// FORALL-SAME:  outs(%{{.+}} : tensor<32x32xf32>)
+// FORALL: linalg.generic
+// FORALL-SAME:  outs(%{{.+}} : tensor<32x32xf32>)
+// FORALL: scf.forall.in_parallel
+// FORALL: %[[REM:.+]] = scf.for %{{.+}} = %[[UB]] to %[[M]] step %{{.+}}
+// FORALL-SAME:  iter_args(%{{.+}} = %[[MAIN]])
+// FORALL: linalg.matmul ins(%{{.+}}, %{{.+}} : tensor<?x64xf32>, tensor<64x32xf32>)
+// FORALL-SAME:  outs(%{{.+}} : tensor<?x32xf32>)
+// FORALL: return %[[REM]]
@@ -0,0 +1,39 @@
+// RUN: tpp-opt %s -tile-consumer-and-fuse-producers="use-for-all=false fuse-packs=true" -cse | FileCheck %s
+// RUN: tpp-opt %s -tile-consumer-and-fuse-producers="use-for-all=false" -cse | FileCheck %s -check-prefix=NOFUSE
+
+#map = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d2, d3, d5)>
+#map1 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d1, d2, d5, d4)>
+#map2 = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d3, d4)>
+
+func.func @matmul_fuse_pack(%arg0: tensor<128x256xf32>, %arg1: tensor<16x8x32x32xf32>,
+                            %arg2: tensor<4x16x32x32xf32>) -> tensor<4x16x32x32xf32> {
+  %0 = tensor.empty() : tensor<4x8x32x32xf32>
+  %pack = tensor.pack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+    into %0 : tensor<128x256xf32> -> tensor<4x8x32x32xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map1, #map2], iterator_types = ["parallel", "parallel", "reduction", "parallel", "parallel", "reduction"]} ins(%pack, %arg1 : tensor<4x8x32x32xf32>, tensor<16x8x32x32xf32>) outs(%arg2 : tensor<4x16x32x32xf32>) {
+    ^bb0(%in: f32, %in_0: f32, %out: f32):
+      %2 = arith.mulf %in, %in_0 : f32
+      %3 = arith.addf %out, %2 : f32
+      linalg.yield %3 : f32
+  } -> tensor<4x16x32x32xf32>
+  return %1 : tensor<4x16x32x32xf32>
+}
+
+// CHECK-LABEL: func.func @matmul_fuse_pack(
+// CHECK-SAME:  %[[ARG0:.+]]: tensor<128x256xf32>
+// CHECK-NOT: tensor.pack
+// CHECK: scf.for %[[I:.+]] =
+// CHECK: scf.for %[[J:.+]] =
+// CHECK: %[[SLICE:.+]] = tensor.extract_slice %[[ARG0]]
+// CHECK: %[[PACK:.+]] = tensor.pack %[[SLICE]]
+// CHECK-SAME:  inner_dims_pos = [0, 1] inner_tiles = [32, 32]
+// CHECK: linalg.batch_reduce_matmul
+// CHECK-SAME:  ins(%{{.+}}, %{{.+}} :
+
+// NOFUSE-LABEL: func.func @matmul_fuse_pack(
+// NOFUSE: %[[PACK:.+]] = tensor.pack
+// NOFUSE-SAME:  into %{{.+}} : tensor<128x256xf32> -> tensor<4x8x32x32xf32>
+// NOFUSE: scf.for
+// NOFUSE: scf.for
+// NOFUSE-NOT: tensor.pack
+// NOFUSE: linalg.batch_reduce_matmul
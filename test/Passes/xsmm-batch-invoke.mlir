@@ -0,0 +1,150 @@
+// RUN: tpp-opt %s -xsmm-batch-invoke -split-input-file | FileCheck %s
+
+#map = affine_map<(d0) -> (d0 * 32)>
+
+func.func @gemm_tiles(%arg0: memref<256x32xf32>, %arg1: memref<32x1024xf32>,
+                      %arg2: memref<256x1024xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %c32 = arith.constant 32 : index
+  %0 = xsmm.gemm.dispatch [32, 32, 32, 32, 1024, 1024] flags = (none) data_type = f32
+  scf.parallel (%i) = (%c0) to (%c8) step (%c1) {
+    %row = affine.apply #map(%i)
+    %a = memref.subview %arg0[%row, 0] [32, 32] [1, 1]
+      : memref<256x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+    scf.for %j = %c0 to %c32 step %c1 {
+      %col = affine.apply #map(%j)
+      %b = memref.subview %arg1[0, %col] [32, 32] [1, 1]
+        : memref<32x1024xf32> to memref<32x32xf32, strided<[1024, 1], offset: ?>>
+      %c = memref.subview %arg2[%row, %col] [32, 32] [1, 1]
+        : memref<256x1024xf32> to memref<32x32xf32, strided<[1024, 1], offset: ?>>
+      xsmm.gemm(data_type = f32, %0, %a, %b, %c)
+        : (i64, memref<32x32xf32, strided<[32, 1], offset: ?>>,
+           memref<32x32xf32, strided<[1024, 1], offset: ?>>,
+           memref<32x32xf32, strided<[1024, 1], offset: ?>>) -> ()
+    }
+    scf.reduce
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @gemm_tiles(
+// CHECK-SAME:  %[[A:.+]]: memref<256x32xf32>, %[[B:.+]]: memref<32x1024xf32>, %[[C:.+]]: memref<256x1024xf32>
+// CHECK-DAG:     %[[c0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[c1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[c32:.+]] = arith.constant 32 : index
+// CHECK:         %[[kernel:.+]] = xsmm.gemm.dispatch
+// CHECK:         scf.parallel
+// CHECK:           %[[aTile:.+]] = memref.subview %[[A]]
+// CHECK-NOT:       scf.for
+// CHECK:           %[[col0:.+]] = affine.apply #{{.+}}(%[[c0]])
+// CHECK:           %[[b0:.+]] = memref.subview %[[B]][0, %[[col0]]]
+// CHECK:           %[[c0Tile:.+]] = memref.subview %[[C]][%{{.+}}, %[[col0]]]
+// CHECK:           %[[iv1:.+]] = arith.addi %[[c0]], %[[c1]] : index
+// CHECK:           %[[col1:.+]] = affine.apply #{{.+}}(%[[iv1]])
+// CHECK:           %[[b1:.+]] = memref.subview %[[B]][0, %[[col1]]]
+// CHECK:           %[[c1Tile:.+]] = memref.subview %[[C]][%{{.+}}, %[[col1]]]
+// CHECK:           %{{.+}}, %[[offA0:.+]], %{{.+}}:2, %{{.+}}:2 = memref.extract_strided_metadata %[[aTile]]
+// CHECK:           %{{.+}}, %[[offA1:.+]], %{{.+}}:2, %{{.+}}:2 = memref.extract_strided_metadata %[[aTile]]
+// CHECK:           %[[strideA:.+]] = arith.subi %[[offA1]], %[[offA0]] : index
+// CHECK:           %[[strideA64:.+]] = arith.index_cast %[[strideA]] : index to i64
+// CHECK:           %{{.+}}, %[[offB0:.+]], %{{.+}}:2, %{{.+}}:2 = memref.extract_strided_metadata %[[b0]]
+// CHECK:           %{{.+}}, %[[offB1:.+]], %{{.+}}:2, %{{.+}}:2 = memref.extract_strided_metadata %[[b1]]
+// CHECK:           %[[strideB:.+]] = arith.subi %[[offB1]], %[[offB0]] : index
+// CHECK:           %[[strideB64:.+]] = arith.index_cast %[[strideB]] : index to i64
+// CHECK:           %{{.+}}, %[[offC0:.+]], %{{.+}}:2, %{{.+}}:2 = memref.extract_strided_metadata %[[c0Tile]]
+// CHECK:           %{{.+}}, %[[offC1:.+]], %{{.+}}:2, %{{.+}}:2 = memref.extract_strided_metadata %[[c1Tile]]
+// CHECK:           %[[strideC:.+]] = arith.subi %[[offC1]], %[[offC0]] : index
+// CHECK:           %[[strideC64:.+]] = arith.index_cast %[[strideC]] : index to i64
+// CHECK:           %[[span:.+]] = arith.subi %[[c32]], %[[c0]] : index
+// CHECK:           %[[trips:.+]] = arith.ceildivsi %[[span]], %[[c1]] : index
+// CHECK:           %[[count:.+]] = arith.index_cast %[[trips]] : index to i64
+// CHECK:           xsmm.gemm_batch(data_type = f32, %[[kernel]], %[[aTile]], %[[b0]], %[[c0Tile]], %[[count]], %[[strideA64]], %[[strideB64]], %[[strideC64]])
+// CHECK:           scf.reduce
+
+// -----
+
+func.func @brgemm_tiles(%arg0: memref<4x32x32xbf16>, %arg1: memref<8x4x16x32x2xbf16>,
+                        %arg2: memref<32x256xbf16>, %ub: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c32 = arith.constant 32 : index
+  %c4 = arith.constant 4 : i64
+  %0 = xsmm.brgemm.dispatch [32, 32, 32, 32, 32, 256, 1024, 1024] flags = (vnni_b) data_type = bf16
+  scf.for %j = %c0 to %ub step %c1 {
+    %col = arith.muli %j, %c32 : index
+    %b = memref.subview %arg1[%j, 0, 0, 0, 0] [1, 4, 16, 32, 2] [1, 1, 1, 1, 1]
+      : memref<8x4x16x32x2xbf16> to memref<4x16x32x2xbf16, strided<[1024, 64, 2, 1], offset: ?>>
+    %c = memref.subview %arg2[0, %col] [32, 32] [1, 1]
+      : memref<32x256xbf16> to memref<32x32xbf16, strided<[256, 1], offset: ?>>
+    xsmm.brgemm(data_type = bf16, %0, %arg0, %b, %c, %c4)
+      : (i64, memref<4x32x32xbf16>, memref<4x16x32x2xbf16, strided<[1024, 64, 2, 1], offset: ?>>,
+         memref<32x32xbf16, strided<[256, 1], offset: ?>>, i64) -> ()
+  }
+  return
+}
+
+// Loop invariant operands get a zero stride and dynamic bounds are supported.
+// CHECK-LABEL: func.func @brgemm_tiles(
+// CHECK-SAME:  %[[A:.+]]: memref<4x32x32xbf16>, %{{.+}}: memref<8x4x16x32x2xbf16>, %{{.+}}: memref<32x256xbf16>, %[[ub:.+]]: index
+// CHECK-DAG:     %[[c4:.+]] = arith.constant 4 : i64
+// CHECK-NOT:     scf.for
+// CHECK:         memref.extract_strided_metadata %[[A]]
+// CHECK:         memref.extract_strided_metadata %[[A]]
+// CHECK:         arith.subi %[[ub]],
+// CHECK:         xsmm.gemm_batch(data_type = bf16, %{{.+}}, %[[A]], %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %{{.+}}, %[[c4]])
+
+// -----
+
+#map = affine_map<(d0) -> (d0 floordiv 2)>
+
+func.func @not_linear(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>,
+                      %arg2: memref<8x32x32xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %0 = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (none) data_type = f32
+  scf.for %j = %c0 to %c8 step %c1 {
+    %idx = affine.apply #map(%j)
+    %c = memref.subview %arg2[%idx, 0, 0] [1, 32, 32] [1, 1, 1]
+      : memref<8x32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+    xsmm.gemm(data_type = f32, %0, %arg0, %arg1, %c)
+      : (i64, memref<32x32xf32>, memref<32x32xf32>,
+         memref<32x32xf32, strided<[32, 1], offset: ?>>) -> ()
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @not_linear(
+// CHECK:         scf.for
+// CHECK:           xsmm.gemm(
+// CHECK-NOT:     xsmm.gemm_batch
+
+// -----
+
+func.func @other_effects(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>,
+                         %arg2: memref<8x32x32xf32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %0 = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (none) data_type = f32
+  %1 = xsmm.unary.dispatch relu [32, 32, 32, 32] flags = (none) data_type = f32
+  scf.for %j = %c0 to %c8 step %c1 {
+    %c = memref.subview %arg2[%j, 0, 0] [1, 32, 32] [1, 1, 1]
+      : memref<8x32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+    xsmm.gemm(data_type = f32, %0, %arg0, %arg1, %c)
+      : (i64, memref<32x32xf32>, memref<32x32xf32>,
+         memref<32x32xf32, strided<[32, 1], offset: ?>>) -> ()
+    xsmm.unary relu(data_type = f32, %1, %c, %c)
+      : (i64, memref<32x32xf32, strided<[32, 1], offset: ?>>,
+         memref<32x32xf32, strided<[32, 1], offset: ?>>) -> ()
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @other_effects(
+// CHECK:         scf.for
+// CHECK:           xsmm.gemm(
+// CHECK:           xsmm.unary relu
+// CHECK-NOT:     xsmm.gemm_batch
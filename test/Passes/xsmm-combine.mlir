@@ -306,3 +306,93 @@ func.func @forward(%arg0: memref<256x1024xf32>) -> memref<256x1024xf32> {
 // CHECK:    }
 // CHECK:    return %{{.*}} : memref<256x1024xf32>
 
+// -----
+
+memref.global "private" constant @__constant_4x32x32xf32 : memref<4x32x32xf32> = dense<1.000000e+00> {alignment = 128 : i64}
+memref.global "private" constant @__constant_8x32x32xf32 :  memref<8x32x32xf32> = dense<1.000000e+00> {alignment = 128 : i64}
+memref.global "private" constant @__constant_32xf32:  memref<32xf32, strided<[32], offset:?>> = dense<1.000000e+00> {alignment = 128 : i64}
+
+func.func @bcast_col_in0_on_binary_add_gelu(%arg0: memref<256x128xf32>) -> memref<256x512xf32>  {
+  %c0 = arith.constant 0 : index
+  %c8 = arith.constant 8 : index
+  %c4 = arith.constant 4 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %c4_i64 = arith.constant 4 : i64
+  %c8_i64 = arith.constant 8 : i64
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = memref.get_global @__constant_4x32x32xf32 : memref<4x32x32xf32>
+  %1 = memref.get_global @__constant_8x32x32xf32 : memref<8x32x32xf32>
+  %2 = memref.get_global @__constant_32xf32 : memref<32xf32, strided<[32], offset:?>>
+  %alloc = memref.alloc() {alignment = 64 : i64} : memref<8x4x32x32xf32>
+  %3 = xsmm.unary.dispatch identity [32, 32, 128, 32] flags = (none) data_type = f32
+  %alloc_0 = memref.alloc() {alignment = 64 : i64} : memref<8x8x32x32xf32>
+  %4 = xsmm.brgemm.dispatch [32, 32, 32, 32, 32, 32, 1024, 1024] flags = (beta_0) data_type = f32
+  %5 = xsmm.binary.dispatch add [32, 32, 32, 32, 32] flags = (bcast_col_in0) data_type = f32
+  %6 = xsmm.unary.dispatch gelu [32, 32, 32, 32] flags = (none) data_type = f32
+  %alloc_1 = memref.alloc() {alignment = 64 : i64} : memref<256x512xf32>
+  scf.parallel (%arg3, %arg2) = (%c0, %c0) to (%c8, %c8) step (%c1, %c1) {
+	  %subview = memref.subview %alloc_0[%arg3, %arg2, 0, 0] [1, 1, 32, 32] [1, 1, 1, 1] : memref<8x8x32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+	  %subview_2 = memref.subview %alloc[%arg3, 0, 0, 0] [1, 4, 32, 32] [1, 1, 1, 1] : memref<8x4x32x32xf32> to memref<4x32x32xf32, strided<[1024, 32, 1], offset: ?>>
+	  xsmm.brgemm(data_type = f32, %4, %subview_2, %0, %subview, %c4_i64) : (i64, memref<4x32x32xf32, strided<[1024, 32, 1], offset: ?>>, memref<4x32x32xf32>, memref<32x32xf32, strided<[32, 1], offset: ?>>, i64) -> ()
+	  xsmm.binary add(data_type = f32, %5, %2, %subview, %subview) : (i64, memref<32xf32, strided<[32], offset:?>>, memref<32x32xf32, strided<[32,1], offset: ?>>, memref<32x32xf32, strided<[32, 1], offset: ?>>) -> ()
+	  xsmm.unary gelu(data_type = f32, %6, %subview, %subview) : (i64, memref<32x32xf32, strided<[32, 1], offset: ?>>, memref<32x32xf32, strided<[32, 1], offset: ?>>) -> ()
+	  scf.reduce
+  }
+  return %alloc_1 : memref<256x512xf32>
+ }
+
+// Gelu is not applied by the fused kernel, it stays after the fused brgemm.
+// CHECK-LABEL: func.func @bcast_col_in0_on_binary_add_gelu(
+// CHECK: %[[ARG0:.*]]: memref<256x128xf32>) -> memref<256x512xf32> {
+// CHECK: %[[BIAS:.*]] = memref.get_global @__constant_32xf32 : memref<32xf32, strided<[32], offset: ?>>
+// CHECK-NOT: xsmm.brgemm.dispatch
+// CHECK-NOT: xsmm.binary.dispatch
+// CHECK: %[[GELU:.*]] = xsmm.unary.dispatch gelu [32, 32, 32, 32] flags = (none) data_type = f32
+// CHECK: %[[DISPATCH:.*]] = xsmm.fused_brgemm.dispatch [32, 32, 32, 32, 32, 32, 1024, 1024][add,none]  flags = (beta_0)  binary_flags = (bcast_col_in0)  unary_flags = (none) data_type = f32
+// CHECK-NOT: xsmm.brgemm(
+// CHECK-NOT: xsmm.binary add
+// CHECK: xsmm.fused_brgemm(data_type = f32, %[[DISPATCH]], %{{.*}}, %{{.*}}, %[[OUT:[^,]+]], %[[BIAS]], %{{.*}})
+// CHECK-NEXT: xsmm.unary gelu(data_type = f32, %[[GELU]], %[[OUT]], %[[OUT]])
+
+// -----
+
+memref.global "private" constant @__constant_4x32x32xf32 : memref<4x32x32xf32> = dense<1.000000e+00> {alignment = 128 : i64}
+memref.global "private" constant @__constant_8x32x32xf32 :  memref<8x32x32xf32> = dense<1.000000e+00> {alignment = 128 : i64}
+memref.global "private" constant @__constant_32xf32:  memref<32xf32, strided<[32], offset:?>> = dense<1.000000e+00> {alignment = 128 : i64}
+
+func.func @bcast_col_in0_on_binary_add_sigmoid(%arg0: memref<256x128xf32>) -> memref<256x512xf32>  {
+  %c0 = arith.constant 0 : index
+  %c8 = arith.constant 8 : index
+  %c4 = arith.constant 4 : index
+  %c1 = arith.constant 1 : index
+  %c16 = arith.constant 16 : index
+  %c4_i64 = arith.constant 4 : i64
+  %c8_i64 = arith.constant 8 : i64
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = memref.get_global @__constant_4x32x32xf32 : memref<4x32x32xf32>
+  %1 = memref.get_global @__constant_8x32x32xf32 : memref<8x32x32xf32>
+  %2 = memref.get_global @__constant_32xf32 : memref<32xf32, strided<[32], offset:?>>
+  %alloc = memref.alloc() {alignment = 64 : i64} : memref<8x4x32x32xf32>
+  %3 = xsmm.unary.dispatch identity [32, 32, 128, 32] flags = (none) data_type = f32
+  %alloc_0 = memref.alloc() {alignment = 64 : i64} : memref<8x8x32x32xf32>
+  %4 = xsmm.brgemm.dispatch [32, 32, 32, 32, 32, 32, 1024, 1024] flags = (beta_0) data_type = f32
+  %5 = xsmm.binary.dispatch add [32, 32, 32, 32, 32] flags = (bcast_col_in0) data_type = f32
+  %6 = xsmm.unary.dispatch sigmoid [32, 32, 32, 32] flags = (none) data_type = f32
+  %alloc_1 = memref.alloc() {alignment = 64 : i64} : memref<256x512xf32>
+  scf.parallel (%arg3, %arg2) = (%c0, %c0) to (%c8, %c8) step (%c1, %c1) {
+	  %subview = memref.subview %alloc_0[%arg3, %arg2, 0, 0] [1, 1, 32, 32] [1, 1, 1, 1] : memref<8x8x32x32xf32> to memref<32x32xf32, strided<[32, 1], offset: ?>>
+	  %subview_2 = memref.subview %alloc[%arg3, 0, 0, 0] [1, 4, 32, 32] [1, 1, 1, 1] : memref<8x4x32x32xf32> to memref<4x32x32xf32, strided<[1024, 32, 1], offset: ?>>
+	  xsmm.brgemm(data_type = f32, %4, %subview_2, %0, %subview, %c4_i64) : (i64, memref<4x32x32xf32, strided<[1024, 32, 1], offset: ?>>, memref<4x32x32xf32>, memref<32x32xf32, strided<[32, 1], offset: ?>>, i64) -> ()
+	  xsmm.binary add(data_type = f32, %5, %2, %subview, %subview) : (i64, memref<32xf32, strided<[32], offset:?>>, memref<32x32xf32, strided<[32,1], offset: ?>>, memref<32x32xf32, strided<[32, 1], offset: ?>>) -> ()
+	  xsmm.unary sigmoid(data_type = f32, %6, %subview, %subview) : (i64, memref<32x32xf32, strided<[32, 1], offset: ?>>, memref<32x32xf32, strided<[32, 1], offset: ?>>) -> ()
+	  scf.reduce
+  }
+  return %alloc_1 : memref<256x512xf32>
+ }
+
+// CHECK-LABEL: func.func @bcast_col_in0_on_binary_add_sigmoid(
+// CHECK-NOT: xsmm.unary.dispatch
+// CHECK: %[[DISPATCH:.*]] = xsmm.fused_brgemm.dispatch [32, 32, 32, 32, 32, 32, 1024, 1024][add,sigmoid]  flags = (beta_0)  binary_flags = (bcast_col_in0)  unary_flags = (none) data_type = f32
+// CHECK-NOT: xsmm.unary sigmoid
+// CHECK: xsmm.fused_brgemm(data_type = f32, %[[DISPATCH]],
@@ -0,0 +1,82 @@
+// RUN: tpp-opt %s -xsmm-global-dispatch -split-input-file | FileCheck %s
+// RUN: tpp-opt %s -xsmm-global-dispatch -split-input-file -mlir-pass-statistics 2>&1 | FileCheck %s --check-prefix=STATS
+
+func.func @layer0(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>, %arg2: memref<32x32xf32>) {
+  %0 = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (none) data_type = f32
+  xsmm.gemm(data_type = f32, %0, %arg0, %arg1, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  %1 = xsmm.unary.dispatch relu [32, 32, 32, 32] flags = (none) data_type = f32
+  xsmm.unary relu(data_type = f32, %1, %arg2, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  return
+}
+
+func.func @layer1(%arg0: memref<32x32xf32>, %arg1: memref<32x32xf32>, %arg2: memref<32x32xf32>) {
+  %c0 = arith.constant 0 : index
+  %c4 = arith.constant 4 : index
+  %c1 = arith.constant 1 : index
+  scf.for %i = %c0 to %c4 step %c1 {
+    %0 = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (none) data_type = f32
+    xsmm.gemm(data_type = f32, %0, %arg0, %arg1, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  }
+  %1 = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (beta_0) data_type = f32
+  xsmm.gemm(data_type = f32, %1, %arg0, %arg1, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  %2 = xsmm.unary.dispatch relu [32, 32, 32, 32] flags = (none) data_type = f32
+  xsmm.unary relu(data_type = f32, %2, %arg2, %arg2) : (i64, memref<32x32xf32>, memref<32x32xf32>) -> ()
+  return
+}
+
+// Handles are loaded once at the entry of each function.
+// CHECK-LABEL: func.func @layer0(
+// CHECK-SAME:  %[[A:.+]]: memref<32x32xf32>, %[[B:.+]]: memref<32x32xf32>, %[[C:.+]]: memref<32x32xf32>
+// CHECK:         %[[reluPtr:.+]] = llvm.mlir.addressof @__xsmm_kernel_1 : !llvm.ptr
+// CHECK:         %[[relu:.+]] = llvm.load %[[reluPtr]] : !llvm.ptr -> i64
+// CHECK:         %[[gemmPtr:.+]] = llvm.mlir.addressof @__xsmm_kernel_0 : !llvm.ptr
+// CHECK:         %[[gemm:.+]] = llvm.load %[[gemmPtr]] : !llvm.ptr -> i64
+// CHECK-NOT:     xsmm.gemm.dispatch
+// CHECK:         xsmm.gemm(data_type = f32, %[[gemm]], %[[A]], %[[B]], %[[C]])
+// CHECK-NOT:     xsmm.unary.dispatch
+// CHECK:         xsmm.unary relu(data_type = f32, %[[relu]], %[[C]], %[[C]])
+
+// CHECK-LABEL: func.func @layer1(
+// CHECK:         %[[gemmBeta0Ptr:.+]] = llvm.mlir.addressof @__xsmm_kernel_2 : !llvm.ptr
+// CHECK:         %[[gemmBeta0:.+]] = llvm.load %[[gemmBeta0Ptr]] : !llvm.ptr -> i64
+// CHECK:         %[[reluPtr:.+]] = llvm.mlir.addressof @__xsmm_kernel_1 : !llvm.ptr
+// CHECK:         %[[relu:.+]] = llvm.load %[[reluPtr]] : !llvm.ptr -> i64
+// CHECK:         %[[gemmPtr:.+]] = llvm.mlir.addressof @__xsmm_kernel_0 : !llvm.ptr
+// CHECK:         %[[gemm:.+]] = llvm.load %[[gemmPtr]] : !llvm.ptr -> i64
+// CHECK:         scf.for
+// CHECK-NOT:       xsmm.gemm.dispatch
+// CHECK:           xsmm.gemm(data_type = f32, %[[gemm]],
+// CHECK:         }
+// CHECK:         xsmm.gemm(data_type = f32, %[[gemmBeta0]],
+// CHECK:         xsmm.unary relu(data_type = f32, %[[relu]],
+
+// CHECK-DAG:   llvm.mlir.global internal @__xsmm_kernel_0(0 : i64) {addr_space = 0 : i32} : i64
+// CHECK-DAG:   llvm.mlir.global internal @__xsmm_kernel_1(0 : i64) {addr_space = 0 : i32} : i64
+// CHECK-DAG:   llvm.mlir.global internal @__xsmm_kernel_2(0 : i64) {addr_space = 0 : i32} : i64
+// CHECK-LABEL: llvm.func internal @__xsmm_dispatch_kernels()
+// CHECK:         %[[k0:.+]] = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (none) data_type = f32
+// CHECK:         %[[p0:.+]] = llvm.mlir.addressof @__xsmm_kernel_0
+// CHECK:         llvm.store %[[k0]], %[[p0]] : i64, !llvm.ptr
+// CHECK:         %[[k1:.+]] = xsmm.unary.dispatch relu [32, 32, 32, 32] flags = (none) data_type = f32
+// CHECK:         %[[p1:.+]] = llvm.mlir.addressof @__xsmm_kernel_1
+// CHECK:         llvm.store %[[k1]], %[[p1]] : i64, !llvm.ptr
+// CHECK:         %[[k2:.+]] = xsmm.gemm.dispatch [32, 32, 32, 32, 32, 32] flags = (beta_0) data_type = f32
+// CHECK:         %[[p2:.+]] = llvm.mlir.addressof @__xsmm_kernel_2
+// CHECK:         llvm.store %[[k2]], %[[p2]] : i64, !llvm.ptr
+// CHECK:         llvm.return
+// CHECK:       llvm.mlir.global_ctors {ctors = [@__xsmm_dispatch_kernels], priorities = [65535 : i32]}
+
+// STATS-DAG: 3 num-kernels
+// STATS-DAG: 5 num-dispatches
+
+// -----
+
+func.func @dynamic_m(%m: i64) -> i64 {
+  %0 = xsmm.gemm.dispatch [0, 4, 4, 4, 4, 4] dynamic_m = %m flags = (none) data_type = f32
+  return %0 : i64
+}
+
+// Kernels selected at runtime are left untouched.
+// CHECK-LABEL: func.func @dynamic_m(
+// CHECK:         xsmm.gemm.dispatch [0, 4, 4, 4, 4, 4] dynamic_m =
+// CHECK-NOT:   llvm.mlir.global_ctors
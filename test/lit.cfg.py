@@ -37,7 +37,7 @@ llvm_config.use_default_substitutions()
 # excludes: A list of directories to exclude from the testsuite. The 'Inputs'
 # subdirectories contain auxiliary inputs for various tests in their parent
 # directories.
-config.excludes = []
+config.excludes = ["Inputs"]
 
 # test_exec_root: The root path where tests should be run.
 config.test_exec_root = os.path.join(config.tpp_obj_root, "test")
@@ -47,6 +47,6 @@ config.tpp_tools_dir = os.path.join(config.tpp_obj_root, "bin")
 llvm_config.with_environment("PATH", config.llvm_tools_dir, append_path=True)
 
 tool_dirs = [config.tpp_tools_dir, config.llvm_tools_dir]
-tools = ["mlir-gen", "tpp-opt", "tpp-run"]
+tools = ["mlir-gen", "tpp-opt", "tpp-run", "tpp-prepack"]
 
 llvm_config.add_tool_substitutions(tools, tool_dirs)
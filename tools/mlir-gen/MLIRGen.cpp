@@ -17,8 +17,10 @@
 #include "mlir/IR/BuiltinDialect.h"
 
 #include "MLIRGen.h"
+#include "TPP/Transforms/Utils/TransformUtils.h"
 #include "llvm/Support/ErrorHandling.h"
 
+#include <cmath>
 #include <optional>
 
 using namespace mlir;
@@ -41,14 +43,20 @@ void parseStringList(StringRef str, SmallVector<int64_t> &list) {
 
 } // anonymous namespace
 
-MLIRGenerator::MLIRGenerator(StringRef kernelStr, unsigned batch,
-                             StringRef layersStr, StringRef tilesStr,
-                             StringRef targetType, int seed, bool enableBias,
-                             bool enableRelu, bool enableSoftmax,
-                             int vnniBlockingFactor)
+MLIRGenerator::MLIRGenerator(StringRef modelStr, StringRef kernelStr,
+                             unsigned batch, StringRef layersStr,
+                             StringRef tilesStr, StringRef targetType, int seed,
+                             bool enableBias, bool enableRelu, bool enableGelu,
+                             bool enableSilu, bool enableTanh,
+                             bool enableSoftmax, int vnniBlockingFactor,
+                             bool prepackedWeights, unsigned seqLen,
+                             unsigned numHeads, unsigned hiddenSize)
     : builder(&context), loc(builder.getUnknownLoc()), batch(batch), seed(seed),
       flops(0), enableBias(enableBias), enableRelu(enableRelu),
-      enableSoftmax(enableSoftmax), vnniFactor(vnniBlockingFactor) {
+      enableGelu(enableGelu), enableSilu(enableSilu), enableTanh(enableTanh),
+      enableSoftmax(enableSoftmax), seqLen(seqLen), numHeads(numHeads),
+      hiddenSize(hiddenSize), vnniFactor(vnniBlockingFactor),
+      prepackedWeights(prepackedWeights) {
 
   // Register all necessary dialects
   context
@@ -65,8 +73,19 @@ MLIRGenerator::MLIRGenerator(StringRef kernelStr, unsigned batch,
   assert(optKernel && "Invalid kernel type");
   kernelType = *optKernel;
 
+  // Parse model type
+  auto optModel = llvm::StringSwitch<std::optional<ModelType>>(modelStr)
+                      .CaseLower("mlp", ModelType::MLP)
+                      .CaseLower("mha", ModelType::MHA)
+                      .CaseLower("transformer", ModelType::Transformer)
+                      .Default(std::nullopt);
+  assert(optModel && "Invalid model type");
+  modelType = *optModel;
+
   // Argument validation
   assert(batch != 0 && "Batch cannot be zero");
+  assert((enableRelu + enableGelu + enableSilu + enableTanh) <= 1 &&
+         "Only one activation per layer");
 
   // Parse hidden layer sizes
   parseStringList(layersStr, layers);
@@ -77,6 +96,13 @@ MLIRGenerator::MLIRGenerator(StringRef kernelStr, unsigned batch,
   assert((tiles.size() == 0 || tiles.size() == 3) &&
          "Must have 3 tile sizes (or none)");
 
+  // Attention models work on [batch, seq-len, hidden-size] activations and
+  // ignore the layer sizes. The transformer MLP defaults to GELU. Their
+  // arguments are checked by generate().
+  if (modelType == ModelType::Transformer &&
+      !(enableRelu || enableGelu || enableSilu || enableTanh))
+    this->enableGelu = true;
+
   // Pick data type
   auto elementType = llvm::StringSwitch<std::optional<Type>>(targetType)
                          .CaseLower("f32", builder.getF32Type())
@@ -144,6 +170,9 @@ Value MLIRGenerator::createLayer(LayerArgs &args) {
   // These are optional and only emitted if enabled
   chain = lowerBiasAdd(chain, args.bias.value, args.output.value);
   chain = lowerRelu(chain, args.output.value);
+  chain = lowerGelu(chain, args.output.value);
+  chain = lowerSilu(chain, args.output.value);
+  chain = lowerTanh(chain, args.output.value);
 
   // Last layer may output softmax
   if (args.index == layers.size() - 1)
@@ -201,6 +230,10 @@ void MLIRGenerator::createKernel() {
 
     // Initialize weights and biases
     if (kernelType == KernelType::Args) {
+      if (prepackedWeights) {
+        func.setArgAttr(argPos, linalgx::utils::kPrepacked,
+                        builder.getUnitAttr());
+      }
       arg.weight.value = func.getArgument(argPos++);
       if (enableBias)
         arg.bias.value = func.getArgument(argPos++);
@@ -222,9 +255,127 @@ void MLIRGenerator::createKernel() {
   builder.create<func::ReturnOp>(loc, lastArg.output.value);
 }
 
+SmallVector<TensorType> MLIRGenerator::getAttentionWeightTypes() {
+  int64_t hidden = hiddenSize;
+  auto weightType = RankedTensorType::get({hidden, hidden}, dataType);
+  auto vectorType = RankedTensorType::get({hidden}, dataType);
+
+  // Q, K, V and output projections: weight + optional bias
+  SmallVector<TensorType> types;
+  for (int i = 0; i < 4; i++) {
+    types.push_back(weightType);
+    if (enableBias)
+      types.push_back(vectorType);
+  }
+  if (modelType == ModelType::MHA)
+    return types;
+
+  // LayerNorm, MLP (hidden -> 4 * hidden -> hidden), LayerNorm
+  int64_t ffn = 4 * hidden;
+  types.append({vectorType, vectorType});
+  types.push_back(RankedTensorType::get({hidden, ffn}, dataType));
+  if (enableBias)
+    types.push_back(RankedTensorType::get({ffn}, dataType));
+  types.push_back(RankedTensorType::get({ffn, hidden}, dataType));
+  if (enableBias)
+    types.push_back(vectorType);
+  types.append({vectorType, vectorType});
+  return types;
+}
+
+void MLIRGenerator::createAttentionKernel() {
+  assert(((kernelType == KernelType::Const) ||
+          (kernelType == KernelType::Args)) &&
+         "Invalid kernel type");
+  OpBuilder::InsertionGuard guard(builder);
+
+  // Activations are [B, S, E], computed as tokens [B * S, E]
+  int64_t tokens = batch * seqLen;
+  int64_t hidden = hiddenSize;
+  auto ioType = RankedTensorType::get({batch, seqLen, hidden}, dataType);
+  auto tokenType = RankedTensorType::get({tokens, hidden}, dataType);
+  SmallVector<TensorType> weightTypes = getAttentionWeightTypes();
+
+  // Args kernels take the weights as arguments, const kernels create them
+  SmallVector<Type> inputTypes{ioType};
+  if (kernelType == KernelType::Args)
+    inputTypes.append(weightTypes.begin(), weightTypes.end());
+  auto func = createFunction(builder, module, "entry", inputTypes, {ioType});
+
+  SmallVector<Value> weights;
+  for (auto [idx, type] : llvm::enumerate(weightTypes)) {
+    if (kernelType == KernelType::Args)
+      weights.push_back(func.getArgument(idx + 1));
+    else
+      weights.push_back(createDenseTensor(builder, initType, type, getRand()));
+  }
+  // Weights are consumed in the same order as getAttentionWeightTypes
+  unsigned weightPos = 0;
+  auto nextWeight = [&]() { return weights[weightPos++]; };
+  auto nextBias = [&]() { return enableBias ? nextWeight() : Value(); };
+
+  Value input = linalgx::utils::collapse(builder, loc, func.getArgument(0),
+                                         tokenType, {{0, 1}, {2}});
+
+  // Multi-head attention
+  Value wq = nextWeight(), bq = nextBias();
+  Value query = lowerProjection(input, wq, bq);
+  Value wk = nextWeight(), bk = nextBias();
+  Value key = lowerProjection(input, wk, bk);
+  Value wv = nextWeight(), bv = nextBias();
+  Value value = lowerProjection(input, wv, bv);
+  Value chain = lowerAttention(query, key, value);
+  Value wo = nextWeight(), bo = nextBias();
+  chain = lowerProjection(chain, wo, bo);
+
+  // Post-LN encoder block: h = LN(x + MHA(x)), y = LN(h + MLP(h))
+  if (modelType == ModelType::Transformer) {
+    chain = lowerResidualAdd(chain, input);
+    Value gamma1 = nextWeight(), beta1 = nextWeight();
+    Value attnOut = lowerLayerNorm(chain, gamma1, beta1);
+
+    Value w1 = nextWeight(), b1 = nextBias();
+    chain = lowerProjection(attnOut, w1, b1);
+    chain = lowerRelu(chain, chain);
+    chain = lowerGelu(chain, chain);
+    chain = lowerSilu(chain, chain);
+    chain = lowerTanh(chain, chain);
+    Value w2 = nextWeight(), b2 = nextBias();
+    chain = lowerProjection(chain, w2, b2);
+
+    chain = lowerResidualAdd(chain, attnOut);
+    Value gamma2 = nextWeight(), beta2 = nextWeight();
+    chain = lowerLayerNorm(chain, gamma2, beta2);
+  }
+  assert(weightPos == weights.size() && "Unused weights");
+
+  Value output =
+      linalgx::utils::expand(builder, loc, chain, ioType, {{0, 1}, {2}});
+  builder.create<func::ReturnOp>(loc, output);
+}
+
+LogicalResult MLIRGenerator::verifyAttentionArgs() {
+  if (!tiles.empty())
+    return module.emitError("Packed attention models not implemented yet");
+  if (prepackedWeights)
+    return module.emitError("Attention models have no packed weights");
+  if (seqLen == 0)
+    return module.emitError("Sequence length cannot be zero");
+  if (numHeads == 0 || hiddenSize % numHeads != 0)
+    return module.emitError(
+        "Hidden size must be a multiple of the number of heads");
+  return success();
+}
+
 int MLIRGenerator::generate(StringRef filename) {
   // First, populate the module with all functions
-  createKernel();
+  if (modelType == ModelType::MLP) {
+    createKernel();
+  } else {
+    if (failed(verifyAttentionArgs()))
+      return 1;
+    createAttentionKernel();
+  }
 
   // Verify
   if (failed(module.verify())) {
@@ -364,6 +515,105 @@ Value MLIRGenerator::lowerRelu(Value input, Value output) {
   return relu;
 }
 
+Value MLIRGenerator::lowerGelu(Value input, Value output) {
+  if (!enableGelu)
+    return input;
+
+  // GELU(x) = 0.5 * x * (1 + erf(x / sqrt(2)))
+  auto floatType = cast<FloatType>(dataType);
+  auto half = getConstFloat(builder, 0.5, floatType);
+  auto one = getConstFloat(builder, 1.0, floatType);
+  auto rsqrt2 = getConstFloat(builder, 0.70710678, floatType);
+  auto outTy = cast<ShapedType>(input.getType());
+  auto map = getMap(input, MAP_PARALLEL);
+  auto gelu =
+      builder
+          .create<linalg::GenericOp>(
+              loc, outTy, ValueRange{}, ValueRange{input},
+              ArrayRef<AffineMap>{map}, getIterators(MAP_PARALLEL),
+              [&](OpBuilder &nestedBuilder, Location nestedLoc,
+                  ValueRange blockArgs) {
+                auto arg0 = blockArgs[0];
+                auto scaled =
+                    nestedBuilder.create<arith::MulFOp>(loc, arg0, rsqrt2);
+                auto erf = nestedBuilder.create<math::ErfOp>(loc, scaled);
+                auto add = nestedBuilder.create<arith::AddFOp>(loc, erf, one);
+                auto mul = nestedBuilder.create<arith::MulFOp>(loc, arg0, add);
+                auto res = nestedBuilder.create<arith::MulFOp>(loc, mul, half);
+                nestedBuilder.create<linalg::YieldOp>(loc, ValueRange{res});
+              })
+          .getResult(0);
+
+  // GELU flops = 5 * M * N = 5 * prod(outputDims), counting erf as one
+  int64_t geluFlops = 1;
+  for (int i = 0, max = outTy.getRank(); i < max; i++)
+    geluFlops *= outTy.getDimSize(i);
+  flops += 5 * geluFlops;
+
+  return gelu;
+}
+
+Value MLIRGenerator::lowerSilu(Value input, Value output) {
+  if (!enableSilu)
+    return input;
+
+  // SiLU(x) = x * sigmoid(x) = x / (1 + exp(-x))
+  auto one = getConstFloat(builder, 1.0, cast<FloatType>(dataType));
+  auto outTy = cast<ShapedType>(input.getType());
+  auto map = getMap(input, MAP_PARALLEL);
+  auto silu =
+      builder
+          .create<linalg::GenericOp>(
+              loc, outTy, ValueRange{}, ValueRange{input},
+              ArrayRef<AffineMap>{map}, getIterators(MAP_PARALLEL),
+              [&](OpBuilder &nestedBuilder, Location nestedLoc,
+                  ValueRange blockArgs) {
+                auto arg0 = blockArgs[0];
+                auto neg = nestedBuilder.create<arith::NegFOp>(loc, arg0);
+                auto exp = nestedBuilder.create<math::ExpOp>(loc, neg);
+                auto add = nestedBuilder.create<arith::AddFOp>(loc, exp, one);
+                auto div = nestedBuilder.create<arith::DivFOp>(loc, arg0, add);
+                nestedBuilder.create<linalg::YieldOp>(loc, ValueRange{div});
+              })
+          .getResult(0);
+
+  // SiLU flops = 4 * M * N = 4 * prod(outputDims), counting exp as one
+  int64_t siluFlops = 1;
+  for (int i = 0, max = outTy.getRank(); i < max; i++)
+    siluFlops *= outTy.getDimSize(i);
+  flops += 4 * siluFlops;
+
+  return silu;
+}
+
+Value MLIRGenerator::lowerTanh(Value input, Value output) {
+  if (!enableTanh)
+    return input;
+
+  auto outTy = cast<ShapedType>(input.getType());
+  auto map = getMap(input, MAP_PARALLEL);
+  auto tanh =
+      builder
+          .create<linalg::GenericOp>(
+              loc, outTy, ValueRange{}, ValueRange{input},
+              ArrayRef<AffineMap>{map}, getIterators(MAP_PARALLEL),
+              [&](OpBuilder &nestedBuilder, Location nestedLoc,
+                  ValueRange blockArgs) {
+                auto arg0 = blockArgs[0];
+                auto res = nestedBuilder.create<math::TanhOp>(loc, arg0);
+                nestedBuilder.create<linalg::YieldOp>(loc, ValueRange{res});
+              })
+          .getResult(0);
+
+  // Tanh flops = M * N = prod(outputDims)
+  int64_t tanhFlops = 1;
+  for (int i = 0, max = outTy.getRank(); i < max; i++)
+    tanhFlops *= outTy.getDimSize(i);
+  flops += tanhFlops;
+
+  return tanh;
+}
+
 Value MLIRGenerator::lowerSoftmax(Value input, Value output) {
   if (!enableSoftmax)
     return input;
@@ -436,6 +686,232 @@ Value MLIRGenerator::lowerSoftmax(Value input, Value output) {
   return softmax;
 }
 
+Value MLIRGenerator::lowerProjection(Value input, Value weight, Value bias) {
+  auto inputTy = cast<ShapedType>(input.getType());
+  auto weightTy = cast<ShapedType>(weight.getType());
+  auto outTy = RankedTensorType::get(
+      {inputTy.getDimSize(0), weightTy.getDimSize(1)}, dataType);
+  Value output = getZeroInitTensor(outTy);
+  Value chain = lowerMatmul(input, weight, output);
+  return lowerBiasAdd(chain, bias, chain);
+}
+
+Value MLIRGenerator::splitHeads(Value input) {
+  int64_t headDim = hiddenSize / numHeads;
+  int64_t heads = numHeads;
+  int64_t seq = seqLen;
+  int64_t batchSize = batch;
+
+  // [B * S, E] -> [B, S, H, D] -> [B, H, S, D] -> [B * H, S, D]
+  auto expandedTy =
+      RankedTensorType::get({batchSize, seq, heads, headDim}, dataType);
+  Value expanded = linalgx::utils::expand(builder, loc, input, expandedTy,
+                                          {{0, 1}, {2, 3}});
+  Value transposed = builder.create<tensor::EmptyOp>(
+      loc, ArrayRef<int64_t>{batchSize, heads, seq, headDim}, dataType);
+  transposed = builder
+                   .create<linalg::TransposeOp>(loc, expanded, transposed,
+                                                ArrayRef<int64_t>{0, 2, 1, 3})
+                   .getResult()[0];
+  auto headsTy =
+      RankedTensorType::get({batchSize * heads, seq, headDim}, dataType);
+  return linalgx::utils::collapse(builder, loc, transposed, headsTy,
+                                  {{0, 1}, {2}, {3}});
+}
+
+Value MLIRGenerator::mergeHeads(Value input) {
+  int64_t headDim = hiddenSize / numHeads;
+  int64_t heads = numHeads;
+  int64_t seq = seqLen;
+  int64_t batchSize = batch;
+
+  // [B * H, S, D] -> [B, H, S, D] -> [B, S, H, D] -> [B * S, E]
+  auto expandedTy =
+      RankedTensorType::get({batchSize, heads, seq, headDim}, dataType);
+  Value expanded = linalgx::utils::expand(builder, loc, input, expandedTy,
+                                          {{0, 1}, {2}, {3}});
+  Value transposed = builder.create<tensor::EmptyOp>(
+      loc, ArrayRef<int64_t>{batchSize, seq, heads, headDim}, dataType);
+  transposed = builder
+                   .create<linalg::TransposeOp>(loc, expanded, transposed,
+                                                ArrayRef<int64_t>{0, 2, 1, 3})
+                   .getResult()[0];
+  auto tokenTy =
+      RankedTensorType::get({batchSize * seq, heads * headDim}, dataType);
+  return linalgx::utils::collapse(builder, loc, transposed, tokenTy,
+                                  {{0, 1}, {2, 3}});
+}
+
+Value MLIRGenerator::lowerAttention(Value query, Value key, Value value) {
+  int64_t headDim = hiddenSize / numHeads;
+  int64_t batchHeads = batch * numHeads;
+  int64_t seq = seqLen;
+
+  // Scale the queries by 1 / sqrt(D) before splitting the heads
+  auto tokenTy = cast<ShapedType>(query.getType());
+  auto scale = getConstFloat(builder, 1.0 / std::sqrt(double(headDim)),
+                             cast<FloatType>(dataType));
+  auto map = getMap(query, MAP_PARALLEL);
+  query = builder
+              .create<linalg::GenericOp>(
+                  loc, tokenTy, ValueRange{}, ValueRange{query},
+                  ArrayRef<AffineMap>{map}, getIterators(MAP_PARALLEL),
+                  [&](OpBuilder &nestedBuilder, Location nestedLoc,
+                      ValueRange blockArgs) {
+                    auto arg0 = blockArgs[0];
+                    auto mul =
+                        nestedBuilder.create<arith::MulFOp>(loc, arg0, scale);
+                    nestedBuilder.create<linalg::YieldOp>(loc,
+                                                          ValueRange{mul});
+                  })
+              .getResult(0);
+  flops += tokenTy.getNumElements();
+
+  query = splitHeads(query);
+  key = splitHeads(key);
+  value = splitHeads(value);
+
+  // Scores: Q x K^T, [BH, S, D] x [BH, S, D]^T -> [BH, S, S]
+  auto scoresTy = RankedTensorType::get({batchHeads, seq, seq}, dataType);
+  Value scores = getZeroInitTensor(scoresTy);
+  scores = builder
+               .create<linalg::BatchMatmulTransposeBOp>(
+                   loc, ValueRange{query, key}, ValueRange{scores})
+               .getResult(0);
+  flops += 2 * batchHeads * seq * seq * headDim;
+
+  // Probabilities along the keys
+  Value probs = builder.create<tensor::EmptyOp>(loc, scoresTy, ValueRange{});
+  probs = builder
+              .create<linalg::SoftmaxOp>(loc, TypeRange{scoresTy}, scores,
+                                         probs, builder.getI64IntegerAttr(2))
+              .getResult()[0];
+  flops += 4 * batchHeads * seq * seq;
+
+  // Context: P x V, [BH, S, S] x [BH, S, D] -> [BH, S, D]
+  auto contextTy = RankedTensorType::get({batchHeads, seq, headDim}, dataType);
+  Value context = getZeroInitTensor(contextTy);
+  context = builder
+                .create<linalg::BatchMatmulOp>(loc, ValueRange{probs, value},
+                                               ValueRange{context})
+                .getResult(0);
+  flops += 2 * batchHeads * seq * seq * headDim;
+
+  return mergeHeads(context);
+}
+
+Value MLIRGenerator::lowerResidualAdd(Value input, Value residual) {
+  auto outTy = cast<ShapedType>(input.getType());
+  auto map = getMap(input, MAP_PARALLEL);
+  auto sum =
+      builder
+          .create<linalg::GenericOp>(
+              loc, outTy, ValueRange{residual}, ValueRange{input},
+              ArrayRef<AffineMap>{map, map}, getIterators(MAP_PARALLEL),
+              [&](OpBuilder &nestedBuilder, Location nestedLoc,
+                  ValueRange blockArgs) {
+                auto arg0 = blockArgs[0];
+                auto arg1 = blockArgs[1];
+                auto add = nestedBuilder.create<arith::AddFOp>(loc, arg0, arg1);
+                nestedBuilder.create<linalg::YieldOp>(loc, ValueRange{add});
+              })
+          .getResult(0);
+
+  // Add flops = M * N = prod(outputDims)
+  flops += outTy.getNumElements();
+
+  return sum;
+}
+
+Value MLIRGenerator::lowerLayerNorm(Value input, Value gamma, Value beta) {
+  auto outTy = cast<ShapedType>(input.getType());
+  assert(outTy.getRank() == 2 && "Packed layernorm not implemented yet");
+  auto floatType = cast<FloatType>(dataType);
+  auto map1 = getMap(input, MAP_PARALLEL);
+  auto map2 = getMap(input, MAP_REDUCTION);
+  auto mapB = getMap(input, MAP_BROADCAST);
+  auto invN = getConstFloat(builder, 1.0 / outTy.getDimSize(1), floatType);
+  auto eps = getConstFloat(builder, 1e-5, floatType);
+
+  // Statistics are reduced into [M, 1] tensors
+  auto redTy = RankedTensorType::get({outTy.getDimSize(0), 1}, dataType);
+
+  // First, the mean: sum(x / N)
+  Value mean = builder
+                   .create<linalg::GenericOp>(
+                       loc, redTy, ValueRange{input},
+                       ValueRange{getZeroInitTensor(redTy)},
+                       ArrayRef<AffineMap>{map1, map2},
+                       getIterators(MAP_REDUCTION),
+                       [&](OpBuilder &nestedBuilder, Location nestedLoc,
+                           ValueRange blockArgs) {
+                         auto arg0 = blockArgs[0];
+                         auto arg1 = blockArgs[1];
+                         auto mul = nestedBuilder.create<arith::MulFOp>(
+                             loc, arg0, invN);
+                         auto add =
+                             nestedBuilder.create<arith::AddFOp>(loc, mul, arg1);
+                         nestedBuilder.create<linalg::YieldOp>(
+                             loc, ValueRange{add});
+                       })
+                   .getResult(0);
+
+  // Second, the variance: sum((x - mean)^2 / N)
+  Value var = builder
+                  .create<linalg::GenericOp>(
+                      loc, redTy, ValueRange{input, mean},
+                      ValueRange{getZeroInitTensor(redTy)},
+                      ArrayRef<AffineMap>{map1, map2, map2},
+                      getIterators(MAP_REDUCTION),
+                      [&](OpBuilder &nestedBuilder, Location nestedLoc,
+                          ValueRange blockArgs) {
+                        auto arg0 = blockArgs[0];
+                        auto arg1 = blockArgs[1];
+                        auto arg2 = blockArgs[2];
+                        auto sub =
+                            nestedBuilder.create<arith::SubFOp>(loc, arg0, arg1);
+                        auto sqr =
+                            nestedBuilder.create<arith::MulFOp>(loc, sub, sub);
+                        auto mul =
+                            nestedBuilder.create<arith::MulFOp>(loc, sqr, invN);
+                        auto add =
+                            nestedBuilder.create<arith::AddFOp>(loc, mul, arg2);
+                        nestedBuilder.create<linalg::YieldOp>(
+                            loc, ValueRange{add});
+                      })
+                  .getResult(0);
+
+  // Third, normalize, scale and shift: (x - mean) * rsqrt(var + eps) * g + b
+  Value normTensor = builder.create<tensor::EmptyOp>(loc, outTy, ValueRange{});
+  auto norm =
+      builder
+          .create<linalg::GenericOp>(
+              loc, outTy, ValueRange{input, mean, var, gamma, beta},
+              ValueRange{normTensor},
+              ArrayRef<AffineMap>{map1, map2, map2, mapB, mapB, map1},
+              getIterators(MAP_PARALLEL),
+              [&](OpBuilder &nestedBuilder, Location nestedLoc,
+                  ValueRange blockArgs) {
+                auto sub = nestedBuilder.create<arith::SubFOp>(
+                    loc, blockArgs[0], blockArgs[1]);
+                auto add =
+                    nestedBuilder.create<arith::AddFOp>(loc, blockArgs[2], eps);
+                auto rstd = nestedBuilder.create<math::RsqrtOp>(loc, add);
+                auto mul = nestedBuilder.create<arith::MulFOp>(loc, sub, rstd);
+                auto scale =
+                    nestedBuilder.create<arith::MulFOp>(loc, mul, blockArgs[3]);
+                auto shift = nestedBuilder.create<arith::AddFOp>(
+                    loc, scale, blockArgs[4]);
+                nestedBuilder.create<linalg::YieldOp>(loc, ValueRange{shift});
+              })
+          .getResult(0);
+
+  // LayerNorm flops = 12 * M * N: mean (2), variance (4), normalization (6)
+  flops += 12 * outTy.getNumElements();
+
+  return norm;
+}
+
 TensorType MLIRGenerator::getShape(ArrayRef<int64_t> dims, PackingType type) {
   // Already packed type, just return ND tensor
   if (dims.size() > 2)
@@ -71,9 +71,37 @@ class MLIRGenerator {
   /// Lower ReLU on every layer
   bool enableRelu;
 
+  /// Lower GELU on every layer
+  bool enableGelu;
+
+  /// Lower SiLU on every layer
+  bool enableSilu;
+
+  /// Lower tanh on every layer
+  bool enableTanh;
+
   /// Lower softmax at the last layer
   bool enableSoftmax;
 
+  /// List of supported models that can be generated
+  ///  * MLP: N * {GEMM + AddBias + Activation} + Softmax.
+  ///  * MHA: QKV projections, multi-head attention and output projection.
+  ///  * Transformer: MHA + residual + layernorm, GELU MLP + residual +
+  ///    layernorm (post-LN encoder block).
+  enum class ModelType { MLP, MHA, Transformer };
+
+  /// Type of model to be generated
+  ModelType modelType;
+
+  /// Sequence length (attention models)
+  unsigned seqLen;
+
+  /// Number of attention heads (attention models)
+  unsigned numHeads;
+
+  /// Hidden (embedding) size (attention models)
+  unsigned hiddenSize;
+
   /// List of supported kernel types that can be generated
   ///  * Const: Generates weights and biases as constant (RO).
   ///  * Args: Generates weights and biaseds as arguments (RW).
@@ -85,6 +113,9 @@ class MLIRGenerator {
   /// VNNI packing factor (0, 2, 4)
   int vnniFactor;
 
+  /// Mark weight arguments as prepacked offline (Args kernel only)
+  bool prepackedWeights;
+
   // ============================ Helpers
 
   /// Return current random seed, update next
@@ -142,11 +173,64 @@ class MLIRGenerator {
   /// Returns the chain value to be used in the next op
   Value lowerRelu(Value, Value);
 
+  /// Creates a GELU (erf form) in the current function
+  /// Args: Input, Output (same for in-place)
+  /// Returns the chain value to be used in the next op
+  Value lowerGelu(Value, Value);
+
+  /// Creates a SiLU (x * sigmoid(x)) in the current function
+  /// Args: Input, Output (same for in-place)
+  /// Returns the chain value to be used in the next op
+  Value lowerSilu(Value, Value);
+
+  /// Creates a tanh in the current function
+  /// Args: Input, Output (same for in-place)
+  /// Returns the chain value to be used in the next op
+  Value lowerTanh(Value, Value);
+
   /// Creates a softmax in the current function
   /// Args: Input, Output (same for in-place)
   /// Returns the chain value to be used in the next op
   Value lowerSoftmax(Value, Value);
 
+  // ============================ Attention Models
+
+  /// Creates a matmul into a new zero tensor plus the optional bias add
+  /// Args: Input, Weight, Bias
+  /// Returns the chain value to be used in the next op
+  Value lowerProjection(Value, Value, Value);
+
+  /// Reshapes tokens into heads: [B*S, E] -> [B*H, S, E/H]
+  Value splitHeads(Value);
+
+  /// Reshapes heads back into tokens: [B*H, S, E/H] -> [B*S, E]
+  Value mergeHeads(Value);
+
+  /// Creates a multi-head scaled dot-product attention in the current function
+  /// Args: Query, Key, Value projections (tokens)
+  /// Returns the attention context (tokens)
+  Value lowerAttention(Value, Value, Value);
+
+  /// Creates a residual add in the current function
+  /// Args: Input, Residual
+  /// Returns the chain value to be used in the next op
+  Value lowerResidualAdd(Value, Value);
+
+  /// Creates a layernorm over the hidden dimension in the current function
+  /// Args: Input, Gamma, Beta
+  /// Returns the chain value to be used in the next op
+  Value lowerLayerNorm(Value, Value, Value);
+
+  /// Checks the arguments of an attention model, emits an error if invalid
+  LogicalResult verifyAttentionArgs();
+
+  /// Returns the types of the weights of an attention model, in the order in
+  /// which they are consumed
+  SmallVector<TensorType> getAttentionWeightTypes();
+
+  /// Creates an attention kernel (MHA or Transformer block)
+  void createAttentionKernel();
+
   // ============================ Main API
 
   /// Creates metadata string containing run command, flops info etc.
@@ -181,16 +265,17 @@ class MLIRGenerator {
   /// Creates a layer function, to be called by the kernel
   Value createLayer(LayerArgs &);
 
-  /// Creates a kernel (N * {GEMM + AddBias + ReLU} + Softmax)
-  /// AddBias, ReLU and Softmax are optional
+  /// Creates a kernel (N * {GEMM + AddBias + Activation} + Softmax)
+  /// AddBias, Activation (ReLU, GELU, SiLU or tanh) and Softmax are optional
   void createKernel();
 
 public:
   /// Creates a specific module. Different configurations need different modules
   /// so should create new objects to not have to share / cleanup existing MLIR
   /// modules.
-  MLIRGenerator(StringRef, unsigned, StringRef, StringRef, StringRef, int, bool,
-                bool, bool, int);
+  MLIRGenerator(StringRef, StringRef, unsigned, StringRef, StringRef, StringRef,
+                int, bool, bool, bool, bool, bool, bool, int, bool, unsigned,
+                unsigned, unsigned);
 
   ~MLIRGenerator() { module->destroy(); }
 
@@ -31,6 +31,11 @@ llvm::cl::opt<std::string> kernel("kernel",
                                   llvm::cl::value_desc("const,args"),
                                   llvm::cl::init("const"));
 
+// Type of model to be generated
+llvm::cl::opt<std::string>
+    model("model", llvm::cl::desc("Model type to be generated"),
+          llvm::cl::value_desc("mlp,mha,transformer"), llvm::cl::init("mlp"));
+
 // Input layer
 llvm::cl::opt<unsigned> batch("batch", llvm::cl::desc("Mini batch size"),
                               llvm::cl::value_desc("256"), llvm::cl::init(256));
@@ -41,6 +46,22 @@ llvm::cl::opt<std::string> layers(
     llvm::cl::desc("Comma-separated values of size of each layer (at least 2)"),
     llvm::cl::value_desc("128,256,512"), llvm::cl::init("128,256,512"));
 
+// Sequence length (attention models)
+llvm::cl::opt<unsigned>
+    seqLen("seq-len", llvm::cl::desc("Sequence length (mha, transformer)"),
+           llvm::cl::value_desc("128"), llvm::cl::init(128));
+
+// Attention heads (attention models)
+llvm::cl::opt<unsigned>
+    heads("heads",
+          llvm::cl::desc("Number of attention heads (mha, transformer)"),
+          llvm::cl::value_desc("8"), llvm::cl::init(8));
+
+// Hidden size (attention models)
+llvm::cl::opt<unsigned> hiddenSize(
+    "hidden-size", llvm::cl::desc("Hidden size (mha, transformer)"),
+    llvm::cl::value_desc("512"), llvm::cl::init(512));
+
 // Tile sizes (N, C, K)
 llvm::cl::opt<std::string>
     tiles("tiles",
@@ -73,6 +94,24 @@ llvm::cl::opt<bool> enableRelu("relu",
                                llvm::cl::value_desc("bool"),
                                llvm::cl::init(false));
 
+// Enable gelu on every layer
+llvm::cl::opt<bool> enableGelu("gelu",
+                               llvm::cl::desc("Enable gelu on every layer"),
+                               llvm::cl::value_desc("bool"),
+                               llvm::cl::init(false));
+
+// Enable silu on every layer
+llvm::cl::opt<bool> enableSilu("silu",
+                               llvm::cl::desc("Enable silu on every layer"),
+                               llvm::cl::value_desc("bool"),
+                               llvm::cl::init(false));
+
+// Enable tanh on every layer
+llvm::cl::opt<bool> enableTanh("tanh",
+                               llvm::cl::desc("Enable tanh on every layer"),
+                               llvm::cl::value_desc("bool"),
+                               llvm::cl::init(false));
+
 // Enable softmax at the last layer
 llvm::cl::opt<bool>
     enableSoftmax("softmax", llvm::cl::desc("Enable softmax on the last layer"),
@@ -83,6 +122,12 @@ llvm::cl::opt<int>
     vnni("vnni", llvm::cl::desc("VNNI packing factor (disabled if zero)"),
          llvm::cl::value_desc("0|2|4"), llvm::cl::init(0));
 
+// Mark weights as prepacked offline (see tpp-prepack)
+llvm::cl::opt<bool> prepackedWeights(
+    "prepacked-weights",
+    llvm::cl::desc("Mark weight arguments as prepacked (args kernel only)"),
+    llvm::cl::value_desc("bool"), llvm::cl::init(false));
+
 int main(int argc, char **argv) {
   // Add the following to include *all* MLIR Core dialects, or selectively
   // include what you need like above. You only need to register dialects that
@@ -92,7 +137,9 @@ int main(int argc, char **argv) {
 
   llvm::cl::ParseCommandLineOptions(argc, argv, "MLIR Generator");
 
-  MLIRGenerator gen(kernel, batch, layers, tiles, floatType, seed, enableBias,
-                    enableRelu, enableSoftmax, vnni);
+  MLIRGenerator gen(model, kernel, batch, layers, tiles, floatType, seed,
+                    enableBias, enableRelu, enableGelu, enableSilu, enableTanh,
+                    enableSoftmax, vnni, prepackedWeights, seqLen, heads,
+                    hiddenSize);
   return gen.generate(filename);
 }
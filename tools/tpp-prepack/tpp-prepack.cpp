@@ -0,0 +1,284 @@
+//===- tpp-prepack.cpp - TPP Offline Weight Packing -----------------------===//
+//
+// Main entry point to a command line utility that packs weights offline. The
+// kernel is compiled up to the layout decisions, with the selected argument
+// marked as prepacked, so that the block factors and VNNI layout match the
+// ones the compiler picks. The raw (row-major) data of the argument is then
+// rearranged into the packed layout and written to a binary file, which can
+// be passed to the kernel directly.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/InitAllExtensions.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+#include "TPP/Dialect/Check/CheckDialect.h"
+#include "TPP/Dialect/Perf/PerfDialect.h"
+#include "TPP/Dialect/Xsmm/XsmmDialect.h"
+#include "TPP/Passes.h"
+#include "TPP/Transforms/Utils/TransformUtils.h"
+
+#include <cstring>
+
+using namespace mlir;
+
+// Input MLIR file
+llvm::cl::opt<std::string> inputFilename(llvm::cl::Positional,
+                                         llvm::cl::desc("<input file>"),
+                                         llvm::cl::init("-"));
+
+// Kernel function
+llvm::cl::opt<std::string> entryName("e", llvm::cl::desc("Kernel function"),
+                                     llvm::cl::value_desc("name"),
+                                     llvm::cl::init("entry"));
+
+// Argument to prepack
+llvm::cl::opt<unsigned> argNum("arg",
+                               llvm::cl::desc("Position of the argument to "
+                                              "prepack (e.g., the weights)"),
+                               llvm::cl::value_desc("int"), llvm::cl::init(1));
+
+// Raw data of the argument, if empty only print the layout
+llvm::cl::opt<std::string>
+    dataFilename("data",
+                 llvm::cl::desc("Row-major data of the argument in its "
+                                "element type (only print layout if empty)"),
+                 llvm::cl::value_desc("filename"), llvm::cl::init(""));
+
+// Packed data
+llvm::cl::opt<std::string> outputFilename("o",
+                                          llvm::cl::desc("Packed data file"),
+                                          llvm::cl::value_desc("filename"),
+                                          llvm::cl::init(""));
+
+// Compiler options that affect the layouts, as in default-tpp-passes.
+llvm::cl::opt<bool>
+    fusePacks("fuse-packs",
+              llvm::cl::desc("Pack input blocks right before their use"),
+              llvm::cl::init(false));
+
+llvm::cl::opt<int64_t> smallGemmSize(
+    "small-gemm-size",
+    llvm::cl::desc("Do not pack batch matmuls with static per-batch m, n and "
+                   "k all at most this size (0 packs all of them)"),
+    llvm::cl::value_desc("int"), llvm::cl::init(0));
+
+namespace {
+
+// Layout of a single tensor.pack, as recorded by the blocked layout ABI.
+struct PackLayout {
+  SmallVector<int64_t> innerDimsPos;
+  SmallVector<int64_t> innerTiles;
+  SmallVector<int64_t> outerDimsPerm;
+};
+
+FailureOr<PackLayout> parsePackLayout(Attribute attr) {
+  auto dict = dyn_cast<DictionaryAttr>(attr);
+  if (!dict)
+    return failure();
+  auto innerDimsPos = dict.getAs<DenseI64ArrayAttr>("inner_dims_pos");
+  auto innerTiles = dict.getAs<DenseI64ArrayAttr>("inner_tiles");
+  auto outerDimsPerm = dict.getAs<DenseI64ArrayAttr>("outer_dims_perm");
+  if (!innerDimsPos || !innerTiles || !outerDimsPerm)
+    return failure();
+  return PackLayout{llvm::to_vector(innerDimsPos.asArrayRef()),
+                    llvm::to_vector(innerTiles.asArrayRef()),
+                    llvm::to_vector(outerDimsPerm.asArrayRef())};
+}
+
+// The layout is either a single pack or a chain of packs.
+LogicalResult parseBlockedLayout(Attribute attr,
+                                 SmallVectorImpl<PackLayout> &packs) {
+  SmallVector<Attribute> packAttrs;
+  if (auto array = dyn_cast<ArrayAttr>(attr))
+    packAttrs.append(array.begin(), array.end());
+  else
+    packAttrs.push_back(attr);
+  for (Attribute packAttr : packAttrs) {
+    FailureOr<PackLayout> pack = parsePackLayout(packAttr);
+    if (failed(pack))
+      return failure();
+    packs.push_back(*pack);
+  }
+  return success();
+}
+
+// Rearrange `src`, a row-major buffer of shape `srcType`, into `packedType`
+// following the tensor.pack semantics. Padding is not supported, the tiles
+// must divide the packed dimensions.
+std::vector<char> packData(ArrayRef<char> src, RankedTensorType srcType,
+                           RankedTensorType packedType,
+                           const PackLayout &layout, size_t elemSize) {
+  ArrayRef<int64_t> srcShape = srcType.getShape();
+  ArrayRef<int64_t> dstShape = packedType.getShape();
+  size_t srcRank = srcShape.size();
+  std::vector<char> dst(packedType.getNumElements() * elemSize);
+
+  SmallVector<int64_t> dstIdx(dstShape.size(), 0);
+  SmallVector<int64_t> srcIdx(srcRank, 0);
+  for (int64_t linear = 0, e = packedType.getNumElements(); linear < e;
+       ++linear) {
+    // Outer dimensions, undoing the outer permutation.
+    for (size_t i = 0; i < srcRank; i++) {
+      size_t dim = layout.outerDimsPerm.empty() ? i : layout.outerDimsPerm[i];
+      srcIdx[dim] = dstIdx[i];
+    }
+    // Inner tiles.
+    for (auto [pos, dim] : llvm::enumerate(layout.innerDimsPos)) {
+      srcIdx[dim] =
+          srcIdx[dim] * layout.innerTiles[pos] + dstIdx[srcRank + pos];
+    }
+    int64_t srcLinear = 0;
+    for (size_t i = 0; i < srcRank; i++)
+      srcLinear = srcLinear * srcShape[i] + srcIdx[i];
+    std::memcpy(&dst[linear * elemSize], &src[srcLinear * elemSize], elemSize);
+
+    // Next destination index.
+    for (int64_t i = dstShape.size() - 1; i >= 0; i--) {
+      if (++dstIdx[i] < dstShape[i])
+        break;
+      dstIdx[i] = 0;
+    }
+  }
+  return dst;
+}
+
+void printLayout(llvm::raw_ostream &os, const PackLayout &layout) {
+  os << "inner_dims_pos = [";
+  llvm::interleaveComma(layout.innerDimsPos, os);
+  os << "] inner_tiles = [";
+  llvm::interleaveComma(layout.innerTiles, os);
+  os << "] outer_dims_perm = [";
+  llvm::interleaveComma(layout.outerDimsPerm, os);
+  os << "]";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  llvm::InitLLVM y(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv, "TPP offline weight packing");
+
+  DialectRegistry registry;
+  registry.insert<xsmm::XsmmDialect>();
+  registry.insert<check::CheckDialect>();
+  registry.insert<perf::PerfDialect>();
+  registerAllDialects(registry);
+  registerAllExtensions(registry);
+  MLIRContext context(registry);
+  context.loadAllAvailableDialects();
+
+  OwningOpRef<ModuleOp> module =
+      parseSourceFile<ModuleOp>(inputFilename, &context);
+  if (!module)
+    return 1;
+
+  auto kernel = module->lookupSymbol<func::FuncOp>(entryName);
+  if (!kernel || kernel.isExternal()) {
+    llvm::errs() << "Kernel function not found: @" << entryName << "\n";
+    return 1;
+  }
+  if (argNum >= kernel.getNumArguments()) {
+    llvm::errs() << "Invalid argument position: " << argNum << "\n";
+    return 1;
+  }
+  auto plainType =
+      dyn_cast<RankedTensorType>(kernel.getArgumentTypes()[argNum]);
+  if (!plainType || !plainType.hasStaticShape()) {
+    llvm::errs() << "Expect a statically shaped tensor argument\n";
+    return 1;
+  }
+
+  // Let the compiler pick the layout of the argument, as it would when
+  // compiling the kernel.
+  kernel.setArgAttr(argNum, linalgx::utils::kPrepacked,
+                    UnitAttr::get(&context));
+  PassManager pm(&context);
+  pm.addPass(tpp::createTppPacking(
+      tpp::TppPackingOptions{fusePacks, smallGemmSize}));
+  if (failed(pm.run(*module)))
+    return 1;
+
+  Attribute layoutAttr =
+      kernel.getArgAttr(argNum, linalgx::utils::kBlockedLayout);
+  SmallVector<PackLayout> packs;
+  if (!layoutAttr || failed(parseBlockedLayout(layoutAttr, packs))) {
+    llvm::errs() << "Argument " << argNum << " of @" << entryName
+                 << " is not packed by the compiler\n";
+    return 1;
+  }
+
+  // Compute the packed type after each pack.
+  SmallVector<RankedTensorType> types = {plainType};
+  for (const PackLayout &pack : packs) {
+    RankedTensorType srcType = types.back();
+    for (auto [pos, dim] : llvm::enumerate(pack.innerDimsPos)) {
+      if (srcType.getDimSize(dim) % pack.innerTiles[pos] != 0) {
+        llvm::errs() << "Padding is not supported\n";
+        return 1;
+      }
+    }
+    types.push_back(tensor::PackOp::inferPackedType(
+        srcType, pack.innerTiles, pack.innerDimsPos, pack.outerDimsPerm));
+  }
+  if (types.back() != kernel.getArgumentTypes()[argNum]) {
+    llvm::errs() << "Packed type " << types.back()
+                 << " does not match the kernel signature: "
+                 << kernel.getArgumentTypes()[argNum] << "\n";
+    return 1;
+  }
+
+  llvm::outs() << "@" << entryName << " argument " << argNum << ": "
+               << plainType << " -> " << types.back() << "\n";
+  for (const PackLayout &pack : packs) {
+    llvm::outs() << "  pack ";
+    printLayout(llvm::outs(), pack);
+    llvm::outs() << "\n";
+  }
+  if (dataFilename.empty())
+    return 0;
+
+  // Pack the data.
+  size_t elemSize = llvm::divideCeil(plainType.getElementTypeBitWidth(), 8);
+  auto buffer = llvm::MemoryBuffer::getFile(dataFilename, /*IsText=*/false);
+  if (std::error_code error = buffer.getError()) {
+    llvm::errs() << dataFilename << ": " << error.message() << "\n";
+    return 1;
+  }
+  size_t expectedSize = plainType.getNumElements() * elemSize;
+  if ((*buffer)->getBufferSize() != expectedSize) {
+    llvm::errs() << dataFilename << ": expect " << expectedSize
+                 << " bytes for " << plainType << "\n";
+    return 1;
+  }
+  std::vector<char> data((*buffer)->getBufferStart(),
+                         (*buffer)->getBufferEnd());
+  for (auto [idx, pack] : llvm::enumerate(packs))
+    data = packData(data, types[idx], types[idx + 1], pack, elemSize);
+
+  std::string filename =
+      outputFilename.empty() ? dataFilename + ".packed" : outputFilename;
+  std::error_code error;
+  llvm::ToolOutputFile output(filename, error, llvm::sys::fs::OF_None);
+  if (error) {
+    llvm::errs() << filename << ": " << error.message() << "\n";
+    return 1;
+  }
+  output.os().write(data.data(), data.size());
+  output.keep();
+  return 0;
+}
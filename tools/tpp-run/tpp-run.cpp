@@ -145,6 +145,35 @@ llvm::cl::opt<bool>
                llvm::cl::desc("Kernel buffers are allocated on GPU"),
                llvm::cl::init(true));
 
+// Kernel arguments and results are passed in blocked layout.
+llvm::cl::opt<bool>
+    blockedAbi("blocked-abi",
+               llvm::cl::desc("Pass kernel buffers in blocked layout"),
+               llvm::cl::init(false));
+
+// Benchmark the kernel specialized for a shape bucket
+llvm::cl::opt<int64_t>
+    shapeBucket("shape-bucket",
+                llvm::cl::desc("Run the kernel specialized for the given "
+                               "size of its dynamic dimension"),
+                llvm::cl::value_desc("int"), llvm::cl::init(0));
+
+// Vectorize the element-wise ops left over by XSMM for the target FPU.
+llvm::cl::opt<bool>
+    vectorize("vectorize",
+              llvm::cl::desc("Vectorize leftover element-wise ops for the "
+                             "vector registers of the target FPU"),
+              llvm::cl::init(false));
+
+// Width in bits of the vector registers of the target FPU.
+static unsigned getVectorWidth(StringRef fpu) {
+  if (fpu.starts_with("avx512"))
+    return 512;
+  if (fpu.starts_with("avx"))
+    return 256;
+  return 128;
+}
+
 // This function will be called by the pass manager after parsing,
 // so we can modify the IR with the needed wrappers
 static LogicalResult prepareMLIRKernel(Operation *op,
@@ -168,9 +197,13 @@ static LogicalResult prepareMLIRKernel(Operation *op,
   wrapperOpts.randomSplat = splatRandom;
   wrapperOpts.seed = seed;
   wrapperOpts.initType = initType;
+  wrapperOpts.blockedAbi = blockedAbi;
+  wrapperOpts.shapeBucket = shapeBucket;
   passManager.addPass(tpp::createTppRunnerWrapper(wrapperOpts));
 
   tpp::DefaultPipelineOptions defPipelineOpts{defGpuBackend};
+  if (vectorize)
+    defPipelineOpts.vectorWidth = getVectorWidth(fpuName);
   passManager.addPass(tpp::createDefaultPipeline(defPipelineOpts));
 
   auto result = passManager.run(module);